@@ -171,6 +171,15 @@ if(CMAKE_COMPILER_IS_GNUCXX)
     add_extra_compiler_option(-mfpu=neon)
   endif()
 
+  # the flags for the *.avx2.cpp sources; their code is only called when the CPU supports AVX2
+  if(ENABLE_AVX2_DISPATCH AND NOT MINGW)
+    ocv_check_flag_support(CXX "-mavx2" _varname)
+    if(${_varname})
+      set(OPENCV_DISPATCH_AVX2_FLAGS "-mavx2")
+      set(HAVE_DISPATCH_AVX2 1)
+    endif()
+  endif()
+
   # Profiling?
   if(ENABLE_PROFILING)
     add_extra_compiler_option("-pg -g")
@@ -218,6 +227,12 @@ if(MSVC)
     set(OPENCV_EXTRA_FLAGS "${OPENCV_EXTRA_FLAGS} /arch:AVX")
   endif()
 
+  # /arch:AVX2 is available since VS 2013 Update 2
+  if(ENABLE_AVX2_DISPATCH AND NOT MSVC_VERSION LESS 1800)
+    set(OPENCV_DISPATCH_AVX2_FLAGS "/arch:AVX2")
+    set(HAVE_DISPATCH_AVX2 1)
+  endif()
+
   if(ENABLE_SSE4_1 AND CV_ICC AND NOT OPENCV_EXTRA_FLAGS MATCHES "/arch:")
     set(OPENCV_EXTRA_FLAGS "${OPENCV_EXTRA_FLAGS} /arch:SSE4.1")
   endif()
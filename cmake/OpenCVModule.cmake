@@ -477,6 +477,18 @@ macro(ocv_set_module_sources)
   set(OPENCV_MODULE_${the_module}_SOURCES ${OPENCV_MODULE_${the_module}_SOURCES} CACHE INTERNAL "List of source files for ${the_module}")
 endmacro()
 
+# compiles the sources named <name>.avx2.cpp with the AVX2 flags; without them such sources
+# compile to nothing, so the callers must check HAVE_DISPATCH_AVX2
+# Usage:
+#   ocv_set_dispatch_flags(<list of sources>)
+macro(ocv_set_dispatch_flags)
+  foreach(src ${ARGN})
+    if(src MATCHES "\\.avx2\\.cpp$" AND HAVE_DISPATCH_AVX2)
+      set_source_files_properties(${src} PROPERTIES COMPILE_FLAGS "${OPENCV_DISPATCH_AVX2_FLAGS}")
+    endif()
+  endforeach()
+endmacro()
+
 # finds and sets headers and sources for the standard OpenCV module
 # Usage:
 # ocv_glob_module_sources([EXCLUDE_CUDA] <extra sources&headers in the same format as used in ocv_set_module_sources>)
@@ -489,6 +501,7 @@ macro(ocv_glob_module_sources)
 
   file(GLOB_RECURSE lib_srcs "src/*.cpp")
   file(GLOB_RECURSE lib_int_hdrs "src/*.hpp" "src/*.h")
+  ocv_set_dispatch_flags(${lib_srcs})
   file(GLOB lib_hdrs     "include/opencv2/*.hpp" "include/opencv2/${name}/*.hpp" "include/opencv2/${name}/*.h")
   file(GLOB lib_hdrs_detail "include/opencv2/${name}/detail/*.hpp" "include/opencv2/${name}/detail/*.h")
   file(GLOB_RECURSE lib_srcs_apple "src/*.mm")
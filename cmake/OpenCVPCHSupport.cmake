@@ -194,7 +194,9 @@ MACRO(ADD_PRECOMPILED_HEADER_TO_TARGET _targetName _input _pch_output_to_use )
 
     GET_TARGET_PROPERTY(_sources ${_targetName} SOURCES)
     FOREACH(src ${_sources})
-      if(NOT "${src}" MATCHES "\\.mm$")
+      # runtime dispatched sources are built with other instruction set flags and must not pull in
+      # the inline code of the precompiled header
+      if(NOT "${src}" MATCHES "\\.mm$" AND NOT "${src}" MATCHES "\\.avx2\\.cpp$")
         get_source_file_property(_flags "${src}" COMPILE_FLAGS)
         if(_flags)
           set(_flags "${_flags} ${_target_cflags}")
@@ -476,6 +476,51 @@ CV_EXPORTS_W void dft(InputArray src, OutputArray dst, int flags = 0, int nonzer
 //! performs inverse 1D or 2D Discrete Fourier Transformation
 CV_EXPORTS_W void idft(InputArray src, OutputArray dst, int flags = 0, int nonzeroRows = 0);
 
+/*!
+    Discrete Fourier Transformation plan
+
+    The class precomputes the factorization of the transform lengths, the permutation tables and
+    the twiddle factors used by dft() for the matrices of the given size and depth, so that the
+    repeated transforms of the same size (e.g. of the image tiles) do not recompute them.
+    The plan does not change once created, so execute() may be called from several threads
+    at once. The same plan serves the forward and the inverse, the real and the complex transforms.
+
+    \code
+    DFTPlan plan(tileSize, CV_32F);
+    for( size_t i = 0; i < tiles.size(); i++ )
+        plan.execute(tiles[i], spectrums[i], DFT_COMPLEX_OUTPUT);
+    \endcode
+*/
+class CV_EXPORTS DFTPlan
+{
+public:
+    //! default constructor
+    DFTPlan();
+
+    //! the constructor that creates the plan for the matrices of the given size and type (only its depth matters)
+    DFTPlan(Size size, int type);
+
+    //! creates the plan. The previously stored tables, if any, are released
+    void create(Size size, int type);
+
+    //! performs the same transformation as dft(src, dst, flags, nonzeroRows); src must have the plan size and depth
+    void execute(InputArray src, OutputArray dst, int flags = 0, int nonzeroRows = 0) const;
+
+    //! returns true if the plan has not been created
+    bool empty() const;
+
+    //! the size of the transformed matrices
+    Size size() const;
+
+    //! the depth of the transformed matrices, CV_32F or CV_64F
+    int depth() const;
+
+    struct Impl;
+
+protected:
+    Ptr<Impl> p;
+};
+
 //! performs forward or inverse 1D or 2D Discrete Cosine Transformation
 CV_EXPORTS_W void dct(InputArray src, OutputArray dst, int flags = 0);
 
@@ -111,6 +111,7 @@
 #define CV_CPU_POPCNT  8
 #define CV_CPU_AVX    10
 #define CV_CPU_NEON   11
+#define CV_CPU_AVX2   12
 // when adding to this list remember to update the enum in core/utility.cpp
 #define CV_HARDWARE_MAX_FEATURE 255
 
@@ -142,6 +143,9 @@
 // See: http://connect.microsoft.com/VisualStudio/feedback/details/605858/arch-avx-should-define-a-predefined-macro-in-x64-and-set-a-unique-value-for-m-ix86-fp-in-win32
 #    include <immintrin.h>
 #    define CV_AVX 1
+#    if defined __AVX2__
+#      define CV_AVX2 1
+#    endif
 #    if defined(_XCR_XFEATURE_ENABLED_MASK)
 #      define __xgetbv() _xgetbv(_XCR_XFEATURE_ENABLED_MASK)
 #    else
@@ -183,6 +187,9 @@
 #ifndef CV_AVX
 #  define CV_AVX 0
 #endif
+#ifndef CV_AVX2
+#  define CV_AVX2 0
+#endif
 #ifndef CV_NEON
 #  define CV_NEON 0
 #endif
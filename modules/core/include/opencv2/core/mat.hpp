@@ -923,6 +923,13 @@ public:
     MatAllocator* allocator;
     //! and the standard allocator
     static MatAllocator* getStdAllocator();
+    //! the allocator used by create() when no custom allocator is set; getStdAllocator() by default
+    static MatAllocator* getDefaultAllocator();
+    //! sets the default allocator; NULL restores the standard one. Should be called before any processing starts
+    static void setDefaultAllocator(MatAllocator* allocator);
+    //! the allocator that keeps the released buffers in a size-bucketed pool for reuse.
+    //! The pool is configured via getBufferPoolController(), the initial limit is taken from OPENCV_BUFFERPOOL_LIMIT
+    static MatAllocator* getBufferPoolAllocator();
 
     //! interaction with UMat
     UMatData* u;
@@ -1150,6 +1157,54 @@ typedef Mat_<Vec2d> Mat2d;
 typedef Mat_<Vec3d> Mat3d;
 typedef Mat_<Vec4d> Mat4d;
 
+/*!
+ Matrix backed by a memory-mapped file
+
+ The class maps a region of a raw binary file into memory and makes the matrix header point to it,
+ so the data is paged in on demand instead of being read into a heap buffer. The mapping is
+ reference-counted like any other matrix data: it is unmapped when the last Mat referencing it
+ (including its ROIs and copies of the header) is released, so MappedMat may be freely assigned to Mat.
+
+ The file must store the elements continuously, row by row, starting at the given offset.
+ In READ_ONLY mode the data must not be modified. In COPY_ON_WRITE mode the modified pages become
+ private copies of the process and the file itself is never changed.
+
+ \code
+ // process a 100-frame dump of 1920x1080 16-bit frames without loading it into memory
+ int sizes[] = { 100, 1080, 1920 };
+ MappedMat frames("frames.raw", 3, sizes, CV_16U);
+ frames.advise(MappedMat::ADVISE_SEQUENTIAL);
+ for( int i = 0; i < sizes[0]; i++ )
+ {
+     Mat frame(sizes[1], sizes[2], CV_16U, frames.ptr(i));
+     ...
+ }
+ \endcode
+*/
+class CV_EXPORTS MappedMat : public Mat
+{
+public:
+    //! the access modes
+    enum { READ_ONLY = 0, COPY_ON_WRITE = 1 };
+    //! the access pattern hints passed to advise()
+    enum { ADVISE_NORMAL = 0, ADVISE_SEQUENTIAL = 1, ADVISE_RANDOM = 2, ADVISE_WILLNEED = 3 };
+
+    //! default constructor
+    MappedMat();
+    //! maps the 2D matrix; when rows <= 0, the number of rows is computed from the file size
+    MappedMat(const String& filename, int rows, int cols, int type, int flags = READ_ONLY, size_t offset = 0);
+    //! maps the n-dimensional matrix
+    MappedMat(const String& filename, int ndims, const int* sizes, int type, int flags = READ_ONLY, size_t offset = 0);
+
+    //! maps the 2D matrix. The previously referenced data, if any, is released
+    void open(const String& filename, int rows, int cols, int type, int flags = READ_ONLY, size_t offset = 0);
+    //! maps the n-dimensional matrix. The previously referenced data, if any, is released
+    void open(const String& filename, int ndims, const int* sizes, int type, int flags = READ_ONLY, size_t offset = 0);
+
+    //! tells the system how the matrix data is going to be accessed; returns false if the hint is not supported
+    bool advise(int hint) const;
+};
+
 class CV_EXPORTS UMat
 {
 public:
@@ -2235,6 +2290,8 @@ public:
 };
 
 
+struct MatExprNode;
+
 class CV_EXPORTS MatExpr
 {
 public:
@@ -2270,6 +2327,9 @@ public:
     Mat a, b, c;
     double alpha, beta;
     Scalar s;
+
+    //! the tree of nested element-wise operations, evaluated in a single pass (see matop.cpp)
+    Ptr<MatExprNode> fused;
 };
 
 
@@ -2315,26 +2375,56 @@ CV_EXPORTS MatExpr operator / (const MatExpr& e1, const MatExpr& e2);
 CV_EXPORTS MatExpr operator < (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator < (const Mat& a, double s);
 CV_EXPORTS MatExpr operator < (double s, const Mat& a);
+CV_EXPORTS MatExpr operator < (const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr operator < (const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr operator < (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator < (double s, const MatExpr& e);
+CV_EXPORTS MatExpr operator < (const MatExpr& e1, const MatExpr& e2);
 
 CV_EXPORTS MatExpr operator <= (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator <= (const Mat& a, double s);
 CV_EXPORTS MatExpr operator <= (double s, const Mat& a);
+CV_EXPORTS MatExpr operator <= (const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr operator <= (const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr operator <= (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator <= (double s, const MatExpr& e);
+CV_EXPORTS MatExpr operator <= (const MatExpr& e1, const MatExpr& e2);
 
 CV_EXPORTS MatExpr operator == (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator == (const Mat& a, double s);
 CV_EXPORTS MatExpr operator == (double s, const Mat& a);
+CV_EXPORTS MatExpr operator == (const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr operator == (const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr operator == (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator == (double s, const MatExpr& e);
+CV_EXPORTS MatExpr operator == (const MatExpr& e1, const MatExpr& e2);
 
 CV_EXPORTS MatExpr operator != (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator != (const Mat& a, double s);
 CV_EXPORTS MatExpr operator != (double s, const Mat& a);
+CV_EXPORTS MatExpr operator != (const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr operator != (const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr operator != (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator != (double s, const MatExpr& e);
+CV_EXPORTS MatExpr operator != (const MatExpr& e1, const MatExpr& e2);
 
 CV_EXPORTS MatExpr operator >= (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator >= (const Mat& a, double s);
 CV_EXPORTS MatExpr operator >= (double s, const Mat& a);
+CV_EXPORTS MatExpr operator >= (const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr operator >= (const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr operator >= (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator >= (double s, const MatExpr& e);
+CV_EXPORTS MatExpr operator >= (const MatExpr& e1, const MatExpr& e2);
 
 CV_EXPORTS MatExpr operator > (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator > (const Mat& a, double s);
 CV_EXPORTS MatExpr operator > (double s, const Mat& a);
+CV_EXPORTS MatExpr operator > (const MatExpr& e, const Mat& m);
+CV_EXPORTS MatExpr operator > (const Mat& m, const MatExpr& e);
+CV_EXPORTS MatExpr operator > (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator > (double s, const MatExpr& e);
+CV_EXPORTS MatExpr operator > (const MatExpr& e1, const MatExpr& e2);
 
 CV_EXPORTS MatExpr operator & (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator & (const Mat& a, const Scalar& s);
@@ -172,7 +172,10 @@ public:
         FORMAT_MASK = (7<<3),
         FORMAT_AUTO = 0,
         FORMAT_XML  = (1<<3),
-        FORMAT_YAML = (2<<3)
+        FORMAT_YAML = (2<<3),
+        BASE64      = 64, //! write mode flag: the data of the dense matrices is written as base64 strings
+        LAZY        = 128 //! read mode flag: only the top-level node names are read when the file is opened,
+                          //! their values are parsed on the first access (the file stays open until release())
     };
     enum
     {
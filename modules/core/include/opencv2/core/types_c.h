@@ -1611,6 +1611,8 @@ typedef struct CvFileStorage CvFileStorage;
 #define CV_STORAGE_FORMAT_AUTO   0
 #define CV_STORAGE_FORMAT_XML    8
 #define CV_STORAGE_FORMAT_YAML  16
+#define CV_STORAGE_BASE64       64 /* write the dense matrix data in base64 */
+#define CV_STORAGE_LAZY        128 /* read the top-level nodes on the first access */
 
 /* List of attributes: */
 typedef struct CvAttrList
@@ -49,10 +49,82 @@
 #endif
 
 #include "opencv2/core.hpp"
+#include <new>
 
 namespace cv
 {
 
+/*!
+ Per-thread scratch arena
+
+ Every thread owns a stack-like arena for short-lived temporary buffers. The arena is
+ only used while the thread is inside at least one ScratchScope; outside of it
+ scratchAlloc() returns NULL and the callers fall back to the heap. Blocks are released
+ in LIFO order: freeing the most recent block (together with any already freed blocks below it)
+ gives the memory back to the arena, so after the first few iterations a processing loop
+ that is wrapped into a ScratchScope does not touch the heap at all:
+
+ \code
+ for(;;)
+ {
+    cap >> frame;
+    cv::ScratchScope scope; // AutoBuffer's and Mat's created with getScratchAllocator()
+                            // will be taken from the thread arena
+    process(frame);
+ }
+ \endcode
+
+ Blocks that outlive the scope stay valid; they just keep the arena memory reserved
+ until they are released (possibly by another thread).
+*/
+class CV_EXPORTS ScratchScope
+{
+public:
+    //! enters the scratch scope of the calling thread
+    ScratchScope();
+    //! leaves the scope; the outermost scope compacts the arena if it is empty
+    ~ScratchScope();
+
+    //! returns true if the calling thread is inside a scratch scope
+    static bool isActive();
+
+private:
+    ScratchScope(const ScratchScope&);
+    ScratchScope& operator = (const ScratchScope&);
+};
+
+//! scratch arena statistics of the calling thread
+struct CV_EXPORTS ScratchArenaStats
+{
+    ScratchArenaStats();
+
+    size_t allocations;     //!< number of blocks allocated from the arena
+    size_t heapAllocations; //!< number of times the arena had to take memory from the heap
+    size_t reservedBytes;   //!< memory currently owned by the arena
+    size_t usedBytes;       //!< memory currently occupied by the live blocks
+    size_t peakUsedBytes;   //!< maximum of usedBytes
+};
+
+//! allocates a block from the calling thread arena. Returns NULL when there is no active ScratchScope
+CV_EXPORTS void* scratchAlloc(size_t size);
+//! releases a block allocated by scratchAlloc(). Can be called from any thread
+CV_EXPORTS void scratchFree(void* ptr);
+//! returns the size requested for the block allocated by scratchAlloc()
+CV_EXPORTS size_t scratchSize(const void* ptr);
+
+//! returns the statistics of the calling thread arena
+CV_EXPORTS ScratchArenaStats getScratchArenaStats();
+//! resets the allocation counters and the peak usage of the calling thread arena
+CV_EXPORTS void resetScratchArenaStats();
+
+/*!
+  Returns the allocator that places Mat data into the calling thread arena.
+
+  Outside of a ScratchScope it behaves like the standard allocator. Intended for
+  temporary matrices that are released in the same scope they are created in.
+*/
+CV_EXPORTS MatAllocator* getScratchAllocator();
+
 /*!
  Automatically Allocated Buffer Class
 
@@ -112,10 +184,17 @@ public:
     operator const _Tp* () const;
 
 protected:
+    //! allocates _size elements from the thread scratch arena or from the heap
+    static _Tp* allocateBuffer(size_t _size, bool& _scratch);
+    //! releases the buffer obtained with allocateBuffer()
+    static void releaseBuffer(_Tp* _ptr, bool _scratch);
+
     //! pointer to the real buffer, can point to buf if the buffer is small enough
     _Tp* ptr;
     //! size of the real buffer
     size_t sz;
+    //! true if ptr has been taken from the scratch arena
+    bool scratch;
     //! pre-allocated buffer. At least 1 element to confirm C++ standard reqirements
     _Tp buf[(fixed_size > 0) ? fixed_size : 1];
 };
@@ -201,7 +280,8 @@ enum {
       CPU_SSE4_2    = 7,
       CPU_POPCNT    = 8,
       CPU_AVX       = 10,
-      CPU_NEON      = 11
+      CPU_NEON      = 11,
+      CPU_AVX2      = 12
      };
 // remember to keep this list identical to the one in cvdef.h
 
@@ -274,6 +354,51 @@ public:
 
 CV_EXPORTS void parallel_for_(const Range& range, const ParallelLoopBody& body, double nstripes=-1.);
 
+/*!
+ The handle of an asynchronous task created by cv::async().
+
+ It works like a future without a value: the owner can check whether the task is complete
+ and wait for it. If the task body (or the body of any task it depends on) has thrown an exception,
+ wait() rethrows it.
+*/
+class CV_EXPORTS AsyncTask
+{
+public:
+    //! the default constructor; creates an empty handle
+    AsyncTask();
+
+    //! returns true if the handle does not refer to any task
+    bool empty() const;
+    //! returns true if the task is complete (successfully or not)
+    bool ready() const;
+    //! waits until the task is complete
+    void wait() const;
+
+    struct Impl;
+    Ptr<Impl> impl;
+};
+
+/*!
+ Runs parallel_for_(range, *body, nstripes) asynchronously, after all the dependencies are complete.
+
+ The tasks are executed by the same thread pool as parallel_for_; the stripes of the task body
+ are processed by the pool threads not busy with other tasks. Independent tasks run concurrently,
+ so dependent stages of a pipeline can overlap across frames:
+
+ \code
+ std::vector<AsyncTask> deps(1, async(decodeBody, Range(0, 1)));
+ AsyncTask converted = async(cvtColorBody, Range(0, rows), deps);
+ ...
+ converted.wait();
+ \endcode
+
+ If the parallel framework is not able to run tasks in background (e.g. there is only one thread),
+ the task is executed by the thread that completes its last dependency, in particular by the calling thread.
+*/
+CV_EXPORTS AsyncTask async(const Ptr<ParallelLoopBody>& body, const Range& range,
+                           const std::vector<AsyncTask>& dependencies=std::vector<AsyncTask>(),
+                           double nstripes=-1.);
+
 /////////////////////////// Synchronization Primitives ///////////////////////////////
 
 class CV_EXPORTS Mutex
@@ -384,6 +509,7 @@ AutoBuffer<_Tp, fixed_size>::AutoBuffer()
 {
     ptr = buf;
     sz = fixed_size;
+    scratch = false;
 }
 
 template<typename _Tp, size_t fixed_size> inline
@@ -391,6 +517,7 @@ AutoBuffer<_Tp, fixed_size>::AutoBuffer(size_t _size)
 {
     ptr = buf;
     sz = fixed_size;
+    scratch = false;
     allocate(_size);
 }
 
@@ -399,6 +526,7 @@ AutoBuffer<_Tp, fixed_size>::AutoBuffer(const AutoBuffer<_Tp, fixed_size>& abuf
 {
     ptr = buf;
     sz = fixed_size;
+    scratch = false;
     allocate(abuf.size());
     for( size_t i = 0; i < sz; i++ )
         ptr[i] = abuf.ptr[i];
@@ -432,7 +560,7 @@ AutoBuffer<_Tp, fixed_size>::allocate(size_t _size)
     deallocate();
     if(_size > fixed_size)
     {
-        ptr = new _Tp[_size];
+        ptr = allocateBuffer(_size, scratch);
         sz = _size;
     }
 }
@@ -442,7 +570,7 @@ AutoBuffer<_Tp, fixed_size>::deallocate()
 {
     if( ptr != buf )
     {
-        delete[] ptr;
+        releaseBuffer(ptr, scratch);
         ptr = buf;
         sz = fixed_size;
     }
@@ -458,8 +586,9 @@ AutoBuffer<_Tp, fixed_size>::resize(size_t _size)
     }
     size_t i, prevsize = sz, minsize = MIN(prevsize, _size);
     _Tp* prevptr = ptr;
+    bool prevscratch = scratch;
 
-    ptr = _size > fixed_size ? new _Tp[_size] : buf;
+    ptr = _size > fixed_size ? allocateBuffer(_size, scratch) : buf;
     sz = _size;
 
     if( ptr != prevptr )
@@ -469,7 +598,32 @@ AutoBuffer<_Tp, fixed_size>::resize(size_t _size)
         ptr[i] = _Tp();
 
     if( prevptr != buf )
-        delete[] prevptr;
+        releaseBuffer(prevptr, prevscratch);
+}
+
+template<typename _Tp, size_t fixed_size> inline _Tp*
+AutoBuffer<_Tp, fixed_size>::allocateBuffer(size_t _size, bool& _scratch)
+{
+    _Tp* p = _size <= ((size_t)-1)/sizeof(_Tp) ? (_Tp*)scratchAlloc(_size*sizeof(_Tp)) : 0;
+    _scratch = p != 0;
+    if( !p )
+        return new _Tp[_size];
+    for( size_t i = 0; i < _size; i++ )
+        new(p + i) _Tp;
+    return p;
+}
+
+template<typename _Tp, size_t fixed_size> inline void
+AutoBuffer<_Tp, fixed_size>::releaseBuffer(_Tp* _ptr, bool _scratch)
+{
+    if( !_scratch )
+    {
+        delete[] _ptr;
+        return;
+    }
+    for( size_t i = 0, n = scratchSize(_ptr)/sizeof(_Tp); i < n; i++ )
+        _ptr[i].~_Tp();
+    scratchFree(_ptr);
 }
 
 template<typename _Tp, size_t fixed_size> inline size_t
@@ -0,0 +1,66 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+CV_ENUM(GemmFlags, 0, GEMM_1_T, GEMM_2_T, GEMM_1_T | GEMM_2_T)
+
+// the last parameter is setUseOptimized(): the packed GEMM kernels are only used when it is on,
+// so the 'false' cases measure the generic implementation for comparison
+typedef std::tr1::tuple<int, MatType, GemmFlags, bool> GemmParams;
+typedef perf::TestBaseWithParam<GemmParams> GemmFixture;
+
+PERF_TEST_P(GemmFixture, gemm,
+            testing::Combine(
+                testing::Values(64, 128, 256, 512, 1024),
+                testing::Values(CV_32FC1, CV_64FC1),
+                GemmFlags::all(),
+                testing::Bool()
+                ))
+{
+    int n = get<0>(GetParam()), type = get<1>(GetParam()), flags = get<2>(GetParam());
+    bool optimized = get<3>(GetParam());
+
+    Mat a(n, n, type), b(n, n, type), c(n, n, type), d(n, n, type);
+    declare.in(a, b, c, WARMUP_RNG).out(d);
+    if( n >= 512 )
+        declare.time(optimized ? 30 : 300);
+
+    bool useOptimized0 = useOptimized();
+    setUseOptimized(optimized);
+
+    TEST_CYCLE() gemm(a, b, 0.5, c, 2.0, d, flags);
+
+    setUseOptimized(useOptimized0);
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef std::tr1::tuple<Size, bool> MulTransposedParams;
+typedef perf::TestBaseWithParam<MulTransposedParams> MulTransposedFixture;
+
+PERF_TEST_P(MulTransposedFixture, mulTransposed,
+            testing::Combine(
+                testing::Values(Size(128, 1024), Size(512, 512), Size(1024, 256)),
+                testing::Bool()
+                ))
+{
+    Size sz = get<0>(GetParam());
+    bool optimized = get<1>(GetParam());
+
+    Mat src(sz, CV_32FC1), dst(sz.width, sz.width, CV_32FC1);
+    declare.in(src, WARMUP_RNG).out(dst);
+    declare.time(optimized ? 30 : 300);
+
+    bool useOptimized0 = useOptimized();
+    setUseOptimized(optimized);
+
+    TEST_CYCLE() mulTransposed(src, dst, true);
+
+    setUseOptimized(useOptimized0);
+
+    SANITY_CHECK_NOTHING();
+}
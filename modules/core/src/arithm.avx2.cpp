@@ -0,0 +1,383 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2014, Itseez Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+/* ////////////////////////////////////////////////////////////////////
+//
+//  AVX2 versions of the element-wise arithmetic: +, -, min, max, absdiff, compare.
+//  Built with the AVX2 compiler flags and called from arithm.cpp when USE_AVX2 is set.
+//
+// */
+
+#include "opt_avx2.hpp"
+#include <string.h>
+
+#if CV_AVX2
+
+namespace cv
+{
+namespace opt_AVX2
+{
+namespace
+{
+
+template<typename T> struct VLoadStore256 {};
+
+#define FUNCTOR_LOADSTORE_CAST(name, template_arg, register_type, load_body, store_body) \
+    template <>                                                                          \
+    struct name<template_arg>{                                                           \
+        typedef register_type reg_type;                                                  \
+        static reg_type load(const template_arg * p) { return load_body ((const reg_type *)p); } \
+        static void store(template_arg * p, reg_type v) { store_body ((reg_type *)p, v); } \
+    }
+
+#define FUNCTOR_LOADSTORE(name, template_arg, register_type, load_body, store_body) \
+    template <>                                                                     \
+    struct name<template_arg>{                                                      \
+        typedef register_type reg_type;                                             \
+        static reg_type load(const template_arg * p) { return load_body (p); }      \
+        static void store(template_arg * p, reg_type v) { store_body (p, v); }      \
+    }
+
+FUNCTOR_LOADSTORE_CAST(VLoadStore256,  uchar, __m256i, _mm256_loadu_si256, _mm256_storeu_si256);
+FUNCTOR_LOADSTORE_CAST(VLoadStore256,  schar, __m256i, _mm256_loadu_si256, _mm256_storeu_si256);
+FUNCTOR_LOADSTORE_CAST(VLoadStore256, ushort, __m256i, _mm256_loadu_si256, _mm256_storeu_si256);
+FUNCTOR_LOADSTORE_CAST(VLoadStore256,  short, __m256i, _mm256_loadu_si256, _mm256_storeu_si256);
+FUNCTOR_LOADSTORE_CAST(VLoadStore256,    int, __m256i, _mm256_loadu_si256, _mm256_storeu_si256);
+FUNCTOR_LOADSTORE(     VLoadStore256,  float, __m256 , _mm256_loadu_ps   , _mm256_storeu_ps   );
+FUNCTOR_LOADSTORE(     VLoadStore256, double, __m256d, _mm256_loadu_pd   , _mm256_storeu_pd   );
+
+#define FUNCTOR_TEMPLATE(name)          \
+    template<typename T> struct name {}
+
+#define FUNCTOR_CLOSURE_2arg(name, template_arg, body)                          \
+    template<>                                                                  \
+    struct name<template_arg>                                                   \
+    {                                                                           \
+        typedef VLoadStore256<template_arg>::reg_type reg_type;                 \
+        reg_type operator()(const reg_type & a, const reg_type & b) const       \
+        {                                                                       \
+            body;                                                               \
+        }                                                                       \
+    }
+
+FUNCTOR_TEMPLATE(VAdd);
+FUNCTOR_CLOSURE_2arg(VAdd,  uchar, return _mm256_adds_epu8 (a, b));
+FUNCTOR_CLOSURE_2arg(VAdd,  schar, return _mm256_adds_epi8 (a, b));
+FUNCTOR_CLOSURE_2arg(VAdd, ushort, return _mm256_adds_epu16(a, b));
+FUNCTOR_CLOSURE_2arg(VAdd,  short, return _mm256_adds_epi16(a, b));
+FUNCTOR_CLOSURE_2arg(VAdd,    int, return _mm256_add_epi32 (a, b));
+FUNCTOR_CLOSURE_2arg(VAdd,  float, return _mm256_add_ps    (a, b));
+FUNCTOR_CLOSURE_2arg(VAdd, double, return _mm256_add_pd    (a, b));
+
+FUNCTOR_TEMPLATE(VSub);
+FUNCTOR_CLOSURE_2arg(VSub,  uchar, return _mm256_subs_epu8 (a, b));
+FUNCTOR_CLOSURE_2arg(VSub,  schar, return _mm256_subs_epi8 (a, b));
+FUNCTOR_CLOSURE_2arg(VSub, ushort, return _mm256_subs_epu16(a, b));
+FUNCTOR_CLOSURE_2arg(VSub,  short, return _mm256_subs_epi16(a, b));
+FUNCTOR_CLOSURE_2arg(VSub,    int, return _mm256_sub_epi32 (a, b));
+FUNCTOR_CLOSURE_2arg(VSub,  float, return _mm256_sub_ps    (a, b));
+FUNCTOR_CLOSURE_2arg(VSub, double, return _mm256_sub_pd    (a, b));
+
+FUNCTOR_TEMPLATE(VMin);
+FUNCTOR_CLOSURE_2arg(VMin,  uchar, return _mm256_min_epu8 (a, b));
+FUNCTOR_CLOSURE_2arg(VMin,  schar, return _mm256_min_epi8 (a, b));
+FUNCTOR_CLOSURE_2arg(VMin, ushort, return _mm256_min_epu16(a, b));
+FUNCTOR_CLOSURE_2arg(VMin,  short, return _mm256_min_epi16(a, b));
+FUNCTOR_CLOSURE_2arg(VMin,    int, return _mm256_min_epi32(a, b));
+FUNCTOR_CLOSURE_2arg(VMin,  float, return _mm256_min_ps   (a, b));
+FUNCTOR_CLOSURE_2arg(VMin, double, return _mm256_min_pd   (a, b));
+
+FUNCTOR_TEMPLATE(VMax);
+FUNCTOR_CLOSURE_2arg(VMax,  uchar, return _mm256_max_epu8 (a, b));
+FUNCTOR_CLOSURE_2arg(VMax,  schar, return _mm256_max_epi8 (a, b));
+FUNCTOR_CLOSURE_2arg(VMax, ushort, return _mm256_max_epu16(a, b));
+FUNCTOR_CLOSURE_2arg(VMax,  short, return _mm256_max_epi16(a, b));
+FUNCTOR_CLOSURE_2arg(VMax,    int, return _mm256_max_epi32(a, b));
+FUNCTOR_CLOSURE_2arg(VMax,  float, return _mm256_max_ps   (a, b));
+FUNCTOR_CLOSURE_2arg(VMax, double, return _mm256_max_pd   (a, b));
+
+FUNCTOR_TEMPLATE(VAbsDiff);
+FUNCTOR_CLOSURE_2arg(VAbsDiff,  uchar,
+        return _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a));
+    );
+FUNCTOR_CLOSURE_2arg(VAbsDiff,  schar,
+        return _mm256_subs_epi8(_mm256_max_epi8(a, b), _mm256_min_epi8(a, b));
+    );
+FUNCTOR_CLOSURE_2arg(VAbsDiff, ushort,
+        return _mm256_or_si256(_mm256_subs_epu16(a, b), _mm256_subs_epu16(b, a));
+    );
+FUNCTOR_CLOSURE_2arg(VAbsDiff,  short,
+        return _mm256_subs_epi16(_mm256_max_epi16(a, b), _mm256_min_epi16(a, b));
+    );
+FUNCTOR_CLOSURE_2arg(VAbsDiff,    int,
+        __m256i d = _mm256_sub_epi32(a, b);
+        __m256i m = _mm256_cmpgt_epi32(b, a);
+        return _mm256_sub_epi32(_mm256_xor_si256(d, m), m);
+    );
+FUNCTOR_CLOSURE_2arg(VAbsDiff,  float,
+        return _mm256_and_ps(_mm256_sub_ps(a, b), _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)));
+    );
+FUNCTOR_CLOSURE_2arg(VAbsDiff, double,
+        return _mm256_and_pd(_mm256_sub_pd(a, b), _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL)));
+    );
+
+template<typename T, class VOp> inline void
+vBinOp(const T* src1, size_t step1, const T* src2, size_t step2, T* dst, size_t step, int width, int height)
+{
+    typedef VLoadStore256<T> ldst;
+    enum { VECSZ = 32/sizeof(T) };
+    VOp vop;
+
+    for( ; height--; src1 = (const T*)((const uchar*)src1 + step1),
+                     src2 = (const T*)((const uchar*)src2 + step2),
+                     dst = (T*)((uchar*)dst + step) )
+    {
+        int x = 0;
+        for( ; x <= width - VECSZ*2; x += VECSZ*2 )
+        {
+            typename ldst::reg_type r0 = ldst::load(src1 + x);
+            typename ldst::reg_type r1 = ldst::load(src1 + x + VECSZ);
+            r0 = vop(r0, ldst::load(src2 + x));
+            r1 = vop(r1, ldst::load(src2 + x + VECSZ));
+            ldst::store(dst + x, r0);
+            ldst::store(dst + x + VECSZ, r1);
+        }
+        if( x <= width - VECSZ )
+        {
+            ldst::store(dst + x, vop(ldst::load(src1 + x), ldst::load(src2 + x)));
+            x += VECSZ;
+        }
+        if( x < width )
+        {
+            // the tail goes through a zero-padded block, so the results match the vector lanes
+            T buf1[VECSZ], buf2[VECSZ];
+            size_t tail = (width - x)*sizeof(T);
+            memset(buf1, 0, sizeof(buf1));
+            memset(buf2, 0, sizeof(buf2));
+            memcpy(buf1, src1 + x, tail);
+            memcpy(buf2, src2 + x, tail);
+            ldst::store(buf1, vop(ldst::load(buf1), ldst::load(buf2)));
+            memcpy(dst + x, buf1, tail);
+        }
+    }
+}
+
+// comparisons return the all-ones/zero mask of the lane size; they are packed into bytes below
+template<typename T> struct VCmp {};
+
+template<> struct VCmp<uchar>
+{
+    __m256i gt(__m256i a, __m256i b) const
+    {
+        __m256i delta = _mm256_set1_epi8((char)-128);
+        return _mm256_cmpgt_epi8(_mm256_xor_si256(a, delta), _mm256_xor_si256(b, delta));
+    }
+    __m256i eq(__m256i a, __m256i b) const { return _mm256_cmpeq_epi8(a, b); }
+};
+
+template<> struct VCmp<schar>
+{
+    __m256i gt(__m256i a, __m256i b) const { return _mm256_cmpgt_epi8(a, b); }
+    __m256i eq(__m256i a, __m256i b) const { return _mm256_cmpeq_epi8(a, b); }
+};
+
+template<> struct VCmp<ushort>
+{
+    __m256i gt(__m256i a, __m256i b) const
+    {
+        __m256i delta = _mm256_set1_epi16((short)-32768);
+        return _mm256_cmpgt_epi16(_mm256_xor_si256(a, delta), _mm256_xor_si256(b, delta));
+    }
+    __m256i eq(__m256i a, __m256i b) const { return _mm256_cmpeq_epi16(a, b); }
+};
+
+template<> struct VCmp<short>
+{
+    __m256i gt(__m256i a, __m256i b) const { return _mm256_cmpgt_epi16(a, b); }
+    __m256i eq(__m256i a, __m256i b) const { return _mm256_cmpeq_epi16(a, b); }
+};
+
+template<> struct VCmp<int>
+{
+    __m256i gt(__m256i a, __m256i b) const { return _mm256_cmpgt_epi32(a, b); }
+    __m256i eq(__m256i a, __m256i b) const { return _mm256_cmpeq_epi32(a, b); }
+};
+
+template<> struct VCmp<float>
+{
+    __m256i gt(__m256 a, __m256 b) const { return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_GT_OQ)); }
+    __m256i eq(__m256 a, __m256 b) const { return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)); }
+};
+
+template<> struct VCmp<double>
+{
+    __m256i gt(__m256d a, __m256d b) const { return _mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_GT_OQ)); }
+    __m256i eq(__m256d a, __m256d b) const { return _mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)); }
+};
+
+// computes the byte masks of the 32 elements starting at src1, src2
+template<typename T> struct CmpBlock32
+{
+    __m256i operator()(const T* src1, const T* src2, bool eq) const
+    {
+        typedef VLoadStore256<T> ldst;
+        VCmp<T> vcmp;
+        enum { VECSZ = 32/sizeof(T) };
+        __m256i m[4];
+        for( int k = 0; k < (int)(32/VECSZ); k++ )
+        {
+            typename ldst::reg_type a = ldst::load(src1 + k*VECSZ), b = ldst::load(src2 + k*VECSZ);
+            m[k] = eq ? vcmp.eq(a, b) : vcmp.gt(a, b);
+        }
+        return pack(m);
+    }
+
+    static __m256i pack(const __m256i* m);
+};
+
+template<> inline __m256i CmpBlock32<uchar>::pack(const __m256i* m) { return m[0]; }
+template<> inline __m256i CmpBlock32<schar>::pack(const __m256i* m) { return m[0]; }
+
+static inline __m256i pack16(const __m256i* m)
+{
+    // packs work within the 128-bit lanes, so the quadwords have to be put back in order
+    return _mm256_permute4x64_epi64(_mm256_packs_epi16(m[0], m[1]), 0xD8);
+}
+
+static inline __m256i pack32(const __m256i* m)
+{
+    __m256i a = _mm256_packs_epi32(m[0], m[1]), b = _mm256_packs_epi32(m[2], m[3]);
+    return _mm256_permutevar8x32_epi32(_mm256_packs_epi16(a, b), _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+}
+
+template<> inline __m256i CmpBlock32<ushort>::pack(const __m256i* m) { return pack16(m); }
+template<> inline __m256i CmpBlock32<short>::pack(const __m256i* m) { return pack16(m); }
+template<> inline __m256i CmpBlock32<int>::pack(const __m256i* m) { return pack32(m); }
+template<> inline __m256i CmpBlock32<float>::pack(const __m256i* m) { return pack32(m); }
+
+// 4 doubles per register: the 64-bit masks are narrowed to 32 bits first
+template<> struct CmpBlock32<double>
+{
+    __m256i operator()(const double* src1, const double* src2, bool eq) const
+    {
+        VCmp<double> vcmp;
+        const __m256i lo = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+        __m256i m[4];
+        for( int k = 0; k < 4; k++ )
+        {
+            __m256d a0 = _mm256_loadu_pd(src1 + k*8), a1 = _mm256_loadu_pd(src1 + k*8 + 4);
+            __m256d b0 = _mm256_loadu_pd(src2 + k*8), b1 = _mm256_loadu_pd(src2 + k*8 + 4);
+            __m256i m0 = _mm256_permutevar8x32_epi32(eq ? vcmp.eq(a0, b0) : vcmp.gt(a0, b0), lo);
+            __m256i m1 = _mm256_permutevar8x32_epi32(eq ? vcmp.eq(a1, b1) : vcmp.gt(a1, b1), lo);
+            m[k] = _mm256_permute2x128_si256(m0, m1, 0x20);
+        }
+        return pack32(m);
+    }
+};
+
+template<typename T> inline void
+vCmpOp(const T* src1, size_t step1, const T* src2, size_t step2,
+       uchar* dst, size_t step, int width, int height, bool eq, bool invert)
+{
+    CmpBlock32<T> block;
+    __m256i vinv = _mm256_set1_epi8(invert ? (char)-1 : 0);
+    int m = invert ? 255 : 0;
+
+    for( ; height--; src1 = (const T*)((const uchar*)src1 + step1),
+                     src2 = (const T*)((const uchar*)src2 + step2),
+                     dst += step )
+    {
+        int x = 0;
+        for( ; x <= width - 32; x += 32 )
+            _mm256_storeu_si256((__m256i*)(dst + x), _mm256_xor_si256(block(src1 + x, src2 + x, eq), vinv));
+
+        if( eq )
+            for( ; x < width; x++ )
+                dst[x] = (uchar)(-(src1[x] == src2[x]) ^ m);
+        else
+            for( ; x < width; x++ )
+                dst[x] = (uchar)(-(src1[x] > src2[x]) ^ m);
+    }
+}
+
+}
+
+#define DEFINE_BINARY_OP(name, type, vop) \
+    void name(const type* src1, size_t step1, const type* src2, size_t step2, \
+              type* dst, size_t step, int width, int height) \
+    { \
+        vBinOp<type, vop<type> >(src1, step1, src2, step2, dst, step, width, height); \
+    }
+
+#define DEFINE_BINARY_OPS(name, vop) \
+    DEFINE_BINARY_OP(name##8u, uchar, vop) \
+    DEFINE_BINARY_OP(name##8s, schar, vop) \
+    DEFINE_BINARY_OP(name##16u, ushort, vop) \
+    DEFINE_BINARY_OP(name##16s, short, vop) \
+    DEFINE_BINARY_OP(name##32s, int, vop) \
+    DEFINE_BINARY_OP(name##32f, float, vop) \
+    DEFINE_BINARY_OP(name##64f, double, vop)
+
+DEFINE_BINARY_OPS(add, VAdd)
+DEFINE_BINARY_OPS(sub, VSub)
+DEFINE_BINARY_OPS(max, VMax)
+DEFINE_BINARY_OPS(min, VMin)
+DEFINE_BINARY_OPS(absdiff, VAbsDiff)
+
+#define DEFINE_CMP_OP(name, type) \
+    void name(const type* src1, size_t step1, const type* src2, size_t step2, \
+              uchar* dst, size_t step, int width, int height, bool eq, bool invert) \
+    { \
+        vCmpOp<type>(src1, step1, src2, step2, dst, step, width, height, eq, invert); \
+    }
+
+DEFINE_CMP_OP(cmp8u, uchar)
+DEFINE_CMP_OP(cmp8s, schar)
+DEFINE_CMP_OP(cmp16u, ushort)
+DEFINE_CMP_OP(cmp16s, short)
+DEFINE_CMP_OP(cmp32s, int)
+DEFINE_CMP_OP(cmp32f, float)
+DEFINE_CMP_OP(cmp64f, double)
+
+}
+}
+
+#endif
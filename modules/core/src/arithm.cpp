@@ -48,6 +48,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels.hpp"
+#include "opt_avx2.hpp"
 
 namespace cv
 {
@@ -1249,8 +1250,52 @@ static void binary_op( InputArray _src1, InputArray _src2, OutputArray _dst,
     }
 }
 
+// The AVX2 kernels are built separately (arithm.avx2.cpp) and selected at runtime,
+// so the same binary runs on the CPUs without AVX2. IPP builds keep using IPP.
+#if defined HAVE_DISPATCH_AVX2 && !ARITHM_USE_IPP
+#define USE_AVX2_TABS 1
+
+#define DEF_AVX2_BINARY_FUNC(name, type) \
+static void name##_avx2( const type* src1, size_t step1, const type* src2, size_t step2, \
+                         type* dst, size_t step, Size sz, void* ) \
+{ \
+    opt_AVX2::name(src1, step1, src2, step2, dst, step, sz.width, sz.height); \
+}
+
+#define DEF_AVX2_BINARY_FUNCS(name) \
+    DEF_AVX2_BINARY_FUNC(name##8u, uchar) \
+    DEF_AVX2_BINARY_FUNC(name##8s, schar) \
+    DEF_AVX2_BINARY_FUNC(name##16u, ushort) \
+    DEF_AVX2_BINARY_FUNC(name##16s, short) \
+    DEF_AVX2_BINARY_FUNC(name##32s, int) \
+    DEF_AVX2_BINARY_FUNC(name##32f, float) \
+    DEF_AVX2_BINARY_FUNC(name##64f, double)
+
+DEF_AVX2_BINARY_FUNCS(add)
+DEF_AVX2_BINARY_FUNCS(sub)
+DEF_AVX2_BINARY_FUNCS(max)
+DEF_AVX2_BINARY_FUNCS(min)
+DEF_AVX2_BINARY_FUNCS(absdiff)
+
+#define AVX2_TAB(name) \
+    { \
+        (BinaryFunc)name##8u_avx2, (BinaryFunc)name##8s_avx2, \
+        (BinaryFunc)name##16u_avx2, (BinaryFunc)name##16s_avx2, \
+        (BinaryFunc)name##32s_avx2, \
+        (BinaryFunc)name##32f_avx2, (BinaryFunc)name##64f_avx2, \
+        0 \
+    }
+#else
+#define USE_AVX2_TABS 0
+#endif
+
 static BinaryFunc* getMaxTab()
 {
+#if USE_AVX2_TABS
+    static BinaryFunc maxTabAVX2[] = AVX2_TAB(max);
+    if( USE_AVX2 )
+        return maxTabAVX2;
+#endif
     static BinaryFunc maxTab[] =
     {
         (BinaryFunc)GET_OPTIMIZED(max8u), (BinaryFunc)GET_OPTIMIZED(max8s),
@@ -1265,6 +1310,11 @@ static BinaryFunc* getMaxTab()
 
 static BinaryFunc* getMinTab()
 {
+#if USE_AVX2_TABS
+    static BinaryFunc minTabAVX2[] = AVX2_TAB(min);
+    if( USE_AVX2 )
+        return minTabAVX2;
+#endif
     static BinaryFunc minTab[] =
     {
         (BinaryFunc)GET_OPTIMIZED(min8u), (BinaryFunc)GET_OPTIMIZED(min8s),
@@ -1765,6 +1815,11 @@ static void arithm_op(InputArray _src1, InputArray _src2, OutputArray _dst,
 
 static BinaryFunc* getAddTab()
 {
+#if USE_AVX2_TABS
+    static BinaryFunc addTabAVX2[] = AVX2_TAB(add);
+    if( USE_AVX2 )
+        return addTabAVX2;
+#endif
     static BinaryFunc addTab[] =
     {
         (BinaryFunc)GET_OPTIMIZED(add8u), (BinaryFunc)GET_OPTIMIZED(add8s),
@@ -1779,6 +1834,11 @@ static BinaryFunc* getAddTab()
 
 static BinaryFunc* getSubTab()
 {
+#if USE_AVX2_TABS
+    static BinaryFunc subTabAVX2[] = AVX2_TAB(sub);
+    if( USE_AVX2 )
+        return subTabAVX2;
+#endif
     static BinaryFunc subTab[] =
     {
         (BinaryFunc)GET_OPTIMIZED(sub8u), (BinaryFunc)GET_OPTIMIZED(sub8s),
@@ -1793,6 +1853,11 @@ static BinaryFunc* getSubTab()
 
 static BinaryFunc* getAbsDiffTab()
 {
+#if USE_AVX2_TABS
+    static BinaryFunc absDiffTabAVX2[] = AVX2_TAB(absdiff);
+    if( USE_AVX2 )
+        return absDiffTabAVX2;
+#endif
     static BinaryFunc absDiffTab[] =
     {
         (BinaryFunc)GET_OPTIMIZED(absdiff8u), (BinaryFunc)GET_OPTIMIZED(absdiff8s),
@@ -2702,8 +2767,40 @@ static void cmp64f(const double* src1, size_t step1, const double* src2, size_t
     cmp_(src1, step1, src2, step2, dst, step, size, *(int*)_cmpop);
 }
 
+#if USE_AVX2_TABS
+
+#define DEF_AVX2_CMP_FUNC(name, type) \
+static void name##_avx2( const type* src1, size_t step1, const type* src2, size_t step2, \
+                         uchar* dst, size_t step, Size sz, void* _cmpop ) \
+{ \
+    int code = *(int*)_cmpop; \
+    if( code == CMP_GE || code == CMP_LT ) \
+    { \
+        std::swap(src1, src2); \
+        std::swap(step1, step2); \
+        code = code == CMP_GE ? CMP_LE : CMP_GT; \
+    } \
+    opt_AVX2::name(src1, step1, src2, step2, dst, step, sz.width, sz.height, \
+                   code == CMP_EQ || code == CMP_NE, code == CMP_LE || code == CMP_NE); \
+}
+
+DEF_AVX2_CMP_FUNC(cmp8u, uchar)
+DEF_AVX2_CMP_FUNC(cmp8s, schar)
+DEF_AVX2_CMP_FUNC(cmp16u, ushort)
+DEF_AVX2_CMP_FUNC(cmp16s, short)
+DEF_AVX2_CMP_FUNC(cmp32s, int)
+DEF_AVX2_CMP_FUNC(cmp32f, float)
+DEF_AVX2_CMP_FUNC(cmp64f, double)
+
+#endif
+
 static BinaryFunc getCmpFunc(int depth)
 {
+#if USE_AVX2_TABS
+    static BinaryFunc cmpTabAVX2[] = AVX2_TAB(cmp);
+    if( USE_AVX2 )
+        return cmpTabAVX2[depth];
+#endif
     static BinaryFunc cmpTab[] =
     {
         (BinaryFunc)GET_OPTIMIZED(cmp8u), (BinaryFunc)GET_OPTIMIZED(cmp8s),
@@ -0,0 +1,154 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2014, Itseez Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+/* ////////////////////////////////////////////////////////////////////
+//
+//  AVX2 version of the radix-4 DFT butterflies.
+//  Built with the AVX2 compiler flags and called from dxt.cpp when USE_AVX2 is set.
+//
+// */
+
+#include "opt_avx2.hpp"
+
+#if CV_AVX2
+
+namespace cv
+{
+namespace opt_AVX2
+{
+
+// (re, im) * (wre, wim) for 4 complex numbers; the same operations as the scalar code,
+// so the results are identical
+static inline __m256 cmul(__m256 x, __m256 w)
+{
+    __m256 t0 = _mm256_mul_ps(_mm256_moveldup_ps(x), w);
+    __m256 t1 = _mm256_mul_ps(_mm256_movehdup_ps(x), _mm256_permute_ps(w, _MM_SHUFFLE(2,3,0,1)));
+    return _mm256_addsub_ps(t0, t1);
+}
+
+// loads the twiddle factors wave[idx], wave[idx+step], ... (a complex float is 8 bytes)
+static inline __m256 loadWave(const float* wave, __m128i idx)
+{
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    return _mm256_castpd_ps(_mm256_mask_i32gather_pd(_mm256_setzero_pd(), (const double*)wave, idx, all, 8));
+}
+
+int dftRadix4_32f(float* dst, int N, int n0, int& _dw0, const float* wave)
+{
+    int n = 1, i, j, nx, dw0 = _dw0;
+    // negates the imaginary parts
+    const __m256 neg_im = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0x80000000, 0, 0x80000000,
+                                                                  0, 0x80000000, 0, 0x80000000));
+
+    for( ; n*4 <= N; )
+    {
+        nx = n;
+        n *= 4;
+        dw0 /= 4;
+
+        for( i = 0; i < n0; i += n )
+        {
+            float* v0 = dst + i*2;
+            float* v1 = v0 + nx*4;
+
+            if( nx < 4 )
+            {
+                // the first pass, the twiddle factors are all 1
+                float r0, i0, r1, i1, r2, i2, r3, i3, r4, i4;
+
+                r0 = v1[0]; i0 = v1[1];
+                r4 = v1[nx*2]; i4 = v1[nx*2+1];
+
+                r1 = r0 + r4; i1 = i0 + i4;
+                r3 = i0 - i4; i3 = r4 - r0;
+
+                r2 = v0[0]; i2 = v0[1];
+                r4 = v0[nx*2]; i4 = v0[nx*2+1];
+
+                r0 = r2 + r4; i0 = i2 + i4;
+                r2 -= r4; i2 -= i4;
+
+                v0[0] = r0 + r1; v0[1] = i0 + i1;
+                v1[0] = r0 - r1; v1[1] = i0 - i1;
+                v0[nx*2] = r2 + r3; v0[nx*2+1] = i2 + i3;
+                v1[nx*2] = r2 - r3; v1[nx*2+1] = i2 - i3;
+                continue;
+            }
+
+            // nx is a power of 4, so the butterflies are processed 4 at once;
+            // at j == 0 the twiddle factors are wave[0] == 1, which keeps the values as they are
+            __m128i idx = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(dw0));
+            __m128i didx = _mm_set1_epi32(dw0*4);
+
+            for( j = 0; j < nx; j += 4, idx = _mm_add_epi32(idx, didx) )
+            {
+                float* p0 = v0 + j*2;
+                float* p1 = v1 + j*2;
+
+                __m256 x0 = _mm256_loadu_ps(p0);
+                __m256 x2 = cmul(_mm256_loadu_ps(p0 + nx*2), loadWave(wave, _mm_add_epi32(idx, idx)));
+                __m256 x1 = cmul(_mm256_loadu_ps(p1), loadWave(wave, idx));
+                __m256 x3 = cmul(_mm256_loadu_ps(p1 + nx*2),
+                                 loadWave(wave, _mm_add_epi32(_mm_add_epi32(idx, idx), idx)));
+
+                __m256 s13 = _mm256_add_ps(x1, x3);
+                // -i*(x1 - x3)
+                __m256 d13 = _mm256_xor_ps(_mm256_permute_ps(_mm256_sub_ps(x1, x3), _MM_SHUFFLE(2,3,0,1)), neg_im);
+                __m256 s02 = _mm256_add_ps(x0, x2);
+                __m256 d02 = _mm256_sub_ps(x0, x2);
+
+                _mm256_storeu_ps(p0, _mm256_add_ps(s02, s13));
+                _mm256_storeu_ps(p1, _mm256_sub_ps(s02, s13));
+                _mm256_storeu_ps(p0 + nx*2, _mm256_add_ps(d02, d13));
+                _mm256_storeu_ps(p1 + nx*2, _mm256_sub_ps(d02, d13));
+            }
+        }
+    }
+
+    _dw0 = dw0;
+    return n;
+}
+
+}
+}
+
+#endif
@@ -43,6 +43,7 @@
 #include "opencv2/core/opencl/runtime/opencl_clamdfft.hpp"
 #include "opencv2/core/opencl/runtime/opencl_core.hpp"
 #include "opencl_kernels.hpp"
+#include "opt_avx2.hpp"
 
 namespace cv
 {
@@ -372,6 +373,90 @@ DFTInit( int n0, int nf, int* factors, int* itab, int elem_size, void* _wave, in
     }
 }
 
+// The factorization, the permutation table and the twiddle factors of the transforms of one length.
+// The tables are read-only once built, so they are shared by the concurrent transforms; the recently
+// used ones are kept in a small cache to avoid recomputing them on every cv::dft call.
+struct DFTTables
+{
+    DFTTables( int _len, int _depth, bool _invItab )
+        : len(_len), depth(_depth), invItab(_invItab)
+    {
+        int complex_elem_size = (int)CV_ELEM_SIZE(CV_MAKETYPE(depth, 2));
+        nf = DFTFactorize( len, factors );
+        itab.resize( len );
+        wave.resize( len*complex_elem_size + 16 );
+        DFTInit( len, nf, factors, &itab[0], complex_elem_size, alignPtr(&wave[0], 16), invItab );
+    }
+
+    const uchar* wavePtr() const { return alignPtr((const uchar*)&wave[0], 16); }
+
+    int len, depth, nf;
+    bool invItab;
+    int factors[34];
+    // not AutoBuffer's: the cached tables must not hold the memory of a scratch arena
+    std::vector<int> itab;
+    std::vector<uchar> wave;
+};
+
+enum { DFT_TABLES_CACHE_SIZE = 16 };
+
+static Mutex dftTablesMutex;
+static Ptr<DFTTables> dftTablesCache[DFT_TABLES_CACHE_SIZE];
+
+static Ptr<DFTTables> getDFTTables( int len, int depth, bool invItab )
+{
+    {
+        AutoLock lock(dftTablesMutex);
+        for( int i = 0; i < DFT_TABLES_CACHE_SIZE; i++ )
+        {
+            const Ptr<DFTTables>& t = dftTablesCache[i];
+            if( t && t->len == len && t->depth == depth && t->invItab == invItab )
+            {
+                // move the entry to the front, the least recently used ones are evicted
+                Ptr<DFTTables> found = t;
+                for( ; i > 0; i-- )
+                    dftTablesCache[i] = dftTablesCache[i-1];
+                dftTablesCache[0] = found;
+                return found;
+            }
+        }
+    }
+
+    Ptr<DFTTables> t = makePtr<DFTTables>(len, depth, invItab);
+
+    AutoLock lock(dftTablesMutex);
+    for( int i = DFT_TABLES_CACHE_SIZE - 1; i > 0; i-- )
+        dftTablesCache[i] = dftTablesCache[i-1];
+    dftTablesCache[0] = t;
+    return t;
+}
+
+// the tables of all the passes that dft() may run over the matrices of the plan size:
+// the row and the column transforms, with the direct and the inverse permutation
+struct DFTPlan::Impl
+{
+    Impl( Size _size, int _depth ) : size(_size), depth(_depth)
+    {
+        int lens[] = { size.width, size.height };
+        for( int i = 0; i < 2; i++ )
+            for( int invItab = 0; invItab < 2; invItab++ )
+                if( !find(lens[i], invItab != 0) )
+                    tables.push_back(makePtr<DFTTables>(lens[i], depth, invItab != 0));
+    }
+
+    const DFTTables* find( int len, bool invItab ) const
+    {
+        for( size_t i = 0; i < tables.size(); i++ )
+            if( tables[i]->len == len && tables[i]->invItab == invItab )
+                return tables[i];
+        return 0;
+    }
+
+    Size size;
+    int depth;
+    std::vector<Ptr<DFTTables> > tables;
+};
+
 template<typename T> struct DFT_VecR4
 {
     int operator()(Complex<T>*, int, int, int&, const Complex<T>*) const { return 1; }
@@ -465,6 +550,20 @@ template<> struct DFT_VecR4<float>
 
 #endif
 
+#ifdef HAVE_DISPATCH_AVX2
+
+static int DFTRadix4_AVX2( Complexf* dst, int N, int n0, int& dw0, const Complexf* wave )
+{
+    return opt_AVX2::dftRadix4_32f((float*)dst, N, n0, dw0, (const float*)wave);
+}
+
+static int DFTRadix4_AVX2( Complexd*, int, int, int&, const Complexd* )
+{
+    return 1;
+}
+
+#endif
+
 #ifdef USE_IPP_DFT
 static void ippsDFTFwd_CToC( const Complex<float>* src, Complex<float>* dst,
                              const void* spec, uchar* buf)
@@ -652,6 +751,11 @@ DFT( const Complex<T>* src, Complex<T>* dst, int n,
     // 1. power-2 transforms
     if( (factors[0] & 1) == 0 )
     {
+#ifdef HAVE_DISPATCH_AVX2
+        if( factors[0] >= 4 && USE_AVX2 )
+            n = DFTRadix4_AVX2(dst, factors[0], n0, dw0, wave);
+        else
+#endif
         if( factors[0] >= 4 && checkHardwareSupport(CV_CPU_SSE3))
         {
             DFT_VecR4<T> vr4;
@@ -2018,7 +2122,132 @@ static bool ocl_dft(InputArray _src, OutputArray _dst, int flags)
 
 #endif // HAVE_CLAMDFFT
 
-void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
+namespace cv
+{
+
+// the number of the transformed elements per parallel_for_ stripe
+enum { DFT_PARALLEL_SIZE = 1 << 16 };
+
+// the 1D transforms of one pass of cv::dft
+struct DFTPass
+{
+    DFTPass( DFTFunc _func, int _len, int _nf, const int* _factors, const int* _itab,
+             const uchar* _wave, const void* _spec, int _flags, double _scale, int _worksize )
+        : func(_func), len(_len), nf(_nf), factors(_factors), itab(_itab), wave(_wave), spec(_spec),
+          flags(_flags), scale(_scale), worksize(_worksize) {}
+
+    DFTFunc func;
+    int len, nf;
+    const int* factors;
+    const int* itab;
+    const uchar* wave;
+    const void* spec;
+    int flags;
+    double scale;
+    // the size of the work buffer of func
+    int worksize;
+};
+
+class DFTRowsInvoker : public ParallelLoopBody
+{
+public:
+    DFTRowsInvoker( const Mat& _src, const Mat& _dst, const DFTPass& _pass,
+                    int _tmpsize, int _dptr_offset, int _dst_full_len )
+        : src(_src), dst(_dst), pass(_pass), tmpsize(_tmpsize),
+          dptr_offset(_dptr_offset), dst_full_len(_dst_full_len) {}
+
+    void operator()( const Range& range ) const
+    {
+        // RealDFT and CCSIDFT temporarily modify the factors
+        int factors[34];
+        memcpy( factors, pass.factors, pass.nf*sizeof(factors[0]) );
+
+        AutoBuffer<uchar> buf( alignSize(tmpsize, 16) + pass.worksize + 16 );
+        uchar* tmp_buf = tmpsize > 0 ? alignPtr((uchar*)buf, 16) : 0;
+        uchar* ptr = alignPtr((uchar*)buf, 16) + alignSize(tmpsize, 16);
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            uchar* sptr = src.data + i*src.step;
+            uchar* dptr0 = dst.data + i*dst.step;
+            uchar* dptr = tmp_buf ? tmp_buf : dptr0;
+
+            pass.func( sptr, dptr, pass.len, pass.nf, factors, pass.itab, pass.wave, pass.len,
+                       pass.spec, ptr, pass.flags, pass.scale );
+            if( dptr != dptr0 )
+                memcpy( dptr0, dptr + dptr_offset, dst_full_len );
+        }
+    }
+
+private:
+    Mat src, dst;
+    DFTPass pass;
+    int tmpsize, dptr_offset, dst_full_len;
+};
+
+class DFTColumnsInvoker : public ParallelLoopBody
+{
+public:
+    // the range is measured in the pairs of columns
+    DFTColumnsInvoker( const uchar* _sptr, size_t _sstep, uchar* _dptr, size_t _dstep, int _ncols,
+                       int _elem_size, const DFTPass& _pass, bool _use_buf )
+        : sptr(_sptr), sstep(_sstep), dptr(_dptr), dstep(_dstep), ncols(_ncols),
+          elem_size(_elem_size), pass(_pass), use_buf(_use_buf) {}
+
+    void operator()( const Range& range ) const
+    {
+        int len = pass.len, vsize = len*elem_size;
+        int factors[34];
+        memcpy( factors, pass.factors, pass.nf*sizeof(factors[0]) );
+
+        AutoBuffer<uchar> buf( vsize*(use_buf ? 3 : 2) + pass.worksize + 32 );
+        uchar *buf0 = alignPtr((uchar*)buf, 16), *buf1 = buf0 + vsize;
+        uchar *dbuf0 = buf0, *dbuf1 = buf1, *ptr = buf1 + vsize;
+
+        if( use_buf )
+        {
+            dbuf1 = ptr;
+            dbuf0 = buf1;
+            ptr += vsize;
+        }
+
+        for( int k = range.start; k < range.end; k++ )
+        {
+            const uchar* sptr0 = sptr + k*2*elem_size;
+            uchar* dptr0 = dptr + k*2*elem_size;
+            bool pair = k*2 + 1 < ncols;
+
+            if( pair )
+            {
+                CopyFrom2Columns( sptr0, sstep, buf0, buf1, len, elem_size );
+                pass.func( buf1, dbuf1, len, pass.nf, factors, pass.itab, pass.wave, len,
+                           pass.spec, ptr, pass.flags, pass.scale );
+            }
+            else
+                CopyColumn( sptr0, sstep, buf0, elem_size, len, elem_size );
+
+            pass.func( buf0, dbuf0, len, pass.nf, factors, pass.itab, pass.wave, len,
+                       pass.spec, ptr, pass.flags, pass.scale );
+
+            if( pair )
+                CopyTo2Columns( dbuf0, dbuf1, dptr0, dstep, len, elem_size );
+            else
+                CopyColumn( dbuf0, elem_size, dptr0, dstep, len, elem_size );
+        }
+    }
+
+private:
+    const uchar* sptr;
+    size_t sstep;
+    uchar* dptr;
+    size_t dstep;
+    int ncols, elem_size;
+    DFTPass pass;
+    bool use_buf;
+};
+
+static void dftImpl( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows,
+                     const DFTPlan::Impl* plan )
 {
 #ifdef HAVE_CLAMDFFT
     CV_OCL_RUN(ocl::haveAmdFft() && ocl::Device::getDefault().type() != ocl::Device::TYPE_CPU &&
@@ -2040,13 +2269,14 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
     void *spec = 0;
 
     Mat src0 = _src0.getMat(), src = src0;
-    int prev_len = 0, stage = 0;
+    int stage = 0;
     bool inv = (flags & DFT_INVERSE) != 0;
     int nf = 0, real_transform = src.channels() == 1 || (inv && (flags & DFT_REAL_OUTPUT)!=0);
     int type = src.type(), depth = src.depth();
     int elem_size = (int)src.elemSize1(), complex_elem_size = elem_size*2;
     int factors[34];
     bool inplace_transform = false;
+    Ptr<DFTTables> cachedTables;
 #ifdef USE_IPP_DFT
     AutoBuffer<uchar> ippbuf;
     int ipp_norm_flag = !(flags & DFT_SCALE) ? 8 : inv ? 2 : 1;
@@ -2118,10 +2348,10 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
     for(;;)
     {
         double scale = 1;
-        uchar* wave = 0;
-        int* itab = 0;
+        const uchar* wave = 0;
+        const int* itab = 0;
         uchar* ptr;
-        int i, len, count, sz = 0;
+        int i, len, count, sz = 0, worksize = 0;
         int use_buf = 0, odd_real = 0;
         DFTFunc dft_func;
 
@@ -2147,7 +2377,7 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
 #ifdef USE_IPP_DFT
         if( len*count >= 64 ) // use IPP DFT if available
         {
-            int specsize=0, initsize=0, worksize=0;
+            int specsize=0, initsize=0;
             IppDFTGetSizeFunc getSizeFunc = 0;
             IppDFTInitFunc initFunc = 0;
 
@@ -2184,48 +2414,40 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
                 uchar* initbuf = alignPtr((uchar*)spec + specsize, 32);
                 if( initFunc(len, ipp_norm_flag, ippAlgHintNone, spec, initbuf) < 0 )
                     spec = 0;
-                sz += worksize;
             }
         }
         else
 #endif
         {
-            if( len != prev_len )
-                nf = DFTFactorize( len, factors );
+            // the tables are taken from the plan or from the cache, the repeated transforms
+            // of the same size do not recompute them
+            bool invItab = stage == 0 && inv && real_transform;
+            const DFTTables* tables = plan ? plan->find( len, invItab ) : 0;
+            if( !tables )
+            {
+                cachedTables = getDFTTables( len, depth, invItab );
+                tables = cachedTables;
+            }
+            nf = tables->nf;
+            memcpy( factors, tables->factors, nf*sizeof(factors[0]) );
+            wave = tables->wavePtr();
+            itab = &tables->itab[0];
 
             inplace_transform = factors[0] == factors[nf-1];
-            sz += len*(complex_elem_size + sizeof(int));
             i = nf > 1 && (factors[0] & 1) == 0;
             if( (factors[i] & 1) != 0 && factors[i] > 5 )
-                sz += (factors[i]+1)*complex_elem_size;
+                worksize = (factors[i]+1)*complex_elem_size;
 
             if( (stage == 0 && ((src.data == dst.data && !inplace_transform) || odd_real)) ||
                 (stage == 1 && !inplace_transform) )
-            {
                 use_buf = 1;
-                sz += len*complex_elem_size;
-            }
         }
 
-        ptr = (uchar*)buf;
+        if( use_buf )
+            sz += len*complex_elem_size;
+        sz += worksize;
         buf.allocate( sz + 32 );
-        if( ptr != (uchar*)buf )
-            prev_len = 0; // because we release the buffer,
-                          // force recalculation of
-                          // twiddle factors and permutation table
-        ptr = (uchar*)buf;
-        if( !spec )
-        {
-            wave = ptr;
-            ptr += len*complex_elem_size;
-            itab = (int*)ptr;
-            ptr = (uchar*)cvAlignPtr( ptr + len*sizeof(int), 16 );
-
-            if( len != prev_len || (!inplace_transform && inv && real_transform))
-                DFTInit( len, nf, factors, itab, complex_elem_size,
-                            wave, stage == 0 && inv && real_transform );
-            // otherwise reuse the tables calculated on the previous stage
-        }
+        ptr = alignPtr((uchar*)buf, 16);
 
         if( stage == 0 )
         {
@@ -2256,21 +2478,12 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
             if( nonzero_rows <= 0 || nonzero_rows > count )
                 nonzero_rows = count;
 
-            for( i = 0; i < nonzero_rows; i++ )
-            {
-                uchar* sptr = src.data + i*src.step;
-                uchar* dptr0 = dst.data + i*dst.step;
-                uchar* dptr = dptr0;
-
-                if( tmp_buf )
-                    dptr = tmp_buf;
+            DFTPass pass( dft_func, len, nf, factors, itab, wave, spec, _flags, scale, worksize );
+            DFTRowsInvoker invoker( src, dst, pass, tmp_buf ? len*complex_elem_size : 0,
+                                    dptr_offset, dst_full_len );
+            parallel_for_( Range(0, nonzero_rows), invoker, (double)nonzero_rows*len/DFT_PARALLEL_SIZE );
 
-                dft_func( sptr, dptr, len, nf, factors, itab, wave, len, spec, ptr, _flags, scale );
-                if( dptr != dptr0 )
-                    memcpy( dptr0, dptr + dptr_offset, dst_full_len );
-            }
-
-            for( ; i < count; i++ )
+            for( i = nonzero_rows; i < count; i++ )
             {
                 uchar* dptr0 = dst.data + i*dst.step;
                 memset( dptr0, 0, dst_full_len );
@@ -2394,26 +2607,13 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
                 }
             }
 
-            for( i = a; i < b; i += 2 )
+            if( a < b )
             {
-                if( i+1 < b )
-                {
-                    CopyFrom2Columns( sptr0, src.step, buf0, buf1, len, complex_elem_size );
-                    dft_func( buf1, dbuf1, len, nf, factors, itab,
-                              wave, len, spec, ptr, inv, scale );
-                }
-                else
-                    CopyColumn( sptr0, src.step, buf0, complex_elem_size, len, complex_elem_size );
-
-                dft_func( buf0, dbuf0, len, nf, factors, itab,
-                          wave, len, spec, ptr, inv, scale );
-
-                if( i+1 < b )
-                    CopyTo2Columns( dbuf0, dbuf1, dptr0, dst.step, len, complex_elem_size );
-                else
-                    CopyColumn( dbuf0, complex_elem_size, dptr0, dst.step, len, complex_elem_size );
-                sptr0 += 2*complex_elem_size;
-                dptr0 += 2*complex_elem_size;
+                // the columns are transformed in pairs
+                DFTPass pass( dft_func, len, nf, factors, itab, wave, spec, inv, scale, worksize );
+                DFTColumnsInvoker invoker( sptr0, src.step, dptr0, dst.step, b - a, complex_elem_size,
+                                           pass, use_buf != 0 );
+                parallel_for_( Range(0, (b - a + 1)/2), invoker, (double)(b - a)*len/DFT_PARALLEL_SIZE );
             }
 
             if( stage != 0 )
@@ -2461,6 +2661,47 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
     }
 }
 
+}
+
+void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
+{
+    dftImpl( _src0, _dst, flags, nonzero_rows, 0 );
+}
+
+cv::DFTPlan::DFTPlan() {}
+
+cv::DFTPlan::DFTPlan( Size size, int type )
+{
+    create( size, type );
+}
+
+void cv::DFTPlan::create( Size size, int type )
+{
+    int depth = CV_MAT_DEPTH(type);
+    CV_Assert( (depth == CV_32F || depth == CV_64F) && size.width > 0 && size.height > 0 );
+    p = makePtr<Impl>(size, depth);
+}
+
+void cv::DFTPlan::execute( InputArray src, OutputArray dst, int flags, int nonzeroRows ) const
+{
+    CV_Assert( !empty() && src.size() == p->size && src.depth() == p->depth );
+    dftImpl( src, dst, flags, nonzeroRows, p );
+}
+
+bool cv::DFTPlan::empty() const
+{
+    return p.empty();
+}
+
+cv::Size cv::DFTPlan::size() const
+{
+    return p ? p->size : Size();
+}
+
+int cv::DFTPlan::depth() const
+{
+    return p ? p->depth : -1;
+}
 
 void cv::idft( InputArray src, OutputArray dst, int flags, int nonzero_rows )
 {
@@ -0,0 +1,272 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2014, Itseez Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+#include "precomp.hpp"
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+# include <windows.h>
+#else
+# include <sys/types.h>
+# include <sys/stat.h>
+# include <sys/mman.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+namespace cv
+{
+
+// Owns the file mappings of MappedMat: u->origdata and u->size describe the whole mapped
+// region, which starts at the page boundary preceding the matrix data
+class MappedFileAllocator : public MatAllocator
+{
+public:
+    UMatData* allocate(int dims, const int* sizes, int type,
+                       void* data, size_t* step, int flags, UMatUsageFlags usageFlags) const
+    {
+        // the new buffers (e.g. on Mat::create) are not file-backed
+        return Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+
+    bool allocate(UMatData* u, int /*accessFlags*/, UMatUsageFlags /*usageFlags*/) const
+    {
+        return u != 0;
+    }
+
+    void deallocate(UMatData* u) const
+    {
+        CV_Assert(u->urefcount >= 0);
+        CV_Assert(u->refcount >= 0);
+        if( u->refcount == 0 )
+        {
+#if defined WIN32 || defined _WIN32 || defined WINCE
+            UnmapViewOfFile(u->origdata);
+#else
+            munmap(u->origdata, u->size);
+#endif
+            u->origdata = 0;
+            delete u;
+        }
+    }
+};
+
+static MatAllocator* getMappedFileAllocator()
+{
+    static MatAllocator* allocator = new MappedFileAllocator();
+    return allocator;
+}
+
+// maps [offset, offset + size) of the file; returns the base of the mapping and its length
+static uchar* mapFile( const String& filename, size_t offset, size_t size, bool copyOnWrite,
+                       size_t& fileSize, size_t& mapOffset, size_t& mapSize )
+{
+#if defined HAVE_WINRT
+    (void)filename; (void)offset; (void)size; (void)copyOnWrite;
+    (void)fileSize; (void)mapOffset; (void)mapSize;
+    CV_Error( CV_StsNotImplemented, "The file mapping is not supported on this platform" );
+    return 0;
+#elif defined WIN32 || defined _WIN32 || defined WINCE
+    HANDLE file = CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, 0,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0 );
+    if( file == INVALID_HANDLE_VALUE )
+        CV_Error_( CV_StsError, ("Can not open file %s", filename.c_str()) );
+
+    LARGE_INTEGER fsize;
+    if( !GetFileSizeEx(file, &fsize) )
+    {
+        CloseHandle(file);
+        CV_Error_( CV_StsError, ("Can not get the size of file %s", filename.c_str()) );
+    }
+    fileSize = (size_t)fsize.QuadPart;
+    if( size == 0 )
+    {
+        // only the file size is requested
+        CloseHandle(file);
+        return 0;
+    }
+    if( offset > fileSize || size > fileSize - offset )
+    {
+        CloseHandle(file);
+        CV_Error_( CV_StsOutOfRange, ("The file %s is too small for the matrix", filename.c_str()) );
+    }
+
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    mapOffset = offset - offset % si.dwAllocationGranularity;
+    mapSize = size + (offset - mapOffset);
+
+    HANDLE mapping = CreateFileMappingA( file, 0, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, 0 );
+    CloseHandle(file);
+    if( !mapping )
+        CV_Error_( CV_StsError, ("Can not map file %s", filename.c_str()) );
+
+    unsigned long long ofs = mapOffset;
+    void* ptr = MapViewOfFile( mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ,
+                               (DWORD)(ofs >> 32), (DWORD)ofs, mapSize );
+    // the view keeps the mapping object alive
+    CloseHandle(mapping);
+    if( !ptr )
+        CV_Error_( CV_StsError, ("Can not map file %s", filename.c_str()) );
+    return (uchar*)ptr;
+#else
+    int fd = ::open( filename.c_str(), O_RDONLY );
+    if( fd < 0 )
+        CV_Error_( CV_StsError, ("Can not open file %s", filename.c_str()) );
+
+    struct stat st;
+    if( fstat(fd, &st) != 0 )
+    {
+        ::close(fd);
+        CV_Error_( CV_StsError, ("Can not get the size of file %s", filename.c_str()) );
+    }
+    fileSize = (size_t)st.st_size;
+    if( size == 0 )
+    {
+        // only the file size is requested
+        ::close(fd);
+        return 0;
+    }
+    if( offset > fileSize || size > fileSize - offset )
+    {
+        ::close(fd);
+        CV_Error_( CV_StsOutOfRange, ("The file %s is too small for the matrix", filename.c_str()) );
+    }
+
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    mapOffset = offset - offset % pageSize;
+    mapSize = size + (offset - mapOffset);
+
+    void* ptr = mmap( 0, mapSize, copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ,
+                      copyOnWrite ? MAP_PRIVATE : MAP_SHARED, fd, (off_t)mapOffset );
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+    if( ptr == MAP_FAILED )
+        CV_Error_( CV_StsError, ("Can not map file %s", filename.c_str()) );
+    return (uchar*)ptr;
+#endif
+}
+
+MappedMat::MappedMat()
+{
+}
+
+MappedMat::MappedMat( const String& filename, int _rows, int _cols, int _type, int _flags, size_t offset )
+{
+    open( filename, _rows, _cols, _type, _flags, offset );
+}
+
+MappedMat::MappedMat( const String& filename, int ndims, const int* sizes, int _type, int _flags, size_t offset )
+{
+    open( filename, ndims, sizes, _type, _flags, offset );
+}
+
+void MappedMat::open( const String& filename, int _rows, int _cols, int _type, int _flags, size_t offset )
+{
+    if( _rows <= 0 )
+    {
+        CV_Assert( _cols > 0 );
+        size_t fileSize = 0, mapOffset = 0, mapSize = 0;
+        mapFile( filename, offset, 0, false, fileSize, mapOffset, mapSize );
+        size_t rowSize = _cols*CV_ELEM_SIZE(_type);
+        if( offset > fileSize || (fileSize - offset)/rowSize == 0 )
+            CV_Error_( CV_StsOutOfRange, ("The file %s is too small for the matrix", filename.c_str()) );
+        CV_Assert( (fileSize - offset)/rowSize <= (size_t)INT_MAX );
+        _rows = (int)((fileSize - offset)/rowSize);
+    }
+
+    int sizes[] = { _rows, _cols };
+    open( filename, 2, sizes, _type, _flags, offset );
+}
+
+void MappedMat::open( const String& filename, int ndims, const int* sizes, int _type, int _flags, size_t offset )
+{
+    CV_Assert( 0 < ndims && ndims <= CV_MAX_DIM && sizes );
+    CV_Assert( _flags == READ_ONLY || _flags == COPY_ON_WRITE );
+
+    size_t total = CV_ELEM_SIZE(_type);
+    for( int i = 0; i < ndims; i++ )
+    {
+        CV_Assert( sizes[i] > 0 );
+        total *= (size_t)sizes[i];
+    }
+
+    release();
+
+    size_t fileSize = 0, mapOffset = 0, mapSize = 0;
+    uchar* base = mapFile( filename, offset, total, _flags == COPY_ON_WRITE, fileSize, mapOffset, mapSize );
+
+    UMatData* ud = new UMatData(getMappedFileAllocator());
+    ud->origdata = base;
+    ud->data = base + (offset - mapOffset);
+    ud->size = mapSize;
+    ud->flags |= UMatData::USER_ALLOCATED;
+    ud->refcount = 1;
+
+    Mat hdr( ndims, sizes, _type, ud->data );
+    // the header takes the ownership of the mapping, so that it is released with the last matrix referencing it
+    hdr.u = ud;
+    Mat::operator = (hdr);
+}
+
+bool MappedMat::advise( int hint ) const
+{
+    if( !u || u->currAllocator != getMappedFileAllocator() )
+        return false;
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    return hint == ADVISE_NORMAL;
+#else
+    int advice = hint == ADVISE_NORMAL ? MADV_NORMAL :
+                 hint == ADVISE_SEQUENTIAL ? MADV_SEQUENTIAL :
+                 hint == ADVISE_RANDOM ? MADV_RANDOM :
+                 hint == ADVISE_WILLNEED ? MADV_WILLNEED : -1;
+    if( advice < 0 )
+        return false;
+
+    // madvise() requires the page-aligned start
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    uchar* start = datastart - (size_t)(datastart - u->origdata) % pageSize;
+    return madvise( start, dataend - start, advice ) == 0;
+#endif
+}
+
+}
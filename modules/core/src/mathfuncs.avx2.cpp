@@ -0,0 +1,245 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2014, Itseez Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+/* ////////////////////////////////////////////////////////////////////
+//
+//  AVX2 versions of exp, log, magnitude and phase.
+//  They use the same tables and polynomials as the SSE2 code in mathfuncs.cpp,
+//  so the results match it bit to bit.
+//
+// */
+
+#include "opt_avx2.hpp"
+#include <float.h>
+
+#if CV_AVX2
+
+namespace cv
+{
+namespace opt_AVX2
+{
+
+// the constants below must be kept in sync with mathfuncs.cpp
+static const float atan2_p1 = 0.9997878412794807f*(float)(180/CV_PI);
+static const float atan2_p3 = -0.3258083974640975f*(float)(180/CV_PI);
+static const float atan2_p5 = 0.1555786518463281f*(float)(180/CV_PI);
+static const float atan2_p7 = -0.04432655554792128f*(float)(180/CV_PI);
+
+static const double exp_prescale = 1.4426950408889634073599246810019 * (1 << EXPTAB_SCALE);
+static const double exp_postscale = 1./(1 << EXPTAB_SCALE);
+static const double exp_max_val = 3000.*(1 << EXPTAB_SCALE); // log10(DBL_MAX) < 3000
+
+static const double ln_2 = 0.69314718055994530941723212145818;
+
+static inline __m256 cvt_pd_ps(__m256d lo, __m256d hi)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(lo)), _mm256_cvtpd_ps(hi), 1);
+}
+
+int exp32f(const float* x, float* y, int n)
+{
+    const float
+        A4 = (float)(1.000000000000002438532970795181890933776 / EXPPOLY_32F_A0),
+        A3 = (float)(.6931471805521448196800669615864773144641 / EXPPOLY_32F_A0),
+        A2 = (float)(.2402265109513301490103372422686535526573 / EXPPOLY_32F_A0),
+        A1 = (float)(.5550339366753125211915322047004666939128e-1 / EXPPOLY_32F_A0);
+
+    const __m256d prescale4 = _mm256_set1_pd(exp_prescale);
+    const __m256 postscale8 = _mm256_set1_ps((float)exp_postscale);
+    const __m256 maxval8 = _mm256_set1_ps((float)(exp_max_val/exp_prescale));
+    const __m256 minval8 = _mm256_set1_ps((float)(-exp_max_val/exp_prescale));
+    const __m256 mA1 = _mm256_set1_ps(A1), mA2 = _mm256_set1_ps(A2);
+    const __m256 mA3 = _mm256_set1_ps(A3), mA4 = _mm256_set1_ps(A4);
+    const __m256i tabmask = _mm256_set1_epi32(EXPTAB_MASK);
+    int i = 0;
+
+    for( ; i <= n - 8; i += 8 )
+    {
+        __m256 xf = _mm256_loadu_ps(x + i);
+        xf = _mm256_min_ps(_mm256_max_ps(xf, minval8), maxval8);
+
+        __m256d xd0 = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(xf)), prescale4);
+        __m256d xd1 = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(xf, 1)), prescale4);
+        __m128i xi0 = _mm256_cvtpd_epi32(xd0), xi1 = _mm256_cvtpd_epi32(xd1);
+
+        xd0 = _mm256_sub_pd(xd0, _mm256_cvtepi32_pd(xi0));
+        xd1 = _mm256_sub_pd(xd1, _mm256_cvtepi32_pd(xi1));
+        xf = _mm256_mul_ps(cvt_pd_ps(xd0, xd1), postscale8);
+
+        __m256i xi = _mm256_inserti128_si256(_mm256_castsi128_si256(xi0), xi1, 1);
+        __m256i idx = _mm256_and_si256(xi, tabmask);
+        __m256d yd0 = _mm256_i32gather_pd(expTab, _mm256_castsi256_si128(idx), 8);
+        __m256d yd1 = _mm256_i32gather_pd(expTab, _mm256_extracti128_si256(idx, 1), 8);
+
+        xi = _mm256_add_epi32(_mm256_srai_epi32(xi, EXPTAB_SCALE), _mm256_set1_epi32(127));
+        xi = _mm256_min_epi32(_mm256_max_epi32(xi, _mm256_setzero_si256()), _mm256_set1_epi32(255));
+        __m256 yf = _mm256_mul_ps(cvt_pd_ps(yd0, yd1), _mm256_castsi256_ps(_mm256_slli_epi32(xi, 23)));
+
+        __m256 zf = _mm256_add_ps(xf, mA1);
+        zf = _mm256_add_ps(_mm256_mul_ps(zf, xf), mA2);
+        zf = _mm256_add_ps(_mm256_mul_ps(zf, xf), mA3);
+        zf = _mm256_add_ps(_mm256_mul_ps(zf, xf), mA4);
+
+        _mm256_storeu_ps(y + i, _mm256_mul_ps(zf, yf));
+    }
+
+    return i;
+}
+
+int log32f(const float* _x, float* y, int n)
+{
+    const float
+        A0 = 0.3333333333333333333333333f,
+        A1 = -0.5f,
+        A2 = 1.f;
+
+    const __m256d ln2_4 = _mm256_set1_pd(ln_2);
+    const __m256 _1_8 = _mm256_set1_ps(1.f);
+    const __m256 shift8 = _mm256_set1_ps(-1.f/512);
+    const __m256 mA0 = _mm256_set1_ps(A0), mA1 = _mm256_set1_ps(A1), mA2 = _mm256_set1_ps(A2);
+    const int* x = (const int*)_x;
+    int i = 0;
+
+    for( ; i <= n - 8; i += 8 )
+    {
+        __m256i h = _mm256_loadu_si256((const __m256i*)(x + i));
+        __m256i yi = _mm256_sub_epi32(_mm256_and_si256(_mm256_srli_epi32(h, 23), _mm256_set1_epi32(255)),
+                                      _mm256_set1_epi32(127));
+        __m256d yd0 = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(yi)), ln2_4);
+        __m256d yd1 = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(yi, 1)), ln2_4);
+
+        __m256i xi = _mm256_or_si256(_mm256_and_si256(h, _mm256_set1_epi32(LOGTAB_MASK2_32F)),
+                                     _mm256_set1_epi32(127 << 23));
+
+        h = _mm256_and_si256(_mm256_srli_epi32(h, 23 - LOGTAB_SCALE - 1), _mm256_set1_epi32(LOGTAB_MASK*2));
+        __m128i h0 = _mm256_castsi256_si128(h), h1 = _mm256_extracti128_si256(h, 1);
+        __m256d t0 = _mm256_i32gather_pd(icvLogTab, h0, 8);
+        __m256d t1 = _mm256_i32gather_pd(icvLogTab, h1, 8);
+        __m256d r0 = _mm256_i32gather_pd(icvLogTab + 1, h0, 8);
+        __m256d r1 = _mm256_i32gather_pd(icvLogTab + 1, h1, 8);
+        h = _mm256_cmpeq_epi32(h, _mm256_set1_epi32(510));
+
+        __m256 yf = cvt_pd_ps(_mm256_add_pd(yd0, t0), _mm256_add_pd(yd1, t1));
+
+        __m256 xf = _mm256_sub_ps(_mm256_castsi256_ps(xi), _1_8);
+        xf = _mm256_mul_ps(xf, cvt_pd_ps(r0, r1));
+        xf = _mm256_add_ps(xf, _mm256_and_ps(_mm256_castsi256_ps(h), shift8));
+
+        __m256 zf = _mm256_mul_ps(xf, mA0);
+        zf = _mm256_mul_ps(_mm256_add_ps(zf, mA1), xf);
+        zf = _mm256_mul_ps(_mm256_add_ps(zf, mA2), xf);
+
+        _mm256_storeu_ps(y + i, _mm256_add_ps(yf, zf));
+    }
+
+    return i;
+}
+
+int magnitude32f(const float* x, const float* y, float* mag, int len)
+{
+    int i = 0;
+
+    for( ; i <= len - 16; i += 16 )
+    {
+        __m256 x0 = _mm256_loadu_ps(x + i), x1 = _mm256_loadu_ps(x + i + 8);
+        __m256 y0 = _mm256_loadu_ps(y + i), y1 = _mm256_loadu_ps(y + i + 8);
+        x0 = _mm256_add_ps(_mm256_mul_ps(x0, x0), _mm256_mul_ps(y0, y0));
+        x1 = _mm256_add_ps(_mm256_mul_ps(x1, x1), _mm256_mul_ps(y1, y1));
+        _mm256_storeu_ps(mag + i, _mm256_sqrt_ps(x0));
+        _mm256_storeu_ps(mag + i + 8, _mm256_sqrt_ps(x1));
+    }
+
+    return i;
+}
+
+int magnitude64f(const double* x, const double* y, double* mag, int len)
+{
+    int i = 0;
+
+    for( ; i <= len - 8; i += 8 )
+    {
+        __m256d x0 = _mm256_loadu_pd(x + i), x1 = _mm256_loadu_pd(x + i + 4);
+        __m256d y0 = _mm256_loadu_pd(y + i), y1 = _mm256_loadu_pd(y + i + 4);
+        x0 = _mm256_add_pd(_mm256_mul_pd(x0, x0), _mm256_mul_pd(y0, y0));
+        x1 = _mm256_add_pd(_mm256_mul_pd(x1, x1), _mm256_mul_pd(y1, y1));
+        _mm256_storeu_pd(mag + i, _mm256_sqrt_pd(x0));
+        _mm256_storeu_pd(mag + i + 4, _mm256_sqrt_pd(x1));
+    }
+
+    return i;
+}
+
+int fastAtan2_32f(const float* Y, const float* X, float* angle, int len, float scale)
+{
+    const __m256 eps = _mm256_set1_ps((float)DBL_EPSILON);
+    const __m256 absmask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 _90 = _mm256_set1_ps(90.f), _180 = _mm256_set1_ps(180.f), _360 = _mm256_set1_ps(360.f);
+    const __m256 z = _mm256_setzero_ps(), scale8 = _mm256_set1_ps(scale);
+    const __m256 p1 = _mm256_set1_ps(atan2_p1), p3 = _mm256_set1_ps(atan2_p3);
+    const __m256 p5 = _mm256_set1_ps(atan2_p5), p7 = _mm256_set1_ps(atan2_p7);
+    int i = 0;
+
+    for( ; i <= len - 8; i += 8 )
+    {
+        __m256 x = _mm256_loadu_ps(X + i), y = _mm256_loadu_ps(Y + i);
+        __m256 ax = _mm256_and_ps(x, absmask), ay = _mm256_and_ps(y, absmask);
+        __m256 tmin = _mm256_min_ps(ax, ay), tmax = _mm256_max_ps(ax, ay);
+        __m256 c = _mm256_div_ps(tmin, _mm256_add_ps(tmax, eps));
+        __m256 c2 = _mm256_mul_ps(c, c);
+        __m256 a = _mm256_mul_ps(c2, p7);
+        a = _mm256_mul_ps(_mm256_add_ps(a, p5), c2);
+        a = _mm256_mul_ps(_mm256_add_ps(a, p3), c2);
+        a = _mm256_mul_ps(_mm256_add_ps(a, p1), c);
+
+        a = _mm256_blendv_ps(a, _mm256_sub_ps(_90, a), _mm256_cmp_ps(ax, ay, _CMP_LT_OQ));
+        a = _mm256_blendv_ps(a, _mm256_sub_ps(_180, a), _mm256_cmp_ps(x, z, _CMP_LT_OQ));
+        a = _mm256_blendv_ps(a, _mm256_sub_ps(_360, a), _mm256_cmp_ps(y, z, _CMP_LT_OQ));
+
+        _mm256_storeu_ps(angle + i, _mm256_mul_ps(a, scale8));
+    }
+
+    return i;
+}
+
+}
+}
+
+#endif
@@ -42,6 +42,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels.hpp"
+#include "opt_avx2.hpp"
 
 namespace cv
 {
@@ -128,6 +129,11 @@ static void FastAtan2_32f(const float *Y, const float *X, float *angle, int len,
         return;
 #endif
 
+#ifdef HAVE_DISPATCH_AVX2
+    if( USE_AVX2 )
+        i = opt_AVX2::fastAtan2_32f(Y, X, angle, len, scale);
+#endif
+
 #if CV_SSE2
     if( USE_SSE2 )
     {
@@ -246,6 +252,11 @@ static void Magnitude_32f(const float* x, const float* y, float* mag, int len)
 
     int i = 0;
 
+#ifdef HAVE_DISPATCH_AVX2
+    if( USE_AVX2 )
+        i = opt_AVX2::magnitude32f(x, y, mag, len);
+#endif
+
 #if CV_SSE
     if( USE_SSE2 )
     {
@@ -279,6 +290,11 @@ static void Magnitude_64f(const double* x, const double* y, double* mag, int len
 
     int i = 0;
 
+#ifdef HAVE_DISPATCH_AVX2
+    if( USE_AVX2 )
+        i = opt_AVX2::magnitude64f(x, y, mag, len);
+#endif
+
 #if CV_SSE2
     if( USE_SSE2 )
     {
@@ -859,12 +875,9 @@ typedef union
 }
 DBLINT;
 
-#define EXPTAB_SCALE 6
-#define EXPTAB_MASK  ((1 << EXPTAB_SCALE) - 1)
-
-#define EXPPOLY_32F_A0 .9670371139572337719125840413672004409288e-2
-
-static const double expTab[] = {
+// EXPTAB_SCALE, EXPTAB_MASK and EXPPOLY_32F_A0 are defined in opt_avx2.hpp,
+// the table is shared with the AVX2 code
+const double expTab[] = {
     1.0 * EXPPOLY_32F_A0,
     1.0108892860517004600204097905619 * EXPPOLY_32F_A0,
     1.0218971486541166782344801347833 * EXPPOLY_32F_A0,
@@ -959,8 +972,13 @@ static void Exp_32f( const float *_x, float *y, int n )
     const Cv32suf* x = (const Cv32suf*)_x;
     Cv32suf buf[4];
 
+#ifdef HAVE_DISPATCH_AVX2
+    if( USE_AVX2 )
+        i = opt_AVX2::exp32f(_x, y, n);
+#endif
+
 #if CV_SSE2
-    if( n >= 8 && USE_SSE2 )
+    if( n - i >= 8 && USE_SSE2 )
     {
         static const __m128d prescale2 = _mm_set1_pd(exp_prescale);
         static const __m128 postscale4 = _mm_set1_ps((float)exp_postscale);
@@ -1373,12 +1391,8 @@ void exp( InputArray _src, OutputArray _dst )
 *                                          L O G                                         *
 \****************************************************************************************/
 
-#define LOGTAB_SCALE    8
-#define LOGTAB_MASK         ((1 << LOGTAB_SCALE) - 1)
-#define LOGTAB_MASK2        ((1 << (20 - LOGTAB_SCALE)) - 1)
-#define LOGTAB_MASK2_32F    ((1 << (23 - LOGTAB_SCALE)) - 1)
-
-static const double CV_DECL_ALIGNED(16) icvLogTab[] = {
+// LOGTAB_* are defined in opt_avx2.hpp, the table is shared with the AVX2 code
+const double CV_DECL_ALIGNED(16) icvLogTab[] = {
 0.0000000000000000000000000000000000000000,    1.000000000000000000000000000000000000000,
 .00389864041565732288852075271279318258166,    .9961089494163424124513618677042801556420,
 .00778214044205494809292034119607706088573,    .9922480620155038759689922480620155038760,
@@ -1657,6 +1671,11 @@ static void Log_32f( const float *_x, float *y, int n )
     Cv32suf buf[4];
     const int* x = (const int*)_x;
 
+#ifdef HAVE_DISPATCH_AVX2
+    if( USE_AVX2 )
+        i = opt_AVX2::log32f(_x, y, n);
+#endif
+
 #if CV_SSE2
     if( USE_SSE2 )
     {
@@ -0,0 +1,138 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2014, Itseez Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+/* ////////////////////////////////////////////////////////////////////
+//
+//  AVX2 versions of the GEMM micro-kernels.
+//  Built with the AVX2 compiler flags and called from matmul.cpp when USE_AVX2 is set.
+//
+// */
+
+#include "opt_avx2.hpp"
+
+#if CV_AVX2
+
+namespace cv
+{
+namespace opt_AVX2
+{
+
+// The products and the sums are rounded separately (no FMA), so the results are
+// the same as the ones of the SSE2 kernels.
+
+// c[0..7] (+)= s, converted to double
+static inline void gemmFlush32f(__m256 s, double* c, bool accumulate)
+{
+    __m256d s0 = _mm256_cvtps_pd(_mm256_castps256_ps128(s)), s1 = _mm256_cvtps_pd(_mm256_extractf128_ps(s, 1));
+    if( accumulate )
+    {
+        s0 = _mm256_add_pd(s0, _mm256_loadu_pd(c));
+        s1 = _mm256_add_pd(s1, _mm256_loadu_pd(c + 4));
+    }
+    _mm256_storeu_pd(c, s0);
+    _mm256_storeu_pd(c + 4, s1);
+}
+
+void gemmKernel32f(int kc, const float* a, const float* b, double* c, size_t cstep, bool accumulate)
+{
+    __m256 c00, c01, c10, c11, c20, c21, c30, c31;
+    c00 = c01 = c10 = c11 = c20 = c21 = c30 = c31 = _mm256_setzero_ps();
+
+    for( int k = 0; k < kc; k++, a += 4, b += 16 )
+    {
+        __m256 b0 = _mm256_load_ps(b), b1 = _mm256_load_ps(b + 8);
+        __m256 a0 = _mm256_broadcast_ss(a), a1 = _mm256_broadcast_ss(a + 1);
+        c00 = _mm256_add_ps(c00, _mm256_mul_ps(a0, b0));
+        c01 = _mm256_add_ps(c01, _mm256_mul_ps(a0, b1));
+        c10 = _mm256_add_ps(c10, _mm256_mul_ps(a1, b0));
+        c11 = _mm256_add_ps(c11, _mm256_mul_ps(a1, b1));
+        a0 = _mm256_broadcast_ss(a + 2); a1 = _mm256_broadcast_ss(a + 3);
+        c20 = _mm256_add_ps(c20, _mm256_mul_ps(a0, b0));
+        c21 = _mm256_add_ps(c21, _mm256_mul_ps(a0, b1));
+        c30 = _mm256_add_ps(c30, _mm256_mul_ps(a1, b0));
+        c31 = _mm256_add_ps(c31, _mm256_mul_ps(a1, b1));
+    }
+
+    gemmFlush32f(c00, c, accumulate); gemmFlush32f(c01, c + 8, accumulate);
+    gemmFlush32f(c10, c + cstep, accumulate); gemmFlush32f(c11, c + cstep + 8, accumulate);
+    gemmFlush32f(c20, c + cstep*2, accumulate); gemmFlush32f(c21, c + cstep*2 + 8, accumulate);
+    gemmFlush32f(c30, c + cstep*3, accumulate); gemmFlush32f(c31, c + cstep*3 + 8, accumulate);
+}
+
+void gemmKernel64f(int kc, const double* a, const double* b, double* c, size_t cstep, bool accumulate)
+{
+    __m256d c00, c01, c10, c11, c20, c21, c30, c31;
+    if( accumulate )
+    {
+        c00 = _mm256_loadu_pd(c); c01 = _mm256_loadu_pd(c + 4);
+        c10 = _mm256_loadu_pd(c + cstep); c11 = _mm256_loadu_pd(c + cstep + 4);
+        c20 = _mm256_loadu_pd(c + cstep*2); c21 = _mm256_loadu_pd(c + cstep*2 + 4);
+        c30 = _mm256_loadu_pd(c + cstep*3); c31 = _mm256_loadu_pd(c + cstep*3 + 4);
+    }
+    else
+        c00 = c01 = c10 = c11 = c20 = c21 = c30 = c31 = _mm256_setzero_pd();
+
+    for( int k = 0; k < kc; k++, a += 4, b += 8 )
+    {
+        __m256d b0 = _mm256_load_pd(b), b1 = _mm256_load_pd(b + 4);
+        __m256d a0 = _mm256_broadcast_sd(a), a1 = _mm256_broadcast_sd(a + 1);
+        c00 = _mm256_add_pd(c00, _mm256_mul_pd(a0, b0));
+        c01 = _mm256_add_pd(c01, _mm256_mul_pd(a0, b1));
+        c10 = _mm256_add_pd(c10, _mm256_mul_pd(a1, b0));
+        c11 = _mm256_add_pd(c11, _mm256_mul_pd(a1, b1));
+        a0 = _mm256_broadcast_sd(a + 2); a1 = _mm256_broadcast_sd(a + 3);
+        c20 = _mm256_add_pd(c20, _mm256_mul_pd(a0, b0));
+        c21 = _mm256_add_pd(c21, _mm256_mul_pd(a0, b1));
+        c30 = _mm256_add_pd(c30, _mm256_mul_pd(a1, b0));
+        c31 = _mm256_add_pd(c31, _mm256_mul_pd(a1, b1));
+    }
+
+    _mm256_storeu_pd(c, c00); _mm256_storeu_pd(c + 4, c01);
+    _mm256_storeu_pd(c + cstep, c10); _mm256_storeu_pd(c + cstep + 4, c11);
+    _mm256_storeu_pd(c + cstep*2, c20); _mm256_storeu_pd(c + cstep*2 + 4, c21);
+    _mm256_storeu_pd(c + cstep*3, c30); _mm256_storeu_pd(c + cstep*3 + 4, c31);
+}
+
+}
+}
+
+#endif
@@ -42,6 +42,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels.hpp"
+#include "opt_avx2.hpp"
 #include "opencv2/core/opencl/runtime/opencl_clamdblas.hpp"
 
 namespace cv
@@ -691,6 +692,290 @@ static void GEMMStore_64fc( const Complexd* c_data, size_t c_step,
     GEMMStore(c_data, c_step, d_buf, d_buf_step, d_data, d_step, d_size, alpha, beta, flags);
 }
 
+/*
+  Packed GEMM for the real 32f and 64f matrices.
+
+  D is computed in GEMM_PACKED_MC x GEMM_PACKED_NC tiles, in parallel. B is packed once into
+  the kc x NR panels, each tile packs its rows of A into the MR x kc panels, and a register-blocked
+  MR x NR micro-kernel accumulates the products over the GEMM_PACKED_KC-long slices of the inner
+  dimension into a per-tile buffer. The buffer is then scaled and combined with C by GEMMStore.
+  Like in GEMMSingleMul, the per-tile buffer of the 32f products is double: the micro-kernel
+  sums at most GEMM_PACKED_KC_32F products in single precision and adds them to the buffer,
+  so the accuracy does not degrade with the length of the inner dimension.
+*/
+
+enum
+{
+    GEMM_PACKED_MR = 4,
+    GEMM_PACKED_KC = 256,
+    GEMM_PACKED_MC = 64,
+    GEMM_PACKED_NC = 512,
+    // the number of the products summed in single precision before they are added to the 64f buffer
+    GEMM_PACKED_KC_32F = 16,
+    // the smaller products are computed by GEMMSingleMul/GEMMBlockMul
+    GEMM_PACKED_MIN_SIZE = 16,
+    GEMM_PACKED_MIN_OPS = 1 << 16
+};
+
+template<typename T, typename WT, int NR> static void
+GEMMKernel( int kc, const T* a, const T* b, WT* c, size_t cstep, bool accumulate )
+{
+    T s[GEMM_PACKED_MR][NR];
+    int i, j, k;
+
+    for( i = 0; i < GEMM_PACKED_MR; i++ )
+        for( j = 0; j < NR; j++ )
+            s[i][j] = T(0);
+
+    for( k = 0; k < kc; k++, a += GEMM_PACKED_MR, b += NR )
+        for( i = 0; i < GEMM_PACKED_MR; i++ )
+            for( j = 0; j < NR; j++ )
+                s[i][j] += a[i]*b[j];
+
+    for( i = 0; i < GEMM_PACKED_MR; i++ )
+        for( j = 0; j < NR; j++ )
+            c[cstep*i + j] = (accumulate ? c[cstep*i + j] : WT(0)) + s[i][j];
+}
+
+#if CV_SSE2
+
+// c[0..3] (+)= s, converted to double
+static inline void GEMMFlush_32f( __m128 s, double* c, bool accumulate )
+{
+    __m128d s0 = _mm_cvtps_pd(s), s1 = _mm_cvtps_pd(_mm_movehl_ps(s, s));
+    if( accumulate )
+    {
+        s0 = _mm_add_pd(s0, _mm_loadu_pd(c));
+        s1 = _mm_add_pd(s1, _mm_loadu_pd(c + 2));
+    }
+    _mm_storeu_pd(c, s0);
+    _mm_storeu_pd(c + 2, s1);
+}
+
+static void GEMMKernel_32f( int kc, const float* a, const float* b, double* c, size_t cstep, bool accumulate )
+{
+    __m128 c00, c01, c10, c11, c20, c21, c30, c31;
+    c00 = c01 = c10 = c11 = c20 = c21 = c30 = c31 = _mm_setzero_ps();
+
+    for( int k = 0; k < kc; k++, a += 4, b += 8 )
+    {
+        __m128 b0 = _mm_load_ps(b), b1 = _mm_load_ps(b + 4);
+        __m128 a0 = _mm_set1_ps(a[0]), a1 = _mm_set1_ps(a[1]);
+        c00 = _mm_add_ps(c00, _mm_mul_ps(a0, b0));
+        c01 = _mm_add_ps(c01, _mm_mul_ps(a0, b1));
+        c10 = _mm_add_ps(c10, _mm_mul_ps(a1, b0));
+        c11 = _mm_add_ps(c11, _mm_mul_ps(a1, b1));
+        a0 = _mm_set1_ps(a[2]); a1 = _mm_set1_ps(a[3]);
+        c20 = _mm_add_ps(c20, _mm_mul_ps(a0, b0));
+        c21 = _mm_add_ps(c21, _mm_mul_ps(a0, b1));
+        c30 = _mm_add_ps(c30, _mm_mul_ps(a1, b0));
+        c31 = _mm_add_ps(c31, _mm_mul_ps(a1, b1));
+    }
+
+    GEMMFlush_32f(c00, c, accumulate); GEMMFlush_32f(c01, c + 4, accumulate);
+    GEMMFlush_32f(c10, c + cstep, accumulate); GEMMFlush_32f(c11, c + cstep + 4, accumulate);
+    GEMMFlush_32f(c20, c + cstep*2, accumulate); GEMMFlush_32f(c21, c + cstep*2 + 4, accumulate);
+    GEMMFlush_32f(c30, c + cstep*3, accumulate); GEMMFlush_32f(c31, c + cstep*3 + 4, accumulate);
+}
+
+static void GEMMKernel_64f( int kc, const double* a, const double* b, double* c, size_t cstep, bool accumulate )
+{
+    __m128d c00, c01, c10, c11, c20, c21, c30, c31;
+    if( accumulate )
+    {
+        c00 = _mm_loadu_pd(c); c01 = _mm_loadu_pd(c + 2);
+        c10 = _mm_loadu_pd(c + cstep); c11 = _mm_loadu_pd(c + cstep + 2);
+        c20 = _mm_loadu_pd(c + cstep*2); c21 = _mm_loadu_pd(c + cstep*2 + 2);
+        c30 = _mm_loadu_pd(c + cstep*3); c31 = _mm_loadu_pd(c + cstep*3 + 2);
+    }
+    else
+        c00 = c01 = c10 = c11 = c20 = c21 = c30 = c31 = _mm_setzero_pd();
+
+    for( int k = 0; k < kc; k++, a += 4, b += 4 )
+    {
+        __m128d b0 = _mm_load_pd(b), b1 = _mm_load_pd(b + 2);
+        __m128d a0 = _mm_set1_pd(a[0]), a1 = _mm_set1_pd(a[1]);
+        c00 = _mm_add_pd(c00, _mm_mul_pd(a0, b0));
+        c01 = _mm_add_pd(c01, _mm_mul_pd(a0, b1));
+        c10 = _mm_add_pd(c10, _mm_mul_pd(a1, b0));
+        c11 = _mm_add_pd(c11, _mm_mul_pd(a1, b1));
+        a0 = _mm_set1_pd(a[2]); a1 = _mm_set1_pd(a[3]);
+        c20 = _mm_add_pd(c20, _mm_mul_pd(a0, b0));
+        c21 = _mm_add_pd(c21, _mm_mul_pd(a0, b1));
+        c30 = _mm_add_pd(c30, _mm_mul_pd(a1, b0));
+        c31 = _mm_add_pd(c31, _mm_mul_pd(a1, b1));
+    }
+
+    _mm_storeu_pd(c, c00); _mm_storeu_pd(c + 2, c01);
+    _mm_storeu_pd(c + cstep, c10); _mm_storeu_pd(c + cstep + 2, c11);
+    _mm_storeu_pd(c + cstep*2, c20); _mm_storeu_pd(c + cstep*2 + 2, c21);
+    _mm_storeu_pd(c + cstep*3, c30); _mm_storeu_pd(c + cstep*3 + 2, c31);
+}
+
+#endif
+
+// T is the matrix type, WT is the type of the per-tile buffer
+template<typename T, typename WT> struct GEMMPackedKernel
+{
+    typedef void (*Func)( int kc, const T* a, const T* b, WT* c, size_t cstep, bool accumulate );
+
+    GEMMPackedKernel();
+
+    Func func;
+    // the width of the packed panels of B
+    int nr;
+    // the maximum kc passed to func
+    int kmax;
+};
+
+template<> GEMMPackedKernel<float, double>::GEMMPackedKernel()
+{
+    func = GEMMKernel<float, double, 8>;
+    nr = 8;
+    kmax = GEMM_PACKED_KC_32F;
+#if CV_SSE2
+    if( USE_SSE2 )
+        func = GEMMKernel_32f;
+#endif
+#ifdef HAVE_DISPATCH_AVX2
+    if( USE_AVX2 )
+        func = opt_AVX2::gemmKernel32f, nr = opt_AVX2::GEMM_KERNEL_NR_32F;
+#endif
+}
+
+template<> GEMMPackedKernel<double, double>::GEMMPackedKernel()
+{
+    func = GEMMKernel<double, double, 4>;
+    nr = 4;
+    kmax = GEMM_PACKED_KC;
+#if CV_SSE2
+    if( USE_SSE2 )
+        func = GEMMKernel_64f;
+#endif
+#ifdef HAVE_DISPATCH_AVX2
+    if( USE_AVX2 )
+        func = opt_AVX2::gemmKernel64f, nr = opt_AVX2::GEMM_KERNEL_NR_64F;
+#endif
+}
+
+// packs the kc x n block of B, b(k, j) = b[k*step0 + j*step1], into the kc x nr panels
+template<typename T> static void
+GEMMPackB( const T* b, size_t step0, size_t step1, T* bp, int kc, int n, int nr )
+{
+    for( int j = 0; j < n; j += nr, b += nr*step1 )
+    {
+        int k, jj, nj = std::min(nr, n - j);
+        for( k = 0; k < kc; k++, bp += nr )
+        {
+            const T* bk = b + k*step0;
+            for( jj = 0; jj < nj; jj++ )
+                bp[jj] = bk[jj*step1];
+            for( ; jj < nr; jj++ )
+                bp[jj] = 0;
+        }
+    }
+}
+
+// packs the m x kc block of A, a(i, k) = a[i*step0 + k*step1], into the MR x kc panels
+template<typename T> static void
+GEMMPackA( const T* a, size_t step0, size_t step1, T* ap, int m, int kc )
+{
+    const int MR = GEMM_PACKED_MR;
+    for( int i = 0; i < m; i += MR, a += MR*step0 )
+    {
+        int k, ii, mi = std::min(MR, m - i);
+        for( k = 0; k < kc; k++, ap += MR )
+        {
+            const T* ak = a + k*step1;
+            for( ii = 0; ii < mi; ii++ )
+                ap[ii] = ak[ii*step0];
+            for( ; ii < MR; ii++ )
+                ap[ii] = 0;
+        }
+    }
+}
+
+template<typename T, typename WT> class GEMMPackedInvoker : public ParallelLoopBody
+{
+public:
+    GEMMPackedInvoker( const Mat& _A, const T* _bp, const Mat& _C, const Mat& _D, int _len,
+                       double _alpha, double _beta, int _flags, const GEMMPackedKernel<T, WT>& _kernel )
+        : A(_A), bp(_bp), C(_C), D(_D), len(_len), alpha(_alpha), beta(_beta), flags(_flags), kernel(_kernel)
+    {
+        ntilesX = (D.cols + GEMM_PACKED_NC - 1)/GEMM_PACKED_NC;
+    }
+
+    void operator()( const Range& range ) const
+    {
+        const int MR = GEMM_PACKED_MR, KC = GEMM_PACKED_KC, MC = GEMM_PACKED_MC, NC = GEMM_PACKED_NC;
+        int nr = kernel.nr, kmax = kernel.kmax, npad = alignSize(D.cols, nr);
+        size_t esz = sizeof(T), step = A.step/esz;
+        size_t a_step0 = flags & GEMM_1_T ? 1 : step, a_step1 = flags & GEMM_1_T ? step : 1;
+        AutoBuffer<T> _abuf(MC*KC);
+        AutoBuffer<WT> _dbuf(MC*NC);
+        T *abuf = _abuf;
+        WT *dbuf = _dbuf;
+
+        for( int t = range.start; t < range.end; t++ )
+        {
+            int i0 = (t / ntilesX)*MC, j0 = (t % ntilesX)*NC;
+            int mc = std::min(MC, D.rows - i0), nc = std::min(NC, D.cols - j0);
+            size_t dstep = alignSize(nc, nr);
+
+            for( int k0 = 0; k0 < len; k0 += KC )
+            {
+                int kc = std::min(KC, len - k0);
+                const T* bblock = bp + (size_t)k0*npad + (size_t)j0*kc;
+
+                GEMMPackA((const T*)A.data + i0*a_step0 + k0*a_step1, a_step0, a_step1, abuf, mc, kc);
+                for( int j = 0; j < nc; j += nr )
+                    for( int i = 0; i < mc; i += MR )
+                        for( int k = 0; k < kc; k += kmax )
+                            kernel.func(std::min(kmax, kc - k), abuf + i*kc + k*MR, bblock + j*kc + k*nr,
+                                        dbuf + i*dstep + j, dstep, k0 + k > 0);
+            }
+
+            const uchar* c = 0;
+            if( C.data )
+                c = flags & GEMM_3_T ? C.data + j0*C.step + i0*esz : C.data + i0*C.step + j0*esz;
+            GEMMStore((const T*)c, C.step, (const WT*)dbuf, dstep*sizeof(WT), (T*)(D.data + i0*D.step + j0*esz),
+                      D.step, Size(nc, mc), alpha, beta, flags);
+        }
+    }
+
+    int total() const { return ntilesX*((D.rows + GEMM_PACKED_MC - 1)/GEMM_PACKED_MC); }
+
+private:
+    Mat A;
+    const T* bp;
+    Mat C, D;
+    int len;
+    double alpha, beta;
+    int flags, ntilesX;
+    const GEMMPackedKernel<T, WT>& kernel;
+};
+
+template<typename T, typename WT> static void
+GEMMPacked( const Mat& A, const Mat& B, double alpha, const Mat& C, double beta, Mat& D, int len, int flags )
+{
+    GEMMPackedKernel<T, WT> kernel;
+    int nr = kernel.nr, npad = alignSize(D.cols, nr);
+    size_t step = B.step/sizeof(T);
+    size_t b_step0 = flags & GEMM_2_T ? 1 : step, b_step1 = flags & GEMM_2_T ? step : 1;
+
+    // the panels are read with the aligned (up to 256-bit) loads
+    AutoBuffer<T> _bbuf((size_t)len*npad + 32/sizeof(T));
+    T* bbuf = alignPtr((T*)_bbuf, 32);
+    for( int k0 = 0; k0 < len; k0 += GEMM_PACKED_KC )
+    {
+        int kc = std::min((int)GEMM_PACKED_KC, len - k0);
+        GEMMPackB((const T*)B.data + k0*b_step0, b_step0, b_step1, bbuf + (size_t)k0*npad, kc, D.cols, nr);
+    }
+
+    GEMMPackedInvoker<T, WT> invoker(A, bbuf, C, D, len, alpha, beta, flags, kernel);
+    parallel_for_(Range(0, invoker.total()), invoker, invoker.total());
+}
+
 #ifdef HAVE_CLAMDBLAS
 
 static bool ocl_gemm( InputArray matA, InputArray matB, double alpha,
@@ -1137,6 +1422,20 @@ void cv::gemm( InputArray matA, InputArray matB, double alpha,
         matD = &tmat;
     }
 
+    if( (type == CV_32FC1 || type == CV_64FC1) && useOptimized() &&
+        std::min(std::min(d_size.width, d_size.height), len) >= GEMM_PACKED_MIN_SIZE &&
+        (double)d_size.width*d_size.height*len >= GEMM_PACKED_MIN_OPS )
+    {
+        if( type == CV_32FC1 )
+            GEMMPacked<float, double>(A, B, alpha, C, beta, *matD, len, flags);
+        else
+            GEMMPacked<double, double>(A, B, alpha, C, beta, *matD, len, flags);
+
+        if( matD != &D )
+            matD->copyTo(D);
+        return;
+    }
+
     if( (d_size.width == 1 || len == 1) && !(flags & GEMM_2_T) && B.isContinuous() )
     {
         b_step = d_size.width == 1 ? 0 : CV_ELEM_SIZE(type);
@@ -120,6 +120,44 @@ public:
 
 static MatOp_Cmp g_MatOp_Cmp;
 
+// an operand of the expression being built: either a matrix or the tree of nested
+// element-wise operations that is fused into the new expression instead of being evaluated
+struct MatExprArg
+{
+    Mat m;
+    Ptr<MatExprNode> node;
+};
+
+class MatOp_Fused : public MatOp
+{
+public:
+    MatOp_Fused() {}
+    virtual ~MatOp_Fused() {}
+
+    bool elementWise(const MatExpr& /*expr*/) const { return false; }
+    void assign(const MatExpr& expr, Mat& m, int type=-1) const;
+
+    void add(const MatExpr& e, const Scalar& s, MatExpr& res) const;
+    void subtract(const Scalar& s, const MatExpr& e, MatExpr& res) const;
+    void multiply(const MatExpr& e, double s, MatExpr& res) const;
+    void divide(double s, const MatExpr& e, MatExpr& res) const;
+    void abs(const MatExpr& e, MatExpr& res) const;
+
+    Size size(const MatExpr& expr) const;
+    int type(const MatExpr& expr) const;
+
+    // the operands of the scaled matrix (alpha*A + s), the scaled matrix without the shift
+    // and the reciprocal (alpha/A); for the fused expressions A is the subtree
+    static bool getAddExArg(const MatExpr& e, MatExprArg& arg, double& alpha, Scalar& s);
+    static bool getScaledArg(const MatExpr& e, MatExprArg& arg, double& alpha);
+    static bool getReciprocalArg(const MatExpr& e, MatExprArg& arg, double& alpha);
+    static void getArg(const MatExpr& e, MatExprArg& arg);
+    static void makeExpr(MatExpr& res, const MatExpr& op, const MatExprArg& a,
+                         const MatExprArg& b=MatExprArg());
+};
+
+static MatOp_Fused g_MatOp_Fused;
+
 class MatOp_GEMM : public MatOp
 {
 public:
@@ -333,26 +371,16 @@ void MatOp::add(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
     if( this == e2.op )
     {
         double alpha = 1, beta = 1;
-        Scalar s;
-        Mat m1, m2;
-        if( isAddEx(e1) && (!e1.b.data || e1.beta == 0) )
-        {
-            m1 = e1.a;
-            alpha = e1.alpha;
-            s = e1.s;
-        }
-        else
-            e1.op->assign(e1, m1);
+        Scalar s, s2;
+        MatExprArg m1, m2;
+        if( !MatOp_Fused::getAddExArg(e1, m1, alpha, s) )
+            MatOp_Fused::getArg(e1, m1);
 
-        if( isAddEx(e2) && (!e2.b.data || e2.beta == 0) )
-        {
-            m2 = e2.a;
-            beta = e2.alpha;
-            s += e2.s;
-        }
+        if( MatOp_Fused::getAddExArg(e2, m2, beta, s2) )
+            s += s2;
         else
-            e2.op->assign(e2, m2);
-        MatOp_AddEx::makeExpr(res, m1, m2, alpha, beta, s);
+            MatOp_Fused::getArg(e2, m2);
+        MatOp_Fused::makeExpr(res, MatExpr(&g_MatOp_AddEx, 0, Mat(), Mat(), Mat(), alpha, beta, s), m1, m2);
     }
     else
         e2.op->add(e1, e2, res);
@@ -361,9 +389,9 @@ void MatOp::add(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 
 void MatOp::add(const MatExpr& expr1, const Scalar& s, MatExpr& res) const
 {
-    Mat m1;
-    expr1.op->assign(expr1, m1);
-    MatOp_AddEx::makeExpr(res, m1, Mat(), 1, 0, s);
+    MatExprArg m1;
+    MatOp_Fused::getArg(expr1, m1);
+    MatOp_Fused::makeExpr(res, MatExpr(&g_MatOp_AddEx, 0, Mat(), Mat(), Mat(), 1, 0, s), m1);
 }
 
 
@@ -372,26 +400,19 @@ void MatOp::subtract(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
     if( this == e2.op )
     {
         double alpha = 1, beta = -1;
-        Scalar s;
-        Mat m1, m2;
-        if( isAddEx(e1) && (!e1.b.data || e1.beta == 0) )
-        {
-            m1 = e1.a;
-            alpha = e1.alpha;
-            s = e1.s;
-        }
-        else
-            e1.op->assign(e1, m1);
+        Scalar s, s2;
+        MatExprArg m1, m2;
+        if( !MatOp_Fused::getAddExArg(e1, m1, alpha, s) )
+            MatOp_Fused::getArg(e1, m1);
 
-        if( isAddEx(e2) && (!e2.b.data || e2.beta == 0) )
+        if( MatOp_Fused::getAddExArg(e2, m2, beta, s2) )
         {
-            m2 = e2.a;
-            beta = -e2.alpha;
-            s -= e2.s;
+            beta = -beta;
+            s -= s2;
         }
         else
-            e2.op->assign(e2, m2);
-        MatOp_AddEx::makeExpr(res, m1, m2, alpha, beta, s);
+            MatOp_Fused::getArg(e2, m2);
+        MatOp_Fused::makeExpr(res, MatExpr(&g_MatOp_AddEx, 0, Mat(), Mat(), Mat(), alpha, beta, s), m1, m2);
     }
     else
         e2.op->subtract(e1, e2, res);
@@ -400,9 +421,9 @@ void MatOp::subtract(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 
 void MatOp::subtract(const Scalar& s, const MatExpr& expr, MatExpr& res) const
 {
-    Mat m;
-    expr.op->assign(expr, m);
-    MatOp_AddEx::makeExpr(res, m, Mat(), -1, 0, s);
+    MatExprArg m;
+    MatOp_Fused::getArg(expr, m);
+    MatOp_Fused::makeExpr(res, MatExpr(&g_MatOp_AddEx, 0, Mat(), Mat(), Mat(), -1, 0, s), m);
 }
 
 
@@ -410,46 +431,38 @@ void MatOp::multiply(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double
 {
     if( this == e2.op )
     {
-        Mat m1, m2;
+        MatExprArg m1, m2;
+        double alpha = 1;
 
-        if( isReciprocal(e1) )
+        if( MatOp_Fused::getReciprocalArg(e1, m1, alpha) )
         {
-            if( isScaled(e2) )
-            {
-                scale *= e2.alpha;
-                m2 = e2.a;
-            }
+            double alpha2 = 1;
+            if( MatOp_Fused::getScaledArg(e2, m2, alpha2) )
+                scale *= alpha2;
             else
-                e2.op->assign(e2, m2);
+                MatOp_Fused::getArg(e2, m2);
 
-            MatOp_Bin::makeExpr(res, '/', m2, e1.a, scale/e1.alpha);
+            MatOp_Fused::makeExpr(res, MatExpr(&g_MatOp_Bin, '/', Mat(), Mat(), Mat(), scale/alpha, 1), m2, m1);
         }
         else
         {
             char op = '*';
-            if( isScaled(e1) )
-            {
-                m1 = e1.a;
-                scale *= e1.alpha;
-            }
+            if( MatOp_Fused::getScaledArg(e1, m1, alpha) )
+                scale *= alpha;
             else
-                e1.op->assign(e1, m1);
+                MatOp_Fused::getArg(e1, m1);
 
-            if( isScaled(e2) )
-            {
-                m2 = e2.a;
-                scale *= e2.alpha;
-            }
-            else if( isReciprocal(e2) )
+            if( MatOp_Fused::getScaledArg(e2, m2, alpha) )
+                scale *= alpha;
+            else if( MatOp_Fused::getReciprocalArg(e2, m2, alpha) )
             {
                 op = '/';
-                m2 = e2.a;
-                scale /= e2.alpha;
+                scale /= alpha;
             }
             else
-                e2.op->assign(e2, m2);
+                MatOp_Fused::getArg(e2, m2);
 
-            MatOp_Bin::makeExpr(res, op, m1, m2, scale);
+            MatOp_Fused::makeExpr(res, MatExpr(&g_MatOp_Bin, op, Mat(), Mat(), Mat(), scale, 1), m1, m2);
         }
     }
     else
@@ -459,9 +472,9 @@ void MatOp::multiply(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double
 
 void MatOp::multiply(const MatExpr& expr, double s, MatExpr& res) const
 {
-    Mat m;
-    expr.op->assign(expr, m);
-    MatOp_AddEx::makeExpr(res, m, Mat(), s, 0);
+    MatExprArg m;
+    MatOp_Fused::getArg(expr, m);
+    MatOp_Fused::makeExpr(res, MatExpr(&g_MatOp_AddEx, 0, Mat(), Mat(), Mat(), s, 0), m);
 }
 
 
@@ -469,35 +482,32 @@ void MatOp::divide(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double sc
 {
     if( this == e2.op )
     {
-        if( isReciprocal(e1) && isReciprocal(e2) )
-            MatOp_Bin::makeExpr(res, '/', e2.a, e1.a, e1.alpha/e2.alpha);
+        MatExprArg r1, r2;
+        double alpha1 = 1, alpha2 = 1;
+
+        if( MatOp_Fused::getReciprocalArg(e1, r1, alpha1) && MatOp_Fused::getReciprocalArg(e2, r2, alpha2) )
+            MatOp_Fused::makeExpr(res, MatExpr(&g_MatOp_Bin, '/', Mat(), Mat(), Mat(), alpha1/alpha2, 1), r2, r1);
         else
         {
-            Mat m1, m2;
+            MatExprArg m1, m2;
+            double alpha = 1;
             char op = '/';
 
-            if( isScaled(e1) )
-            {
-                m1 = e1.a;
-                scale *= e1.alpha;
-            }
+            if( MatOp_Fused::getScaledArg(e1, m1, alpha) )
+                scale *= alpha;
             else
-                e1.op->assign(e1, m1);
+                MatOp_Fused::getArg(e1, m1);
 
-            if( isScaled(e2) )
+            if( MatOp_Fused::getScaledArg(e2, m2, alpha) )
+                scale /= alpha;
+            else if( MatOp_Fused::getReciprocalArg(e2, m2, alpha) )
             {
-                m2 = e2.a;
-                scale /= e2.alpha;
-            }
-            else if( isReciprocal(e2) )
-            {
-                m2 = e2.a;
-                scale /= e2.alpha;
+                scale /= alpha;
                 op = '*';
             }
             else
-                e2.op->assign(e2, m2);
-            MatOp_Bin::makeExpr(res, op, m1, m2, scale);
+                MatOp_Fused::getArg(e2, m2);
+            MatOp_Fused::makeExpr(res, MatExpr(&g_MatOp_Bin, op, Mat(), Mat(), Mat(), scale, 1), m1, m2);
         }
     }
     else
@@ -507,17 +517,17 @@ void MatOp::divide(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double sc
 
 void MatOp::divide(double s, const MatExpr& expr, MatExpr& res) const
 {
-    Mat m;
-    expr.op->assign(expr, m);
-    MatOp_Bin::makeExpr(res, '/', m, Mat(), s);
+    MatExprArg m;
+    MatOp_Fused::getArg(expr, m);
+    MatOp_Fused::makeExpr(res, MatExpr(&g_MatOp_Bin, '/', Mat(), Mat(), Mat(), s, 0), m);
 }
 
 
 void MatOp::abs(const MatExpr& expr, MatExpr& res) const
 {
-    Mat m;
-    expr.op->assign(expr, m);
-    MatOp_Bin::makeExpr(res, 'a', m, Mat());
+    MatExprArg m;
+    MatOp_Fused::getArg(expr, m);
+    MatOp_Fused::makeExpr(res, MatExpr(&g_MatOp_Bin, 'a', Mat(), Mat(), Mat(), 1, 0), m);
 }
 
 
@@ -1033,6 +1043,66 @@ MatExpr operator > (double s, const Mat& a)
     return e;
 }
 
+static void compareExpr(MatExpr& res, int cmpop, const MatExpr& e1, const MatExpr& e2)
+{
+    MatExprArg m1, m2;
+    MatOp_Fused::getArg(e1, m1);
+    MatOp_Fused::getArg(e2, m2);
+    MatOp_Fused::makeExpr(res, MatExpr(&g_MatOp_Cmp, cmpop, Mat(), Mat(), Mat(), 1, 1), m1, m2);
+}
+
+static void compareExpr(MatExpr& res, int cmpop, const MatExpr& e, double s)
+{
+    MatExprArg m;
+    MatOp_Fused::getArg(e, m);
+    MatOp_Fused::makeExpr(res, MatExpr(&g_MatOp_Cmp, cmpop, Mat(), Mat(), Mat(), s, 1), m);
+}
+
+#define CV_MATEXPR_CMP_OPERATORS(op, cmpop, rcmpop) \
+MatExpr operator op (const MatExpr& e, const Mat& m) \
+{ \
+    MatExpr en; \
+    compareExpr(en, cmpop, e, MatExpr(m)); \
+    return en; \
+} \
+ \
+MatExpr operator op (const Mat& m, const MatExpr& e) \
+{ \
+    MatExpr en; \
+    compareExpr(en, cmpop, MatExpr(m), e); \
+    return en; \
+} \
+ \
+MatExpr operator op (const MatExpr& e, double s) \
+{ \
+    MatExpr en; \
+    compareExpr(en, cmpop, e, s); \
+    return en; \
+} \
+ \
+MatExpr operator op (double s, const MatExpr& e) \
+{ \
+    MatExpr en; \
+    compareExpr(en, rcmpop, e, s); \
+    return en; \
+} \
+ \
+MatExpr operator op (const MatExpr& e1, const MatExpr& e2) \
+{ \
+    MatExpr en; \
+    compareExpr(en, cmpop, e1, e2); \
+    return en; \
+}
+
+CV_MATEXPR_CMP_OPERATORS(<, CV_CMP_LT, CV_CMP_GT)
+CV_MATEXPR_CMP_OPERATORS(<=, CV_CMP_LE, CV_CMP_GE)
+CV_MATEXPR_CMP_OPERATORS(==, CV_CMP_EQ, CV_CMP_EQ)
+CV_MATEXPR_CMP_OPERATORS(!=, CV_CMP_NE, CV_CMP_NE)
+CV_MATEXPR_CMP_OPERATORS(>=, CV_CMP_GE, CV_CMP_LE)
+CV_MATEXPR_CMP_OPERATORS(>, CV_CMP_GT, CV_CMP_LT)
+
+#undef CV_MATEXPR_CMP_OPERATORS
+
 MatExpr min(const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -1590,6 +1660,970 @@ inline void MatOp_Initializer::makeExpr(MatExpr& res, int method, int ndims, con
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/*
+  Fused evaluation of element-wise expressions.
+
+  When an element-wise expression (MatOp_AddEx, MatOp_Bin or MatOp_Cmp) becomes an operand
+  of another one, it is not evaluated into a temporary matrix; instead, both are merged into
+  a tree of MatExprNode's, e.g. abs(a*alpha + b*beta - c) > t makes a single tree. On assignment
+  the tree is compiled into a small stack program that is run over the matrices block by block,
+  so that every input is read and the result is written only once.
+
+  The operations follow the corresponding functions (cv::add, cv::scaleAdd, cv::compare etc.),
+  including the saturation of the intermediate integer results. The operations that can not be
+  reproduced exactly this way (multi-channel and 32s data, bitwise operations, scaled integer
+  arithmetic, 64f division) are not fused and are evaluated as before.
+*/
+
+enum
+{
+    FUSED_LEAF=0,
+    // binary operations, dst = x op y
+    FUSED_ADD, FUSED_SUB, FUSED_SCALE_ADD, FUSED_WEIGHTED, FUSED_MUL, FUSED_DIV,
+    FUSED_ABSDIFF, FUSED_MIN, FUSED_MAX, FUSED_CMP,
+    // unary operations, dst = op x
+    FUSED_SCALE, FUSED_RECIP, FUSED_ABSDIFF_S, FUSED_MIN_S, FUSED_MAX_S, FUSED_CMP_S
+};
+
+// the larger trees are split and evaluated in several passes;
+// the stack of the program is FUSED_BLOCK_SIZE bytes per level
+enum { FUSED_MAX_HEIGHT = 8, FUSED_BLOCK_SIZE = 4096 };
+
+struct MatExprNode
+{
+    MatExprNode() : op(FUSED_LEAF), cmpop(0), type(-1), height(0), alpha(0), beta(0), gamma(0), swapped(false) {}
+
+    int op, cmpop, type, height;
+    // the operation parameters, already converted the way the corresponding function does it
+    double alpha, beta, gamma;
+    bool swapped;            // the operation is evaluated as (b op a)
+    Size size;
+    Mat m;                   // the leaf matrix
+    Ptr<MatExprNode> a, b;   // the operands
+    MatExpr e;               // the source operation, without the operands
+};
+
+static Ptr<MatExprNode> makeFusedLeaf(const Mat& m)
+{
+    Ptr<MatExprNode> n;
+    if( m.data && m.dims <= 2 && m.channels() == 1 )
+    {
+        n = makePtr<MatExprNode>();
+        n->m = m;
+        n->type = m.type();
+        n->size = m.size();
+    }
+    return n;
+}
+
+// the functions working on 32f data use float scale factors and scalars
+static inline double fusedCoeff(double v, int depth)
+{
+    return depth < CV_32F ? (double)saturate_cast<int>(v) : depth == CV_32F ? (double)(float)v : v;
+}
+
+static double fusedSaturate(double v, int depth)
+{
+    switch( depth )
+    {
+    case CV_8U: return saturate_cast<uchar>(v);
+    case CV_8S: return saturate_cast<schar>(v);
+    case CV_16U: return saturate_cast<ushort>(v);
+    case CV_16S: return saturate_cast<short>(v);
+    case CV_32F: return saturate_cast<float>(v);
+    }
+    return v;
+}
+
+// same as in cv::compare, integer data is compared with the integer threshold
+static double fusedThreshold(double v, int cmpop, int depth)
+{
+    if( depth >= CV_32F )
+        return fusedCoeff(v, depth);
+
+    double minval = depth == CV_8S ? SCHAR_MIN : depth == CV_16S ? SHRT_MIN : 0;
+    double maxval = depth == CV_8U ? UCHAR_MAX : depth == CV_8S ? SCHAR_MAX :
+                    depth == CV_16U ? USHRT_MAX : SHRT_MAX;
+    v = std::min(std::max(v, minval - 1), maxval + 1);
+    if( v != cvRound(v) )
+        v = cmpop == CMP_LT || cmpop == CMP_GE ? cvCeil(v) :
+            cmpop == CMP_LE || cmpop == CMP_GT ? cvFloor(v) : minval - 1;
+    return v;
+}
+
+static Ptr<MatExprNode> makeFusedNode(const MatExpr& e, const Ptr<MatExprNode>& a,
+                                      const Ptr<MatExprNode>& b)
+{
+    Ptr<MatExprNode> n;
+    if( !a || (b && (b->type != a->type || b->size != a->size)) )
+        return n;
+
+    int type = a->type, depth = CV_MAT_DEPTH(type);
+    int height = std::max(a->height, b ? b->height : 0) + 1;
+    if( CV_MAT_CN(type) != 1 || depth == CV_32S || height > FUSED_MAX_HEIGHT )
+        return n;
+
+    bool isInt = depth < CV_32F, swapped = false;
+    int op = -1, cmpop = 0;
+    double alpha = 1, beta = 1, gamma = 0;
+
+    if( isAddEx(e) && e.s.isReal() )
+    {
+        double s0 = e.s[0];
+        if( b )
+        {
+            if( s0 == 0 && e.alpha == 1 && e.beta == 1 )
+                op = FUSED_ADD;
+            else if( s0 == 0 && e.alpha == 1 && e.beta == -1 )
+                op = FUSED_SUB;
+            else if( s0 == 0 && e.alpha == -1 && e.beta == 1 )
+                op = FUSED_SUB, swapped = true;
+            else if( isInt )
+                ;
+            else if( s0 == 0 && e.alpha == 1 )
+                op = FUSED_SCALE_ADD, alpha = fusedCoeff(e.beta, depth), swapped = true;
+            else if( s0 == 0 && e.beta == 1 )
+                op = FUSED_SCALE_ADD, alpha = fusedCoeff(e.alpha, depth);
+            else
+                op = FUSED_WEIGHTED, alpha = e.alpha, beta = e.beta, gamma = s0;
+        }
+        else if( !isInt || fabs(e.alpha) == 1 )
+            op = FUSED_SCALE, alpha = isInt ? e.alpha : fusedCoeff(e.alpha, depth), gamma = fusedCoeff(s0, depth);
+    }
+    else if( e.op == &g_MatOp_Bin )
+    {
+        if( e.flags == '*' && b && (!isInt || e.alpha == 1) )
+            op = FUSED_MUL, alpha = fusedCoeff(e.alpha, depth);
+        // cv::divide computes the 64f quotients through the grouped reciprocals,
+        // which differ from the plain division by a few ULP's
+        else if( e.flags == '/' && depth == CV_32F )
+            op = b ? FUSED_DIV : FUSED_RECIP, alpha = e.alpha;
+        else if( e.flags == 'a' )
+            op = b ? FUSED_ABSDIFF : FUSED_ABSDIFF_S, gamma = fusedCoeff(e.s[0], depth);
+        else if( e.flags == 'm' || e.flags == 'M' )
+        {
+            op = e.flags == 'm' ? (b ? FUSED_MIN : FUSED_MIN_S) : (b ? FUSED_MAX : FUSED_MAX_S);
+            gamma = fusedSaturate(e.s[0], depth);
+        }
+    }
+    else if( isCmp(e) )
+    {
+        cmpop = e.flags;
+        if( !b )
+            op = FUSED_CMP_S, gamma = fusedThreshold(e.alpha, cmpop, depth);
+        else
+        {
+            op = FUSED_CMP;
+            if( cmpop == CMP_LT || cmpop == CMP_LE )
+            {
+                swapped = true;
+                cmpop = cmpop == CMP_LT ? CMP_GT : CMP_GE;
+            }
+        }
+        type = CV_8U;
+    }
+
+    if( op < 0 )
+        return n;
+
+    n = makePtr<MatExprNode>();
+    n->op = op;
+    n->cmpop = cmpop;
+    n->type = type;
+    n->height = height;
+    n->alpha = alpha;
+    n->beta = beta;
+    n->gamma = gamma;
+    n->swapped = swapped;
+    n->size = a->size;
+    n->a = a;
+    n->b = b;
+    n->e = e;
+    n->e.a = n->e.b = n->e.c = Mat();
+    return n;
+}
+
+struct FusedInstr
+{
+    int op, cmpop, depth, idx;
+    double alpha, beta, gamma;
+    bool normalize;
+};
+
+// appends the instructions evaluating the node; returns the required stack depth
+static int compileFused(const MatExprNode* n, std::vector<FusedInstr>& prog, std::vector<Mat>& leaves)
+{
+    FusedInstr instr = { n->op, n->cmpop, CV_MAT_DEPTH(n->type), -1, n->alpha, n->beta, n->gamma, false };
+    int stackDepth = 1;
+
+    if( n->op == FUSED_LEAF )
+    {
+        instr.idx = (int)leaves.size();
+        leaves.push_back(n->m);
+    }
+    else
+    {
+        const MatExprNode *x = n->a, *y = n->b;
+        if( n->swapped )
+            std::swap(x, y);
+        stackDepth = compileFused(x, prog, leaves);
+        if( y )
+            stackDepth = std::max(stackDepth, compileFused(y, prog, leaves) + 1);
+    }
+    prog.push_back(instr);
+    return stackDepth;
+}
+
+struct FusedAdd
+{
+    template<typename T> T operator()(T x, T y) const { return x + y; }
+#if CV_SSE2
+    __m128 operator()(__m128 x, __m128 y) const { return _mm_add_ps(x, y); }
+#endif
+};
+
+struct FusedSub
+{
+    template<typename T> T operator()(T x, T y) const { return x - y; }
+#if CV_SSE2
+    __m128 operator()(__m128 x, __m128 y) const { return _mm_sub_ps(x, y); }
+#endif
+};
+
+struct FusedAbsDiff
+{
+    template<typename T> T operator()(T x, T y) const { return std::abs(x - y); }
+#if CV_SSE2
+    __m128 operator()(__m128 x, __m128 y) const { return _mm_andnot_ps(_mm_set1_ps(-0.f), _mm_sub_ps(x, y)); }
+#endif
+};
+
+struct FusedMin
+{
+    template<typename T> T operator()(T x, T y) const { return std::min(x, y); }
+#if CV_SSE2
+    __m128 operator()(__m128 x, __m128 y) const { return _mm_min_ps(x, y); }
+#endif
+};
+
+struct FusedMax
+{
+    template<typename T> T operator()(T x, T y) const { return std::max(x, y); }
+#if CV_SSE2
+    __m128 operator()(__m128 x, __m128 y) const { return _mm_max_ps(x, y); }
+#endif
+};
+
+struct FusedCmpGT
+{
+    template<typename T> T operator()(T x, T y) const { return x > y ? (T)255 : (T)0; }
+#if CV_SSE2
+    __m128 operator()(__m128 x, __m128 y) const { return _mm_and_ps(_mm_cmpgt_ps(x, y), _mm_set1_ps(255.f)); }
+#endif
+};
+
+struct FusedCmpGE
+{
+    template<typename T> T operator()(T x, T y) const { return x >= y ? (T)255 : (T)0; }
+#if CV_SSE2
+    __m128 operator()(__m128 x, __m128 y) const { return _mm_and_ps(_mm_cmpge_ps(x, y), _mm_set1_ps(255.f)); }
+#endif
+};
+
+struct FusedCmpEQ
+{
+    template<typename T> T operator()(T x, T y) const { return x == y ? (T)255 : (T)0; }
+#if CV_SSE2
+    __m128 operator()(__m128 x, __m128 y) const { return _mm_and_ps(_mm_cmpeq_ps(x, y), _mm_set1_ps(255.f)); }
+#endif
+};
+
+template<typename WT> struct FusedScaleAdd
+{
+    FusedScaleAdd(double _alpha) : alpha((WT)_alpha) {}
+    WT operator()(WT x, WT y) const { return x*alpha + y; }
+#if CV_SSE2
+    __m128 operator()(__m128 x, __m128 y) const { return _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps((float)alpha)), y); }
+#endif
+    WT alpha;
+};
+
+template<typename WT> struct FusedMul
+{
+    FusedMul(double _alpha) : alpha((WT)_alpha) {}
+    WT operator()(WT x, WT y) const { return alpha*x*y; }
+#if CV_SSE2
+    __m128 operator()(__m128 x, __m128 y) const { return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps((float)alpha), x), y); }
+#endif
+    WT alpha;
+};
+
+template<typename WT> struct FusedScale
+{
+    FusedScale(double _alpha, double _gamma) : alpha((WT)_alpha), gamma((WT)_gamma) {}
+    WT operator()(WT x) const { return x*alpha + gamma; }
+#if CV_SSE2
+    __m128 operator()(__m128 x) const { return _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps((float)alpha)), _mm_set1_ps((float)gamma)); }
+#endif
+    WT alpha, gamma;
+};
+
+// the operations below are computed in double precision, as in the corresponding functions
+
+template<typename WT> struct FusedWeighted
+{
+    FusedWeighted(double _alpha, double _beta, double _gamma) : alpha(_alpha), beta(_beta), gamma(_gamma) {}
+    WT operator()(WT x, WT y) const { return (WT)(x*alpha + y*beta + gamma); }
+#if CV_SSE2
+    __m128d op(__m128d x, __m128d y) const
+    {
+        return _mm_add_pd(_mm_add_pd(_mm_mul_pd(x, _mm_set1_pd(alpha)), _mm_mul_pd(y, _mm_set1_pd(beta))),
+                          _mm_set1_pd(gamma));
+    }
+    __m128 operator()(__m128 x, __m128 y) const
+    {
+        __m128d lo = op(_mm_cvtps_pd(x), _mm_cvtps_pd(y));
+        __m128d hi = op(_mm_cvtps_pd(_mm_movehl_ps(x, x)), _mm_cvtps_pd(_mm_movehl_ps(y, y)));
+        return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+    }
+#endif
+    double alpha, beta, gamma;
+};
+
+template<typename WT> struct FusedDiv
+{
+    FusedDiv(double _scale) : scale(_scale) {}
+    WT operator()(WT x, WT y) const { return y != 0 ? (WT)(x*scale/y) : (WT)0; }
+#if CV_SSE2
+    __m128d op(__m128d x, __m128d y) const
+    {
+        __m128d z = _mm_setzero_pd();
+        return _mm_andnot_pd(_mm_cmpeq_pd(y, z), _mm_div_pd(_mm_mul_pd(x, _mm_set1_pd(scale)), y));
+    }
+    __m128 operator()(__m128 x, __m128 y) const
+    {
+        __m128d lo = op(_mm_cvtps_pd(x), _mm_cvtps_pd(y));
+        __m128d hi = op(_mm_cvtps_pd(_mm_movehl_ps(x, x)), _mm_cvtps_pd(_mm_movehl_ps(y, y)));
+        return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+    }
+#endif
+    double scale;
+};
+
+template<typename WT> struct FusedRecip
+{
+    FusedRecip(double _scale) : scale(_scale) {}
+    WT operator()(WT x) const { return x != 0 ? (WT)(scale/x) : (WT)0; }
+#if CV_SSE2
+    __m128d op(__m128d x) const
+    {
+        return _mm_andnot_pd(_mm_cmpeq_pd(x, _mm_setzero_pd()), _mm_div_pd(_mm_set1_pd(scale), x));
+    }
+    __m128 operator()(__m128 x) const
+    {
+        __m128d lo = op(_mm_cvtps_pd(x)), hi = op(_mm_cvtps_pd(_mm_movehl_ps(x, x)));
+        return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+    }
+#endif
+    double scale;
+};
+
+// makes the unary operation (x op s) or (s op x) from the binary one
+template<class Op, typename WT> struct FusedBind2nd
+{
+    FusedBind2nd(double _s) : s((WT)_s) {}
+    WT operator()(WT x) const { return op(x, s); }
+#if CV_SSE2
+    __m128 operator()(__m128 x) const { return op(x, _mm_set1_ps((float)s)); }
+#endif
+    Op op;
+    WT s;
+};
+
+template<class Op, typename WT> struct FusedBind1st
+{
+    FusedBind1st(double _s) : s((WT)_s) {}
+    WT operator()(WT x) const { return op(s, x); }
+#if CV_SSE2
+    __m128 operator()(__m128 x) const { return op(_mm_set1_ps((float)s), x); }
+#endif
+    Op op;
+    WT s;
+};
+
+template<class Op> static int vFusedLoop(float* x, const float* y, int n, const Op& op)
+{
+    int i = 0;
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        for( ; i <= n - 8; i += 8 )
+        {
+            __m128 r0 = op(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i));
+            __m128 r1 = op(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(y + i + 4));
+            _mm_storeu_ps(x + i, r0);
+            _mm_storeu_ps(x + i + 4, r1);
+        }
+    }
+#else
+    (void)x; (void)y; (void)n; (void)op;
+#endif
+    return i;
+}
+
+template<class Op> static int vFusedLoop(float* x, int n, const Op& op)
+{
+    int i = 0;
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        for( ; i <= n - 8; i += 8 )
+        {
+            __m128 r0 = op(_mm_loadu_ps(x + i));
+            __m128 r1 = op(_mm_loadu_ps(x + i + 4));
+            _mm_storeu_ps(x + i, r0);
+            _mm_storeu_ps(x + i + 4, r1);
+        }
+    }
+#else
+    (void)x; (void)n; (void)op;
+#endif
+    return i;
+}
+
+template<class Op> static int vFusedLoop(double*, const double*, int, const Op&) { return 0; }
+template<class Op> static int vFusedLoop(double*, int, const Op&) { return 0; }
+
+template<typename WT, class Op> static void fusedLoop(WT* x, const WT* y, int n, const Op& op)
+{
+    for( int i = vFusedLoop(x, y, n, op); i < n; i++ )
+        x[i] = op(x[i], y[i]);
+}
+
+template<typename WT, class Op> static void fusedLoop(WT* x, int n, const Op& op)
+{
+    for( int i = vFusedLoop(x, n, op); i < n; i++ )
+        x[i] = op(x[i]);
+}
+
+template<typename WT> static void binaryFused(const FusedInstr& instr, WT* x, const WT* y, int n)
+{
+    switch( instr.op )
+    {
+    case FUSED_ADD: fusedLoop(x, y, n, FusedAdd()); break;
+    case FUSED_SUB: fusedLoop(x, y, n, FusedSub()); break;
+    case FUSED_SCALE_ADD: fusedLoop(x, y, n, FusedScaleAdd<WT>(instr.alpha)); break;
+    case FUSED_WEIGHTED: fusedLoop(x, y, n, FusedWeighted<WT>(instr.alpha, instr.beta, instr.gamma)); break;
+    case FUSED_MUL: fusedLoop(x, y, n, FusedMul<WT>(instr.alpha)); break;
+    case FUSED_DIV: fusedLoop(x, y, n, FusedDiv<WT>(instr.alpha)); break;
+    case FUSED_ABSDIFF: fusedLoop(x, y, n, FusedAbsDiff()); break;
+    case FUSED_MIN: fusedLoop(x, y, n, FusedMin()); break;
+    case FUSED_MAX: fusedLoop(x, y, n, FusedMax()); break;
+    case FUSED_CMP:
+        if( instr.cmpop == CMP_GT )
+            fusedLoop(x, y, n, FusedCmpGT());
+        else if( instr.cmpop == CMP_GE )
+            fusedLoop(x, y, n, FusedCmpGE());
+        else
+        {
+            fusedLoop(x, y, n, FusedCmpEQ());
+            if( instr.cmpop == CMP_NE )
+                fusedLoop(x, n, FusedScale<WT>(-1, 255));
+        }
+        break;
+    default:
+        CV_Error(CV_StsError, "Unknown operation");
+    }
+}
+
+template<typename WT> static void unaryFused(const FusedInstr& instr, WT* x, int n)
+{
+    switch( instr.op )
+    {
+    case FUSED_SCALE: fusedLoop(x, n, FusedScale<WT>(instr.alpha, instr.gamma)); break;
+    case FUSED_RECIP: fusedLoop(x, n, FusedRecip<WT>(instr.alpha)); break;
+    case FUSED_ABSDIFF_S: fusedLoop(x, n, FusedBind2nd<FusedAbsDiff, WT>(instr.gamma)); break;
+    case FUSED_MIN_S: fusedLoop(x, n, FusedBind2nd<FusedMin, WT>(instr.gamma)); break;
+    case FUSED_MAX_S: fusedLoop(x, n, FusedBind2nd<FusedMax, WT>(instr.gamma)); break;
+    case FUSED_CMP_S:
+        if( instr.cmpop == CMP_GT )
+            fusedLoop(x, n, FusedBind2nd<FusedCmpGT, WT>(instr.gamma));
+        else if( instr.cmpop == CMP_GE )
+            fusedLoop(x, n, FusedBind2nd<FusedCmpGE, WT>(instr.gamma));
+        else if( instr.cmpop == CMP_LT )
+            fusedLoop(x, n, FusedBind1st<FusedCmpGT, WT>(instr.gamma));
+        else if( instr.cmpop == CMP_LE )
+            fusedLoop(x, n, FusedBind1st<FusedCmpGE, WT>(instr.gamma));
+        else
+        {
+            fusedLoop(x, n, FusedBind2nd<FusedCmpEQ, WT>(instr.gamma));
+            if( instr.cmpop == CMP_NE )
+                fusedLoop(x, n, FusedScale<WT>(-1, 255));
+        }
+        break;
+    default:
+        CV_Error(CV_StsError, "Unknown operation");
+    }
+}
+
+// brings the intermediate result to the node type: saturates the integers
+// and rounds 32f values computed in double precision
+template<typename WT> static void normalizeFused(WT* x, int n, int depth)
+{
+    if( depth == CV_32F )
+    {
+        for( int i = 0; i < n; i++ )
+            x[i] = (WT)(float)x[i];
+        return;
+    }
+
+    WT minval = (WT)(depth == CV_8S ? SCHAR_MIN : depth == CV_16S ? SHRT_MIN : 0);
+    WT maxval = (WT)(depth == CV_8U ? UCHAR_MAX : depth == CV_8S ? SCHAR_MAX :
+                     depth == CV_16U ? USHRT_MAX : SHRT_MAX);
+    fusedLoop(x, n, FusedBind2nd<FusedMin, WT>(maxval));
+    fusedLoop(x, n, FusedBind2nd<FusedMax, WT>(minval));
+}
+
+template<typename T, typename WT> static void loadFused_(const uchar* _src, WT* dst, int n)
+{
+    const T* src = (const T*)_src;
+    for( int i = 0; i < n; i++ )
+        dst[i] = (WT)src[i];
+}
+
+#if CV_SSE2
+template<> void loadFused_<uchar, float>(const uchar* src, float* dst, int n)
+{
+    int i = 0;
+    if( USE_SSE2 )
+    {
+        __m128i z = _mm_setzero_si128();
+        for( ; i <= n - 16; i += 16 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            __m128i v0 = _mm_unpacklo_epi8(v, z), v1 = _mm_unpackhi_epi8(v, z);
+            _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_unpacklo_epi16(v0, z)));
+            _mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(v0, z)));
+            _mm_storeu_ps(dst + i + 8, _mm_cvtepi32_ps(_mm_unpacklo_epi16(v1, z)));
+            _mm_storeu_ps(dst + i + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(v1, z)));
+        }
+    }
+    for( ; i < n; i++ )
+        dst[i] = (float)src[i];
+}
+#endif
+
+template<typename WT> static void loadFused(const uchar* src, int depth, WT* dst, int n)
+{
+    if( depth == DataType<WT>::depth )
+    {
+        memcpy(dst, src, n*sizeof(WT));
+        return;
+    }
+
+    switch( depth )
+    {
+    case CV_8U: loadFused_<uchar, WT>(src, dst, n); break;
+    case CV_8S: loadFused_<schar, WT>(src, dst, n); break;
+    case CV_16U: loadFused_<ushort, WT>(src, dst, n); break;
+    case CV_16S: loadFused_<short, WT>(src, dst, n); break;
+    case CV_32F: loadFused_<float, WT>(src, dst, n); break;
+    case CV_64F: loadFused_<double, WT>(src, dst, n); break;
+    default: CV_Error(CV_StsUnsupportedFormat, "");
+    }
+}
+
+template<typename T, typename WT> static void storeFused_(const WT* src, uchar* _dst, int n)
+{
+    T* dst = (T*)_dst;
+    for( int i = 0; i < n; i++ )
+        dst[i] = saturate_cast<T>(src[i]);
+}
+
+#if CV_SSE2
+template<> void storeFused_<uchar, float>(const float* src, uchar* dst, int n)
+{
+    int i = 0;
+    if( USE_SSE2 )
+    {
+        for( ; i <= n - 16; i += 16 )
+        {
+            __m128i v0 = _mm_packs_epi32(_mm_cvtps_epi32(_mm_loadu_ps(src + i)),
+                                         _mm_cvtps_epi32(_mm_loadu_ps(src + i + 4)));
+            __m128i v1 = _mm_packs_epi32(_mm_cvtps_epi32(_mm_loadu_ps(src + i + 8)),
+                                         _mm_cvtps_epi32(_mm_loadu_ps(src + i + 12)));
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(v0, v1));
+        }
+    }
+    for( ; i < n; i++ )
+        dst[i] = saturate_cast<uchar>(src[i]);
+}
+#endif
+
+template<typename WT> static void storeFused(const WT* src, uchar* dst, int depth, int n)
+{
+    if( depth == DataType<WT>::depth )
+    {
+        memcpy(dst, src, n*sizeof(WT));
+        return;
+    }
+
+    switch( depth )
+    {
+    case CV_8U: storeFused_<uchar, WT>(src, dst, n); break;
+    case CV_8S: storeFused_<schar, WT>(src, dst, n); break;
+    case CV_16U: storeFused_<ushort, WT>(src, dst, n); break;
+    case CV_16S: storeFused_<short, WT>(src, dst, n); break;
+    case CV_32S: storeFused_<int, WT>(src, dst, n); break;
+    case CV_32F: storeFused_<float, WT>(src, dst, n); break;
+    case CV_64F: storeFused_<double, WT>(src, dst, n); break;
+    default: CV_Error(CV_StsUnsupportedFormat, "");
+    }
+}
+
+template<typename WT> class FusedExprInvoker : public ParallelLoopBody
+{
+public:
+    FusedExprInvoker(const std::vector<FusedInstr>& _prog, const std::vector<Mat>& _leaves,
+                     const Mat& _dst, int _stackDepth, int _blockSize)
+        : prog(_prog), leaves(_leaves), dst(_dst), stackDepth(_stackDepth), blockSize(_blockSize)
+    {
+        nblocks = (dst.cols + blockSize - 1)/blockSize;
+    }
+
+    // the range is measured in blocks, nblocks per each row
+    void operator()(const Range& range) const
+    {
+        AutoBuffer<WT> _buf(blockSize*stackDepth);
+        WT* buf = _buf;
+        int wdepth = DataType<WT>::depth;
+        size_t nprog = prog.size();
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            int y = i / nblocks, x = (i - y*nblocks)*blockSize;
+            int n = std::min(blockSize, dst.cols - x), sp = 0;
+
+            for( size_t k = 0; k < nprog; k++ )
+            {
+                const FusedInstr* instr = &prog[k];
+                if( instr->op == FUSED_LEAF )
+                {
+                    const Mat& src = leaves[instr->idx];
+                    const uchar* sptr = src.ptr(y) + x*src.elemSize();
+                    // the second operand of the next binary operation is read in place
+                    if( src.depth() == wdepth && sp > 0 && k + 1 < nprog &&
+                        prog[k+1].op != FUSED_LEAF && prog[k+1].op < FUSED_SCALE )
+                    {
+                        instr = &prog[++k];
+                        WT* d = buf + blockSize*(sp - 1);
+                        binaryFused(*instr, d, (const WT*)sptr, n);
+                        if( instr->normalize )
+                            normalizeFused(d, n, instr->depth);
+                    }
+                    else
+                        loadFused(sptr, src.depth(), buf + blockSize*sp++, n);
+                    continue;
+                }
+
+                WT* d;
+                if( instr->op < FUSED_SCALE )
+                {
+                    d = buf + blockSize*(sp - 2);
+                    binaryFused(*instr, d, d + blockSize, n);
+                    sp--;
+                }
+                else
+                {
+                    d = buf + blockSize*(sp - 1);
+                    unaryFused(*instr, d, n);
+                }
+                if( instr->normalize )
+                    normalizeFused(d, n, instr->depth);
+            }
+            storeFused(buf, (uchar*)dst.ptr(y) + x*dst.elemSize(), dst.depth(), n);
+        }
+    }
+
+    int total() const { return dst.rows*nblocks; }
+
+private:
+    const std::vector<FusedInstr>& prog;
+    const std::vector<Mat>& leaves;
+    Mat dst;
+    int stackDepth, blockSize, nblocks;
+};
+
+template<typename WT> static void runFused(const std::vector<FusedInstr>& prog, const std::vector<Mat>& leaves,
+                                           const Mat& dst, int stackDepth)
+{
+    FusedExprInvoker<WT> invoker(prog, leaves, dst, stackDepth, (int)(FUSED_BLOCK_SIZE/sizeof(WT)));
+    Range range(0, invoker.total());
+    double total = (double)dst.total();
+
+    if( total >= (1 << 16) )
+        parallel_for_(range, invoker, total/(1 << 16));
+    else
+        invoker(range);
+}
+
+static void evaluateFused(const MatExprNode* root, Mat& m, int _type)
+{
+    std::vector<FusedInstr> prog;
+    std::vector<Mat> leaves;
+    int stackDepth = compileFused(root, prog, leaves);
+    int rdepth = CV_MAT_DEPTH(root->type), ddepth = _type < 0 ? rdepth : CV_MAT_DEPTH(_type);
+    bool useDouble = ddepth == CV_64F;
+
+    for( size_t i = 0; i < leaves.size(); i++ )
+        useDouble = useDouble || leaves[i].depth() == CV_64F;
+
+    for( size_t i = 0; i < prog.size(); i++ )
+    {
+        FusedInstr& instr = prog[i];
+        instr.normalize = instr.op != FUSED_LEAF && (instr.depth < CV_32F ?
+            instr.op != FUSED_CMP && instr.op != FUSED_CMP_S : instr.depth == CV_32F && useDouble);
+    }
+
+    const MatExpr& e = root->e;
+    if( ddepth != rdepth && isAddEx(e) && !e.b.data && (m.data || fabs(e.alpha) != 1) )
+    {
+        // as MatOp_AddEx::assign, convert the operand with the scale and the shift at once
+        FusedInstr& instr = prog.back();
+        bool useFloat = rdepth < CV_64F && ddepth < CV_64F;
+        instr.alpha = useFloat ? (float)e.alpha : e.alpha;
+        instr.gamma = useFloat ? (float)e.s[0] : e.s[0];
+        instr.normalize = false;
+    }
+
+    m.create(root->size, CV_MAKETYPE(ddepth, 1));
+    Mat dst = m;
+    bool continuous = dst.isContinuous();
+    for( size_t i = 0; i < leaves.size(); i++ )
+        continuous = continuous && leaves[i].isContinuous();
+    if( continuous )
+    {
+        dst = dst.reshape(1, 1);
+        for( size_t i = 0; i < leaves.size(); i++ )
+            leaves[i] = leaves[i].reshape(1, 1);
+    }
+
+    if( useDouble )
+        runFused<double>(prog, leaves, dst, stackDepth);
+    else
+        runFused<float>(prog, leaves, dst, stackDepth);
+}
+
+void MatOp_Fused::assign(const MatExpr& e, Mat& m, int _type) const
+{
+    evaluateFused(e.fused, m, _type);
+}
+
+Size MatOp_Fused::size(const MatExpr& e) const
+{
+    return e.fused->size;
+}
+
+int MatOp_Fused::type(const MatExpr& e) const
+{
+    return e.fused->type;
+}
+
+static void getFusedOperand(const Ptr<MatExprNode>& n, MatExprArg& arg)
+{
+    arg = MatExprArg();
+    if( n->op == FUSED_LEAF )
+        arg.m = n->m;
+    else
+        arg.node = n;
+}
+
+// rebuilds the expression with another top operation over the same operands
+static void remakeFused(MatExpr& res, const MatExpr& op, const MatExprNode* n, bool binary)
+{
+    MatExprArg a, b;
+    getFusedOperand(n->a, a);
+    if( binary && n->b )
+        getFusedOperand(n->b, b);
+    MatOp_Fused::makeExpr(res, op, a, b);
+}
+
+// the rewritings below follow MatOp_AddEx and MatOp_Bin, so that the fused expressions
+// produce the same results as the expressions evaluated step by step
+
+void MatOp_Fused::add(const MatExpr& e, const Scalar& s, MatExpr& res) const
+{
+    const MatExprNode* n = e.fused;
+    if( isAddEx(n->e) )
+    {
+        MatExpr op = n->e;
+        op.s += s;
+        remakeFused(res, op, n, true);
+    }
+    else
+        MatOp::add(e, s, res);
+}
+
+void MatOp_Fused::subtract(const Scalar& s, const MatExpr& e, MatExpr& res) const
+{
+    const MatExprNode* n = e.fused;
+    if( isAddEx(n->e) )
+    {
+        MatExpr op = n->e;
+        op.alpha = -op.alpha;
+        op.beta = -op.beta;
+        op.s = s - op.s;
+        remakeFused(res, op, n, true);
+    }
+    else
+        MatOp::subtract(s, e, res);
+}
+
+void MatOp_Fused::multiply(const MatExpr& e, double s, MatExpr& res) const
+{
+    const MatExprNode* n = e.fused;
+    MatExpr op = n->e;
+    if( isAddEx(op) )
+    {
+        op.alpha *= s;
+        op.beta *= s;
+        op.s *= s;
+        remakeFused(res, op, n, true);
+    }
+    else if( isBin(op, '*') || isBin(op, '/') )
+    {
+        op.alpha *= s;
+        remakeFused(res, op, n, true);
+    }
+    else
+        MatOp::multiply(e, s, res);
+}
+
+void MatOp_Fused::divide(double s, const MatExpr& e, MatExpr& res) const
+{
+    const MatExprNode* n = e.fused;
+    const MatExpr& op = n->e;
+    if( isAddEx(op) && (!n->b || op.beta == 0) && op.s == Scalar() )
+        remakeFused(res, MatExpr(&g_MatOp_Bin, '/', Mat(), Mat(), Mat(), s/op.alpha, 0), n, false);
+    else if( isBin(op, '/') && (!n->b || op.beta == 0) )
+        remakeFused(res, MatExpr(&g_MatOp_AddEx, 0, Mat(), Mat(), Mat(), s/op.alpha, 0), n, false);
+    else
+        MatOp::divide(s, e, res);
+}
+
+void MatOp_Fused::abs(const MatExpr& e, MatExpr& res) const
+{
+    const MatExprNode* n = e.fused;
+    const MatExpr& op = n->e;
+    if( isAddEx(op) && (!n->b || op.beta == 0) && fabs(op.alpha) == 1 )
+        remakeFused(res, MatExpr(&g_MatOp_Bin, 'a', Mat(), Mat(), Mat(), 1, 0, -op.s*op.alpha), n, false);
+    else if( isAddEx(op) && n->b && op.alpha + op.beta == 0 && op.alpha*op.beta == -1 )
+        remakeFused(res, MatExpr(&g_MatOp_Bin, 'a', Mat(), Mat(), Mat(), 1, 1), n, true);
+    else
+        MatOp::abs(e, res);
+}
+
+bool MatOp_Fused::getAddExArg(const MatExpr& e, MatExprArg& arg, double& alpha, Scalar& s)
+{
+    if( isAddEx(e) && (!e.b.data || e.beta == 0) )
+    {
+        arg = MatExprArg();
+        arg.m = e.a;
+        alpha = e.alpha;
+        s = e.s;
+        return true;
+    }
+
+    const MatExprNode* n = e.op == &g_MatOp_Fused ? e.fused.get() : 0;
+    if( n && isAddEx(n->e) && (!n->b || n->e.beta == 0) )
+    {
+        getFusedOperand(n->a, arg);
+        alpha = n->e.alpha;
+        s = n->e.s;
+        return true;
+    }
+    return false;
+}
+
+bool MatOp_Fused::getScaledArg(const MatExpr& e, MatExprArg& arg, double& alpha)
+{
+    MatExprArg a;
+    double alpha0 = 1;
+    Scalar s;
+    if( !getAddExArg(e, a, alpha0, s) || !(s == Scalar()) )
+        return false;
+    arg = a;
+    alpha = alpha0;
+    return true;
+}
+
+bool MatOp_Fused::getReciprocalArg(const MatExpr& e, MatExprArg& arg, double& alpha)
+{
+    if( isReciprocal(e) )
+    {
+        arg = MatExprArg();
+        arg.m = e.a;
+        alpha = e.alpha;
+        return true;
+    }
+
+    const MatExprNode* n = e.op == &g_MatOp_Fused ? e.fused.get() : 0;
+    if( n && isBin(n->e, '/') && (!n->b || n->e.beta == 0) )
+    {
+        getFusedOperand(n->a, arg);
+        alpha = n->e.alpha;
+        return true;
+    }
+    return false;
+}
+
+void MatOp_Fused::getArg(const MatExpr& e, MatExprArg& arg)
+{
+    arg.node.release();
+    if( e.op == &g_MatOp_Fused )
+        arg.node = e.fused;
+    else if( isAddEx(e) || e.op == &g_MatOp_Bin || isCmp(e) )
+    {
+        Ptr<MatExprNode> a = makeFusedLeaf(e.a), b;
+        if( e.b.data && !(b = makeFusedLeaf(e.b)) )
+            a.release();
+        arg.node = makeFusedNode(e, a, b);
+    }
+
+    if( !arg.node )
+        e.op->assign(e, arg.m);
+}
+
+void MatOp_Fused::makeExpr(MatExpr& res, const MatExpr& e, const MatExprArg& a, const MatExprArg& b)
+{
+    if( a.node || b.node )
+    {
+        bool binary = b.node || b.m.data;
+        Ptr<MatExprNode> na = a.node ? a.node : makeFusedLeaf(a.m);
+        Ptr<MatExprNode> nb = b.node ? b.node : makeFusedLeaf(b.m), n;
+
+        if( !binary || nb )
+            n = makeFusedNode(e, na, nb);
+        if( n )
+        {
+            res = MatExpr(&g_MatOp_Fused, 0, Mat(), Mat(), Mat(), 1, 0);
+            res.fused = n;
+            return;
+        }
+    }
+
+    // the operation is not fused; evaluate the operands
+    res = e;
+    res.a = a.m;
+    res.b = b.m;
+    if( a.node )
+        evaluateFused(a.node, res.a, -1);
+    if( b.node )
+        evaluateFused(b.node, res.b, -1);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 MatExpr Mat::t() const
 {
     MatExpr e;
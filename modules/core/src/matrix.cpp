@@ -45,6 +45,9 @@
 
 #include "bufferpool.impl.hpp"
 
+#include <list>
+#include <map>
+
 /****************************************************************************************\
 *                           [scaled] Identity matrix initialization                      *
 \****************************************************************************************/
@@ -225,6 +228,227 @@ MatAllocator* Mat::getStdAllocator()
     return allocator;
 }
 
+static MatAllocator* defaultMatAllocator = 0;
+
+MatAllocator* Mat::getDefaultAllocator()
+{
+    return defaultMatAllocator ? defaultMatAllocator : getStdAllocator();
+}
+
+void Mat::setDefaultAllocator(MatAllocator* allocator)
+{
+    defaultMatAllocator = allocator;
+}
+
+/*
+   The pool of the host memory buffers.
+
+   The released buffers are kept in the LRU list and indexed by their capacity.
+   The requested sizes are rounded up to the allocation granularity, so the buffers
+   of the same-sized matrices (e.g. video frames) fall into the same bucket and are
+   reused without going to the heap.
+*/
+class HostBufferPoolImpl : public BufferPoolController
+{
+public:
+    struct BufferEntry
+    {
+        uchar* ptr_;
+        size_t capacity_;
+    };
+protected:
+    typedef std::list<BufferEntry> EntryList;
+    typedef std::multimap<size_t, EntryList::iterator> BucketMap;
+
+    Mutex mutex_;
+
+    size_t currentReservedSize;
+    size_t maxReservedSize;
+
+    EntryList reservedEntries_; // LRU order, the most recently released buffers go first
+    BucketMap buckets_;         // capacity -> position in reservedEntries_
+
+    // synchronized
+    void _removeEntry(BucketMap::iterator pos)
+    {
+        const BufferEntry& entry = *pos->second;
+        CV_DbgAssert(currentReservedSize >= entry.capacity_);
+        currentReservedSize -= entry.capacity_;
+        reservedEntries_.erase(pos->second);
+        buckets_.erase(pos);
+    }
+
+    // synchronized
+    void _releaseLeastRecentlyUsed()
+    {
+        CV_DbgAssert(!reservedEntries_.empty());
+        EntryList::iterator last = --reservedEntries_.end();
+        std::pair<BucketMap::iterator, BucketMap::iterator> r = buckets_.equal_range(last->capacity_);
+        for( ; r.first != r.second; ++r.first )
+            if( r.first->second == last )
+                break;
+        CV_Assert(r.first != r.second);
+        fastFree(last->ptr_);
+        _removeEntry(r.first);
+    }
+
+    // synchronized
+    void _checkSizeOfReservedEntries()
+    {
+        while (currentReservedSize > maxReservedSize)
+            _releaseLeastRecentlyUsed();
+    }
+
+    static size_t _allocationGranularity(size_t size)
+    {
+        // heuristic values
+        if (size < 1024)
+            return 16;
+        else if (size < 64*1024)
+            return 64;
+        else if (size < 1024*1024)
+            return 4096;
+        else if (size < 16*1024*1024)
+            return 64*1024;
+        else
+            return 1024*1024;
+    }
+public:
+    HostBufferPoolImpl()
+        : currentReservedSize(0), maxReservedSize(0)
+    {
+        maxReservedSize = getConfigurationParameterForSize("OPENCV_BUFFERPOOL_LIMIT", 128*1024*1024);
+    }
+    virtual ~HostBufferPoolImpl()
+    {
+        freeAllReservedBuffers();
+    }
+
+    uchar* allocate(size_t size, CV_OUT size_t& capacity)
+    {
+        capacity = alignSize(size, (int)_allocationGranularity(size));
+        if (maxReservedSize > 0)
+        {
+            AutoLock locker(mutex_);
+            std::pair<BucketMap::iterator, BucketMap::iterator> r = buckets_.equal_range(capacity);
+            if (r.first != r.second)
+            {
+                // the last entry of the bucket is the most recently released one
+                BucketMap::iterator pos = --r.second;
+                uchar* ptr = pos->second->ptr_;
+                _removeEntry(pos);
+                return ptr;
+            }
+        }
+        return (uchar*)fastMalloc(capacity);
+    }
+
+    void release(uchar* ptr, size_t capacity)
+    {
+        if (maxReservedSize == 0 || capacity > maxReservedSize / 8)
+        {
+            fastFree(ptr);
+            return;
+        }
+        AutoLock locker(mutex_);
+        BufferEntry entry = {ptr, capacity};
+        reservedEntries_.push_front(entry);
+        buckets_.insert(std::make_pair(capacity, reservedEntries_.begin()));
+        currentReservedSize += capacity;
+        _checkSizeOfReservedEntries();
+    }
+
+    virtual size_t getReservedSize() const { return currentReservedSize; }
+    virtual size_t getMaxReservedSize() const { return maxReservedSize; }
+    virtual void setMaxReservedSize(size_t size)
+    {
+        AutoLock locker(mutex_);
+        maxReservedSize = size;
+        BucketMap::iterator i = buckets_.upper_bound(maxReservedSize / 8);
+        while (i != buckets_.end())
+        {
+            fastFree(i->second->ptr_);
+            _removeEntry(i++);
+        }
+        _checkSizeOfReservedEntries();
+    }
+    virtual void freeAllReservedBuffers()
+    {
+        AutoLock locker(mutex_);
+        for (EntryList::const_iterator i = reservedEntries_.begin(); i != reservedEntries_.end(); ++i)
+            fastFree(i->ptr_);
+        reservedEntries_.clear();
+        buckets_.clear();
+        currentReservedSize = 0;
+    }
+};
+
+class BufferPoolMatAllocator : public MatAllocator
+{
+public:
+    UMatData* allocate(int dims, const int* sizes, int type,
+                       void* data0, size_t* step, int /*flags*/, UMatUsageFlags /*usageFlags*/) const
+    {
+        size_t total = CV_ELEM_SIZE(type);
+        for( int i = dims-1; i >= 0; i-- )
+        {
+            if( step )
+            {
+                if( data0 && step[i] != CV_AUTOSTEP )
+                {
+                    CV_Assert(total <= step[i]);
+                    total = step[i];
+                }
+                else
+                    step[i] = total;
+            }
+            total *= sizes[i];
+        }
+        size_t capacity = total;
+        uchar* data = data0 ? (uchar*)data0 : bufferPool.allocate(total, capacity);
+        UMatData* u = new UMatData(this);
+        u->data = u->origdata = data;
+        u->size = total;
+        u->capacity = capacity;
+        if(data0)
+            u->flags |= UMatData::USER_ALLOCATED;
+
+        return u;
+    }
+
+    bool allocate(UMatData* u, int /*accessFlags*/, UMatUsageFlags /*usageFlags*/) const
+    {
+        if(!u) return false;
+        return true;
+    }
+
+    void deallocate(UMatData* u) const
+    {
+        CV_Assert(u->urefcount >= 0);
+        CV_Assert(u->refcount >= 0);
+        if(u && u->refcount == 0)
+        {
+            if( !(u->flags & UMatData::USER_ALLOCATED) )
+            {
+                bufferPool.release(u->origdata, u->capacity);
+                u->origdata = 0;
+            }
+            delete u;
+        }
+    }
+
+    BufferPoolController* getBufferPoolController() const { return &bufferPool; }
+
+protected:
+    mutable HostBufferPoolImpl bufferPool;
+};
+
+MatAllocator* Mat::getBufferPoolAllocator()
+{
+    static MatAllocator * allocator = new BufferPoolMatAllocator();
+    return allocator;
+}
+
 void swap( Mat& a, Mat& b )
 {
     std::swap(a.flags, b.flags);
@@ -395,7 +619,7 @@ void Mat::create(int d, const int* _sizes, int _type)
             a = tegra::getAllocator(d, _sizes, _type);
 #endif
         if(!a)
-            a = a0;
+            a = getDefaultAllocator();
         try
         {
             u = a->allocate(dims, size, _type, 0, step.p, 0, USAGE_DEFAULT);
@@ -0,0 +1,131 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2014, Itseez Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#ifndef __OPENCV_CORE_OPT_AVX2_HPP__
+#define __OPENCV_CORE_OPT_AVX2_HPP__
+
+// Kernels compiled with the AVX2 flags (see *.avx2.cpp). The callers may only use them
+// when the build has HAVE_DISPATCH_AVX2 and the CPU reports CV_CPU_AVX2 (USE_AVX2).
+// This header is included by the sources built with and without AVX2, so it must not
+// define any inline code.
+
+#include "opencv2/core/cvdef.h"
+
+namespace cv
+{
+
+#define EXPTAB_SCALE 6
+#define EXPTAB_MASK  ((1 << EXPTAB_SCALE) - 1)
+
+#define EXPPOLY_32F_A0 .9670371139572337719125840413672004409288e-2
+
+#define LOGTAB_SCALE    8
+#define LOGTAB_MASK         ((1 << LOGTAB_SCALE) - 1)
+#define LOGTAB_MASK2        ((1 << (20 - LOGTAB_SCALE)) - 1)
+#define LOGTAB_MASK2_32F    ((1 << (23 - LOGTAB_SCALE)) - 1)
+
+// defined in mathfuncs.cpp
+extern const double expTab[];
+extern const double icvLogTab[];
+
+namespace opt_AVX2
+{
+
+#define OPT_AVX2_BINARY_OP(name, type) \
+    void name(const type* src1, size_t step1, const type* src2, size_t step2, \
+              type* dst, size_t step, int width, int height)
+
+#define OPT_AVX2_BINARY_OPS(name) \
+    OPT_AVX2_BINARY_OP(name##8u, uchar); \
+    OPT_AVX2_BINARY_OP(name##8s, schar); \
+    OPT_AVX2_BINARY_OP(name##16u, ushort); \
+    OPT_AVX2_BINARY_OP(name##16s, short); \
+    OPT_AVX2_BINARY_OP(name##32s, int); \
+    OPT_AVX2_BINARY_OP(name##32f, float); \
+    OPT_AVX2_BINARY_OP(name##64f, double)
+
+OPT_AVX2_BINARY_OPS(add);
+OPT_AVX2_BINARY_OPS(sub);
+OPT_AVX2_BINARY_OPS(max);
+OPT_AVX2_BINARY_OPS(min);
+OPT_AVX2_BINARY_OPS(absdiff);
+
+// dst = (eq ? src1 == src2 : src1 > src2) ^ invert, as 0/255 masks
+#define OPT_AVX2_CMP_OP(name, type) \
+    void name(const type* src1, size_t step1, const type* src2, size_t step2, \
+              uchar* dst, size_t step, int width, int height, bool eq, bool invert)
+
+OPT_AVX2_CMP_OP(cmp8u, uchar);
+OPT_AVX2_CMP_OP(cmp8s, schar);
+OPT_AVX2_CMP_OP(cmp16u, ushort);
+OPT_AVX2_CMP_OP(cmp16s, short);
+OPT_AVX2_CMP_OP(cmp32s, int);
+OPT_AVX2_CMP_OP(cmp32f, float);
+OPT_AVX2_CMP_OP(cmp64f, double);
+
+#undef OPT_AVX2_BINARY_OPS
+#undef OPT_AVX2_BINARY_OP
+#undef OPT_AVX2_CMP_OP
+
+// the math functions process the longest prefix they can and return its length;
+// the caller finishes the rest of the array
+int exp32f(const float* x, float* y, int n);
+int log32f(const float* x, float* y, int n);
+int magnitude32f(const float* x, const float* y, float* mag, int len);
+int magnitude64f(const double* x, const double* y, double* mag, int len);
+int fastAtan2_32f(const float* Y, const float* X, float* angle, int len, float scale);
+
+// GEMM micro-kernels (see matmul.cpp): c[4][16] (+)= a*b for the 32f and c[4][8] (+)= a*b
+// for the 64f data, where a is a packed 4 x kc panel and b is a packed kc x 16 (kc x 8) one;
+// c is double in both cases
+enum { GEMM_KERNEL_NR_32F = 16, GEMM_KERNEL_NR_64F = 8 };
+void gemmKernel32f(int kc, const float* a, const float* b, double* c, size_t cstep, bool accumulate);
+void gemmKernel64f(int kc, const double* a, const double* b, double* c, size_t cstep, bool accumulate);
+
+// the radix-4 passes of the 32f DFT over the interleaved complex data, as DFT_VecR4 in dxt.cpp:
+// returns the size of the transformed sub-sequences and updates the twiddle factor step
+int dftRadix4_32f(float* dst, int N, int n0, int& dw0, const float* wave);
+
+}
+
+}
+
+#endif
@@ -50,6 +50,10 @@
     #undef abs
 #endif
 
+#if !(defined WIN32 || defined WINCE)
+    #include <pthread.h>
+#endif
+
 #if defined __linux__ || defined __APPLE__
     #include <unistd.h>
     #include <stdio.h>
@@ -79,6 +83,7 @@
    3. HAVE_OPENMP      - integrated to compiler, should be explicitly enabled
    4. HAVE_GCD         - system wide, used automatically        (APPLE only)
    5. HAVE_CONCURRENCY - part of runtime, used automatically    (Windows only - MSVS 10, MSVS 11)
+   6. HAVE_PTHREADS_PF - pthreads based thread pool, enabled by default (UNIX only)
 */
 
 #if defined HAVE_TBB
@@ -120,6 +125,8 @@
 #  define CV_PARALLEL_FRAMEWORK "gcd"
 #elif defined HAVE_CONCURRENCY
 #  define CV_PARALLEL_FRAMEWORK "ms-concurrency"
+#elif defined HAVE_PTHREADS_PF
+#  define CV_PARALLEL_FRAMEWORK "pthreads"
 #endif
 
 namespace cv
@@ -192,6 +199,19 @@ namespace
             this->ParallelLoopBodyWrapper::operator()(cv::Range(i, i + 1));
         }
     };
+#elif defined HAVE_PTHREADS_PF
+    class ProxyLoopBody : public cv::ParallelLoopBody, public ParallelLoopBodyWrapper
+    {
+    public:
+        ProxyLoopBody(const cv::ParallelLoopBody& _body, const cv::Range& _r, double _nstripes)
+        : ParallelLoopBodyWrapper(_body, _r, _nstripes)
+        {}
+
+        void operator ()(const cv::Range& range) const
+        {
+            this->ParallelLoopBodyWrapper::operator()(range);
+        }
+    };
 #else
     typedef ParallelLoopBodyWrapper ProxyLoopBody;
 #endif
@@ -224,6 +244,8 @@ public:
     ~SchedPtr() { *this = 0; }
 };
 static SchedPtr pplScheduler;
+#elif defined HAVE_PTHREADS_PF
+// the thread pool is created on demand, see parallel_pthreads.cpp
 #endif
 
 #endif // CV_PARALLEL_FRAMEWORK
@@ -280,6 +302,10 @@ void cv::parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body,
             Concurrency::CurrentScheduler::Detach();
         }
 
+#elif defined HAVE_PTHREADS_PF
+
+        cv::parallel_for_pthreads(stripeRange, pbody);
+
 #else
 
 #error You have hacked and compiling with unsupported parallel framework
@@ -296,6 +322,263 @@ void cv::parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body,
     }
 }
 
+/* ================================   async  ================================ */
+
+namespace
+{
+
+// manual-reset event signalled when the task is complete
+class TaskEvent
+{
+public:
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    TaskEvent()
+    {
+#ifdef HAVE_WINRT
+        handle = CreateEventEx(0, 0, CREATE_EVENT_MANUAL_RESET, EVENT_ALL_ACCESS);
+#else
+        handle = CreateEvent(0, TRUE, FALSE, 0);
+#endif
+    }
+    ~TaskEvent() { CloseHandle(handle); }
+
+    void set() { SetEvent(handle); }
+    void wait()
+    {
+#ifdef HAVE_WINRT
+        WaitForSingleObjectEx(handle, INFINITE, FALSE);
+#else
+        WaitForSingleObject(handle, INFINITE);
+#endif
+    }
+
+protected:
+    HANDLE handle;
+#else
+    TaskEvent() : signalled(false)
+    {
+        pthread_mutex_init(&mutex, 0);
+        pthread_cond_init(&cond, 0);
+    }
+    ~TaskEvent()
+    {
+        pthread_cond_destroy(&cond);
+        pthread_mutex_destroy(&mutex);
+    }
+
+    void set()
+    {
+        pthread_mutex_lock(&mutex);
+        signalled = true;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&mutex);
+    }
+    void wait()
+    {
+        pthread_mutex_lock(&mutex);
+        while( !signalled )
+            pthread_cond_wait(&cond, &mutex);
+        pthread_mutex_unlock(&mutex);
+    }
+
+protected:
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool signalled;
+#endif
+
+private:
+    TaskEvent(const TaskEvent&);
+    TaskEvent& operator = (const TaskEvent&);
+};
+
+// guards the dependency lists and the completion state of all the tasks
+cv::Mutex& getAsyncMutex()
+{
+    static cv::Mutex* m = new cv::Mutex();
+    return *m;
+}
+
+} // namespace
+
+struct cv::AsyncTask::Impl
+{
+    Impl(const Ptr<ParallelLoopBody>& _body, const Range& _range, double _nstripes)
+        : body(_body), range(_range), nstripes(_nstripes), ndeps(1), done(false), failed(false)
+    {}
+
+    void execute();
+    void complete();
+
+    // called when one of the dependencies is complete
+    static void release(const Ptr<Impl>& task);
+    static void schedule(const Ptr<Impl>& task);
+    static void run(void* arg);
+
+    Ptr<ParallelLoopBody> body;
+    Range range;
+    double nstripes;
+
+    int ndeps;                          // incomplete dependencies + 1 while the task is set up
+    std::vector<Ptr<Impl> > dependents; // tasks waiting for this one
+    bool done;
+    bool failed;
+    Exception error;
+    TaskEvent event;
+};
+
+void cv::AsyncTask::Impl::execute()
+{
+    try
+    {
+        parallel_for_(range, *body, nstripes);
+    }
+    catch( const Exception& e )
+    {
+        AutoLock lock(getAsyncMutex());
+        failed = true;
+        error = e;
+    }
+    catch( const std::exception& e )
+    {
+        AutoLock lock(getAsyncMutex());
+        failed = true;
+        error = Exception(CV_StsError, e.what(), "async", __FILE__, __LINE__);
+    }
+    catch(...)
+    {
+        AutoLock lock(getAsyncMutex());
+        failed = true;
+        error = Exception(CV_StsError, "Unknown exception", "async", __FILE__, __LINE__);
+    }
+    complete();
+}
+
+void cv::AsyncTask::Impl::complete()
+{
+    std::vector<Ptr<Impl> > ready;
+    {
+        AutoLock lock(getAsyncMutex());
+        done = true;
+        std::swap(ready, dependents);
+        for( size_t i = 0; i < ready.size(); i++ )
+            if( failed && !ready[i]->failed )
+            {
+                ready[i]->failed = true;
+                ready[i]->error = error;
+            }
+    }
+    body.release();
+    event.set();
+
+    for( size_t i = 0; i < ready.size(); i++ )
+        release(ready[i]);
+}
+
+void cv::AsyncTask::Impl::release(const Ptr<Impl>& task)
+{
+    if( CV_XADD(&task->ndeps, -1) == 1 )
+        schedule(task);
+}
+
+void cv::AsyncTask::Impl::run(void* arg)
+{
+    Ptr<Impl>* task = (Ptr<Impl>*)arg;
+    (*task)->execute();
+    delete task;
+}
+
+void cv::AsyncTask::Impl::schedule(const Ptr<Impl>& task)
+{
+    // the failure of a dependency is propagated without running the task
+    if( task->failed )
+    {
+        task->complete();
+        return;
+    }
+
+#if defined HAVE_PTHREADS_PF
+    Ptr<Impl>* arg = new Ptr<Impl>(task);
+    if( parallel_pthreads_submit(&Impl::run, arg) )
+        return;
+    delete arg;
+#endif
+
+    task->execute();
+}
+
+cv::AsyncTask::AsyncTask()
+{
+}
+
+bool cv::AsyncTask::empty() const
+{
+    return impl.empty();
+}
+
+bool cv::AsyncTask::ready() const
+{
+    if( impl.empty() )
+        return true;
+    AutoLock lock(getAsyncMutex());
+    return impl->done;
+}
+
+void cv::AsyncTask::wait() const
+{
+    if( impl.empty() )
+        return;
+
+#if defined HAVE_PTHREADS_PF
+    // help the pool instead of blocking; this also prevents a deadlock
+    // when the tasks running on all the pool threads are waiting for queued tasks
+    while( !ready() && parallel_pthreads_run_queued_task() )
+        ;
+#endif
+
+    impl->event.wait();
+
+    bool failed;
+    Exception error;
+    {
+        AutoLock lock(getAsyncMutex());
+        failed = impl->failed;
+        error = impl->error;
+    }
+    if( failed )
+        throw error;
+}
+
+cv::AsyncTask cv::async(const Ptr<ParallelLoopBody>& body, const Range& range,
+                        const std::vector<AsyncTask>& dependencies, double nstripes)
+{
+    CV_Assert( !body.empty() );
+
+    AsyncTask task;
+    task.impl = makePtr<AsyncTask::Impl>(body, range, nstripes);
+    {
+        AutoLock lock(getAsyncMutex());
+        for( size_t i = 0; i < dependencies.size(); i++ )
+        {
+            const Ptr<AsyncTask::Impl>& dep = dependencies[i].impl;
+            if( dep.empty() )
+                continue;
+            if( !dep->done )
+            {
+                dep->dependents.push_back(task.impl);
+                CV_XADD(&task.impl->ndeps, 1);
+            }
+            else if( dep->failed && !task.impl->failed )
+            {
+                task.impl->failed = true;
+                task.impl->error = dep->error;
+            }
+        }
+    }
+    AsyncTask::Impl::release(task.impl);
+    return task;
+}
+
 int cv::getNumThreads(void)
 {
 #ifdef CV_PARALLEL_FRAMEWORK
@@ -331,6 +614,10 @@ int cv::getNumThreads(void)
                 ? Concurrency::CurrentScheduler::Get()->GetNumberOfVirtualProcessors()
                 : pplScheduler->GetNumberOfVirtualProcessors());
 
+#elif defined HAVE_PTHREADS_PF
+
+    return cv::parallel_pthreads_get_threads_num();
+
 #else
 
     return 1;
@@ -384,6 +671,10 @@ void cv::setNumThreads( int threads )
                        Concurrency::MaxConcurrency, threads-1));
     }
 
+#elif defined HAVE_PTHREADS_PF
+
+    cv::parallel_pthreads_set_threads_num(threads);
+
 #endif
 }
 
@@ -404,6 +695,8 @@ int cv::getThreadNum(void)
     return (int)(size_t)(void*)pthread_self(); // no zero-based indexing
 #elif defined HAVE_CONCURRENCY
     return std::max(0, (int)Concurrency::Context::VirtualProcessorId()); // zero for master thread, unique number for others but not necessary 1,2,3,...
+#elif defined HAVE_PTHREADS_PF
+    return cv::parallel_pthreads_get_thread_num(); // zero for the calling thread, 1..getNumThreads()-1 for the pool workers
 #else
     return 0;
 #endif
@@ -0,0 +1,566 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+
+#if defined HAVE_PTHREADS_PF
+
+#include <pthread.h>
+#include <deque>
+
+namespace cv
+{
+
+/*
+   Thread pool used by parallel_for_ when no other parallel framework is available.
+
+   The pool keeps (numThreads - 1) worker threads parked on a condition variable between
+   the calls; the calling thread always takes part in the job as the slot 0.
+   Every participating thread owns a queue of stripes (a contiguous range of stripe indices).
+   The owner takes stripes from the front of its queue, an idle thread steals the back half
+   of the queue of another participant. Nested parallel_for_ calls (made from inside a running
+   job) and calls made while the pool is busy with another job are executed serially
+   by the calling thread, so the number of running threads never exceeds numThreads.
+
+   Besides the parallel_for_ jobs the pool runs the tasks submitted by cv::async().
+   A task is executed by one of the workers; the parallel_for_ called by the task body
+   becomes a regular job, which the idle workers join.
+*/
+class ThreadPool
+{
+public:
+    static ThreadPool& instance();
+
+    void run(const Range& stripes, const ParallelLoopBody& body);
+    void setNumThreads(int nthreads);
+    int getNumThreads();
+    int getThreadNum();
+
+    typedef void (*TaskFunc)(void* arg);
+    bool submit(TaskFunc func, void* arg);
+    bool runQueuedTask();
+
+protected:
+    ThreadPool();
+    ~ThreadPool();
+
+    struct StripeQueue
+    {
+        StripeQueue() : begin(0), end(0) { pthread_mutex_init(&mutex, 0); }
+        ~StripeQueue() { pthread_mutex_destroy(&mutex); }
+
+        bool pop(int& idx);
+        bool stealTo(StripeQueue& dst);
+        void set(int _begin, int _end);
+
+        pthread_mutex_t mutex;
+        int begin, end;
+        char pad[64]; // keep the queues of different threads in different cache lines
+    };
+
+    struct Task
+    {
+        TaskFunc func;
+        void* arg;
+    };
+
+    static void* workerProc(void* arg);
+    void workerLoop(int slot);
+    void execute(int slot);
+    void startWorkers();
+    void stopWorkers();
+
+    int numThreads;                 // requested number of threads including the caller
+    std::vector<pthread_t> workers; // running worker threads
+    std::vector<StripeQueue*> queues;
+
+    pthread_mutex_t mutex;          // guards the fields below
+    pthread_cond_t workCond;        // signalled when a new job or task is published or on shutdown
+    pthread_cond_t doneCond;        // signalled when the last active worker leaves the job
+    unsigned generation;
+    int activeWorkers;
+    int runningWorkers;
+    bool stopping;
+    const ParallelLoopBody* body;
+    bool scratch;                   // the owner of the job is inside a ScratchScope
+    std::deque<Task> tasks;
+
+    pthread_mutex_t jobMutex;       // held by the thread that owns the pool during a job
+    int pending;                    // the number of stripes not yet processed
+    int cancelled;                  // set when one of the stripes has thrown an exception
+    bool hasError;
+    Exception error;
+
+    pthread_key_t slotKey;          // slot of the current thread: 1..numThreads-1 for the workers, 0 for others
+    pthread_key_t jobKey;           // non-zero while the current thread processes the stripes of a job
+};
+
+bool ThreadPool::StripeQueue::pop(int& idx)
+{
+    pthread_mutex_lock(&mutex);
+    bool ok = begin < end;
+    if( ok )
+        idx = begin++;
+    pthread_mutex_unlock(&mutex);
+    return ok;
+}
+
+bool ThreadPool::StripeQueue::stealTo(StripeQueue& dst)
+{
+    pthread_mutex_lock(&mutex);
+    int len = end - begin;
+    int stolenEnd = end, stolenBegin = end - (len + 1)/2;
+    if( len > 0 )
+        end = stolenBegin;
+    pthread_mutex_unlock(&mutex);
+
+    if( len <= 0 )
+        return false;
+    dst.set(stolenBegin, stolenEnd);
+    return true;
+}
+
+void ThreadPool::StripeQueue::set(int _begin, int _end)
+{
+    pthread_mutex_lock(&mutex);
+    begin = _begin;
+    end = _end;
+    pthread_mutex_unlock(&mutex);
+}
+
+ThreadPool& ThreadPool::instance()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::ThreadPool()
+{
+    numThreads = std::max(getNumberOfCPUs(), 1);
+    generation = 0;
+    activeWorkers = 0;
+    runningWorkers = 0;
+    stopping = false;
+    body = 0;
+    scratch = false;
+    pending = 0;
+    cancelled = 0;
+    hasError = false;
+
+    pthread_mutex_init(&mutex, 0);
+    pthread_cond_init(&workCond, 0);
+    pthread_cond_init(&doneCond, 0);
+    pthread_mutex_init(&jobMutex, 0);
+    pthread_key_create(&slotKey, 0);
+    pthread_key_create(&jobKey, 0);
+}
+
+ThreadPool::~ThreadPool()
+{
+    pthread_mutex_lock(&jobMutex);
+    stopWorkers();
+    pthread_mutex_unlock(&jobMutex);
+
+    for( size_t i = 0; i < queues.size(); i++ )
+        delete queues[i];
+
+    pthread_key_delete(jobKey);
+    pthread_key_delete(slotKey);
+    pthread_mutex_destroy(&jobMutex);
+    pthread_cond_destroy(&doneCond);
+    pthread_cond_destroy(&workCond);
+    pthread_mutex_destroy(&mutex);
+}
+
+struct WorkerArg
+{
+    ThreadPool* pool;
+    int slot;
+};
+
+void* ThreadPool::workerProc(void* arg)
+{
+    WorkerArg* warg = (WorkerArg*)arg;
+    ThreadPool* pool = warg->pool;
+    int slot = warg->slot;
+    delete warg;
+
+    pool->workerLoop(slot);
+    return 0;
+}
+
+// must be called with jobMutex locked
+void ThreadPool::startWorkers()
+{
+    int nworkers = numThreads - 1;
+    if( (int)workers.size() == nworkers )
+        return;
+
+    stopWorkers();
+
+    while( (int)queues.size() < numThreads )
+        queues.push_back(new StripeQueue);
+
+    for( int i = 1; i <= nworkers; i++ )
+    {
+        WorkerArg* warg = new WorkerArg;
+        warg->pool = this;
+        warg->slot = i;
+
+        pthread_t thread;
+        if( pthread_create(&thread, 0, workerProc, warg) != 0 )
+        {
+            // continue with the threads we have managed to start
+            delete warg;
+            break;
+        }
+        workers.push_back(thread);
+    }
+
+    pthread_mutex_lock(&mutex);
+    runningWorkers = (int)workers.size();
+    pthread_mutex_unlock(&mutex);
+}
+
+// must be called with jobMutex locked
+void ThreadPool::stopWorkers()
+{
+    if( workers.empty() )
+        return;
+
+    pthread_mutex_lock(&mutex);
+    stopping = true;
+    runningWorkers = 0;
+    pthread_cond_broadcast(&workCond);
+    pthread_mutex_unlock(&mutex);
+
+    for( size_t i = 0; i < workers.size(); i++ )
+        pthread_join(workers[i], 0);
+    workers.clear();
+
+    pthread_mutex_lock(&mutex);
+    stopping = false;
+    pthread_mutex_unlock(&mutex);
+}
+
+void ThreadPool::workerLoop(int slot)
+{
+    pthread_setspecific(slotKey, (void*)(size_t)slot);
+
+    unsigned seen = 0;
+    pthread_mutex_lock(&mutex);
+    seen = generation;
+    for(;;)
+    {
+        while( generation == seen && tasks.empty() && !stopping )
+            pthread_cond_wait(&workCond, &mutex);
+        if( stopping )
+            break;
+
+        // the jobs go first: their owners are blocked until the jobs are complete
+        if( generation != seen )
+        {
+            seen = generation;
+
+            // the job could have been completed before this worker has woken up
+            if( !body )
+                continue;
+
+            activeWorkers++;
+            bool useScratch = scratch;
+            pthread_mutex_unlock(&mutex);
+
+            pthread_setspecific(jobKey, (void*)1);
+            if( useScratch )
+            {
+                // let the temporary buffers of the stripes come from the worker arena as well
+                ScratchScope scope;
+                execute(slot);
+            }
+            else
+                execute(slot);
+            pthread_setspecific(jobKey, 0);
+
+            pthread_mutex_lock(&mutex);
+            if( --activeWorkers == 0 )
+                pthread_cond_signal(&doneCond);
+            continue;
+        }
+
+        Task task = tasks.front();
+        tasks.pop_front();
+        pthread_mutex_unlock(&mutex);
+
+        task.func(task.arg);
+
+        pthread_mutex_lock(&mutex);
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+void ThreadPool::execute(int slot)
+{
+    int nqueues = (int)workers.size() + 1;
+    StripeQueue& own = *queues[slot];
+
+    for(;;)
+    {
+        int idx;
+        if( !own.pop(idx) )
+        {
+            bool stolen = false;
+            for( int i = 1; i < nqueues && !stolen; i++ )
+                stolen = queues[(slot + i) % nqueues]->stealTo(own);
+            if( !stolen )
+                break;
+            continue;
+        }
+
+        if( CV_XADD(&cancelled, 0) == 0 )
+        {
+            try
+            {
+                (*body)(Range(idx, idx + 1));
+            }
+            catch( const Exception& e )
+            {
+                pthread_mutex_lock(&mutex);
+                if( !hasError )
+                    error = e;
+                hasError = true;
+                CV_XADD(&cancelled, 1);
+                pthread_mutex_unlock(&mutex);
+            }
+            catch( const std::exception& e )
+            {
+                pthread_mutex_lock(&mutex);
+                if( !hasError )
+                    error = Exception(CV_StsError, e.what(), "parallel_for_", __FILE__, __LINE__);
+                hasError = true;
+                CV_XADD(&cancelled, 1);
+                pthread_mutex_unlock(&mutex);
+            }
+            catch(...)
+            {
+                pthread_mutex_lock(&mutex);
+                if( !hasError )
+                    error = Exception(CV_StsError, "Unknown exception", "parallel_for_", __FILE__, __LINE__);
+                hasError = true;
+                CV_XADD(&cancelled, 1);
+                pthread_mutex_unlock(&mutex);
+            }
+        }
+        CV_XADD(&pending, -1);
+    }
+}
+
+void ThreadPool::run(const Range& stripes, const ParallelLoopBody& _body)
+{
+    int nstripes = stripes.end - stripes.start;
+    if( nstripes <= 0 )
+        return;
+
+    if( nstripes == 1 || numThreads <= 1 || pthread_getspecific(jobKey) != 0 ||
+        pthread_mutex_trylock(&jobMutex) != 0 )
+    {
+        _body(stripes);
+        return;
+    }
+
+    startWorkers();
+
+    // spread the stripes evenly between the participants; the rest will be balanced by stealing
+    int nqueues = (int)workers.size() + 1;
+    int nparts = std::min(nqueues, nstripes);
+    for( int i = 0; i < nqueues; i++ )
+    {
+        int a = i < nparts ? stripes.start + (int)((int64)nstripes*i/nparts) : 0;
+        int b = i < nparts ? stripes.start + (int)((int64)nstripes*(i+1)/nparts) : 0;
+        queues[i]->set(a, b);
+    }
+
+    pending = nstripes;
+    cancelled = 0;
+    hasError = false;
+
+    bool useScratch = ScratchScope::isActive();
+
+    pthread_mutex_lock(&mutex);
+    body = &_body;
+    scratch = useScratch;
+    generation++;
+    if( nparts > 1 )
+        pthread_cond_broadcast(&workCond);
+    pthread_mutex_unlock(&mutex);
+
+    // the owner of the job is either an outside thread (slot 0) or a worker running a task
+    pthread_setspecific(jobKey, (void*)1);
+    execute(getThreadNum());
+    pthread_setspecific(jobKey, 0);
+
+    pthread_mutex_lock(&mutex);
+    while( activeWorkers > 0 || pending > 0 )
+        pthread_cond_wait(&doneCond, &mutex);
+    body = 0;
+    bool failed = hasError;
+    Exception e = error;
+    pthread_mutex_unlock(&mutex);
+
+    pthread_mutex_unlock(&jobMutex);
+
+    if( failed )
+        throw e;
+}
+
+void ThreadPool::setNumThreads(int nthreads)
+{
+    pthread_mutex_lock(&jobMutex);
+    numThreads = nthreads > 0 ? nthreads : std::max(getNumberOfCPUs(), 1);
+    if( (int)workers.size() != numThreads - 1 )
+    {
+        // the workers are restarted lazily by the next job, unless there are queued tasks
+        stopWorkers();
+
+        pthread_mutex_lock(&mutex);
+        bool hasTasks = !tasks.empty();
+        pthread_mutex_unlock(&mutex);
+
+        if( hasTasks )
+            startWorkers();
+        if( workers.empty() )
+            while( runQueuedTask() )
+                ;
+    }
+    pthread_mutex_unlock(&jobMutex);
+}
+
+int ThreadPool::getNumThreads()
+{
+    return numThreads;
+}
+
+int ThreadPool::getThreadNum()
+{
+    return (int)(size_t)pthread_getspecific(slotKey);
+}
+
+bool ThreadPool::submit(TaskFunc func, void* arg)
+{
+    if( numThreads <= 1 )
+        return false;
+
+    for( int attempt = 0; attempt < 2; attempt++ )
+    {
+        pthread_mutex_lock(&mutex);
+        bool ok = runningWorkers > 0 && !stopping;
+        if( ok )
+        {
+            Task task;
+            task.func = func;
+            task.arg = arg;
+            tasks.push_back(task);
+            pthread_cond_signal(&workCond);
+        }
+        pthread_mutex_unlock(&mutex);
+
+        if( ok )
+            return true;
+
+        // the workers have not been started yet
+        if( attempt > 0 || pthread_mutex_trylock(&jobMutex) != 0 )
+            break;
+        startWorkers();
+        pthread_mutex_unlock(&jobMutex);
+    }
+    return false;
+}
+
+bool ThreadPool::runQueuedTask()
+{
+    pthread_mutex_lock(&mutex);
+    bool ok = !tasks.empty();
+    Task task = { 0, 0 };
+    if( ok )
+    {
+        task = tasks.front();
+        tasks.pop_front();
+    }
+    pthread_mutex_unlock(&mutex);
+
+    if( ok )
+        task.func(task.arg);
+    return ok;
+}
+
+void parallel_for_pthreads(const Range& stripes, const ParallelLoopBody& body)
+{
+    ThreadPool::instance().run(stripes, body);
+}
+
+void parallel_pthreads_set_threads_num(int nthreads)
+{
+    ThreadPool::instance().setNumThreads(nthreads);
+}
+
+int parallel_pthreads_get_threads_num()
+{
+    return ThreadPool::instance().getNumThreads();
+}
+
+int parallel_pthreads_get_thread_num()
+{
+    return ThreadPool::instance().getThreadNum();
+}
+
+bool parallel_pthreads_submit(void (*func)(void*), void* arg)
+{
+    return ThreadPool::instance().submit(func, arg);
+}
+
+bool parallel_pthreads_run_queued_task()
+{
+    return ThreadPool::instance().runQueuedTask();
+}
+
+}
+
+#endif // HAVE_PTHREADS_PF
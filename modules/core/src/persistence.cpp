@@ -198,11 +198,26 @@ typedef void (*CvWriteString)( struct CvFileStorage* fs, const char* key,
 typedef void (*CvWriteComment)( struct CvFileStorage* fs, const char* comment, int eol_comment );
 typedef void (*CvStartNextStream)( struct CvFileStorage* fs );
 
+// the location of a top-level node value that has not been parsed yet
+// (see CV_STORAGE_LAZY); the node itself is tagged CV_NODE_LAZY and its data.i
+// is the index of the location in CvFileStorage::lazy_nodes
+typedef struct CvFSLazyNode
+{
+    size_t pos;     // offset of the line where the element starts
+    int col;        // column of the value (YAML) or of the opening tag (XML)
+    int indent;     // indentation of the key (YAML)
+    int lineno;
+}
+CvFSLazyNode;
+
+#define CV_NODE_LAZY CV_NODE_REF
+
 typedef struct CvFileStorage
 {
     int flags;
     int fmt;
     int write_mode;
+    int write_base64;
     int is_first;
     CvMemStorage* memstorage;
     CvMemStorage* dststorage;
@@ -238,6 +253,10 @@ typedef struct CvFileStorage
     size_t strbufsize, strbufpos;
     std::deque<char>* outbuf;
 
+    size_t line_pos, next_line_pos;
+    std::vector<CvFSLazyNode>* lazy_nodes;
+    cv::Mutex* lazy_mutex; // serializes the parsing of the lazy nodes
+
     bool is_opened;
 }
 CvFileStorage;
@@ -276,14 +295,22 @@ static char* icvGets( CvFileStorage* fs, char* str, int maxCount )
         fs->strbufpos = i;
         return j > 1 ? str : 0;
     }
+    char* ptr = 0;
     if( fs->file )
-        return fgets( str, maxCount, fs->file );
+        ptr = fgets( str, maxCount, fs->file );
 #if USE_ZLIB
-    if( fs->gzfile )
-        return gzgets( fs->gzfile, str, maxCount );
+    else if( fs->gzfile )
+        ptr = gzgets( fs->gzfile, str, maxCount );
 #endif
-    CV_Error( CV_StsError, "The storage is not opened" );
-    return 0;
+    else
+        CV_Error( CV_StsError, "The storage is not opened" );
+    if( ptr )
+    {
+        // keep track of the line offsets, so that the lazily parsed nodes can be found again
+        fs->line_pos = fs->next_line_pos;
+        fs->next_line_pos += strlen(ptr);
+    }
+    return ptr;
 }
 
 static int icvEof( CvFileStorage* fs )
@@ -323,6 +350,21 @@ static void icvRewind( CvFileStorage* fs )
         gzrewind(fs->gzfile);
 #endif
     fs->strbufpos = 0;
+    fs->line_pos = fs->next_line_pos = 0;
+}
+
+static void icvSeek( CvFileStorage* fs, size_t pos )
+{
+    int code = -1;
+    if( fs->file )
+        code = fseek( fs->file, (long)pos, SEEK_SET );
+#if USE_ZLIB
+    else if( fs->gzfile )
+        code = gzseek( fs->gzfile, (z_off_t)pos, SEEK_SET ) >= 0 ? 0 : -1;
+#endif
+    if( code != 0 )
+        CV_Error( CV_StsError, "Can not seek the file storage" );
+    fs->line_pos = fs->next_line_pos = pos;
 }
 
 #define CV_YML_INDENT  3
@@ -562,6 +604,8 @@ cvReleaseFileStorage( CvFileStorage** p_fs )
 
         if( fs->outbuf )
             delete fs->outbuf;
+        delete fs->lazy_nodes;
+        delete fs->lazy_mutex;
 
         memset( fs, 0, sizeof(*fs) );
         cvFree( &fs );
@@ -571,6 +615,21 @@ cvReleaseFileStorage( CvFileStorage** p_fs )
 
 #define CV_HASHVAL_SCALE 33
 
+static void icvFSResolveLazyNode( CvFileStorage* fs, CvFileNode* node );
+
+static inline CvFileNode* icvFSCheckLazyNode( const CvFileStorage* fs, CvFileNode* node )
+{
+    // the storage may be read from several threads; the node is parsed by the first of them
+    // and the others wait for it, since the parser uses the file and the buffer of the storage
+    if( fs->lazy_nodes )
+    {
+        cv::AutoLock lock(*fs->lazy_mutex);
+        if( CV_NODE_TYPE(node->tag) == CV_NODE_LAZY )
+            icvFSResolveLazyNode( (CvFileStorage*)fs, node );
+    }
+    return node;
+}
+
 CV_IMPL CvStringHashNode*
 cvGetHashedKey( CvFileStorage* fs, const char* str, int len, int create_missing )
 {
@@ -674,7 +733,7 @@ cvGetFileNode( CvFileStorage* fs, CvFileNode* _map_node,
             {
                 if( !create_missing )
                 {
-                    value = &another->value;
+                    value = icvFSCheckLazyNode( fs, &another->value );
                     return value;
                 }
                 CV_PARSE_ERROR( "Duplicated key" );
@@ -756,7 +815,7 @@ cvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const
                 key->str.len == len &&
                 memcmp( key->str.ptr, str, len ) == 0 )
             {
-                value = &another->value;
+                value = icvFSCheckLazyNode( fs, &another->value );
                 return value;
             }
         }
@@ -774,7 +833,24 @@ cvGetRootFileNode( const CvFileStorage* fs, int stream_index )
     if( !fs->roots || (unsigned)stream_index >= (unsigned)fs->roots->total )
         return 0;
 
-    return (CvFileNode*)cvGetSeqElem( fs->roots, stream_index );
+    CvFileNode* root = (CvFileNode*)cvGetSeqElem( fs->roots, stream_index );
+
+    // the root node may be traversed directly, so all its lazy elements are parsed here
+    if( fs->lazy_nodes && CV_NODE_IS_MAP(root->tag) )
+    {
+        CvSeqReader reader;
+        CvSet* map = (CvSet*)root->data.map;
+        cvStartReadSeq( (CvSeq*)map, &reader, 0 );
+        for( int i = 0; i < map->total; i++ )
+        {
+            CvFileMapNode* elem = (CvFileMapNode*)reader.ptr;
+            if( CV_IS_SET_ELEM(elem) )
+                icvFSCheckLazyNode( fs, &elem->value );
+            CV_NEXT_SEQ_ELEM( map->elem_size, reader );
+        }
+    }
+
+    return root;
 }
 
 
@@ -1337,6 +1413,64 @@ force_string:
 }
 
 
+static CvFileNode*
+icvFSAddLazyNode( CvFileStorage* fs, CvFileNode* elem, const CvFSLazyNode& pos )
+{
+    elem->tag = CV_NODE_LAZY | CV_NODE_NAMED;
+    elem->info = 0;
+    elem->data.i = (int)fs->lazy_nodes->size();
+    fs->lazy_nodes->push_back( pos );
+    return elem;
+}
+
+
+// indexes the top-level block map: only the keys are parsed, the values are skipped
+// and parsed on the first access (see icvFSResolveLazyNode)
+static char*
+icvYMLIndexValue( CvFileStorage* fs, char* ptr, CvFileNode* node )
+{
+    int indent = (int)(ptr - fs->buffer_start);
+    char* endptr = ptr;
+
+    if( *ptr != '-' && *ptr != '{' && *ptr != '[' && *ptr != '!' )
+    {
+        while( cv_isprint(*endptr) && *endptr != ':' )
+            endptr++;
+    }
+    if( *endptr != ':' )
+        return icvYMLParseValue( fs, ptr, node, CV_NODE_NONE, 0 );
+
+    memset( node, 0, sizeof(*node) );
+    icvFSCreateCollection( fs, CV_NODE_MAP, node );
+
+    for(;;)
+    {
+        CvFileNode* elem = 0;
+        CvFSLazyNode pos;
+
+        pos.pos = fs->line_pos;
+        pos.indent = indent;
+        pos.lineno = fs->lineno;
+        ptr = icvYMLParseKey( fs, ptr, node, &elem );
+        pos.col = (int)(ptr - fs->buffer_start);
+        icvFSAddLazyNode( fs, elem, pos );
+
+        // skip the rest of the line and all the lines with the larger indentation
+        do
+        {
+            ptr += strlen(ptr);
+            ptr = icvYMLSkipSpaces( fs, ptr, 0, INT_MAX );
+        }
+        while( ptr - fs->buffer_start > indent );
+
+        if( ptr - fs->buffer_start < indent || memcmp( ptr, "...", 3 ) == 0 )
+            break;
+    }
+
+    return ptr;
+}
+
+
 static void
 icvYMLParse( CvFileStorage* fs )
 {
@@ -1388,7 +1522,10 @@ icvYMLParse( CvFileStorage* fs )
             // 2. parse the collection
             CvFileNode* root_node = (CvFileNode*)cvSeqPush( fs->roots, 0 );
 
-            ptr = icvYMLParseValue( fs, ptr, root_node, CV_NODE_NONE, 0 );
+            if( fs->lazy_nodes )
+                ptr = icvYMLIndexValue( fs, ptr, root_node );
+            else
+                ptr = icvYMLParseValue( fs, ptr, root_node, CV_NODE_NONE, 0 );
             if( !CV_NODE_IS_COLLECTION(root_node->tag) )
                 CV_PARSE_ERROR( "Only collections as YAML streams are supported by this parser" );
 
@@ -1817,6 +1954,33 @@ static char*
 icvXMLParseTag( CvFileStorage* fs, char* ptr, CvStringHashNode** _tag,
                 CvAttrList** _list, int* _tag_type );
 
+// returns the element type specified by the type_id attribute
+static int
+icvXMLGetElemType( CvAttrList* list, CvTypeInfo** info )
+{
+    const char* type_name = list ? cvAttrValue( list, "type_id" ) : 0;
+    int elem_type = CV_NODE_NONE;
+
+    *info = 0;
+    if( type_name )
+    {
+        if( strcmp( type_name, "str" ) == 0 )
+            elem_type = CV_NODE_STRING;
+        else if( strcmp( type_name, "map" ) == 0 )
+            elem_type = CV_NODE_MAP;
+        else if( strcmp( type_name, "seq" ) == 0 )
+            elem_type = CV_NODE_SEQ;
+        else
+        {
+            *info = cvFindType( type_name );
+            if( *info )
+                elem_type = CV_NODE_USER;
+        }
+    }
+    return elem_type;
+}
+
+
 static char*
 icvXMLParseValue( CvFileStorage* fs, char* ptr, CvFileNode* node,
                   int value_type CV_DEFAULT(CV_NODE_NONE))
@@ -1849,8 +2013,7 @@ icvXMLParseValue( CvFileStorage* fs, char* ptr, CvFileNode* node,
             CvTypeInfo* info = 0;
             int tag_type = 0;
             int is_noname = 0;
-            const char* type_name = 0;
-            int elem_type = CV_NODE_NONE;
+            int elem_type;
 
             if( d == '/' || c == '\0' )
                 break;
@@ -1864,22 +2027,7 @@ icvXMLParseValue( CvFileStorage* fs, char* ptr, CvFileNode* node,
 
             assert( tag_type == CV_XML_OPENING_TAG );
 
-            type_name = list ? cvAttrValue( list, "type_id" ) : 0;
-            if( type_name )
-            {
-                if( strcmp( type_name, "str" ) == 0 )
-                    elem_type = CV_NODE_STRING;
-                else if( strcmp( type_name, "map" ) == 0 )
-                    elem_type = CV_NODE_MAP;
-                else if( strcmp( type_name, "seq" ) == 0 )
-                    elem_type = CV_NODE_SEQ;
-                else
-                {
-                    info = cvFindType( type_name );
-                    if( info )
-                        elem_type = CV_NODE_USER;
-                }
-            }
+            elem_type = icvXMLGetElemType( list, &info );
 
             is_noname = key->str.len == 1 && key->str.ptr[0] == '_';
             if( !CV_NODE_IS_COLLECTION(node->tag) )
@@ -2205,6 +2353,111 @@ icvXMLParseTag( CvFileStorage* fs, char* ptr, CvStringHashNode** _tag,
 }
 
 
+// skips the element content and the closing tag; the opening tag has been parsed already
+static char*
+icvXMLSkipElement( CvFileStorage* fs, char* ptr )
+{
+    int depth = 1, tag_type = 0;
+
+    for(;;)
+    {
+        char c = *ptr;
+        if( c == '\0' || c == '\n' || c == '\r' )
+        {
+            ptr = icvXMLSkipSpaces( fs, ptr, 0 );
+            if( *ptr == '\0' )
+                CV_PARSE_ERROR( "Preliminary end of the stream" );
+            continue;
+        }
+        if( c != '<' )
+        {
+            ptr += strcspn( ptr + 1, "<\n\r" ) + 1;
+            continue;
+        }
+        if( ptr[1] == '!' && ptr[2] == '-' && ptr[3] == '-' )
+        {
+            ptr = icvXMLSkipSpaces( fs, ptr, 0 );
+            continue;
+        }
+
+        tag_type = ptr[1] == '/' ? CV_XML_CLOSING_TAG :
+                   ptr[1] == '?' || ptr[1] == '!' ? CV_XML_DIRECTIVE_TAG : CV_XML_OPENING_TAG;
+        // find the end of the tag, which may span several lines
+        for( ;; )
+        {
+            c = *++ptr;
+            if( c == '>' )
+                break;
+            if( c == '\0' || c == '\n' || c == '\r' )
+            {
+                ptr = icvXMLSkipSpaces( fs, ptr, CV_XML_INSIDE_TAG );
+                if( *ptr == '\0' )
+                    CV_PARSE_ERROR( "Preliminary end of the stream" );
+                ptr--;
+            }
+        }
+        if( tag_type == CV_XML_OPENING_TAG && ptr[-1] == '/' )
+            tag_type = CV_XML_EMPTY_TAG;
+        ptr++;
+
+        if( tag_type == CV_XML_OPENING_TAG )
+            depth++;
+        else if( tag_type == CV_XML_CLOSING_TAG && --depth == 0 )
+            break;
+    }
+
+    return ptr;
+}
+
+
+// indexes the elements of <opencv_storage>: only the tags are parsed, the element content
+// is skipped and parsed on the first access (see icvFSResolveLazyNode)
+static char*
+icvXMLIndexValue( CvFileStorage* fs, char* ptr, CvFileNode* node )
+{
+    memset( node, 0, sizeof(*node) );
+
+    for(;;)
+    {
+        CvStringHashNode* key = 0;
+        CvAttrList* list = 0;
+        int tag_type = 0;
+        CvFSLazyNode pos;
+
+        ptr = icvXMLSkipSpaces( fs, ptr, 0 );
+        if( *ptr == '\0' || (ptr[0] == '<' && ptr[1] == '/') )
+            break;
+
+        // the sequences and the scalar values are parsed as usual
+        if( ptr[0] != '<' || (ptr[1] == '_' && (ptr[2] == '>' || cv_isspace(ptr[2]))) )
+        {
+            if( node->tag != CV_NODE_NONE )
+                CV_PARSE_ERROR( "Map element should have a name" );
+            return icvXMLParseValue( fs, ptr, node, CV_NODE_NONE );
+        }
+
+        pos.pos = fs->line_pos;
+        pos.col = (int)(ptr - fs->buffer_start);
+        pos.indent = 0;
+        pos.lineno = fs->lineno;
+
+        ptr = icvXMLParseTag( fs, ptr, &key, &list, &tag_type );
+        if( tag_type == CV_XML_DIRECTIVE_TAG )
+            CV_PARSE_ERROR( "Directive tags are not allowed here" );
+        if( tag_type == CV_XML_EMPTY_TAG )
+            CV_PARSE_ERROR( "Empty tags are not supported" );
+
+        if( !CV_NODE_IS_COLLECTION(node->tag) )
+            icvFSCreateCollection( fs, CV_NODE_MAP, node );
+        icvFSAddLazyNode( fs, cvGetFileNode( fs, node, key, 1 ), pos );
+
+        ptr = icvXMLSkipElement( fs, ptr );
+    }
+
+    return ptr;
+}
+
+
 static void
 icvXMLParse( CvFileStorage* fs )
 {
@@ -2249,7 +2502,10 @@ icvXMLParse( CvFileStorage* fs )
                 CV_PARSE_ERROR( "<opencv_storage> tag is missing" );
 
             root_node = (CvFileNode*)cvSeqPush( fs->roots, 0 );
-            ptr = icvXMLParseValue( fs, ptr, root_node, CV_NODE_NONE );
+            if( fs->lazy_nodes )
+                ptr = icvXMLIndexValue( fs, ptr, root_node );
+            else
+                ptr = icvXMLParseValue( fs, ptr, root_node, CV_NODE_NONE );
             ptr = icvXMLParseTag( fs, ptr, &key2, &list, &tag_type );
             if( tag_type != CV_XML_CLOSING_TAG || key != key2 )
                 CV_PARSE_ERROR( "</opencv_storage> tag is missing" );
@@ -2261,6 +2517,45 @@ icvXMLParse( CvFileStorage* fs )
 }
 
 
+// parses the value of the top-level node indexed by icvYMLIndexValue or icvXMLIndexValue
+static void
+icvFSResolveLazyNode( CvFileStorage* fs, CvFileNode* node )
+{
+    const CvFSLazyNode pos = (*fs->lazy_nodes)[node->data.i];
+    int max_size = (int)(fs->buffer_end - fs->buffer_start);
+    char* ptr;
+
+    icvSeek( fs, pos.pos );
+    fs->lineno = pos.lineno;
+    fs->dummy_eof = 0;
+    ptr = icvGets( fs, fs->buffer_start, max_size );
+    if( !ptr || (int)strlen(ptr) < pos.col )
+        CV_PARSE_ERROR( "The file storage has been modified" );
+    ptr += pos.col;
+
+    if( fs->fmt == CV_STORAGE_FORMAT_XML )
+    {
+        CvStringHashNode *key = 0, *key2 = 0;
+        CvAttrList* list = 0;
+        CvTypeInfo* info = 0;
+        int tag_type = 0;
+
+        ptr = icvXMLParseTag( fs, ptr, &key, &list, &tag_type );
+        ptr = icvXMLParseValue( fs, ptr, node, icvXMLGetElemType( list, &info ) );
+        node->info = info;
+        ptr = icvXMLParseTag( fs, ptr, &key2, &list, &tag_type );
+        if( tag_type != CV_XML_CLOSING_TAG || key2 != key )
+            CV_PARSE_ERROR( "Mismatched closing tag" );
+    }
+    else
+    {
+        ptr = icvYMLSkipSpaces( fs, ptr, pos.indent + 1, INT_MAX );
+        icvYMLParseValue( fs, ptr, node, CV_NODE_MAP, pos.indent + 1 );
+    }
+    node->tag |= CV_NODE_NAMED;
+}
+
+
 /****************************************************************************************\
 *                                       XML Emitter                                      *
 \****************************************************************************************/
@@ -2679,6 +2974,7 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
 
     fs->flags = CV_FILE_STORAGE;
     fs->write_mode = write_mode;
+    fs->write_base64 = write_mode && (flags & CV_STORAGE_BASE64) != 0;
 
     if( !mem )
     {
@@ -2701,7 +2997,9 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
 
         if( !isGZ )
         {
-            fs->file = fopen(fs->filename, !fs->write_mode ? "rt" : !append ? "wt" : "a+t" );
+            // the lazily parsed storages seek to the line offsets counted by icvGets()
+            fs->file = fopen(fs->filename, !fs->write_mode ? (flags & CV_STORAGE_LAZY ? "rb" : "rt") :
+                             !append ? "wt" : "a+t" );
             if( !fs->file )
                 goto _exit_;
         }
@@ -2874,6 +3172,9 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
         fs->buffer[0] = '\n';
         fs->buffer[1] = '\0';
 
+        if( !mem && (flags & CV_STORAGE_LAZY) )
+            fs->lazy_nodes = new std::vector<CvFSLazyNode>;
+
         //mode = cvGetErrMode();
         //cvSetErrMode( CV_ErrModeSilent );
         if( fs->fmt == CV_STORAGE_FORMAT_XML )
@@ -2883,8 +3184,18 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
         //cvSetErrMode( mode );
 
         // release resources that we do not need anymore
-        cvFree( &fs->buffer_start );
-        fs->buffer = fs->buffer_end = 0;
+        if( fs->lazy_nodes && fs->lazy_nodes->empty() )
+        {
+            delete fs->lazy_nodes;
+            fs->lazy_nodes = 0;
+        }
+        if( !fs->lazy_nodes )
+        {
+            cvFree( &fs->buffer_start );
+            fs->buffer = fs->buffer_end = 0;
+        }
+        else
+            fs->lazy_mutex = new cv::Mutex;
     }
     fs->is_opened = true;
 
@@ -2895,7 +3206,7 @@ _exit_:
         {
             cvReleaseFileStorage( &fs );
         }
-        else if( !fs->write_mode )
+        else if( !fs->write_mode && !fs->lazy_nodes )
         {
             icvCloseFile(fs);
             // we close the file since it's not needed anymore. But icvCloseFile() resets is_opened,
@@ -3471,6 +3782,161 @@ cvGetFileNodeName( const CvFileNode* file_node )
 #define CV_TYPE_NAME_SEQ_TREE "opencv-sequence-tree"
 #define CV_TYPE_NAME_GRAPH "opencv-graph"*/
 
+/******************************* base64 ******************************/
+
+/* In the storages opened with CV_STORAGE_BASE64 the data of the dense matrices is written
+   as a sequence of strings: the "$base64$" marker followed by the base64-encoded element values
+   in the little-endian byte order, ICV_BASE64_LINE_SIZE bytes per string. The data is encoded
+   line by line, so the whole text is never kept in memory. */
+
+#define ICV_BASE64_MARKER "$base64$"
+
+enum { ICV_BASE64_LINE_SIZE = 384 }; // multiple of 3 and of the largest element size
+
+static const char icvBase64Chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+#if ( defined( WORDS_BIGENDIAN ) && !defined( OPENCV_UNIVERSAL_BUILD ) ) || defined( __BIG_ENDIAN__ )
+static void
+icvSwapBytes( uchar* data, size_t size, int elem_size )
+{
+    for( size_t i = 0; i < size; i += elem_size )
+        std::reverse( data + i, data + i + elem_size );
+}
+#define ICV_BASE64_SWAP_BYTES 1
+#endif
+
+static int
+icvBase64Encode( const uchar* src, int len, char* dst )
+{
+    char* dst0 = dst;
+    for( int i = 0; i < len; i += 3, dst += 4 )
+    {
+        int b0 = src[i], b1 = i+1 < len ? src[i+1] : 0, b2 = i+2 < len ? src[i+2] : 0;
+        dst[0] = icvBase64Chars[b0 >> 2];
+        dst[1] = icvBase64Chars[((b0 & 3) << 4) | (b1 >> 4)];
+        dst[2] = i+1 < len ? icvBase64Chars[((b1 & 15) << 2) | (b2 >> 6)] : '=';
+        dst[3] = i+2 < len ? icvBase64Chars[b2 & 63] : '=';
+    }
+    *dst = '\0';
+    return (int)(dst - dst0);
+}
+
+static int
+icvBase64Value( char c )
+{
+    return 'A' <= c && c <= 'Z' ? c - 'A' : 'a' <= c && c <= 'z' ? c - 'a' + 26 :
+           '0' <= c && c <= '9' ? c - '0' + 52 : c == '+' ? 62 : c == '/' ? 63 : -1;
+}
+
+// decodes the string to dst, which has room for max_len bytes; returns the decoded length or -1 on error
+static int
+icvBase64Decode( const char* src, int len, uchar* dst, size_t max_len )
+{
+    int i, n = 0;
+    if( len % 4 != 0 )
+        return -1;
+    for( i = 0; i < len; i += 4 )
+    {
+        int v0 = icvBase64Value(src[i]), v1 = icvBase64Value(src[i+1]);
+        int v2 = src[i+2] == '=' ? 0 : icvBase64Value(src[i+2]);
+        int v3 = src[i+3] == '=' ? 0 : icvBase64Value(src[i+3]);
+        int count = src[i+2] == '=' ? 1 : src[i+3] == '=' ? 2 : 3;
+        if( (v0 | v1 | v2 | v3) < 0 || (count < 3 && i + 4 < len) || (size_t)(n + count) > max_len )
+            return -1;
+        dst[n] = (uchar)((v0 << 2) | (v1 >> 4));
+        if( count > 1 )
+            dst[n+1] = (uchar)((v1 << 4) | (v2 >> 2));
+        if( count > 2 )
+            dst[n+2] = (uchar)((v2 << 6) | v3);
+        n += count;
+    }
+    return n;
+}
+
+// writes the element values of the "data" sequence of a matrix
+class CvBase64Writer
+{
+public:
+    CvBase64Writer( CvFileStorage* _fs, int _elem_size ) : fs(_fs), elem_size(_elem_size), count(0)
+    {
+        cvWriteString( fs, 0, ICV_BASE64_MARKER, 1 );
+    }
+
+    void write( const uchar* data, size_t len )
+    {
+        while( len > 0 )
+        {
+            int n = (int)std::min( len, (size_t)(ICV_BASE64_LINE_SIZE - count) );
+            memcpy( buf + count, data, n );
+            count += n;
+            data += n;
+            len -= n;
+            if( count == ICV_BASE64_LINE_SIZE )
+                flush();
+        }
+    }
+
+    void flush()
+    {
+        if( count == 0 )
+            return;
+#ifdef ICV_BASE64_SWAP_BYTES
+        icvSwapBytes( buf, count, elem_size );
+#endif
+        char line[ICV_BASE64_LINE_SIZE*4/3 + 4];
+        icvBase64Encode( buf, count, line );
+        cvWriteString( fs, 0, line, 1 );
+        count = 0;
+    }
+
+private:
+    CvFileStorage* fs;
+    int elem_size, count;
+    uchar buf[ICV_BASE64_LINE_SIZE];
+};
+
+static bool
+icvIsBase64Data( const CvFileNode* node )
+{
+    if( !node || !CV_NODE_IS_SEQ(node->tag) || node->data.seq->total == 0 )
+        return false;
+    const CvFileNode* first = (const CvFileNode*)cvGetSeqElem( node->data.seq, 0 );
+    return CV_NODE_IS_STRING(first->tag) && strcmp( first->data.str.ptr, ICV_BASE64_MARKER ) == 0;
+}
+
+// reads the data written by CvBase64Writer; size is the expected number of bytes
+static void
+icvReadBase64Data( const CvFileNode* node, uchar* data, size_t size, int elem_size )
+{
+    CvSeqReader reader;
+    size_t ofs = 0;
+    int i, total = node->data.seq->total;
+
+    cvStartReadSeq( node->data.seq, &reader, 0 );
+    for( i = 1; i < total; i++ )
+    {
+        // skip the marker
+        CV_NEXT_SEQ_ELEM( sizeof(CvFileNode), reader );
+
+        const CvFileNode* line = (const CvFileNode*)reader.ptr;
+        if( !CV_NODE_IS_STRING(line->tag) )
+            CV_Error( CV_StsError, "The base64 data contains a non-string element" );
+        int n = icvBase64Decode( line->data.str.ptr, line->data.str.len, data + ofs, size - ofs );
+        if( n < 0 )
+            CV_Error( CV_StsError, "Invalid base64 data" );
+        ofs += n;
+    }
+
+    if( ofs != size )
+        CV_Error( CV_StsUnmatchedSizes, "The matrix size does not match to the size of the stored data" );
+#ifdef ICV_BASE64_SWAP_BYTES
+    icvSwapBytes( data, size, elem_size );
+#else
+    (void)elem_size;
+#endif
+}
+
 /******************************* CvMat ******************************/
 
 static int
@@ -3494,9 +3960,11 @@ icvWriteMat( CvFileStorage* fs, const char* name,
     cvWriteInt( fs, "rows", mat->rows );
     cvWriteInt( fs, "cols", mat->cols );
     cvWriteString( fs, "dt", icvEncodeFormat( CV_MAT_TYPE(mat->type), dt ), 0 );
-    cvStartWriteStruct( fs, "data", CV_NODE_SEQ + CV_NODE_FLOW );
 
     size = cvGetSize(mat);
+    bool base64 = fs->write_base64 && size.height > 0 && size.width > 0 && mat->data.ptr;
+    cvStartWriteStruct( fs, "data", CV_NODE_SEQ + (base64 ? 0 : CV_NODE_FLOW) );
+
     if( size.height > 0 && size.width > 0 && mat->data.ptr )
     {
         if( CV_IS_MAT_CONT(mat->type) )
@@ -3505,8 +3973,16 @@ icvWriteMat( CvFileStorage* fs, const char* name,
             size.height = 1;
         }
 
-        for( y = 0; y < size.height; y++ )
-            cvWriteRawData( fs, mat->data.ptr + (size_t)y*mat->step, size.width, dt );
+        if( base64 )
+        {
+            CvBase64Writer writer( fs, CV_ELEM_SIZE1(mat->type) );
+            for( y = 0; y < size.height; y++ )
+                writer.write( mat->data.ptr + (size_t)y*mat->step, (size_t)size.width*CV_ELEM_SIZE(mat->type) );
+            writer.flush();
+        }
+        else
+            for( y = 0; y < size.height; y++ )
+                cvWriteRawData( fs, mat->data.ptr + (size_t)y*mat->step, size.width, dt );
     }
     cvEndWriteStruct( fs );
     cvEndWriteStruct( fs );
@@ -3543,6 +4019,14 @@ icvReadMat( CvFileStorage* fs, CvFileNode* node )
     if( !data )
         CV_Error( CV_StsError, "The matrix data is not found in file storage" );
 
+    if( icvIsBase64Data( data ) )
+    {
+        mat = cvCreateMat( rows, cols, elem_type );
+        icvReadBase64Data( data, mat->data.ptr, (size_t)rows*cols*CV_ELEM_SIZE(elem_type),
+                           CV_ELEM_SIZE1(elem_type) );
+        return mat;
+    }
+
     int nelems = icvFileNodeSeqLen( data );
     if( nelems > 0 && nelems != rows*cols*CV_MAT_CN(elem_type) )
         CV_Error( CV_StsUnmatchedSizes,
@@ -3590,15 +4074,27 @@ icvWriteMatND( CvFileStorage* fs, const char* name,
     cvWriteRawData( fs, sizes, dims, "i" );
     cvEndWriteStruct( fs );
     cvWriteString( fs, "dt", icvEncodeFormat( cvGetElemType(mat), dt ), 0 );
-    cvStartWriteStruct( fs, "data", CV_NODE_SEQ + CV_NODE_FLOW );
+
+    bool base64 = fs->write_base64 && mat->dim[0].size > 0 && mat->data.ptr;
+    cvStartWriteStruct( fs, "data", CV_NODE_SEQ + (base64 ? 0 : CV_NODE_FLOW) );
 
     if( mat->dim[0].size > 0 && mat->data.ptr )
     {
         cvInitNArrayIterator( 1, (CvArr**)&mat, 0, &stub, &iterator );
 
-        do
-            cvWriteRawData( fs, iterator.ptr[0], iterator.size.width, dt );
-        while( cvNextNArraySlice( &iterator ));
+        if( base64 )
+        {
+            int elem_type = cvGetElemType(mat);
+            CvBase64Writer writer( fs, CV_ELEM_SIZE1(elem_type) );
+            do
+                writer.write( iterator.ptr[0], (size_t)iterator.size.width*CV_ELEM_SIZE(elem_type) );
+            while( cvNextNArraySlice( &iterator ));
+            writer.flush();
+        }
+        else
+            do
+                cvWriteRawData( fs, iterator.ptr[0], iterator.size.width, dt );
+            while( cvNextNArraySlice( &iterator ));
     }
     cvEndWriteStruct( fs );
     cvEndWriteStruct( fs );
@@ -3640,6 +4136,14 @@ icvReadMatND( CvFileStorage* fs, CvFileNode* node )
     for( total_size = CV_MAT_CN(elem_type), i = 0; i < dims; i++ )
         total_size *= sizes[i];
 
+    if( icvIsBase64Data( data ) )
+    {
+        mat = cvCreateMatND( dims, sizes, elem_type );
+        icvReadBase64Data( data, mat->data.ptr, (size_t)total_size*CV_ELEM_SIZE1(elem_type),
+                           CV_ELEM_SIZE1(elem_type) );
+        return mat;
+    }
+
     int nelems = icvFileNodeSeqLen( data );
 
     if( nelems > 0 && nelems != total_size )
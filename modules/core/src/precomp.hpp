@@ -194,6 +194,7 @@ struct NoVec
 extern volatile bool USE_SSE2;
 extern volatile bool USE_SSE4_2;
 extern volatile bool USE_AVX;
+extern volatile bool USE_AVX2;
 
 enum { BLOCK_SIZE = 1024 };
 
@@ -246,6 +247,19 @@ struct CoreTLSData
 
 extern TLSData<CoreTLSData> coreTlsData;
 
+// reads the size from the environment variable; accepts "KB" and "MB" suffixes
+size_t getConfigurationParameterForSize(const char* name, size_t defaultValue);
+
+#if defined HAVE_PTHREADS_PF
+// the pthreads based thread pool, implemented in parallel_pthreads.cpp
+void parallel_for_pthreads(const Range& stripes, const ParallelLoopBody& body);
+void parallel_pthreads_set_threads_num(int nthreads);
+int parallel_pthreads_get_threads_num();
+int parallel_pthreads_get_thread_num();
+bool parallel_pthreads_submit(void (*func)(void*), void* arg);
+bool parallel_pthreads_run_queued_task();
+#endif
+
 #if defined(BUILD_SHARED_LIBS)
 #if defined WIN32 || defined _WIN32 || defined WINCE
 #define CL_RUNTIME_EXPORT __declspec(dllexport)
@@ -0,0 +1,287 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+#include "precomp.hpp"
+
+namespace cv
+{
+
+namespace
+{
+
+struct ScratchArena;
+
+// the header placed in front of every block handed out by the arena
+struct ScratchBlock
+{
+    ScratchArena* arena;
+    ScratchBlock* prev;  // the block allocated right before this one
+    size_t size;         // the size requested by the caller
+    int chunk;           // index of the arena chunk the block resides in
+    int freed;           // set (atomically) when the block is released
+};
+
+enum
+{
+    SCRATCH_HEADER_SIZE = (sizeof(ScratchBlock) + CV_MALLOC_ALIGN - 1) & -CV_MALLOC_ALIGN,
+    SCRATCH_MIN_CHUNK_SIZE = 1 << 16
+};
+
+static inline size_t blockSpace(const ScratchBlock* b)
+{
+    return SCRATCH_HEADER_SIZE + alignSize(b->size, CV_MALLOC_ALIGN);
+}
+
+struct ScratchArena
+{
+    ScratchArena() : top(0), depth(0) {}
+
+    ~ScratchArena()
+    {
+        popFreed();
+        // blocks that are still referenced keep their chunks alive
+        if( !top )
+            releaseChunks();
+    }
+
+    void* allocate(size_t size)
+    {
+        popFreed();
+
+        size_t need = SCRATCH_HEADER_SIZE + alignSize(size, CV_MALLOC_ALIGN);
+        size_t c = 0, ofs = 0, nchunks = chunks.size();
+        if( top )
+        {
+            c = top->chunk;
+            ofs = (uchar*)top - chunks[c] + blockSpace(top);
+        }
+        while( c < nchunks && ofs + need > chunkSizes[c] )
+        {
+            c++;
+            ofs = 0;
+        }
+        if( c == nchunks )
+            addChunk(std::max(need, nchunks > 0 ? chunkSizes.back()*2 : (size_t)SCRATCH_MIN_CHUNK_SIZE));
+
+        ScratchBlock* b = (ScratchBlock*)(chunks[c] + ofs);
+        b->arena = this;
+        b->prev = top;
+        b->size = size;
+        b->chunk = (int)c;
+        b->freed = 0;
+        top = b;
+
+        stats.allocations++;
+        stats.usedBytes += need;
+        stats.peakUsedBytes = std::max(stats.peakUsedBytes, stats.usedBytes);
+        return (uchar*)b + SCRATCH_HEADER_SIZE;
+    }
+
+    // pops the released blocks from the top of the stack
+    void popFreed()
+    {
+        while( top && CV_XADD(&top->freed, 0) != 0 )
+        {
+            stats.usedBytes -= blockSpace(top);
+            top = top->prev;
+        }
+    }
+
+    void addChunk(size_t size)
+    {
+        chunks.push_back((uchar*)fastMalloc(size));
+        chunkSizes.push_back(size);
+        stats.heapAllocations++;
+        stats.reservedBytes += size;
+    }
+
+    void releaseChunks()
+    {
+        for( size_t i = 0; i < chunks.size(); i++ )
+            fastFree(chunks[i]);
+        chunks.clear();
+        chunkSizes.clear();
+        stats.reservedBytes = 0;
+    }
+
+    // replaces several chunks with a single one, so that the next iterations
+    // are served from the contiguous memory
+    void compact()
+    {
+        popFreed();
+        if( top || chunks.size() <= 1 )
+            return;
+        size_t total = stats.reservedBytes;
+        releaseChunks();
+        addChunk(total);
+    }
+
+    std::vector<uchar*> chunks;
+    std::vector<size_t> chunkSizes;
+    ScratchBlock* top;
+    int depth;
+    ScratchArenaStats stats;
+};
+
+static inline ScratchArena* getScratchArena()
+{
+    // function-local, so that AutoBuffer can be used during the static initialization
+    static TLSData<ScratchArena> scratchArenaTls;
+    return scratchArenaTls.get();
+}
+
+static inline ScratchBlock* getScratchBlock(const void* ptr)
+{
+    return (ScratchBlock*)((uchar*)ptr - SCRATCH_HEADER_SIZE);
+}
+
+class ScratchMatAllocator : public MatAllocator
+{
+public:
+    UMatData* allocate(int dims, const int* sizes, int type,
+                       void* data0, size_t* step, int flags, UMatUsageFlags usageFlags) const
+    {
+        if( data0 || !ScratchScope::isActive() )
+            return Mat::getStdAllocator()->allocate(dims, sizes, type, data0, step, flags, usageFlags);
+
+        size_t total = CV_ELEM_SIZE(type);
+        for( int i = dims-1; i >= 0; i-- )
+        {
+            if( step )
+                step[i] = total;
+            total *= sizes[i];
+        }
+        size_t hdrsize = alignSize(sizeof(UMatData), CV_MALLOC_ALIGN);
+        uchar* block = (uchar*)scratchAlloc(hdrsize + total);
+        UMatData* u = new(block) UMatData(this);
+        u->data = u->origdata = block + hdrsize;
+        u->size = total;
+        return u;
+    }
+
+    bool allocate(UMatData* u, int /*accessFlags*/, UMatUsageFlags /*usageFlags*/) const
+    {
+        return u != 0;
+    }
+
+    void deallocate(UMatData* u) const
+    {
+        CV_Assert(u->urefcount >= 0);
+        CV_Assert(u->refcount >= 0);
+        if(u && u->refcount == 0)
+        {
+            u->~UMatData();
+            scratchFree(u);
+        }
+    }
+};
+
+}
+
+ScratchArenaStats::ScratchArenaStats()
+    : allocations(0), heapAllocations(0), reservedBytes(0), usedBytes(0), peakUsedBytes(0)
+{
+}
+
+ScratchScope::ScratchScope()
+{
+    getScratchArena()->depth++;
+}
+
+ScratchScope::~ScratchScope()
+{
+    ScratchArena* arena = getScratchArena();
+    if( --arena->depth == 0 )
+        arena->compact();
+}
+
+bool ScratchScope::isActive()
+{
+    return getScratchArena()->depth > 0;
+}
+
+void* scratchAlloc(size_t size)
+{
+    ScratchArena* arena = getScratchArena();
+    return arena->depth > 0 ? arena->allocate(size) : 0;
+}
+
+void scratchFree(void* ptr)
+{
+    if( !ptr )
+        return;
+    ScratchBlock* b = getScratchBlock(ptr);
+    CV_XADD(&b->freed, 1);
+    // only the owner thread may touch the arena; other threads just mark the block,
+    // it will be reclaimed by the owner during the next allocation
+    ScratchArena* arena = getScratchArena();
+    if( b->arena == arena && b == arena->top )
+        arena->popFreed();
+}
+
+size_t scratchSize(const void* ptr)
+{
+    return ptr ? getScratchBlock(ptr)->size : 0;
+}
+
+ScratchArenaStats getScratchArenaStats()
+{
+    ScratchArena* arena = getScratchArena();
+    arena->popFreed();
+    return arena->stats;
+}
+
+void resetScratchArenaStats()
+{
+    ScratchArenaStats& stats = getScratchArena()->stats;
+    stats.allocations = stats.heapAllocations = 0;
+    stats.peakUsedBytes = stats.usedBytes;
+}
+
+MatAllocator* getScratchAllocator()
+{
+    static MatAllocator* allocator = new ScratchMatAllocator();
+    return allocator;
+}
+
+}
@@ -251,11 +251,55 @@ struct HWFeatures
             f.have[CV_CPU_SSE4_2] = (cpuid_data[2] & (1<<20)) != 0;
             f.have[CV_CPU_POPCNT] = (cpuid_data[2] & (1<<23)) != 0;
             f.have[CV_CPU_AVX]    = (((cpuid_data[2] & (1<<28)) != 0)&&((cpuid_data[2] & (1<<27)) != 0));//OS uses XSAVE_XRSTORE and CPU support AVX
+
+            // the structured extended feature flags are reported by leaf 7
+            int cpuid_data_ex[4] = { 0, 0, 0, 0 };
+            if( f.have[CV_CPU_AVX] && getMaxCpuidLeaf() >= 7 )
+            {
+                cpuid_ex(cpuid_data_ex, 7, 0);
+                f.have[CV_CPU_AVX2] = (cpuid_data_ex[1] & (1<<5)) != 0;
+            }
         }
 
         return f;
     }
 
+    static int getMaxCpuidLeaf()
+    {
+        int cpuid_data[4] = { 0, 0, 0, 0 };
+        cpuid_ex(cpuid_data, 0, 0);
+        return cpuid_data[0];
+    }
+
+    static void cpuid_ex(int* cpuid_data, int leaf, int subleaf)
+    {
+    #if defined _MSC_VER && (defined _M_IX86 || defined _M_X64) && _MSC_FULL_VER >= 150030729
+        __cpuidex(cpuid_data, leaf, subleaf);
+    #elif defined __GNUC__ && (defined __i386__ || defined __x86_64__)
+        #ifdef __x86_64__
+        asm __volatile__
+        (
+         "cpuid\n\t"
+         :[eax]"=a"(cpuid_data[0]),[ebx]"=b"(cpuid_data[1]),[ecx]"=c"(cpuid_data[2]),[edx]"=d"(cpuid_data[3])
+         :"a"(leaf), "c"(subleaf)
+         : "cc"
+        );
+        #else
+        asm volatile
+        (
+         "movl %%ebx, %%esi\n\t"
+         "cpuid\n\t"
+         "xchgl %%ebx, %%esi\n\t"
+         : "=a"(cpuid_data[0]), "=S"(cpuid_data[1]), "=c"(cpuid_data[2]), "=d"(cpuid_data[3])
+         : "a"(leaf), "c"(subleaf)
+         : "cc"
+        );
+        #endif
+    #else
+        (void)cpuid_data; (void)leaf; (void)subleaf;
+    #endif
+    }
+
     int x86_family;
     bool have[MAX_FEATURE+1];
 };
@@ -290,12 +334,14 @@ IPPInitializer ippInitializer;
 volatile bool USE_SSE2 = featuresEnabled.have[CV_CPU_SSE2];
 volatile bool USE_SSE4_2 = featuresEnabled.have[CV_CPU_SSE4_2];
 volatile bool USE_AVX = featuresEnabled.have[CV_CPU_AVX];
+volatile bool USE_AVX2 = featuresEnabled.have[CV_CPU_AVX2];
 
 void setUseOptimized( bool flag )
 {
     useOptimizedFlag = flag;
     currentFeatures = flag ? &featuresEnabled : &featuresDisabled;
     USE_SSE2 = currentFeatures->have[CV_CPU_SSE2];
+    USE_AVX2 = currentFeatures->have[CV_CPU_AVX2];
 }
 
 bool useOptimized(void)
@@ -419,6 +465,32 @@ const String& getBuildInformation()
     return build_info;
 }
 
+size_t getConfigurationParameterForSize(const char* name, size_t defaultValue)
+{
+    const char* envValue = getenv(name);
+    if (envValue == NULL)
+    {
+        return defaultValue;
+    }
+    String value = envValue;
+    size_t pos = 0;
+    for (; pos < value.size(); pos++)
+    {
+        if (!isdigit(value[pos]))
+            break;
+    }
+    String valueStr = value.substr(0, pos);
+    String suffixStr = value.substr(pos, value.length() - pos);
+    int v = atoi(valueStr.c_str());
+    if (suffixStr.length() == 0)
+        return v;
+    else if (suffixStr == "MB" || suffixStr == "Mb" || suffixStr == "mb")
+        return (size_t)v * 1024 * 1024;
+    else if (suffixStr == "KB" || suffixStr == "Kb" || suffixStr == "kb")
+        return (size_t)v * 1024;
+    CV_ErrorNoReturn(Error::StsBadArg, format("Invalid value for %s parameter: %s", name, value.c_str()));
+}
+
 String format( const char* fmt, ... )
 {
     AutoBuffer<char, 1024> buf;
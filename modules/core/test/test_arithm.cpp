@@ -1563,6 +1563,65 @@ TEST(Core_round, CvRound)
     ASSERT_EQ(-4, cvRound(-3.5));
 }
 
+// the optimized element-wise kernels (SSE2 or, when the CPU has it, AVX2 chosen at runtime)
+// have to produce the same results as the generic code, including the row tails
+TEST(Core_Arithm, optimizedMatchesGeneric)
+{
+    RNG& rng = theRNG();
+    bool useOptimized = cv::useOptimized();
+
+    for( int depth = CV_8U; depth <= CV_64F; depth++ )
+    {
+        double lo = depth == CV_32S ? -1e6 : depth >= CV_32F ? -1e3 : cvtest::getMinVal(depth);
+        double hi = depth == CV_32S ? 1e6 : depth >= CV_32F ? 1e3 : cvtest::getMaxVal(depth);
+        Mat big1(13, 101, depth), big2(13, 101, depth);
+        cvtest::randUni(rng, big1, Scalar::all(lo), Scalar::all(hi));
+        cvtest::randUni(rng, big2, Scalar::all(lo), Scalar::all(hi));
+        big1.rowRange(0, 3).setTo(Scalar::all(7));
+        big2.rowRange(0, 3).setTo(Scalar::all(7));
+        Mat src1 = big1(Rect(1, 0, 99, 13)), src2 = big2(Rect(2, 0, 99, 13));
+
+        Mat dst[2][11];
+        for( int k = 0; k < 2; k++ )
+        {
+            cv::setUseOptimized(k == 0);
+            cv::add(src1, src2, dst[k][0]);
+            cv::subtract(src1, src2, dst[k][1]);
+            cv::min(src1, src2, dst[k][2]);
+            cv::max(src1, src2, dst[k][3]);
+            cv::absdiff(src1, src2, dst[k][4]);
+            for( int op = CMP_EQ; op <= CMP_NE; op++ )
+                cv::compare(src1, src2, dst[k][5 + op], op);
+        }
+        cv::setUseOptimized(useOptimized);
+
+        for( int i = 0; i < 11; i++ )
+            EXPECT_EQ(0, cvtest::norm(dst[0][i], dst[1][i], NORM_INF)) << "depth " << depth << ", op " << i;
+    }
+
+    Mat x(7, 203, CV_32F), y(7, 203, CV_32F);
+    cvtest::randUni(rng, x, Scalar::all(-80), Scalar::all(80));
+    cvtest::randUni(rng, y, Scalar::all(-80), Scalar::all(80));
+    Mat ax = cv::abs(x) + 1e-3, xd, yd;
+    x.convertTo(xd, CV_64F);
+    y.convertTo(yd, CV_64F);
+
+    Mat dst[2][5];
+    for( int k = 0; k < 2; k++ )
+    {
+        cv::setUseOptimized(k == 0);
+        cv::exp(x, dst[k][0]);
+        cv::log(ax, dst[k][1]);
+        cv::magnitude(x, y, dst[k][2]);
+        cv::magnitude(xd, yd, dst[k][3]);
+        cv::phase(x, y, dst[k][4], true);
+    }
+    cv::setUseOptimized(useOptimized);
+
+    for( int i = 0; i < 5; i++ )
+        EXPECT_LE(cvtest::norm(dst[0][i], dst[1][i], NORM_INF | NORM_RELATIVE), 1e-6) << "function " << i;
+}
+
 
 typedef testing::TestWithParam<Size> Mul1;
 
@@ -866,3 +866,84 @@ protected:
 };
 
 TEST(Core_DFT, complex_output) { Core_DFTComplexOutputTest test; test.safe_run(); }
+
+TEST(Core_DFT, plan)
+{
+    RNG& rng = theRNG();
+    const int flags[] = { 0, DFT_ROWS, DFT_SCALE, DFT_COMPLEX_OUTPUT, DFT_INVERSE, DFT_INVERSE + DFT_SCALE,
+                          DFT_INVERSE + DFT_REAL_OUTPUT, DFT_INVERSE + DFT_ROWS + DFT_REAL_OUTPUT };
+
+    for( int iter = 0; iter < 20; iter++ )
+    {
+        int rows = iter == 0 ? 1 : rng.uniform(1, 40), cols = iter == 1 ? 1 : rng.uniform(1, 40);
+        int depth = rng.uniform(0, 2) + CV_32F;
+        DFTPlan plan(Size(cols, rows), depth);
+        ASSERT_EQ(Size(cols, rows), plan.size());
+        ASSERT_EQ(depth, plan.depth());
+
+        for( int cn = 1; cn <= 2; cn++ )
+            for( size_t k = 0; k < sizeof(flags)/sizeof(flags[0]); k++ )
+            {
+                bool inv = (flags[k] & DFT_INVERSE) != 0;
+                int dcn = !inv && (flags[k] & DFT_COMPLEX_OUTPUT) ? 2 : inv && (flags[k] & DFT_REAL_OUTPUT) ? 1 : cn;
+                Mat src(rows, cols, CV_MAKETYPE(depth, cn));
+                // 1D transforms with the complex output do not fill the whole matrix
+                Mat dst(rows, cols, CV_MAKETYPE(depth, dcn), Scalar::all(123)), ref = dst.clone();
+                randu(src, Scalar::all(-1), Scalar::all(1));
+                dft(src, ref, flags[k]);
+                plan.execute(src, dst, flags[k]);
+                ASSERT_EQ(ref.type(), dst.type());
+                ASSERT_EQ(0, cvtest::norm(dst, ref, NORM_INF)) << "flags=" << flags[k] << " cn=" << cn;
+            }
+    }
+
+    DFTPlan plan(Size(16, 16), CV_32F);
+    Mat src(16, 17, CV_32F);
+    EXPECT_THROW(plan.execute(src, src), cv::Exception);
+    EXPECT_TRUE(DFTPlan().empty());
+}
+
+TEST(Core_DFT, parallel_radix4)
+{
+    int nthreads = getNumThreads();
+    bool useOptimized = cv::useOptimized();
+    RNG& rng = theRNG();
+    // power-of-2 lengths go through the radix-4 stages, the many rows through the parallel row pass
+    const Size sizes[] = { Size(1024, 1), Size(256, 300), Size(64, 1000), Size(4096, 16), Size(512, 256) };
+    const int flags[] = { 0, DFT_ROWS, DFT_COMPLEX_OUTPUT, DFT_INVERSE + DFT_SCALE, DFT_INVERSE + DFT_ROWS + DFT_REAL_OUTPUT };
+
+    for( size_t i = 0; i < sizeof(sizes)/sizeof(sizes[0]); i++ )
+        for( int cn = 1; cn <= 2; cn++ )
+            for( size_t k = 0; k < sizeof(flags)/sizeof(flags[0]); k++ )
+            {
+                bool inv = (flags[k] & DFT_INVERSE) != 0;
+                int dcn = !inv && (flags[k] & DFT_COMPLEX_OUTPUT) ? 2 : inv && (flags[k] & DFT_REAL_OUTPUT) ? 1 : cn;
+                // 1D transforms with the complex output do not fill the whole matrix
+                Mat src(sizes[i], CV_32FC(cn)), src64;
+                Mat ref = Mat::zeros(sizes[i], CV_32FC(dcn)), dst = ref.clone(), ref64 = Mat::zeros(sizes[i], CV_64FC(dcn));
+                rng.fill(src, RNG::UNIFORM, -1, 1);
+
+                setUseOptimized(false);
+                setNumThreads(1);
+                dft(src, ref, flags[k]);
+                setUseOptimized(true);
+                setNumThreads(4);
+                dft(src, dst, flags[k]);
+
+                src.convertTo(src64, CV_64F);
+                dft(src64, ref64, flags[k]);
+                ref64.convertTo(ref64, CV_32F);
+
+                double scale = cvtest::norm(ref64, NORM_INF);
+                ASSERT_EQ(ref.type(), dst.type());
+                EXPECT_LE(cvtest::norm(ref, ref64, NORM_INF), 1e-5*scale)
+                    << "size " << sizes[i] << ", cn " << cn << ", flags " << flags[k];
+                EXPECT_LE(cvtest::norm(dst, ref64, NORM_INF), 1e-5*scale)
+                    << "size " << sizes[i] << ", cn " << cn << ", flags " << flags[k];
+                EXPECT_LE(cvtest::norm(dst, ref, NORM_INF), 1e-5*scale)
+                    << "size " << sizes[i] << ", cn " << cn << ", flags " << flags[k];
+            }
+
+    setUseOptimized(useOptimized);
+    setNumThreads(nthreads);
+}
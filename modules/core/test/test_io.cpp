@@ -558,3 +558,168 @@ TEST(Core_InputOutput, FileStorage)
     sprintf(arr, "sprintf is hell %d", 666);
     EXPECT_NO_THROW(f << arr);
 }
+
+TEST(Core_InputOutput, FileStorage_base64)
+{
+    const char* exts[] = { ".xml", ".yml", ".xml.gz" };
+    const int types[] = { CV_8UC1, CV_8SC3, CV_16UC2, CV_16SC1, CV_32SC4, CV_32FC1, CV_64FC3 };
+    RNG& rng = theRNG();
+
+    for( size_t k = 0; k < sizeof(exts)/sizeof(exts[0]); k++ )
+    {
+        std::string file = cv::tempfile(exts[k]);
+        std::vector<Mat> mats;
+        {
+            FileStorage fs(file, FileStorage::WRITE + FileStorage::BASE64);
+            for( size_t i = 0; i < sizeof(types)/sizeof(types[0]); i++ )
+            {
+                Mat m(rng.uniform(1, 50), rng.uniform(1, 50), types[i]);
+                rng.fill(m, RNG::UNIFORM, Scalar::all(-1000), Scalar::all(1000));
+                // the non-continuous data is written row by row
+                if( i % 2 )
+                    m = m.colRange(0, (m.cols + 1)/2);
+                mats.push_back(m);
+                fs << format("m%d", (int)i) << m;
+            }
+            int sizes[] = { 3, 4, 5 };
+            Mat nd(3, sizes, CV_32FC2);
+            rng.fill(nd, RNG::UNIFORM, Scalar::all(-1), Scalar::all(1));
+            mats.push_back(nd);
+            fs << "nd" << nd << "empty" << Mat() << "value" << 42;
+        }
+
+        FileStorage fs(file, FileStorage::READ);
+        ASSERT_TRUE(fs.isOpened());
+        for( size_t i = 0; i < mats.size(); i++ )
+        {
+            Mat m;
+            fs[i + 1 < mats.size() ? format("m%d", (int)i) : String("nd")] >> m;
+            ASSERT_EQ(mats[i].type(), m.type());
+            ASSERT_EQ(mats[i].dims, m.dims);
+            EXPECT_EQ(0, cvtest::norm(mats[i], m, NORM_INF)) << exts[k] << " " << i;
+        }
+        Mat empty;
+        fs["empty"] >> empty;
+        EXPECT_TRUE(empty.empty());
+        EXPECT_EQ(42, (int)fs["value"]);
+        fs.release();
+        remove(file.c_str());
+    }
+}
+
+TEST(Core_InputOutput, FileStorage_lazy)
+{
+    const char* exts[] = { ".xml", ".yml", ".yml.gz" };
+    RNG& rng = theRNG();
+
+    for( size_t k = 0; k < sizeof(exts)/sizeof(exts[0]); k++ )
+    {
+        std::string file = cv::tempfile(exts[k]);
+        Mat m(20, 30, CV_32FC3), m_base64(10, 10, CV_8UC1);
+        rng.fill(m, RNG::UNIFORM, Scalar::all(-1), Scalar::all(1));
+        rng.fill(m_base64, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+        bool gz = k == 2;
+        {
+            FileStorage fs(file, FileStorage::WRITE + (gz ? FileStorage::BASE64 : 0));
+            fs << "first" << 1;
+            fs << "m" << m;
+            fs << "map" << "{" << "str" << "text with <>&\"' chars" << "seq" << "[" << 1 << 2.5 << "]" << "}";
+            fs << "seq" << "[:" << 1 << 2 << 3 << "]";
+            cvWriteComment(*fs, "comment", 0);
+            fs << "last" << "end";
+            if( gz )
+                fs << "m_base64" << m_base64;
+        }
+        if( !gz )
+        {
+            FileStorage fs(file, FileStorage::APPEND + FileStorage::BASE64);
+            ASSERT_TRUE(fs.isOpened());
+            fs << "m_base64" << m_base64;
+        }
+
+        FileStorage fs(file, FileStorage::READ + FileStorage::LAZY);
+        ASSERT_TRUE(fs.isOpened());
+        EXPECT_EQ(String("end"), (String)fs["last"]);
+        EXPECT_EQ(String("text with <>&\"' chars"), (String)fs["map"]["str"]);
+        EXPECT_EQ(2.5, (double)fs["map"]["seq"][1]);
+        Mat m1, m2;
+        fs["m"] >> m1;
+        EXPECT_EQ(0, cvtest::norm(m, m1, NORM_INF)) << exts[k];
+        // the second access returns the already parsed node
+        fs["m"] >> m1;
+        EXPECT_EQ(0, cvtest::norm(m, m1, NORM_INF)) << exts[k];
+        fs["m_base64"] >> m2;
+        EXPECT_EQ(0, cvtest::norm(m_base64, m2, NORM_INF)) << exts[k];
+        EXPECT_TRUE(fs["missing"].empty());
+
+        // the traversal of the roots parses the remaining nodes
+        // (the appended YAML data is the second stream)
+        std::vector<String> keys;
+        for( int i = 0; !fs.root(i).empty(); i++ )
+        {
+            FileNode root = fs.root(i);
+            for( FileNodeIterator it = root.begin(); it != root.end(); ++it )
+            {
+                keys.push_back((*it).name());
+                EXPECT_FALSE((*it).empty()) << (*it).name();
+            }
+        }
+        EXPECT_EQ(1, (int)fs.getFirstTopLevelNode());
+        EXPECT_EQ(6u, keys.size());
+        EXPECT_EQ(3, (int)fs["seq"].size());
+        EXPECT_EQ(3, (int)fs["seq"][2]);
+        fs.release();
+        remove(file.c_str());
+    }
+}
+
+class LazyReadInvoker : public ParallelLoopBody
+{
+public:
+    LazyReadInvoker(const FileStorage& _fs, std::vector<Mat>& _mats) : fs(&_fs), mats(&_mats) {}
+
+    void operator()(const Range& range) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+            (*fs)[format("m%d", i)] >> (*mats)[i];
+    }
+
+private:
+    const FileStorage* fs;
+    std::vector<Mat>* mats;
+};
+
+TEST(Core_InputOutput, FileStorage_lazy_parallel)
+{
+    const char* exts[] = { ".xml", ".yml" };
+    const int n = 64;
+    RNG& rng = theRNG();
+    int nthreads = getNumThreads();
+    setNumThreads(4);
+
+    for( size_t k = 0; k < sizeof(exts)/sizeof(exts[0]); k++ )
+    {
+        std::string file = cv::tempfile(exts[k]);
+        std::vector<Mat> mats(n), mats1(n);
+        {
+            FileStorage fs(file, FileStorage::WRITE);
+            for( int i = 0; i < n; i++ )
+            {
+                mats[i].create(10 + i, 7, CV_32FC1);
+                rng.fill(mats[i], RNG::UNIFORM, Scalar::all(-1), Scalar::all(1));
+                fs << format("m%d", i) << mats[i];
+            }
+        }
+
+        // the nodes are parsed on the first access from several threads at once
+        FileStorage fs(file, FileStorage::READ + FileStorage::LAZY);
+        ASSERT_TRUE(fs.isOpened());
+        parallel_for_(Range(0, n), LazyReadInvoker(fs, mats1), n);
+        for( int i = 0; i < n; i++ )
+            EXPECT_EQ(0, cvtest::norm(mats[i], mats1[i], NORM_INF)) << exts[k] << ", m" << i;
+        fs.release();
+        remove(file.c_str());
+    }
+
+    setNumThreads(nthreads);
+}
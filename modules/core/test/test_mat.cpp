@@ -1160,3 +1160,122 @@ TEST(Core_Mat, copyNx1ToVector)
 
     ASSERT_PRED_FORMAT2(cvtest::MatComparator(0, 0), ref_dst16, cv::Mat_<ushort>(dst16));
 }
+
+TEST(Core_Mat, bufferPoolAllocator)
+{
+    cv::MatAllocator* allocator = cv::Mat::getBufferPoolAllocator();
+    cv::BufferPoolController* pool = allocator->getBufferPoolController();
+    size_t maxReservedSize = pool->getMaxReservedSize();
+    pool->setMaxReservedSize(64*1024*1024);
+    pool->freeAllReservedBuffers();
+    ASSERT_EQ(0u, pool->getReservedSize());
+
+    const uchar* data = 0;
+    {
+        cv::Mat frame;
+        frame.allocator = allocator;
+        frame.create(480, 640, CV_8UC3);
+        data = frame.data;
+    }
+    EXPECT_GE(pool->getReservedSize(), (size_t)480*640*3);
+
+    // the same-sized frames reuse the released buffer
+    cv::Mat frame;
+    frame.allocator = allocator;
+    frame.create(480, 640, CV_8UC3);
+    EXPECT_EQ(data, frame.data);
+    EXPECT_EQ(0u, pool->getReservedSize());
+
+    // Mat::create() uses the default allocator
+    cv::Mat::setDefaultAllocator(allocator);
+    EXPECT_EQ(allocator, cv::Mat::getDefaultAllocator());
+    frame.release();
+    cv::Mat other(480, 640, CV_8UC3, cv::Scalar::all(1));
+    cv::Mat::setDefaultAllocator(NULL);
+    EXPECT_EQ(data, other.data);
+    EXPECT_EQ(cv::Mat::getStdAllocator(), cv::Mat::getDefaultAllocator());
+    other.release();
+
+    // the buffers exceeding 1/8 of the limit are not kept
+    pool->setMaxReservedSize(480*640*3*4);
+    EXPECT_EQ(0u, pool->getReservedSize());
+
+    // the least recently used buffers are evicted first
+    pool->setMaxReservedSize(40*1024);
+    {
+        cv::Mat b;
+        b.allocator = allocator;
+        b.create(1, 4160, CV_8U);
+    }
+    EXPECT_EQ(4160u, pool->getReservedSize());
+    {
+        std::vector<cv::Mat> v(9);
+        for( size_t i = 0; i < v.size(); i++ )
+        {
+            v[i].allocator = allocator;
+            v[i].create(1, 4096, CV_8U);
+        }
+    }
+    EXPECT_EQ(9u*4096, pool->getReservedSize());
+    {
+        cv::Mat b;
+        b.allocator = allocator;
+        b.create(1, 4096, CV_8U);
+        EXPECT_EQ(8u*4096, pool->getReservedSize());
+    }
+
+    pool->freeAllReservedBuffers();
+    EXPECT_EQ(0u, pool->getReservedSize());
+    pool->setMaxReservedSize(maxReservedSize);
+}
+
+TEST(Core_Mat, mappedMat)
+{
+    const int rows = 37, cols = 1000;
+    cv::Mat ref(rows, cols, CV_32FC1);
+    cv::randu(ref, cv::Scalar::all(-1), cv::Scalar::all(1));
+
+    // the matrix data follows a header of an arbitrary size
+    const size_t offset = 100;
+    std::string filename = cv::tempfile(".raw");
+    FILE* f = fopen(filename.c_str(), "wb");
+    ASSERT_TRUE(f != NULL);
+    std::vector<char> header(offset, 'h');
+    fwrite(&header[0], 1, offset, f);
+    fwrite(ref.data, ref.elemSize(), ref.total(), f);
+    fclose(f);
+
+    {
+        cv::MappedMat m(filename, rows, cols, CV_32FC1, cv::MappedMat::READ_ONLY, offset);
+        ASSERT_EQ(ref.size(), m.size());
+        EXPECT_TRUE(m.isContinuous());
+        EXPECT_EQ(0, cvtest::norm(ref, m, cv::NORM_INF));
+        EXPECT_TRUE(m.advise(cv::MappedMat::ADVISE_SEQUENTIAL));
+
+        // the number of rows is taken from the file size
+        cv::MappedMat all(filename, 0, cols, CV_32FC1, cv::MappedMat::READ_ONLY, offset);
+        EXPECT_EQ(rows, all.rows);
+
+        // the ROI keeps the mapping alive
+        cv::Mat roi = cv::MappedMat(filename, rows, cols, CV_32FC1, cv::MappedMat::READ_ONLY, offset).rowRange(10, 20);
+        EXPECT_EQ(0, cvtest::norm(ref.rowRange(10, 20), roi, cv::NORM_INF));
+    }
+
+    {
+        int sizes[] = { rows, cols };
+        cv::MappedMat m(filename, 2, sizes, CV_32FC1, cv::MappedMat::COPY_ON_WRITE, offset);
+        m.row(5).setTo(cv::Scalar::all(7));
+        EXPECT_EQ(7.f, m.at<float>(5, 3));
+    }
+
+    // the private modifications do not go to the file
+    {
+        cv::MappedMat m(filename, rows, cols, CV_32FC1, cv::MappedMat::READ_ONLY, offset);
+        EXPECT_EQ(0, cvtest::norm(ref, m, cv::NORM_INF));
+    }
+
+    EXPECT_THROW(cv::MappedMat(filename, rows + 1, cols, CV_32FC1, cv::MappedMat::READ_ONLY, offset), cv::Exception);
+    EXPECT_FALSE(cv::MappedMat().advise(cv::MappedMat::ADVISE_RANDOM));
+
+    remove(filename.c_str());
+}
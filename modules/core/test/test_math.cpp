@@ -2751,4 +2751,35 @@ TEST(CovariationMatrixVectorOfMatWithMean, accuracy)
     ASSERT_EQ(sDiff.dot(sDiff), 0.0);
 }
 
+TEST(Core_GEMM, large_inner_dim_32f)
+{
+    // the packed 32f GEMM must keep the accuracy of the double accumulation for the long dot products
+    RNG& rng = theRNG();
+    const int lens[] = { 1000, 8000 };
+    const int flags[] = { 0, GEMM_1_T, GEMM_2_T };
+
+    for( size_t i = 0; i < sizeof(lens)/sizeof(lens[0]); i++ )
+        for( size_t k = 0; k < sizeof(flags)/sizeof(flags[0]); k++ )
+        {
+            int len = lens[i];
+            Mat A = flags[k] & GEMM_1_T ? Mat(len, 64, CV_32F) : Mat(64, len, CV_32F);
+            Mat B = flags[k] & GEMM_2_T ? Mat(64, len, CV_32F) : Mat(len, 64, CV_32F);
+            Mat A64, B64, D, D64, ref, err;
+            rng.fill(A, RNG::UNIFORM, 0, 1);
+            rng.fill(B, RNG::UNIFORM, 0, 1);
+            A.convertTo(A64, CV_64F);
+            B.convertTo(B64, CV_64F);
+
+            gemm(A, B, 1, noArray(), 0, D, flags[k]);
+            gemm(A64, B64, 1, noArray(), 0, ref, flags[k]);
+            D.convertTo(D64, CV_64F);
+            divide(abs(D64 - ref), ref, err);
+
+            double maxerr = 0;
+            minMaxLoc(err, 0, &maxerr);
+            // a few ulp of the result
+            EXPECT_LE(maxerr, 3e-7) << "len " << len << ", flags " << flags[k];
+        }
+}
+
 /* End of file. */
@@ -48,3 +48,238 @@ TEST(Core_SaturateCast, NegativeNotClipped)
 
     ASSERT_EQ(0xffffffff, val);
 }
+
+namespace
+{
+
+class CountStripesBody : public cv::ParallelLoopBody
+{
+public:
+    CountStripesBody(Mat& _counts, bool _nested) : counts(&_counts), nested(_nested) {}
+
+    void operator()(const Range& r) const
+    {
+        for( int i = r.start; i < r.end; i++ )
+        {
+            if( nested )
+            {
+                Mat row = counts->row(i);
+                cv::parallel_for_(Range(0, row.cols), CountStripesBody(row, false));
+            }
+            else
+                counts->at<int>(i)++;
+        }
+    }
+
+protected:
+    Mat* counts;
+    bool nested;
+};
+
+class ThrowingBody : public cv::ParallelLoopBody
+{
+public:
+    void operator()(const Range& r) const
+    {
+        if( r.start <= 50 && 50 < r.end )
+            CV_Error(CV_StsBadArg, "stripe 50");
+    }
+};
+
+}
+
+TEST(Core_Parallel, all_stripes_processed_once)
+{
+    int nthreads = cv::getNumThreads();
+    int threads[] = { 1, 2, 4, 0, -1 };
+
+    for( size_t k = 0; k < sizeof(threads)/sizeof(threads[0]); k++ )
+    {
+        cv::setNumThreads(threads[k]);
+        for( int n = 1; n <= 1000; n += 333 )
+        {
+            Mat counts(1, n, CV_32S, Scalar(0));
+            cv::parallel_for_(Range(0, n), CountStripesBody(counts, false));
+            EXPECT_EQ(n, countNonZero(counts == 1)) << "threads=" << threads[k];
+
+            counts.setTo(Scalar(0));
+            cv::parallel_for_(Range(0, n), CountStripesBody(counts, false), 7);
+            EXPECT_EQ(n, countNonZero(counts == 1)) << "threads=" << threads[k];
+        }
+    }
+
+    cv::setNumThreads(nthreads);
+}
+
+TEST(Core_Parallel, nested)
+{
+    Mat counts(64, 64, CV_32S, Scalar(0));
+    cv::parallel_for_(Range(0, counts.rows), CountStripesBody(counts, true));
+    EXPECT_EQ((int)counts.total(), countNonZero(counts == 1));
+}
+
+TEST(Core_Parallel, exception_is_propagated)
+{
+    EXPECT_THROW(cv::parallel_for_(Range(0, 100), ThrowingBody()), cv::Exception);
+
+    Mat counts(1, 100, CV_32S, Scalar(0));
+    cv::parallel_for_(Range(0, 100), CountStripesBody(counts, false));
+    EXPECT_EQ(100, countNonZero(counts == 1));
+}
+
+namespace
+{
+
+// dst[i] = src[i] + 1
+class IncrementBody : public cv::ParallelLoopBody
+{
+public:
+    IncrementBody(const Mat& _src, const Mat& _dst) : src(_src.ptr<int>()), dst((int*)_dst.data) {}
+
+    void operator()(const Range& r) const
+    {
+        for( int i = r.start; i < r.end; i++ )
+            dst[i] = src[i] + 1;
+    }
+
+protected:
+    const int* src;
+    int* dst;
+};
+
+}
+
+TEST(Core_Async, dependencies)
+{
+    int nthreads = cv::getNumThreads();
+    int threads[] = { 1, 4, -1 };
+
+    for( size_t k = 0; k < sizeof(threads)/sizeof(threads[0]); k++ )
+    {
+        cv::setNumThreads(threads[k]);
+
+        const int n = 1000, nframes = 8;
+        std::vector<AsyncTask> results;
+        std::vector<Mat> a(nframes), b(nframes), c(nframes), d(nframes);
+
+        // a -> b, a -> c, (b, c) -> d for every frame; the frames are independent
+        for( int f = 0; f < nframes; f++ )
+        {
+            a[f] = Mat(1, n, CV_32S, Scalar(f));
+            b[f].create(1, n, CV_32S);
+            c[f].create(1, n, CV_32S);
+            d[f].create(1, n, CV_32S);
+
+            std::vector<AsyncTask> deps;
+            AsyncTask tb = cv::async(makePtr<IncrementBody>(a[f], b[f]), Range(0, n), deps);
+            AsyncTask tc = cv::async(makePtr<IncrementBody>(b[f], c[f]), Range(0, n), std::vector<AsyncTask>(1, tb));
+            deps.push_back(tb);
+            deps.push_back(tc);
+            results.push_back(cv::async(makePtr<IncrementBody>(c[f], d[f]), Range(0, n), deps, 10));
+        }
+
+        for( int f = 0; f < nframes; f++ )
+        {
+            ASSERT_NO_THROW(results[f].wait());
+            EXPECT_TRUE(results[f].ready());
+            EXPECT_EQ(0, cvtest::norm(d[f], Mat(1, n, CV_32S, Scalar(f + 3)), NORM_INF)) << "threads=" << threads[k];
+        }
+    }
+
+    cv::setNumThreads(nthreads);
+}
+
+TEST(Core_Async, exception_is_propagated_to_dependents)
+{
+    Mat counts(1, 100, CV_32S, Scalar(0));
+    AsyncTask failed = cv::async(makePtr<ThrowingBody>(), Range(0, 100));
+    AsyncTask dependent = cv::async(Ptr<ParallelLoopBody>(new CountStripesBody(counts, false)), Range(0, 100),
+                                    std::vector<AsyncTask>(1, failed));
+
+    EXPECT_THROW(failed.wait(), cv::Exception);
+    EXPECT_THROW(dependent.wait(), cv::Exception);
+    EXPECT_EQ(0, countNonZero(counts));
+
+    AsyncTask empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_NO_THROW(empty.wait());
+}
+
+namespace
+{
+
+void processScratchFrame(const Mat& frame)
+{
+    AutoBuffer<float> rowbuf(frame.cols*3);
+    AutoBuffer<Mat> planes(frame.rows + 100);
+    Mat tmp;
+    tmp.allocator = getScratchAllocator();
+    tmp.create(frame.size(), CV_32F);
+    frame.convertTo(tmp, CV_32F);
+    for( int i = 0; i < frame.cols*3; i++ )
+        rowbuf[i] = (float)i;
+    planes[0] = tmp;
+}
+
+}
+
+TEST(Core_ScratchArena, steady_state_has_no_heap_allocations)
+{
+    Mat frame(480, 640, CV_8U, Scalar(1));
+    EXPECT_FALSE(ScratchScope::isActive());
+    EXPECT_TRUE(scratchAlloc(100) == NULL);
+
+    for( int i = 0; i < 3; i++ )
+    {
+        ScratchScope scope;
+        processScratchFrame(frame);
+    }
+
+    resetScratchArenaStats();
+    for( int i = 0; i < 10; i++ )
+    {
+        ScratchScope scope;
+        EXPECT_TRUE(ScratchScope::isActive());
+        processScratchFrame(frame);
+    }
+    EXPECT_FALSE(ScratchScope::isActive());
+
+    ScratchArenaStats stats = getScratchArenaStats();
+    EXPECT_EQ(30u, stats.allocations);
+    EXPECT_EQ(0u, stats.heapAllocations);
+    EXPECT_EQ(0u, stats.usedBytes);
+    EXPECT_GE(stats.reservedBytes, stats.peakUsedBytes);
+    EXPECT_GE(stats.peakUsedBytes, frame.total()*sizeof(float));
+}
+
+TEST(Core_ScratchArena, escaped_blocks_stay_valid)
+{
+    Mat escaped;
+    void* block = 0;
+    {
+        ScratchScope scope;
+        block = scratchAlloc(1000);
+        ASSERT_TRUE(block != NULL);
+        EXPECT_EQ(1000u, scratchSize(block));
+        memset(block, 1, 1000);
+
+        escaped.allocator = getScratchAllocator();
+        escaped.create(100, 100, CV_8U);
+        escaped.setTo(Scalar(7));
+    }
+    EXPECT_GT(getScratchArenaStats().usedBytes, 0u);
+
+    // the memory of the escaped blocks must not be reused
+    {
+        ScratchScope scope;
+        AutoBuffer<uchar> buf(100000);
+        memset(buf, 0, 100000);
+    }
+    EXPECT_EQ(0, cvtest::norm(escaped, Mat(100, 100, CV_8U, Scalar(7)), NORM_INF));
+    EXPECT_EQ(1000, countNonZero(Mat(1, 1000, CV_8U, block)));
+
+    // the blocks may be released in any order
+    escaped.release();
+    scratchFree(block);
+    EXPECT_EQ(0u, getScratchArenaStats().usedBytes);
+}
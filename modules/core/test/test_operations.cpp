@@ -1240,3 +1240,103 @@ protected:
 };
 
 TEST(Core_SparseMat, iterations) { CV_SparseMatTest test; test.safe_run(); }
+
+TEST(Core_MatExpr, fusedEvaluation)
+{
+    RNG& rng = theRNG();
+
+    for( int depth = CV_8U; depth <= CV_64F; depth++ )
+    {
+        if( depth == CV_32S )
+            continue;
+        double lo = depth >= CV_32F ? -1e3 : cvtest::getMinVal(depth);
+        // keep the 16u products within int, where cv::multiply computes them
+        double hi = depth >= CV_32F ? 1e3 : depth == CV_16U ? 40000 : cvtest::getMaxVal(depth);
+        double eps = depth == CV_32F ? 1e-3 : depth == CV_64F ? 1e-9 : 0;
+        Mat big[3];
+        for( int i = 0; i < 3; i++ )
+        {
+            big[i].create(480, 643, depth);
+            cvtest::randUni(rng, big[i], Scalar::all(lo), Scalar::all(hi));
+        }
+
+        for( int k = 0; k < 2; k++ )
+        {
+            // the continuous and the non-continuous operands
+            Mat x = k == 0 ? big[0] : big[0](Rect(1, 2, 640, 470));
+            Mat y = k == 0 ? big[1] : big[1](Rect(0, 1, 640, 470));
+            Mat z = k == 0 ? big[2] : big[2](Rect(3, 0, 640, 470));
+            Mat t, ref, r;
+
+            // the reference results are computed with the intermediate results stored in matrices
+            t = x + y;
+            ref = t - z;
+            r = (x + y) - z;
+            EXPECT_LE(cvtest::norm(r, ref, NORM_INF), eps) << "depth " << depth;
+
+            t = abs(x - y);
+            ref = t > hi*0.25;
+            r = abs(x - y) > hi*0.25;
+            EXPECT_EQ(0, cvtest::norm(r, ref, NORM_INF)) << "depth " << depth;
+
+            t = x.mul(y);
+            t = t - z + 7;
+            ref = t <= 100.5;
+            r = (x.mul(y) - z + 7) <= 100.5;
+            EXPECT_EQ(0, cvtest::norm(r, ref, NORM_INF)) << "depth " << depth;
+
+            t = min(x, y);
+            t = abs(t - z);
+            ref = t + 3;
+            r = abs(min(x, y) - z) + 3;
+            EXPECT_LE(cvtest::norm(r, ref, NORM_INF), eps) << "depth " << depth;
+
+            t = abs(x - y);
+            ref = -t + z;
+            r = -abs(x - y) + z;
+            EXPECT_LE(cvtest::norm(r, ref, NORM_INF), eps) << "depth " << depth;
+
+            ref = x + y;
+            MatExpr e = x + y;
+            for( int i = 1; i < 12; i++ )
+            {
+                ref = ref + (i % 2 ? y : z);
+                e = e + (i % 2 ? y : z);
+            }
+            r = e;
+            EXPECT_LE(cvtest::norm(r, ref, NORM_INF), eps) << "depth " << depth;
+
+            t = abs(x - y);
+            Mat_<float> rf = abs(x - y) + 0.5, reff = t + 0.5;
+            EXPECT_LE(cvtest::norm(rf, reff, NORM_INF), eps) << "depth " << depth;
+
+            if( depth >= CV_32F )
+            {
+                t = x*0.5 + y*0.25;
+                t = t - z;
+                ref = t/z;
+                r = (x*0.5 + y*0.25 - z)/z;
+                EXPECT_LE(cvtest::norm(r, ref, NORM_INF), eps) << "depth " << depth;
+            }
+
+            if( depth == CV_64F )
+            {
+                // the 64f division is not fused, so it matches cv::divide exactly
+                t = x + y;
+                divide(t, z, ref);
+                r = (x + y)/z;
+                EXPECT_EQ(0, cvtest::norm(r, ref, NORM_INF));
+                divide(3., t, ref);
+                r = 3./(x + y);
+                EXPECT_EQ(0, cvtest::norm(r, ref, NORM_INF));
+            }
+
+            // the destination is one of the operands
+            t = x + y;
+            ref = t - z;
+            r = x.clone();
+            r = (r + y) - z;
+            EXPECT_LE(cvtest::norm(r, ref, NORM_INF), eps) << "depth " << depth;
+        }
+    }
+}
@@ -212,7 +212,13 @@ enum { IMREAD_UNCHANGED  = -1, // 8bit, color or not
        IMREAD_GRAYSCALE  = 0,  // 8bit, gray
        IMREAD_COLOR      = 1,  // ?, color
        IMREAD_ANYDEPTH   = 2,  // any depth, ?
-       IMREAD_ANYCOLOR   = 4   // ?, any color
+       IMREAD_ANYCOLOR   = 4,  // ?, any color
+       IMREAD_REDUCED_GRAYSCALE_2 = 16, // 8bit, gray, the image size reduced 2 times
+       IMREAD_REDUCED_COLOR_2     = 17, // 8bit, color, the image size reduced 2 times
+       IMREAD_REDUCED_GRAYSCALE_4 = 32, // ... 4 times
+       IMREAD_REDUCED_COLOR_4     = 33,
+       IMREAD_REDUCED_GRAYSCALE_8 = 64, // ... 8 times
+       IMREAD_REDUCED_COLOR_8     = 65
      };
 
 enum { IMWRITE_JPEG_QUALITY     = 1,
@@ -221,6 +227,7 @@ enum { IMWRITE_JPEG_QUALITY     = 1,
        IMWRITE_PNG_COMPRESSION  = 16,
        IMWRITE_PNG_STRATEGY     = 17,
        IMWRITE_PNG_BILEVEL      = 18,
+       IMWRITE_PNG_PARALLEL     = 19, // compress the bands of rows in parallel (0 or 1, default 0)
        IMWRITE_PXM_BINARY       = 32,
        IMWRITE_WEBP_QUALITY     = 64
      };
@@ -234,6 +241,15 @@ enum { IMWRITE_PNG_STRATEGY_DEFAULT      = 0,
 
 CV_EXPORTS_W Mat imread( const String& filename, int flags = IMREAD_COLOR );
 
+//! reads the region of the image (in the coordinates of the image read with the same flags);
+//! the JPEG, PNG and TIFF decoders skip most of the data outside of the region
+CV_EXPORTS Mat imread( const String& filename, const Rect& roi, int flags = IMREAD_COLOR );
+
+//! reads all the pages of a multi-page image (TIFF) and appends them to mats;
+//! the pages are decoded one at a time. Returns false if no page could be read
+CV_EXPORTS_W bool imreadmulti( const String& filename, CV_OUT std::vector<Mat>& mats,
+                               int flags = IMREAD_ANYCOLOR );
+
 CV_EXPORTS_W bool imwrite( const String& filename, InputArray img,
               const std::vector<int>& params = std::vector<int>());
 
@@ -241,10 +257,29 @@ CV_EXPORTS_W Mat imdecode( InputArray buf, int flags );
 
 CV_EXPORTS Mat imdecode( InputArray buf, int flags, Mat* dst);
 
+CV_EXPORTS Mat imdecode( InputArray buf, const Rect& roi, int flags );
+
 CV_EXPORTS_W bool imencode( const String& ext, InputArray img,
                             CV_OUT std::vector<uchar>& buf,
                             const std::vector<int>& params = std::vector<int>());
 
+//! encodes the image into the caller's memory of bufsize bytes (JPEG, PNG and WebP are encoded
+//! right there), size is set to the size of the encoded image. If it does not fit, returns false
+//! and size is set to the required bufsize; the content of buf is undefined then
+CV_EXPORTS bool imencode( const String& ext, InputArray img, uchar* buf, size_t bufsize,
+                          CV_OUT size_t& size, const std::vector<int>& params = std::vector<int>());
+
+//! decodes the buffers in parallel, reusing the decoders within every thread;
+//! the images that could not be decoded are left empty. Returns the number of decoded images
+CV_EXPORTS int imdecodeBatch( InputArrayOfArrays bufs, CV_OUT std::vector<Mat>& imgs,
+                              int flags = IMREAD_COLOR );
+
+//! encodes the images in parallel, reusing the encoders within every thread;
+//! returns false if some of the images could not be encoded (their buffers are left empty)
+CV_EXPORTS bool imencodeBatch( const String& ext, InputArrayOfArrays imgs,
+                               CV_OUT std::vector<std::vector<uchar> >& bufs,
+                               const std::vector<int>& params = std::vector<int>());
+
 } // cv
 
 
@@ -390,6 +425,43 @@ enum { CAP_PROP_GSTREAMER_QUEUE_LENGTH = 200 // default is 1
      };
 
 
+// Asynchronous capture: the frames are grabbed and decoded in a background thread.
+// It is turned on by setting CAP_PROP_ASYNC_QUEUE_SIZE of an opened capture, and
+// lasts until it is set to 0 (the queued frames are dropped then) or the capture is released
+enum { CAP_PROP_ASYNC_QUEUE_SIZE  = 250, // max number of the decoded frames waiting in the queue, 0 - synchronous capture (default)
+       CAP_PROP_ASYNC_POLICY      = 251, // what to do when the queue is full, CAP_ASYNC_BLOCK (default) or CAP_ASYNC_DROP_OLDEST
+       CAP_PROP_ASYNC_QUEUE_DEPTH = 252, // readonly, number of the frames in the queue
+       CAP_PROP_ASYNC_MAX_DEPTH   = 253, // readonly, max number of the frames that have been in the queue
+       CAP_PROP_ASYNC_DROPPED     = 254  // readonly, number of the frames dropped by CAP_ASYNC_DROP_OLDEST
+     };
+
+enum { CAP_ASYNC_BLOCK       = 0, // the background thread waits until a frame is read
+       CAP_ASYNC_DROP_OLDEST = 1  // the oldest frame in the queue is dropped
+     };
+
+
+// FFmpeg
+// CAP_PROP_FORMAT can also be set to CV_8UC1 to get the luma plane of the decoded frames
+// as is, without the conversion to BGR (CV_8UC3, the default)
+enum { CAP_PROP_FFMPEG_THREAD_COUNT     = 270, // number of the decoding threads, 0 - the number of CPUs (default)
+       CAP_PROP_FFMPEG_THREAD_TYPE      = 271, // combination of CAP_FFMPEG_THREAD_FRAME and CAP_FFMPEG_THREAD_SLICE
+       CAP_PROP_FFMPEG_SKIP_FRAME       = 272, // frames the decoder skips, one of CAP_FFMPEG_DISCARD_*
+       CAP_PROP_FFMPEG_SKIP_LOOP_FILTER = 273  // frames the decoder skips the loop (deblocking) filter for, one of CAP_FFMPEG_DISCARD_*
+     };
+
+enum { CAP_FFMPEG_THREAD_FRAME = 1, // decode several frames at once
+       CAP_FFMPEG_THREAD_SLICE = 2  // decode several slices of a frame at once
+     };
+
+enum { CAP_FFMPEG_DISCARD_NONE    = -16, // nothing
+       CAP_FFMPEG_DISCARD_DEFAULT = 0,   // useless packets like 0-size ones (default)
+       CAP_FFMPEG_DISCARD_NONREF  = 8,   // non-reference frames
+       CAP_FFMPEG_DISCARD_BIDIR   = 16,  // bidirectional frames
+       CAP_FFMPEG_DISCARD_NONKEY  = 32,  // everything except the keyframes
+       CAP_FFMPEG_DISCARD_ALL     = 48   // everything
+     };
+
+
 // PVAPI
 enum { CAP_PROP_PVAPI_MULTICASTIP               = 300, // ip for anable multicast master mode. 0 for disable multicast
        CAP_PROP_PVAPI_FRAMESTARTTRIGGERMODE     = 301  // FrameStartTriggerMode: Determines how a frame is initiated
@@ -0,0 +1,95 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::get;
+
+typedef std::tr1::tuple<std::string, bool> Ext_Batch_t;
+typedef perf::TestBaseWithParam<Ext_Batch_t> Ext_Batch;
+
+#ifdef HAVE_JPEG
+#  define JPEG_EXT std::string(".jpg"),
+#else
+#  define JPEG_EXT
+#endif
+#ifdef HAVE_PNG
+#  define PNG_EXT std::string(".png"),
+#else
+#  define PNG_EXT
+#endif
+
+#define IMAGE_EXTS testing::Values( JPEG_EXT PNG_EXT std::string(".bmp") )
+
+// a batch of smooth photo-like images, so that the codecs do a realistic amount of work
+static void makeImages( std::vector<Mat>& imgs, int count, Size size )
+{
+    imgs.resize( count );
+    for( int k = 0; k < count; k++ )
+    {
+        Mat& img = imgs[k];
+        img.create( size, CV_8UC3 );
+        randu( img, Scalar::all(0), Scalar::all(32) );
+        for( int y = 0; y < size.height; y++ )
+        {
+            uchar* row = img.ptr(y);
+            for( int x = 0; x < size.width*3; x++ )
+                row[x] = saturate_cast<uchar>( row[x] + ((x/3 + y + k*16) & 127) + (x % 3)*32 );
+        }
+    }
+}
+
+PERF_TEST_P(Ext_Batch, imdecodeBatch, testing::Combine( IMAGE_EXTS, testing::Bool() ))
+{
+    string ext = get<0>(GetParam());
+    bool batch = get<1>(GetParam());
+
+    std::vector<Mat> imgs, decoded;
+    makeImages( imgs, 32, Size(640, 480) );
+    std::vector<std::vector<uchar> > bufs( imgs.size() );
+    for( size_t i = 0; i < imgs.size(); i++ )
+        ASSERT_TRUE( imencode( ext, imgs[i], bufs[i] ) );
+
+    declare.time(60);
+
+    TEST_CYCLE()
+    {
+        if( batch )
+            imdecodeBatch( bufs, decoded );
+        else
+        {
+            decoded.resize( bufs.size() );
+            for( size_t i = 0; i < bufs.size(); i++ )
+                decoded[i] = imdecode( bufs[i], IMREAD_COLOR );
+        }
+    }
+
+    ASSERT_EQ( imgs.size(), decoded.size() );
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(Ext_Batch, imencodeBatch, testing::Combine( IMAGE_EXTS, testing::Bool() ))
+{
+    string ext = get<0>(GetParam());
+    bool batch = get<1>(GetParam());
+
+    std::vector<Mat> imgs;
+    makeImages( imgs, 32, Size(640, 480) );
+    std::vector<std::vector<uchar> > bufs( imgs.size() );
+
+    declare.time(60);
+
+    TEST_CYCLE()
+    {
+        if( batch )
+            imencodeBatch( ext, imgs, bufs );
+        else
+        {
+            for( size_t i = 0; i < imgs.size(); i++ )
+                imencode( ext, imgs[i], bufs[i] );
+        }
+    }
+
+    ASSERT_EQ( imgs.size(), bufs.size() );
+    SANITY_CHECK_NOTHING();
+}
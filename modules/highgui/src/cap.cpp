@@ -41,6 +41,7 @@
 
 #include "precomp.hpp"
 #include "cap_intelperc.hpp"
+#include "cap_async.hpp"
 
 #if defined _M_X64 && defined _MSC_VER && !defined CV_ICC
 #pragma optimize("",off)
@@ -571,8 +572,39 @@ VideoCapture& VideoCapture::operator >> (UMat& image)
     return *this;
 }
 
+// wraps the capture into VideoCapture_Async or unwraps it
+static bool setAsyncQueueSize(Ptr<CvCapture>& cap, Ptr<IVideoCapture>& icap, int size)
+{
+    VideoCapture_Async* async = dynamic_cast<VideoCapture_Async*>(icap.get());
+    if (async)
+    {
+        if (size > 0)
+            return async->setProperty(CAP_PROP_ASYNC_QUEUE_SIZE, size);
+        Ptr<IVideoCapture> wrapper = icap; // alive until it gives the capture back
+        async->detach(cap, icap);
+        return true;
+    }
+    if (size <= 0)
+        return true;
+    if (cap.empty() && icap.empty())
+        return false;
+
+    Ptr<VideoCapture_Async> wrapper = makePtr<VideoCapture_Async>(cap, icap, size);
+    cap.release();
+    icap.release();
+    if (!wrapper->isStarted())
+    {
+        wrapper->detach(cap, icap);
+        return false;
+    }
+    icap = wrapper;
+    return true;
+}
+
 bool VideoCapture::set(int propId, double value)
 {
+    if (propId == CAP_PROP_ASYNC_QUEUE_SIZE)
+        return setAsyncQueueSize(cap, icap, cvRound(value));
     if (!icap.empty())
         return icap->setProperty(propId, value);
     return cvSetCaptureProperty(cap, propId, value) != 0;
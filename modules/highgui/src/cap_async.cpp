@@ -0,0 +1,530 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2008-2013, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and / or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+#include "cap_async.hpp"
+
+#include <deque>
+
+#if defined WIN32 || defined _WIN32
+#  if defined _WIN32_WINNT && _WIN32_WINNT >= 0x0600
+#    define HAVE_ASYNC_CAPTURE 1
+#    include <windows.h>
+#  endif
+#else
+#  define HAVE_ASYNC_CAPTURE 1
+#  include <pthread.h>
+#endif
+
+namespace cv
+{
+
+#ifdef HAVE_ASYNC_CAPTURE
+
+namespace
+{
+
+#if defined WIN32 || defined _WIN32
+
+class AsyncMutex
+{
+public:
+    AsyncMutex() { InitializeCriticalSection(&cs); }
+    ~AsyncMutex() { DeleteCriticalSection(&cs); }
+    void lock() { EnterCriticalSection(&cs); }
+    void unlock() { LeaveCriticalSection(&cs); }
+
+    CRITICAL_SECTION cs;
+};
+
+class AsyncCondition
+{
+public:
+    AsyncCondition() { InitializeConditionVariable(&cv); }
+    void wait( AsyncMutex& m ) { SleepConditionVariableCS(&cv, &m.cs, INFINITE); }
+    void notifyAll() { WakeAllConditionVariable(&cv); }
+
+    CONDITION_VARIABLE cv;
+};
+
+class AsyncThread
+{
+public:
+    AsyncThread() : handle(0) {}
+    bool start( void (*func)(void*), void* arg )
+    {
+        f = func; param = arg;
+        handle = CreateThread(0, 0, threadFunc, this, 0, 0);
+        return handle != 0;
+    }
+    void join()
+    {
+        if( handle )
+        {
+            WaitForSingleObject(handle, INFINITE);
+            CloseHandle(handle);
+            handle = 0;
+        }
+    }
+
+protected:
+    static DWORD WINAPI threadFunc( LPVOID arg )
+    {
+        AsyncThread* t = (AsyncThread*)arg;
+        t->f(t->param);
+        return 0;
+    }
+
+    HANDLE handle;
+    void (*f)(void*);
+    void* param;
+};
+
+#else
+
+class AsyncMutex
+{
+public:
+    AsyncMutex() { pthread_mutex_init(&mutex, 0); }
+    ~AsyncMutex() { pthread_mutex_destroy(&mutex); }
+    void lock() { pthread_mutex_lock(&mutex); }
+    void unlock() { pthread_mutex_unlock(&mutex); }
+
+    pthread_mutex_t mutex;
+};
+
+class AsyncCondition
+{
+public:
+    AsyncCondition() { pthread_cond_init(&cond, 0); }
+    ~AsyncCondition() { pthread_cond_destroy(&cond); }
+    void wait( AsyncMutex& m ) { pthread_cond_wait(&cond, &m.mutex); }
+    void notifyAll() { pthread_cond_broadcast(&cond); }
+
+    pthread_cond_t cond;
+};
+
+class AsyncThread
+{
+public:
+    AsyncThread() : started(false) {}
+    bool start( void (*func)(void*), void* arg )
+    {
+        f = func; param = arg;
+        started = pthread_create(&thread, 0, threadFunc, this) == 0;
+        return started;
+    }
+    void join()
+    {
+        if( started )
+        {
+            pthread_join(thread, 0);
+            started = false;
+        }
+    }
+
+protected:
+    static void* threadFunc( void* arg )
+    {
+        AsyncThread* t = (AsyncThread*)arg;
+        t->f(t->param);
+        return 0;
+    }
+
+    pthread_t thread;
+    bool started;
+    void (*f)(void*);
+    void* param;
+};
+
+#endif
+
+class AsyncLock
+{
+public:
+    AsyncLock( AsyncMutex& _m ) : m(&_m) { m->lock(); }
+    ~AsyncLock() { m->unlock(); }
+
+protected:
+    AsyncMutex* m;
+};
+
+// the VideoCapture that reads the frames in the background thread
+class WrappedCapture : public VideoCapture
+{
+public:
+    WrappedCapture( const Ptr<CvCapture>& _cap, const Ptr<IVideoCapture>& _icap )
+    {
+        cap = _cap;
+        icap = _icap;
+    }
+
+    void detach( Ptr<CvCapture>& _cap, Ptr<IVideoCapture>& _icap )
+    {
+        _cap = cap;
+        _icap = icap;
+        cap.release();
+        icap.release();
+    }
+
+    int getCaptureDomain()
+    {
+        return icap ? icap->getCaptureDomain() : cap ? cvGetCaptureDomain(cap) : CAP_ANY;
+    }
+};
+
+}
+
+/*
+   The background thread decodes the frames into the Mats taken from the pool and puts them to the
+   queue; grabFrame() takes the frame from the queue, and the Mat of the previous frame goes back
+   to the pool. So after a few frames the buffers are only reused, not allocated. retrieveFrame()
+   hands the frame over to the caller's Mat (and takes its buffer for the pool), when nobody else
+   references that Mat; otherwise the frame is copied.
+*/
+class VideoCapture_Async::Impl
+{
+public:
+    Impl( const Ptr<CvCapture>& cap, const Ptr<IVideoCapture>& icap, int queueSize ) :
+        capture(cap, icap), capacity(std::max(queueSize, 1)), policy(CAP_ASYNC_BLOCK),
+        stop(false), eof(false), generation(0), maxDepth(0), dropped(0), hasFrame(false)
+    {
+        started = thread.start(threadFunc, this);
+    }
+
+    ~Impl()
+    {
+        stopThread();
+    }
+
+    void stopThread()
+    {
+        {
+            AsyncLock lock(mutex);
+            stop = true;
+            changed.notifyAll();
+        }
+        thread.join();
+    }
+
+    static void threadFunc( void* arg )
+    {
+        ((Impl*)arg)->run();
+    }
+
+    void run()
+    {
+        Mat frame;
+        for(;;)
+        {
+            {
+                AsyncLock lock(mutex);
+                // at the end of the stream wait for a seek
+                while( !stop && eof )
+                    changed.wait(mutex);
+                if( stop )
+                    break;
+                if( frame.empty() && !pool.empty() )
+                {
+                    frame = pool.back();
+                    pool.pop_back();
+                }
+            }
+
+            int64 gen;
+            bool ok;
+            {
+                // generation is only changed under capMutex, so it is consistent with the frame
+                AsyncLock lock(capMutex);
+                gen = generation;
+                ok = capture.read(frame);
+            }
+
+            AsyncLock lock(mutex);
+            while( ok && !stop && gen == generation &&
+                   (int)queue.size() >= capacity && policy == CAP_ASYNC_BLOCK )
+                changed.wait(mutex);
+            if( stop )
+                break;
+            if( gen != generation )
+                continue; // the capture has been repositioned meanwhile, the frame is stale
+            if( !ok )
+            {
+                eof = true;
+                changed.notifyAll();
+                continue;
+            }
+
+            while( (int)queue.size() >= capacity )
+            {
+                pool.push_back(queue.front());
+                queue.pop_front();
+                dropped++;
+            }
+            queue.push_back(frame);
+            frame.release();
+            maxDepth = std::max(maxDepth, (int)queue.size());
+            changed.notifyAll();
+        }
+    }
+
+    bool grabFrame()
+    {
+        AsyncLock lock(mutex);
+        last.release();
+        if( !current.empty() )
+            pool.push_back(current);
+        current.release();
+        hasFrame = false;
+
+        while( queue.empty() && !eof && !stop )
+            changed.wait(mutex);
+        if( queue.empty() )
+            return false;
+
+        current = queue.front();
+        queue.pop_front();
+        hasFrame = true;
+        changed.notifyAll();
+        return true;
+    }
+
+    bool retrieveFrame( int channel, OutputArray image )
+    {
+        // current and last are only touched by the caller's thread
+        if( channel != 0 || !hasFrame )
+        {
+            image.release();
+            return false;
+        }
+        if( !last.empty() )
+        {
+            last.copyTo(image);
+            return true;
+        }
+
+        if( image.kind() == _InputArray::MAT && !image.fixedType() && !image.fixedSize() )
+        {
+            Mat& dst = image.getMatRef();
+            if( dst.empty() || (dst.u && dst.u->refcount == 1) )
+            {
+                cv::swap(dst, current);
+                last = dst;
+                return true;
+            }
+        }
+        current.copyTo(image);
+        last = current;
+        return true;
+    }
+
+    double getProperty( int propIdx )
+    {
+        switch( propIdx )
+        {
+        case CAP_PROP_ASYNC_QUEUE_SIZE:
+            return capacity;
+        case CAP_PROP_ASYNC_POLICY:
+            return policy;
+        case CAP_PROP_ASYNC_QUEUE_DEPTH:
+        {
+            AsyncLock lock(mutex);
+            return (double)queue.size();
+        }
+        case CAP_PROP_ASYNC_MAX_DEPTH:
+        {
+            AsyncLock lock(mutex);
+            return maxDepth;
+        }
+        case CAP_PROP_ASYNC_DROPPED:
+        {
+            AsyncLock lock(mutex);
+            return (double)dropped;
+        }
+        }
+
+        AsyncLock lock(capMutex);
+        return capture.get(propIdx);
+    }
+
+    bool setProperty( int propIdx, double propVal )
+    {
+        switch( propIdx )
+        {
+        case CAP_PROP_ASYNC_QUEUE_SIZE:
+        case CAP_PROP_ASYNC_POLICY:
+        {
+            int value = cvRound(propVal);
+            if( propIdx == CAP_PROP_ASYNC_QUEUE_SIZE ? value < 1 :
+                value != CAP_ASYNC_BLOCK && value != CAP_ASYNC_DROP_OLDEST )
+                return false;
+            AsyncLock lock(mutex);
+            (propIdx == CAP_PROP_ASYNC_QUEUE_SIZE ? capacity : policy) = value;
+            changed.notifyAll();
+            return true;
+        }
+        case CAP_PROP_ASYNC_QUEUE_DEPTH:
+        case CAP_PROP_ASYNC_MAX_DEPTH:
+        case CAP_PROP_ASYNC_DROPPED:
+            return false;
+        }
+
+        AsyncLock lock(capMutex);
+        bool ok = capture.set(propIdx, propVal);
+        if( ok && (propIdx == CAP_PROP_POS_MSEC || propIdx == CAP_PROP_POS_FRAMES ||
+                   propIdx == CAP_PROP_POS_AVI_RATIO) )
+        {
+            // the queued frames are from the old position
+            AsyncLock lock2(mutex);
+            generation++;
+            for( ; !queue.empty(); queue.pop_front() )
+                pool.push_back(queue.front());
+            eof = false;
+            changed.notifyAll();
+        }
+        return ok;
+    }
+
+    WrappedCapture capture;
+    bool started;
+
+protected:
+    AsyncThread thread;
+    AsyncMutex capMutex; // guards capture
+    AsyncMutex mutex;    // guards the rest of the state shared with the background thread
+    AsyncCondition changed;
+
+    std::deque<Mat> queue;
+    std::vector<Mat> pool;
+    int capacity, policy;
+    bool stop, eof;
+    int64 generation;
+    int maxDepth;
+    int64 dropped;
+
+    Mat current, last;
+    bool hasFrame;
+};
+
+VideoCapture_Async::VideoCapture_Async( const Ptr<CvCapture>& cap, const Ptr<IVideoCapture>& icap, int queueSize )
+{
+    impl = makePtr<Impl>(cap, icap, queueSize);
+}
+
+VideoCapture_Async::~VideoCapture_Async()
+{
+}
+
+bool VideoCapture_Async::isStarted() const
+{
+    return impl->started;
+}
+
+void VideoCapture_Async::detach( Ptr<CvCapture>& cap, Ptr<IVideoCapture>& icap )
+{
+    impl->stopThread();
+    impl->capture.detach(cap, icap);
+}
+
+double VideoCapture_Async::getProperty( int propIdx )
+{
+    return impl->getProperty(propIdx);
+}
+
+bool VideoCapture_Async::setProperty( int propIdx, double propVal )
+{
+    return impl->setProperty(propIdx, propVal);
+}
+
+bool VideoCapture_Async::grabFrame()
+{
+    return impl->grabFrame();
+}
+
+bool VideoCapture_Async::retrieveFrame( int channel, OutputArray image )
+{
+    return impl->retrieveFrame(channel, image);
+}
+
+int VideoCapture_Async::getCaptureDomain()
+{
+    return impl->capture.getCaptureDomain();
+}
+
+#else
+
+// no threading primitives (Windows older than Vista), isStarted() is always false
+
+class VideoCapture_Async::Impl
+{
+public:
+    Impl( const Ptr<CvCapture>& _cap, const Ptr<IVideoCapture>& _icap ) : cap(_cap), icap(_icap) {}
+
+    Ptr<CvCapture> cap;
+    Ptr<IVideoCapture> icap;
+};
+
+VideoCapture_Async::VideoCapture_Async( const Ptr<CvCapture>& cap, const Ptr<IVideoCapture>& icap, int )
+{
+    impl = makePtr<Impl>(cap, icap);
+}
+
+VideoCapture_Async::~VideoCapture_Async() {}
+bool VideoCapture_Async::isStarted() const { return false; }
+
+void VideoCapture_Async::detach( Ptr<CvCapture>& cap, Ptr<IVideoCapture>& icap )
+{
+    cap = impl->cap;
+    icap = impl->icap;
+    impl->cap.release();
+    impl->icap.release();
+}
+
+double VideoCapture_Async::getProperty( int ) { return 0; }
+bool VideoCapture_Async::setProperty( int, double ) { return false; }
+bool VideoCapture_Async::grabFrame() { return false; }
+bool VideoCapture_Async::retrieveFrame( int, OutputArray ) { return false; }
+int VideoCapture_Async::getCaptureDomain() { return CAP_ANY; }
+
+#endif
+
+}
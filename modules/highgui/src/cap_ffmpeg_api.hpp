@@ -23,7 +23,18 @@ enum
     CV_FFMPEG_CAP_PROP_FRAME_HEIGHT=4,
     CV_FFMPEG_CAP_PROP_FPS=5,
     CV_FFMPEG_CAP_PROP_FOURCC=6,
-    CV_FFMPEG_CAP_PROP_FRAME_COUNT=7
+    CV_FFMPEG_CAP_PROP_FRAME_COUNT=7,
+    CV_FFMPEG_CAP_PROP_FORMAT=8,
+    CV_FFMPEG_CAP_PROP_THREAD_COUNT=270,
+    CV_FFMPEG_CAP_PROP_THREAD_TYPE=271,
+    CV_FFMPEG_CAP_PROP_SKIP_FRAME=272,
+    CV_FFMPEG_CAP_PROP_SKIP_LOOP_FILTER=273
+};
+
+enum
+{
+    CV_FFMPEG_FORMAT_GRAY=0, // CV_8UC1, the luma plane
+    CV_FFMPEG_FORMAT_BGR=16  // CV_8UC3
 };
 
 
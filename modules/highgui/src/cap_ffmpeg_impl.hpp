@@ -203,6 +203,31 @@ static int get_number_of_cpus(void)
 }
 
 
+// the pixel formats, which first plane is the 8-bit luma
+static bool hasLumaPlane(int pix_fmt)
+{
+    switch( pix_fmt )
+    {
+    case PIX_FMT_GRAY8:
+    case PIX_FMT_YUV420P:
+    case PIX_FMT_YUVJ420P:
+    case PIX_FMT_YUV422P:
+    case PIX_FMT_YUVJ422P:
+    case PIX_FMT_YUV444P:
+    case PIX_FMT_YUVJ444P:
+    case PIX_FMT_YUV440P:
+    case PIX_FMT_YUVJ440P:
+    case PIX_FMT_YUV411P:
+    case PIX_FMT_YUV410P:
+    case PIX_FMT_NV12:
+    case PIX_FMT_NV21:
+        return true;
+    default:
+        return false;
+    }
+}
+
+
 struct Image_FFMPEG
 {
     unsigned char* data;
@@ -235,6 +260,7 @@ struct CvCapture_FFMPEG
     void    seek(int64_t frame_number);
     void    seek(double sec);
     bool    slowSeek( int framenumber );
+    bool    reopenCodec( int thread_count, int thread_type );
 
     int64_t get_total_frames();
     double  get_duration_sec();
@@ -259,6 +285,7 @@ struct CvCapture_FFMPEG
 
     int64_t frame_number, first_frame_number;
 
+    bool luma_only;
     double eps_zero;
 /*
    'filename' contains the filename of the videosource,
@@ -287,6 +314,7 @@ void CvCapture_FFMPEG::init()
 
     avcodec = 0;
     frame_number = 0;
+    luma_only = false;
     eps_zero = 0.000025;
 }
 
@@ -712,25 +740,42 @@ bool CvCapture_FFMPEG::retrieveFrame(int, unsigned char** data, int* step, int*
     if( !video_st || !picture->data[0] )
         return false;
 
-    avpicture_fill((AVPicture*)&rgb_picture, rgb_picture.data[0], PIX_FMT_RGB24,
+    // the decoded luma plane is returned as is, no conversion is needed
+    if( luma_only && hasLumaPlane(video_st->codec->pix_fmt) )
+    {
+        *data = picture->data[0];
+        *step = picture->linesize[0];
+        *width = video_st->codec->width;
+        *height = video_st->codec->height;
+        *cn = 1;
+        return true;
+    }
+
+    int dst_cn = luma_only ? 1 : 3;
+
+    avpicture_fill((AVPicture*)&rgb_picture, rgb_picture.data[0],
+                   luma_only ? PIX_FMT_GRAY8 : PIX_FMT_BGR24,
                    video_st->codec->width, video_st->codec->height);
 
     if( img_convert_ctx == NULL ||
         frame.width != video_st->codec->width ||
-        frame.height != video_st->codec->height )
+        frame.height != video_st->codec->height ||
+        frame.cn != dst_cn )
     {
         if( img_convert_ctx )
             sws_freeContext(img_convert_ctx);
 
         frame.width = video_st->codec->width;
         frame.height = video_st->codec->height;
+        frame.cn = dst_cn;
+        frame.step = rgb_picture.linesize[0];
 
         img_convert_ctx = sws_getCachedContext(
                 NULL,
                 video_st->codec->width, video_st->codec->height,
                 video_st->codec->pix_fmt,
                 video_st->codec->width, video_st->codec->height,
-                PIX_FMT_BGR24,
+                luma_only ? PIX_FMT_GRAY8 : PIX_FMT_BGR24,
                 SWS_BICUBIC,
                 NULL, NULL, NULL
                 );
@@ -789,6 +834,20 @@ double CvCapture_FFMPEG::getProperty( int property_id )
 #else
         return (double)video_st->codec.codec_tag;
 #endif
+    case CV_FFMPEG_CAP_PROP_FORMAT:
+        return luma_only ? CV_FFMPEG_FORMAT_GRAY : CV_FFMPEG_FORMAT_BGR;
+    case CV_FFMPEG_CAP_PROP_THREAD_COUNT:
+        return (double)video_st->codec->thread_count;
+    case CV_FFMPEG_CAP_PROP_THREAD_TYPE:
+#ifdef FF_THREAD_FRAME
+        return (double)video_st->codec->thread_type;
+#else
+        return 0;
+#endif
+    case CV_FFMPEG_CAP_PROP_SKIP_FRAME:
+        return (double)video_st->codec->skip_frame;
+    case CV_FFMPEG_CAP_PROP_SKIP_LOOP_FILTER:
+        return (double)video_st->codec->skip_loop_filter;
     default:
         break;
     }
@@ -928,6 +987,42 @@ void CvCapture_FFMPEG::seek(double sec)
     seek((int64_t)(sec * get_fps() + 0.5));
 }
 
+// the threading parameters of a decoder can be changed only when it is opened
+bool CvCapture_FFMPEG::reopenCodec( int thread_count, int thread_type )
+{
+    AVCodecContext* enc = video_st->codec;
+    AVCodec* codec = avcodec_find_decoder(enc->codec_id);
+    if( !codec )
+        return false;
+
+    avcodec_close(enc);
+    enc->thread_count = thread_count > 0 ? thread_count : get_number_of_cpus();
+#ifdef FF_THREAD_FRAME
+    enc->thread_type = thread_type;
+#else
+    (void)thread_type;
+#endif
+
+    if(
+#if LIBAVCODEC_VERSION_INT >= ((53<<16)+(8<<8)+0)
+        avcodec_open2(enc, codec, NULL)
+#else
+        avcodec_open(enc, codec)
+#endif
+        < 0 )
+    {
+        CV_WARN("Could not reopen the codec");
+        close();
+        return false;
+    }
+
+    // the reopened decoder has no reference frames, so restart decoding at the current position
+    if( frame_number > 0 )
+        seek(frame_number);
+
+    return true;
+}
+
 bool CvCapture_FFMPEG::setProperty( int property_id, double value )
 {
     if( !video_st ) return false;
@@ -956,6 +1051,38 @@ bool CvCapture_FFMPEG::setProperty( int property_id, double value )
             picture_pts=(int64_t)value;
         }
         break;
+    case CV_FFMPEG_CAP_PROP_FORMAT:
+        if( value != CV_FFMPEG_FORMAT_GRAY && value != CV_FFMPEG_FORMAT_BGR )
+            return false;
+        luma_only = value == CV_FFMPEG_FORMAT_GRAY;
+        break;
+    case CV_FFMPEG_CAP_PROP_THREAD_COUNT:
+        if( value < 0 )
+            return false;
+#ifdef FF_THREAD_FRAME
+        return reopenCodec( (int)value, video_st->codec->thread_type );
+#else
+        return reopenCodec( (int)value, 0 );
+#endif
+    case CV_FFMPEG_CAP_PROP_THREAD_TYPE:
+#ifdef FF_THREAD_FRAME
+        if( value < 0 || ((int)value & ~(FF_THREAD_FRAME | FF_THREAD_SLICE)) != 0 )
+            return false;
+        return reopenCodec( video_st->codec->thread_count, (int)value );
+#else
+        return false;
+#endif
+    case CV_FFMPEG_CAP_PROP_SKIP_FRAME:
+        // both are checked by the decoder for every frame, so they can be changed at any time
+        if( value < AVDISCARD_NONE || value > AVDISCARD_ALL )
+            return false;
+        video_st->codec->skip_frame = (enum AVDiscard)(int)value;
+        break;
+    case CV_FFMPEG_CAP_PROP_SKIP_LOOP_FILTER:
+        if( value < AVDISCARD_NONE || value > AVDISCARD_ALL )
+            return false;
+        video_st->codec->skip_loop_filter = (enum AVDiscard)(int)value;
+        break;
     default:
         return false;
     }
@@ -51,9 +51,20 @@ BaseImageDecoder::BaseImageDecoder()
 {
     m_width = m_height = 0;
     m_type = -1;
+    m_scale_denom = 1;
     m_buf_supported = false;
 }
 
+int BaseImageDecoder::setScale( int scale_denom )
+{
+    return scale_denom;
+}
+
+bool BaseImageDecoder::setROI( const Rect& )
+{
+    return false;
+}
+
 bool BaseImageDecoder::setSource( const String& filename )
 {
     m_filename = filename;
@@ -88,7 +99,11 @@ ImageDecoder BaseImageDecoder::newDecoder() const
 
 BaseImageEncoder::BaseImageEncoder()
 {
+    m_buf = 0;
     m_buf_supported = false;
+    m_mem = 0;
+    m_mem_capacity = m_mem_size = 0;
+    m_mem_supported = false;
 }
 
 bool  BaseImageEncoder::isFormatSupported( int depth ) const
@@ -105,6 +120,7 @@ bool BaseImageEncoder::setDestination( const String& filename )
 {
     m_filename = filename;
     m_buf = 0;
+    m_mem = 0;
     return true;
 }
 
@@ -114,10 +130,46 @@ bool BaseImageEncoder::setDestination( std::vector<uchar>& buf )
         return false;
     m_buf = &buf;
     m_buf->clear();
+    m_mem = 0;
+    m_filename = String();
+    return true;
+}
+
+bool BaseImageEncoder::setDestination( uchar* buf, size_t capacity )
+{
+    if( !m_mem_supported )
+        return false;
+    CV_Assert( buf != 0 );
+    m_mem = buf;
+    m_mem_capacity = capacity;
+    m_mem_size = 0;
+    m_buf = 0;
     m_filename = String();
     return true;
 }
 
+size_t BaseImageEncoder::outputSize() const
+{
+    return m_buf ? m_buf->size() : m_mem_size;
+}
+
+void BaseImageEncoder::writeToBuf( const uchar* data, size_t size )
+{
+    if( m_buf )
+    {
+        size_t sz = m_buf->size();
+        m_buf->resize( sz + size );
+        memcpy( &(*m_buf)[sz], data, size );
+    }
+    else
+    {
+        CV_Assert( m_mem != 0 );
+        if( m_mem_size < m_mem_capacity )
+            memcpy( m_mem + m_mem_size, data, std::min( size, m_mem_capacity - m_mem_size ) );
+        m_mem_size += size;
+    }
+}
+
 ImageEncoder BaseImageEncoder::newEncoder() const
 {
     return ImageEncoder();
@@ -70,6 +70,18 @@ public:
     virtual bool readHeader() = 0;
     virtual bool readData( Mat& img ) = 0;
 
+    // requests the image reduced scale_denom times (must be called before readHeader());
+    // returns the reduction factor that is left to the caller
+    virtual int setScale( int scale_denom );
+
+    // restricts readData() to the region of the image (must be called after readHeader()),
+    // so that the passed Mat has the region size; returns false if the decoder does not support it
+    virtual bool setROI( const Rect& roi );
+
+    // switches to the next page of a multi-page image and reads its header;
+    // returns false if there are no more pages
+    virtual bool nextPage() { return false; }
+
     virtual size_t signatureLength() const;
     virtual bool checkSignature( const String& signature ) const;
     virtual ImageDecoder newDecoder() const;
@@ -78,6 +90,8 @@ protected:
     int  m_width;  // width  of the image ( filled by readHeader )
     int  m_height; // height of the image ( filled by readHeader )
     int  m_type;
+    int  m_scale_denom;
+    Rect m_roi;    // the region to decode, empty if the whole image is decoded
     String m_filename;
     String m_signature;
     Mat m_buf;
@@ -95,6 +109,14 @@ public:
 
     virtual bool setDestination( const String& filename );
     virtual bool setDestination( std::vector<uchar>& buf );
+
+    // sets the caller's memory of the given capacity as the destination (if m_mem_supported).
+    // An image that does not fit is still encoded to the end, so that outputSize()
+    // reports the capacity it needs; only the first capacity bytes are stored then
+    virtual bool setDestination( uchar* buf, size_t capacity );
+    // the size of the image written to the memory destination
+    size_t outputSize() const;
+
     virtual bool write( const Mat& img, const std::vector<int>& params ) = 0;
 
     virtual String getDescription() const;
@@ -103,12 +125,20 @@ public:
     virtual void throwOnEror() const;
 
 protected:
+    // appends the data to the memory destination, either the vector or the caller's memory
+    void writeToBuf( const uchar* data, size_t size );
+
     String m_description;
 
     String m_filename;
     std::vector<uchar>* m_buf;
     bool m_buf_supported;
 
+    uchar* m_mem;
+    size_t m_mem_capacity;
+    size_t m_mem_size;
+    bool m_mem_supported;
+
     String m_last_error;
 };
 
@@ -168,6 +168,29 @@ error_exit( j_common_ptr cinfo )
 }
 
 
+static bool isHuffTableEmpty( const JHUFF_TBL* table )
+{
+    if( !table )
+        return true;
+    for( int i = 1; i <= 16; i++ )
+        if( table->bits[i] != 0 )
+            return false;
+    return true;
+}
+
+
+static void resetHuffTables( j_decompress_ptr cinfo )
+{
+    for( int i = 0; i < NUM_HUFF_TBLS; i++ )
+    {
+        if( cinfo->dc_huff_tbl_ptrs[i] )
+            memset( cinfo->dc_huff_tbl_ptrs[i]->bits, 0, sizeof(cinfo->dc_huff_tbl_ptrs[i]->bits) );
+        if( cinfo->ac_huff_tbl_ptrs[i] )
+            memset( cinfo->ac_huff_tbl_ptrs[i]->bits, 0, sizeof(cinfo->ac_huff_tbl_ptrs[i]->bits) );
+    }
+}
+
+
 /////////////////////// JpegDecoder ///////////////////
 
 
@@ -183,10 +206,11 @@ JpegDecoder::JpegDecoder()
 JpegDecoder::~JpegDecoder()
 {
     close();
+    releaseState();
 }
 
 
-void  JpegDecoder::close()
+void  JpegDecoder::releaseState()
 {
     if( m_state )
     {
@@ -195,6 +219,20 @@ void  JpegDecoder::close()
         delete state;
         m_state = 0;
     }
+}
+
+
+void  JpegDecoder::close()
+{
+    // the decompressor that reads from memory is kept for the next image,
+    // so that decoding a sequence of buffers does not recreate it every time
+    if( m_state )
+    {
+        if( m_f )
+            releaseState();
+        else
+            jpeg_abort_decompress( &((JpegState*)m_state)->cinfo );
+    }
 
     if( m_f )
     {
@@ -204,6 +242,7 @@ void  JpegDecoder::close()
 
     m_width = m_height = 0;
     m_type = -1;
+    m_roi = Rect();
 }
 
 ImageDecoder JpegDecoder::newDecoder() const
@@ -211,19 +250,47 @@ ImageDecoder JpegDecoder::newDecoder() const
     return makePtr<JpegDecoder>();
 }
 
+// libjpeg reduces the image by 2, 4 or 8 times right in the IDCT
+int JpegDecoder::setScale( int scale_denom )
+{
+    m_scale_denom = 1;
+    while( m_scale_denom < 8 && m_scale_denom*2 <= scale_denom )
+        m_scale_denom *= 2;
+    return scale_denom / m_scale_denom;
+}
+
+bool JpegDecoder::setROI( const Rect& roi )
+{
+    m_roi = roi;
+    return true;
+}
+
 bool  JpegDecoder::readHeader()
 {
     bool result = false;
     close();
 
-    JpegState* state = new JpegState;
-    m_state = state;
-    state->cinfo.err = jpeg_std_error(&state->jerr.pub);
-    state->jerr.pub.error_exit = error_exit;
+    JpegState* state = (JpegState*)m_state;
+    bool reused = state != 0;
+    if( !state )
+    {
+        state = new JpegState;
+        m_state = state;
+        state->cinfo.err = jpeg_std_error(&state->jerr.pub);
+        state->jerr.pub.error_exit = error_exit;
+    }
 
     if( setjmp( state->jerr.setjmp_buffer ) == 0 )
     {
-        jpeg_create_decompress( &state->cinfo );
+        if( reused )
+        {
+            // the tables of the previous image stay in the decompressor; forget the
+            // Huffman ones, so that the MJPEG frames without DHT still get the default tables
+            state->cinfo.src = 0;
+            resetHuffTables( &state->cinfo );
+        }
+        else
+            jpeg_create_decompress( &state->cinfo );
 
         if( !m_buf.empty() )
         {
@@ -242,15 +309,23 @@ bool  JpegDecoder::readHeader()
         {
             jpeg_read_header( &state->cinfo, TRUE );
 
-            m_width = state->cinfo.image_width;
-            m_height = state->cinfo.image_height;
+            state->cinfo.scale_num = 1;
+            state->cinfo.scale_denom = m_scale_denom;
+            jpeg_calc_output_dimensions( &state->cinfo );
+
+            m_width = state->cinfo.output_width;
+            m_height = state->cinfo.output_height;
             m_type = state->cinfo.num_components > 1 ? CV_8UC3 : CV_8UC1;
             result = true;
         }
     }
 
     if( !result )
+    {
         close();
+        // the decompressor may be left in any state after an error
+        releaseState();
+    }
 
     return result;
 }
@@ -404,10 +479,10 @@ bool  JpegDecoder::readData( Mat& img )
         if( setjmp( jerr->setjmp_buffer ) == 0 )
         {
             /* check if this is a mjpeg image format */
-            if ( cinfo->ac_huff_tbl_ptrs[0] == NULL &&
-                cinfo->ac_huff_tbl_ptrs[1] == NULL &&
-                cinfo->dc_huff_tbl_ptrs[0] == NULL &&
-                cinfo->dc_huff_tbl_ptrs[1] == NULL )
+            if ( isHuffTableEmpty( cinfo->ac_huff_tbl_ptrs[0] ) &&
+                isHuffTableEmpty( cinfo->ac_huff_tbl_ptrs[1] ) &&
+                isHuffTableEmpty( cinfo->dc_huff_tbl_ptrs[0] ) &&
+                isHuffTableEmpty( cinfo->dc_huff_tbl_ptrs[1] ) )
             {
                 /* yes, this is a mjpeg image format, so load the correct
                 huffman table */
@@ -446,30 +521,53 @@ bool  JpegDecoder::readData( Mat& img )
 
             jpeg_start_decompress( cinfo );
 
+            Rect roi = m_roi.area() > 0 ? m_roi : Rect(0, 0, m_width, m_height);
+            int width = roi.width, xofs = roi.x;
+#ifdef LIBJPEG_TURBO_VERSION_NUMBER
+            // libjpeg-turbo can skip the columns (up to the iMCU boundary) and the rows
+            // outside of the region without decoding them
+            if( roi.width < m_width )
+            {
+                JDIMENSION crop_x = roi.x, crop_width = roi.width;
+                jpeg_crop_scanline( cinfo, &crop_x, &crop_width );
+                xofs = roi.x - (int)crop_x;
+            }
+            if( roi.y > 0 )
+                jpeg_skip_scanlines( cinfo, roi.y );
+#endif
+
             buffer = (*cinfo->mem->alloc_sarray)((j_common_ptr)cinfo,
                                               JPOOL_IMAGE, m_width*4, 1 );
 
+            while( (int)cinfo->output_scanline < roi.y )
+                jpeg_read_scanlines( cinfo, buffer, 1 );
+
             uchar* data = img.data;
-            for( ; m_height--; data += step )
+            for( int y = 0; y < roi.height; y++, data += step )
             {
                 jpeg_read_scanlines( cinfo, buffer, 1 );
+                const uchar* src = buffer[0] + xofs*cinfo->out_color_components;
                 if( color )
                 {
                     if( cinfo->out_color_components == 3 )
-                        icvCvt_RGB2BGR_8u_C3R( buffer[0], 0, data, 0, cvSize(m_width,1) );
+                        icvCvt_RGB2BGR_8u_C3R( src, 0, data, 0, cvSize(width,1) );
                     else
-                        icvCvt_CMYK2BGR_8u_C4C3R( buffer[0], 0, data, 0, cvSize(m_width,1) );
+                        icvCvt_CMYK2BGR_8u_C4C3R( src, 0, data, 0, cvSize(width,1) );
                 }
                 else
                 {
                     if( cinfo->out_color_components == 1 )
-                        memcpy( data, buffer[0], m_width );
+                        memcpy( data, src, width );
                     else
-                        icvCvt_CMYK2Gray_8u_C4C1R( buffer[0], 0, data, 0, cvSize(m_width,1) );
+                        icvCvt_CMYK2Gray_8u_C4C1R( src, 0, data, 0, cvSize(width,1) );
                 }
             }
             result = true;
-            jpeg_finish_decompress( cinfo );
+            // the rest of the image is not needed
+            if( cinfo->output_scanline < cinfo->output_height )
+                jpeg_abort_decompress( cinfo );
+            else
+                jpeg_finish_decompress( cinfo );
         }
     }
 
@@ -484,6 +582,10 @@ struct JpegDestination
 {
     struct jpeg_destination_mgr pub;
     std::vector<uchar> *buf, *dst;
+    // when dst is 0, the image is compressed right into the caller's memory; what does not
+    // fit there goes through buf and is only counted, so that mem_size is the full image size
+    size_t mem_capacity, mem_size;
+    bool overflow;
 };
 
 METHODDEF(void)
@@ -495,6 +597,11 @@ METHODDEF(void)
 term_destination (j_compress_ptr cinfo)
 {
     JpegDestination* dest = (JpegDestination*)cinfo->dest;
+    if( !dest->dst )
+    {
+        dest->mem_size += (dest->overflow ? dest->buf->size() : dest->mem_capacity) - dest->pub.free_in_buffer;
+        return;
+    }
     size_t sz = dest->dst->size(), bufsz = dest->buf->size() - dest->pub.free_in_buffer;
     if( bufsz > 0 )
     {
@@ -507,9 +614,18 @@ METHODDEF(boolean)
 empty_output_buffer (j_compress_ptr cinfo)
 {
     JpegDestination* dest = (JpegDestination*)cinfo->dest;
-    size_t sz = dest->dst->size(), bufsz = dest->buf->size();
-    dest->dst->resize(sz + bufsz);
-    memcpy( &(*dest->dst)[0] + sz, &(*dest->buf)[0], bufsz);
+    size_t bufsz = dest->buf->size();
+    if( !dest->dst )
+    {
+        dest->mem_size += dest->overflow ? bufsz : dest->mem_capacity;
+        dest->overflow = true;
+    }
+    else
+    {
+        size_t sz = dest->dst->size();
+        dest->dst->resize(sz + bufsz);
+        memcpy( &(*dest->dst)[0] + sz, &(*dest->buf)[0], bufsz);
+    }
 
     dest->pub.next_output_byte = &(*dest->buf)[0];
     dest->pub.free_in_buffer = bufsz;
@@ -530,6 +646,7 @@ JpegEncoder::JpegEncoder()
 {
     m_description = "JPEG files (*.jpeg;*.jpg;*.jpe)";
     m_buf_supported = true;
+    m_mem_supported = true;
 }
 
 
@@ -569,7 +686,21 @@ bool JpegEncoder::write( const Mat& img, const std::vector<int>& params )
     cinfo.err = jpeg_std_error(&jerr.pub);
     jerr.pub.error_exit = error_exit;
 
-    if( !m_buf )
+    if( m_mem )
+    {
+        dest.dst = 0;
+        dest.buf = &out_buf;
+        dest.mem_capacity = m_mem_capacity;
+        dest.mem_size = 0;
+        // libjpeg expects some room in the buffer from the very beginning
+        dest.overflow = m_mem_capacity == 0;
+
+        jpeg_buffer_dest( &cinfo, &dest );
+
+        dest.pub.next_output_byte = dest.overflow ? &out_buf[0] : m_mem;
+        dest.pub.free_in_buffer = dest.overflow ? out_buf.size() : m_mem_capacity;
+    }
+    else if( !m_buf )
     {
         fw.f = fopen( m_filename.c_str(), "wb" );
         if( !fw.f )
@@ -652,6 +783,8 @@ bool JpegEncoder::write( const Mat& img, const std::vector<int>& params )
         }
 
         jpeg_finish_compress( &cinfo );
+        if( m_mem )
+            m_mem_size = dest.mem_size;
         result = true;
     }
 
@@ -63,11 +63,15 @@ public:
     bool  readData( Mat& img );
     bool  readHeader();
     void  close();
+    int   setScale( int scale_denom );
+    bool  setROI( const Rect& roi );
 
     ImageDecoder newDecoder() const;
 
 protected:
 
+    void  releaseState();
+
     FILE* m_f;
     void* m_state;
 };
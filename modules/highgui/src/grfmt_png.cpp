@@ -120,6 +120,17 @@ void  PngDecoder::close()
         png_destroy_read_struct( &png_ptr, &info_ptr, &end_info );
         m_png_ptr = m_info_ptr = m_end_info = 0;
     }
+    m_roi = Rect();
+}
+
+
+// the rows of the interlaced images are spread over the whole stream
+bool  PngDecoder::setROI( const Rect& roi )
+{
+    if( !m_png_ptr || png_get_interlace_type( (png_structp)m_png_ptr, (png_infop)m_info_ptr ) != PNG_INTERLACE_NONE )
+        return false;
+    m_roi = roi;
+    return true;
 }
 
 
@@ -227,6 +238,9 @@ bool  PngDecoder::readData( Mat& img )
     bool result = false;
     AutoBuffer<uchar*> _buffer(m_height);
     uchar** buffer = _buffer;
+    // the row buffer for the region decoding is allocated before setjmp, so that longjmp
+    // does not skip its destructor; a decoded row takes at most 4 channels of 16 bits
+    AutoBuffer<uchar> _row(m_roi.area() > 0 ? (size_t)m_width*8 : 0);
     int color = img.channels() > 1;
     uchar* data = img.data;
     int step = (int)img.step;
@@ -280,11 +294,28 @@ bool  PngDecoder::readData( Mat& img )
             png_set_interlace_handling( png_ptr );
             png_read_update_info( png_ptr, info_ptr );
 
-            for( y = 0; y < m_height; y++ )
-                buffer[y] = data + y*step;
+            if( m_roi.area() > 0 )
+            {
+                // decode the rows one by one and stop after the last row of the region
+                CV_Assert( png_get_rowbytes( png_ptr, info_ptr ) <= _row.size() );
+                uchar* row = _row;
+                size_t esz = img.elemSize();
+
+                for( y = 0; y < m_roi.y + m_roi.height; y++ )
+                {
+                    png_read_row( png_ptr, row, 0 );
+                    if( y >= m_roi.y )
+                        memcpy( data + (y - m_roi.y)*step, row + m_roi.x*esz, m_roi.width*esz );
+                }
+            }
+            else
+            {
+                for( y = 0; y < m_height; y++ )
+                    buffer[y] = data + y*step;
 
-            png_read_image( png_ptr, buffer );
-            png_read_end( png_ptr, end_info );
+                png_read_image( png_ptr, buffer );
+                png_read_end( png_ptr, end_info );
+            }
 
             result = true;
         }
@@ -302,6 +333,7 @@ PngEncoder::PngEncoder()
 {
     m_description = "Portable Network Graphics files (*.png)";
     m_buf_supported = true;
+    m_mem_supported = true;
 }
 
 
@@ -327,10 +359,8 @@ void PngEncoder::writeDataToBuf(void* _png_ptr, uchar* src, size_t size)
         return;
     png_structp png_ptr = (png_structp)_png_ptr;
     PngEncoder* encoder = (PngEncoder*)(png_get_io_ptr(png_ptr));
-    CV_Assert( encoder && encoder->m_buf );
-    size_t cursz = encoder->m_buf->size();
-    encoder->m_buf->resize(cursz + size);
-    memcpy( &(*encoder->m_buf)[cursz], src, size );
+    CV_Assert( encoder && (encoder->m_buf || encoder->m_mem) );
+    encoder->writeToBuf( src, size );
 }
 
 
@@ -338,6 +368,166 @@ void PngEncoder::flushBuf(void*)
 {
 }
 
+// the PNG row with the SUB filter applied (the filter byte goes first); the channels
+// are reordered to RGB(A) and 16-bit samples are stored in the network byte order
+static void filterPngRow( const Mat& img, int y, uchar* dst )
+{
+    int cn = img.channels(), esz = (int)img.elemSize1();
+    int width = img.cols, bpp = cn*esz, rowbytes = width*bpp;
+    const uchar* src = img.ptr(y);
+
+    dst[0] = 1; // PNG_FILTER_VALUE_SUB
+    uchar* row = dst + 1;
+    if( esz == 1 && cn == 1 )
+        memcpy( row, src, rowbytes );
+    else if( esz == 1 )
+    {
+        // BGR(A) -> RGB(A)
+        for( int i = 0; i < rowbytes; i += cn )
+        {
+            row[i] = src[i + 2]; row[i + 1] = src[i + 1]; row[i + 2] = src[i];
+            if( cn == 4 )
+                row[i + 3] = src[i + 3];
+        }
+    }
+    else
+    {
+        const ushort* src16 = (const ushort*)src;
+        for( int i = 0; i < width*cn; i += cn )
+            for( int c = 0; c < cn; c++ )
+            {
+                ushort v = src16[i + (cn >= 3 && c < 3 ? 2 - c : c)];
+                row[(i + c)*2] = (uchar)(v >> 8);
+                row[(i + c)*2 + 1] = (uchar)v;
+            }
+    }
+
+    for( int i = rowbytes - 1; i >= bpp; i-- )
+        row[i] = (uchar)(row[i] - row[i - bpp]);
+}
+
+// compresses the bands of rows independently, the way pigz does: every band is a raw deflate
+// stream primed with the last 32K of the previous band and ended with a sync flush (the last
+// one is finished), so the concatenation of the bands is the data of a single zlib stream
+class PngDeflateInvoker : public ParallelLoopBody
+{
+public:
+    PngDeflateInvoker( const Mat& _img, int _band_rows, int _level, int _strategy,
+                       std::vector<std::vector<uchar> >& _bands, std::vector<uLong>& _adlers ) :
+        img(&_img), band_rows(_band_rows), level(_level), strategy(_strategy),
+        bands(&_bands), adlers(&_adlers)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int rowsize = (int)(img->cols*img->elemSize()) + 1;
+        std::vector<uchar> rows;
+
+        for( int b = range.start; b < range.end; b++ )
+        {
+            int y0 = b*band_rows, y1 = std::min( y0 + band_rows, img->rows ), y;
+            int dict_rows = std::min( (PNG_WINDOW_SIZE + rowsize - 1)/rowsize, y0 );
+            bool last = y1 == img->rows;
+            std::vector<uchar>& band = (*bands)[b];
+            uLong adler = adler32( 0, 0, 0 );
+
+            rows.resize( (size_t)rowsize*(y1 - y0 + dict_rows) );
+            for( y = y0 - dict_rows; y < y1; y++ )
+                filterPngRow( *img, y, &rows[(size_t)rowsize*(y - y0 + dict_rows)] );
+
+            z_stream strm;
+            memset( &strm, 0, sizeof(strm) );
+            if( deflateInit2( &strm, level, Z_DEFLATED, -15, 8, strategy ) != Z_OK )
+            {
+                band.clear();
+                continue;
+            }
+
+            if( dict_rows > 0 )
+            {
+                size_t dict_size = std::min( (size_t)PNG_WINDOW_SIZE, (size_t)rowsize*dict_rows );
+                deflateSetDictionary( &strm, &rows[(size_t)rowsize*dict_rows - dict_size], (uInt)dict_size );
+            }
+
+            uInt size = (uInt)((size_t)rowsize*(y1 - y0));
+            strm.next_in = &rows[(size_t)rowsize*dict_rows];
+            strm.avail_in = size;
+            adler = adler32( adler, strm.next_in, size );
+
+            // a sync flush adds an empty stored block of 5 bytes to the bound
+            band.resize( deflateBound( &strm, size ) + 16 );
+            strm.next_out = &band[0];
+            strm.avail_out = (uInt)band.size();
+
+            int code = deflate( &strm, last ? Z_FINISH : Z_SYNC_FLUSH );
+            bool ok = last ? code == Z_STREAM_END : code == Z_OK && strm.avail_in == 0;
+            band.resize( ok ? band.size() - strm.avail_out : 0 );
+            (*adlers)[b] = adler;
+            deflateEnd( &strm );
+        }
+    }
+
+protected:
+    enum { PNG_WINDOW_SIZE = 1 << 15 };
+
+    const Mat* img;
+    int band_rows, level, strategy;
+    std::vector<std::vector<uchar> >* bands;
+    std::vector<uLong>* adlers;
+};
+
+static bool deflatePngBands( const Mat& img, int level, int strategy,
+                             std::vector<std::vector<uchar> >& bands, uLong& adler )
+{
+    // bands of ~128K of the image data, as in pigz
+    int rowsize = (int)(img.cols*img.elemSize()) + 1;
+    int band_rows = std::max( (1 << 17)/rowsize, 1 );
+    int i, nbands = (img.rows + band_rows - 1)/band_rows;
+    std::vector<uLong> adlers( nbands );
+
+    bands.resize( nbands );
+    parallel_for_( Range(0, nbands), PngDeflateInvoker( img, band_rows, level, strategy, bands, adlers ) );
+
+    adler = adler32( 0, 0, 0 );
+    for( i = 0; i < nbands; i++ )
+    {
+        if( bands[i].empty() )
+            return false;
+        int rows = std::min( band_rows, img.rows - i*band_rows );
+        adler = adler32_combine( adler, adlers[i], (z_off_t)rowsize*rows );
+    }
+    return true;
+}
+
+// writes the bands compressed by deflatePngBands() as IDAT chunks of a single zlib stream
+static void writePngBands( png_structp png_ptr, int level,
+                           const std::vector<std::vector<uchar> >& bands, uLong adler )
+{
+    static const png_byte idat[5] = { 73, 68, 65, 84, 0 }; // "IDAT"
+    static const png_byte iend[5] = { 73, 69, 78, 68, 0 }; // "IEND"
+
+    int flevel = level == Z_DEFAULT_COMPRESSION || level == 6 ? 2 : level < 2 ? 0 : level < 6 ? 1 : 3;
+    png_byte header[2] = { 0x78, (png_byte)(flevel << 6) };
+    header[1] = (png_byte)(header[1] + 31 - (header[0]*256 + header[1]) % 31);
+    png_byte trailer[4] = { (png_byte)(adler >> 24), (png_byte)(adler >> 16),
+                            (png_byte)(adler >> 8), (png_byte)adler };
+
+    for( size_t i = 0; i < bands.size(); i++ )
+    {
+        bool first = i == 0, last = i == bands.size() - 1;
+        png_write_chunk_start( png_ptr, idat,
+            (png_uint_32)(bands[i].size() + (first ? sizeof(header) : 0) + (last ? sizeof(trailer) : 0)) );
+        if( first )
+            png_write_chunk_data( png_ptr, header, sizeof(header) );
+        png_write_chunk_data( png_ptr, (png_bytep)&bands[i][0], bands[i].size() );
+        if( last )
+            png_write_chunk_data( png_ptr, trailer, sizeof(trailer) );
+        png_write_chunk_end( png_ptr );
+    }
+    png_write_chunk( png_ptr, iend, 0, 0 );
+}
+
 bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
 {
     png_structp png_ptr = png_create_write_struct( PNG_LIBPNG_VER_STRING, 0, 0, 0 );
@@ -347,6 +537,7 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
     int depth = img.depth(), channels = img.channels();
     bool result = false;
     AutoBuffer<uchar*> buffer;
+    std::vector<std::vector<uchar> > bands;
 
     if( depth != CV_8U && depth != CV_16U )
         return false;
@@ -359,7 +550,7 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
         {
             if( setjmp( png_jmpbuf ( png_ptr ) ) == 0 )
             {
-                if( m_buf )
+                if( m_buf || m_mem )
                 {
                     png_set_write_fn(png_ptr, this,
                         (png_rw_ptr)writeDataToBuf, (png_flush_ptr)flushBuf);
@@ -374,6 +565,7 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
                 int compression_level = -1; // Invalid value to allow setting 0-9 as valid
                 int compression_strategy = Z_RLE; // Default strategy
                 bool isBilevel = false;
+                bool isParallel = false;
 
                 for( size_t i = 0; i < params.size(); i += 2 )
                 {
@@ -391,9 +583,13 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
                     {
                         isBilevel = params[i+1] != 0;
                     }
+                    if( params[i] == CV_IMWRITE_PNG_PARALLEL )
+                    {
+                        isParallel = params[i+1] != 0;
+                    }
                 }
 
-                if( m_buf || f )
+                if( m_buf || m_mem || f )
                 {
                     if( compression_level >= 0 )
                     {
@@ -416,6 +612,19 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
 
                     png_write_info( png_ptr, info_ptr );
 
+                    if( isParallel && !isBilevel )
+                    {
+                        // the rows are filtered with SUB, like the default fast mode does
+                        int level = compression_level >= 0 ? compression_level : Z_BEST_SPEED;
+                        uLong adler = 0;
+                        if( deflatePngBands( img, level, compression_strategy, bands, adler ) )
+                        {
+                            writePngBands( png_ptr, level, bands, adler );
+                            result = true;
+                        }
+                        goto _exit_;
+                    }
+
                     if (isBilevel)
                         png_set_packing(png_ptr);
 
@@ -436,6 +645,7 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
         }
     }
 
+_exit_:
     png_destroy_write_struct( &png_ptr, &info_ptr );
     if(f) fclose( f );
 
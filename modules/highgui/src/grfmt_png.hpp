@@ -61,6 +61,7 @@ public:
     bool  readData( Mat& img );
     bool  readHeader();
     void  close();
+    bool  setROI( const Rect& roi );
 
     ImageDecoder newDecoder() const;
 
@@ -84,6 +84,16 @@ void TiffDecoder::close()
         TIFFClose( tif );
         m_tif = 0;
     }
+    m_roi = Rect();
+}
+
+// the SGI LogLuv data is always decoded as a whole
+bool TiffDecoder::setROI( const Rect& roi )
+{
+    if( m_hdr )
+        return false;
+    m_roi = roi;
+    return true;
 }
 
 TiffDecoder::~TiffDecoder()
@@ -91,6 +101,19 @@ TiffDecoder::~TiffDecoder()
     close();
 }
 
+// the file kept open for nextPage() belongs to the previous source
+bool TiffDecoder::setSource( const String& filename )
+{
+    close();
+    return BaseImageDecoder::setSource( filename );
+}
+
+bool TiffDecoder::setSource( const Mat& buf )
+{
+    close();
+    return BaseImageDecoder::setSource( buf );
+}
+
 size_t TiffDecoder::signatureLength() const
 {
     return 4;
@@ -113,14 +136,26 @@ ImageDecoder TiffDecoder::newDecoder() const
     return makePtr<TiffDecoder>();
 }
 
+bool TiffDecoder::nextPage()
+{
+    return m_tif && TIFFReadDirectory( (TIFF*)m_tif ) && readHeader();
+}
+
 bool TiffDecoder::readHeader()
 {
     bool result = false;
 
-    close();
-    // TIFFOpen() mode flags are different to fopen().  A 'b' in mode "rb" has no effect when reading.
-    // http://www.remotesensing.org/libtiff/man/TIFFOpen.3tiff.html
-    TIFF* tif = TIFFOpen( m_filename.c_str(), "r" );
+    // after nextPage() the header of the current directory is read
+    TIFF* tif = (TIFF*)m_tif;
+    if( !tif )
+    {
+        close();
+        // TIFFOpen() mode flags are different to fopen().  A 'b' in mode "rb" has no effect when reading.
+        // http://www.remotesensing.org/libtiff/man/TIFFOpen.3tiff.html
+        tif = TIFFOpen( m_filename.c_str(), "r" );
+    }
+    else
+        m_roi = Rect();
 
     if( tif )
     {
@@ -190,7 +225,6 @@ bool  TiffDecoder::readData( Mat& img )
     }
     bool result = false;
     bool color = img.channels() > 1;
-    uchar* data = img.data;
 
     if( img.depth() != CV_8U && img.depth() != CV_16U && img.depth() != CV_32F && img.depth() != CV_64F )
         return false;
@@ -239,22 +273,38 @@ bool  TiffDecoder::readData( Mat& img )
             ushort* buffer16 = (ushort*)buffer;
             float* buffer32 = (float*)buffer;
             double* buffer64 = (double*)buffer;
-            int tileidx = 0;
+            int tiles_across = (m_width + tile_width0 - 1) / tile_width0;
 
-            for( y = 0; y < m_height; y += tile_height0, data += img.step*tile_height0 )
+            // only the strips/tiles that intersect the region are decoded; they are converted
+            // right into the image, or into a temporary tile if the region does not cover them
+            Rect roi = m_roi.area() > 0 ? m_roi : Rect(0, 0, m_width, m_height);
+            Mat tile_buf;
+
+            for( y = roi.y - roi.y % tile_height0; y < roi.y + roi.height; y += tile_height0 )
             {
                 int tile_height = tile_height0;
 
                 if( y + tile_height > m_height )
                     tile_height = m_height - y;
 
-                for( x = 0; x < m_width; x += tile_width0, tileidx++ )
+                for( x = roi.x - roi.x % tile_width0; x < roi.x + roi.width; x += tile_width0 )
                 {
                     int tile_width = tile_width0, ok;
+                    int tileidx = (y / tile_height0)*tiles_across + x / tile_width0;
 
                     if( x + tile_width > m_width )
                         tile_width = m_width - x;
 
+                    Rect tile_rect( x, y, tile_width, tile_height ), dst_rect = tile_rect & roi;
+                    Mat tile;
+                    if( dst_rect == tile_rect )
+                        tile = img( tile_rect - roi.tl() );
+                    else
+                    {
+                        tile_buf.create( tile_height0, tile_width0, img.type() );
+                        tile = tile_buf( Rect(0, 0, tile_width, tile_height) );
+                    }
+
                     switch(dst_bpp)
                     {
                         case 8:
@@ -280,19 +330,19 @@ bool  TiffDecoder::readData( Mat& img )
                                     if (wanted_channels == 4)
                                     {
                                         icvCvt_BGRA2RGBA_8u_C4R( bstart + i*tile_width0*4, 0,
-                                                             data + x*4 + img.step*(tile_height - i - 1), 0,
+                                                             tile.ptr(tile_height - i - 1), 0,
                                                              cvSize(tile_width,1) );
                                     }
                                     else
                                     {
                                         icvCvt_BGRA2BGR_8u_C4C3R( bstart + i*tile_width0*4, 0,
-                                                             data + x*3 + img.step*(tile_height - i - 1), 0,
+                                                             tile.ptr(tile_height - i - 1), 0,
                                                              cvSize(tile_width,1), 2 );
                                     }
                                 }
                                 else
                                     icvCvt_BGRA2Gray_8u_C4C1R( bstart + i*tile_width0*4, 0,
-                                                              data + x + img.step*(tile_height - i - 1), 0,
+                                                              tile.ptr(tile_height - i - 1), 0,
                                                               cvSize(tile_width,1), 2 );
                             break;
                         }
@@ -317,19 +367,19 @@ bool  TiffDecoder::readData( Mat& img )
                                     if( ncn == 1 )
                                     {
                                         icvCvt_Gray2BGR_16u_C1C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                                  (ushort*)(data + img.step*i) + x*3, 0,
+                                                                  tile.ptr<ushort>(i), 0,
                                                                   cvSize(tile_width,1) );
                                     }
                                     else if( ncn == 3 )
                                     {
                                         icvCvt_RGB2BGR_16u_C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                               (ushort*)(data + img.step*i) + x*3, 0,
+                                                               tile.ptr<ushort>(i), 0,
                                                                cvSize(tile_width,1) );
                                     }
                                     else
                                     {
                                         icvCvt_BGRA2BGR_16u_C4C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                               (ushort*)(data + img.step*i) + x*3, 0,
+                                                               tile.ptr<ushort>(i), 0,
                                                                cvSize(tile_width,1), 2 );
                                     }
                                 }
@@ -337,14 +387,14 @@ bool  TiffDecoder::readData( Mat& img )
                                 {
                                     if( ncn == 1 )
                                     {
-                                        memcpy((ushort*)(data + img.step*i)+x,
+                                        memcpy(tile.ptr<ushort>(i),
                                                buffer16 + i*tile_width0*ncn,
                                                tile_width*sizeof(buffer16[0]));
                                     }
                                     else
                                     {
                                         icvCvt_BGRA2Gray_16u_CnC1R(buffer16 + i*tile_width0*ncn, 0,
-                                                               (ushort*)(data + img.step*i) + x, 0,
+                                                               tile.ptr<ushort>(i), 0,
                                                                cvSize(tile_width,1), ncn, 2 );
                                     }
                                 }
@@ -370,13 +420,13 @@ bool  TiffDecoder::readData( Mat& img )
                             {
                                 if(dst_bpp == 32)
                                 {
-                                    memcpy((float*)(data + img.step*i)+x,
+                                    memcpy(tile.ptr<float>(i),
                                            buffer32 + i*tile_width0*ncn,
                                            tile_width*sizeof(buffer32[0]));
                                 }
                                 else
                                 {
-                                    memcpy((double*)(data + img.step*i)+x,
+                                    memcpy(tile.ptr<double>(i),
                                          buffer64 + i*tile_width0*ncn,
                                          tile_width*sizeof(buffer64[0]));
                                 }
@@ -390,6 +440,9 @@ bool  TiffDecoder::readData( Mat& img )
                             return false;
                         }
                     }
+
+                    if( dst_rect != tile_rect )
+                        tile( dst_rect - tile_rect.tl() ).copyTo( img( dst_rect - roi.tl() ) );
                 }
             }
 
@@ -397,7 +450,9 @@ bool  TiffDecoder::readData( Mat& img )
         }
     }
 
-    close();
+    // the file stays open for nextPage()
+    if( !result )
+        close();
     return result;
 }
 
@@ -420,7 +475,6 @@ bool TiffDecoder::readHdrData(Mat& img)
         TIFFReadEncodedStrip(tif, i, ptr, size);
         size -= strip_size * sizeof(float);
     }
-    close();
     if(photometric == PHOTOMETRIC_LOGLUV)
     {
         cvtColor(img, img, COLOR_XYZ2BGR);
@@ -100,6 +100,10 @@ public:
     bool  readHeader();
     bool  readData( Mat& img );
     void  close();
+    bool  setROI( const Rect& roi );
+    bool  nextPage();
+    bool  setSource( const String& filename );
+    bool  setSource( const Mat& buf );
 
     size_t signatureLength() const;
     bool checkSignature( const String& signature ) const;
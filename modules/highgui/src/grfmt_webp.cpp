@@ -195,6 +195,7 @@ WebPEncoder::WebPEncoder()
 {
     m_description = "WebP files (*.webp)";
     m_buf_supported = true;
+    m_mem_supported = true;
 }
 
 WebPEncoder::~WebPEncoder() { }
@@ -276,10 +277,9 @@ bool WebPEncoder::write(const Mat& img, const std::vector<int>& params)
 
     if(size > 0)
     {
-        if(m_buf)
+        if(m_buf || m_mem)
         {
-            m_buf->resize(size);
-            memcpy(&(*m_buf)[0], out, size);
+            writeToBuf(out, size);
         }
         else
         {
@@ -45,6 +45,7 @@
 
 #include "precomp.hpp"
 #include "grfmts.hpp"
+#include "opencv2/imgproc.hpp"
 #undef min
 #undef max
 #include <iostream>
@@ -125,12 +126,13 @@ static ImageDecoder findDecoder( const String& filename )
     return ImageDecoder();
 }
 
-static ImageDecoder findDecoder( const Mat& buf )
+// the index of the codec in codecs.decoders that recognizes the buffer signature, or -1
+static int findDecoderIndex( const Mat& buf )
 {
     size_t i, maxlen = 0;
 
     if( buf.rows*buf.cols < 1 || !buf.isContinuous() )
-        return ImageDecoder();
+        return -1;
 
     for( i = 0; i < codecs.decoders.size(); i++ )
     {
@@ -146,10 +148,16 @@ static ImageDecoder findDecoder( const Mat& buf )
     for( i = 0; i < codecs.decoders.size(); i++ )
     {
         if( codecs.decoders[i]->checkSignature(signature) )
-            return codecs.decoders[i]->newDecoder();
+            return (int)i;
     }
 
-    return ImageDecoder();
+    return -1;
+}
+
+static ImageDecoder findDecoder( const Mat& buf )
+{
+    int idx = findDecoderIndex( buf );
+    return idx >= 0 ? codecs.decoders[idx]->newDecoder() : ImageDecoder();
 }
 
 static ImageEncoder findEncoder( const String& _ext )
@@ -193,8 +201,61 @@ static ImageEncoder findEncoder( const String& _ext )
 
 enum { LOAD_CVMAT=0, LOAD_IMAGE=1, LOAD_MAT=2 };
 
+// the type of the image returned for the decoded image type and the IMREAD_* flags
+static int getImageType( int flags, int type )
+{
+    if( flags != -1 )
+    {
+        if( (flags & CV_LOAD_IMAGE_ANYDEPTH) == 0 )
+            type = CV_MAKETYPE(CV_8U, CV_MAT_CN(type));
+
+        if( (flags & CV_LOAD_IMAGE_COLOR) != 0 ||
+           ((flags & CV_LOAD_IMAGE_ANYCOLOR) != 0 && CV_MAT_CN(type) > 1) )
+            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 3);
+        else
+            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
+    }
+    return type;
+}
+
+static int getScaleDenom( int flags )
+{
+    if( flags == IMREAD_UNCHANGED )
+        return 1;
+    return (flags & IMREAD_REDUCED_GRAYSCALE_8) ? 8 :
+           (flags & IMREAD_REDUCED_GRAYSCALE_4) ? 4 :
+           (flags & IMREAD_REDUCED_GRAYSCALE_2) ? 2 : 1;
+}
+
+// the size of the image reduced scale_denom times (rounded up, like libjpeg does)
+static Size getReducedSize( const ImageDecoder& decoder, int scale_denom )
+{
+    return Size( (decoder->width() + scale_denom - 1) / scale_denom,
+                 (decoder->height() + scale_denom - 1) / scale_denom );
+}
+
+// decodes the roi of the image reduced scale_denom times into dst, which has the roi size.
+// The decoders that can not reduce the image or decode just the roi themselves
+// decode the whole image, and the result is downsampled and cropped here
+static bool readImageData( const ImageDecoder& decoder, Mat& dst, int scale_denom, const Rect& roi )
+{
+    Size size = getReducedSize( decoder, scale_denom );
+    bool full = roi == Rect( Point(), size );
+
+    if( scale_denom == 1 && (full || decoder->setROI( roi )) )
+        return decoder->readData( dst );
+
+    Mat img( decoder->height(), decoder->width(), dst.type() ), reduced = img;
+    if( !decoder->readData( img ) )
+        return false;
+    if( scale_denom > 1 )
+        resize( img, reduced, size, 0, 0, INTER_AREA );
+    reduced( roi ).copyTo( dst );
+    return true;
+}
+
 static void*
-imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
+imread_( const String& filename, int flags, int hdrtype, Mat* mat=0, const Rect* _roi=0 )
 {
     IplImage* image = 0;
     CvMat *matrix = 0;
@@ -203,25 +264,18 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
     ImageDecoder decoder = findDecoder(filename);
     if( !decoder )
         return 0;
+    int scale_denom = decoder->setScale( getScaleDenom(flags) );
     decoder->setSource(filename);
     if( !decoder->readHeader() )
         return 0;
-    CvSize size;
-    size.width = decoder->width();
-    size.height = decoder->height();
-
-    int type = decoder->type();
-    if( flags != -1 )
-    {
-        if( (flags & CV_LOAD_IMAGE_ANYDEPTH) == 0 )
-            type = CV_MAKETYPE(CV_8U, CV_MAT_CN(type));
+    Rect roi( Point(), getReducedSize( decoder, scale_denom ) );
+    if( _roi )
+        roi &= *_roi;
+    if( roi.area() == 0 )
+        return 0;
+    CvSize size = roi.size();
 
-        if( (flags & CV_LOAD_IMAGE_COLOR) != 0 ||
-           ((flags & CV_LOAD_IMAGE_ANYCOLOR) != 0 && CV_MAT_CN(type) > 1) )
-            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 3);
-        else
-            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
-    }
+    int type = getImageType( flags, decoder->type() );
 
     if( hdrtype == LOAD_CVMAT || hdrtype == LOAD_MAT )
     {
@@ -242,7 +296,7 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
         temp = cvarrToMat(image);
     }
 
-    if( !decoder->readData( *data ))
+    if( !readImageData( decoder, *data, scale_denom, roi ))
     {
         cvReleaseImage( &image );
         cvReleaseMat( &matrix );
@@ -262,6 +316,37 @@ Mat imread( const String& filename, int flags )
     return img;
 }
 
+Mat imread( const String& filename, const Rect& roi, int flags )
+{
+    Mat img;
+    imread_( filename, flags, LOAD_MAT, &img, &roi );
+    return img;
+}
+
+bool imreadmulti( const String& filename, std::vector<Mat>& mats, int flags )
+{
+    ImageDecoder decoder = findDecoder(filename);
+    if( !decoder )
+        return false;
+    int scale_denom = decoder->setScale( getScaleDenom(flags) );
+    decoder->setSource(filename);
+    if( !decoder->readHeader() )
+        return false;
+
+    size_t count = mats.size();
+    // the pages are decoded one by one, the decoder only keeps the state of the current page
+    do
+    {
+        Mat img( getReducedSize( decoder, scale_denom ), getImageType( flags, decoder->type() ) );
+        if( !readImageData( decoder, img, scale_denom, Rect( Point(), img.size() ) ) )
+            break;
+        mats.push_back( img );
+    }
+    while( decoder->nextPage() );
+
+    return mats.size() > count;
+}
+
 static bool imwrite_( const String& filename, const Mat& image,
                       const std::vector<int>& params, bool flipv )
 {
@@ -301,7 +386,7 @@ bool imwrite( const String& filename, InputArray _img,
 }
 
 static void*
-imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
+imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0, const Rect* _roi=0 )
 {
     CV_Assert(buf.data && buf.isContinuous());
     IplImage* image = 0;
@@ -312,6 +397,7 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
     ImageDecoder decoder = findDecoder(buf);
     if( !decoder )
         return 0;
+    int scale_denom = decoder->setScale( getScaleDenom(flags) );
 
     if( !decoder->setSource(buf) )
     {
@@ -325,29 +411,29 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
         decoder->setSource(filename);
     }
 
+    // the decoder may keep the temporary file open (e.g. for nextPage()),
+    // so it is released before the file is removed
     if( !decoder->readHeader() )
     {
+        decoder.release();
         if( !filename.empty() )
             remove(filename.c_str());
         return 0;
     }
 
-    CvSize size;
-    size.width = decoder->width();
-    size.height = decoder->height();
-
-    int type = decoder->type();
-    if( flags != -1 )
+    Rect roi( Point(), getReducedSize( decoder, scale_denom ) );
+    if( _roi )
+        roi &= *_roi;
+    if( roi.area() == 0 )
     {
-        if( (flags & CV_LOAD_IMAGE_ANYDEPTH) == 0 )
-            type = CV_MAKETYPE(CV_8U, CV_MAT_CN(type));
-
-        if( (flags & CV_LOAD_IMAGE_COLOR) != 0 ||
-           ((flags & CV_LOAD_IMAGE_ANYCOLOR) != 0 && CV_MAT_CN(type) > 1) )
-            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 3);
-        else
-            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
+        decoder.release();
+        if( !filename.empty() )
+            remove(filename.c_str());
+        return 0;
     }
+    CvSize size = roi.size();
+
+    int type = getImageType( flags, decoder->type() );
 
     if( hdrtype == LOAD_CVMAT || hdrtype == LOAD_MAT )
     {
@@ -368,7 +454,8 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
         temp = cvarrToMat(image);
     }
 
-    bool code = decoder->readData( *data );
+    bool code = readImageData( decoder, *data, scale_denom, roi );
+    decoder.release();
     if( !filename.empty() )
         remove(filename.c_str());
 
@@ -401,25 +488,32 @@ Mat imdecode( InputArray _buf, int flags, Mat* dst )
     return *dst;
 }
 
-bool imencode( const String& ext, InputArray _image,
-               std::vector<uchar>& buf, const std::vector<int>& params )
+Mat imdecode( InputArray _buf, const Rect& roi, int flags )
 {
-    Mat image = _image.getMat();
+    Mat buf = _buf.getMat(), img;
+    imdecode_( buf, flags, LOAD_MAT, &img, &roi );
+    return img;
+}
 
+// the image converted to the depth the encoder supports
+static Mat getEncodableImage( const ImageEncoder& encoder, const Mat& image )
+{
     int channels = image.channels();
     CV_Assert( channels == 1 || channels == 3 || channels == 4 );
 
-    ImageEncoder encoder = findEncoder( ext );
-    if( !encoder )
-        CV_Error( CV_StsError, "could not find encoder for the specified extension" );
+    if( encoder->isFormatSupported(image.depth()) )
+        return image;
 
-    if( !encoder->isFormatSupported(image.depth()) )
-    {
-        CV_Assert( encoder->isFormatSupported(CV_8U) );
-        Mat temp;
-        image.convertTo(temp, CV_8U);
-        image = temp;
-    }
+    CV_Assert( encoder->isFormatSupported(CV_8U) );
+    Mat temp;
+    image.convertTo(temp, CV_8U);
+    return temp;
+}
+
+static bool imencode_( const ImageEncoder& encoder, const Mat& _image,
+                       std::vector<uchar>& buf, const std::vector<int>& params )
+{
+    Mat image = getEncodableImage( encoder, _image );
 
     bool code;
     if( encoder->setDestination(buf) )
@@ -451,6 +545,187 @@ bool imencode( const String& ext, InputArray _image,
     return code;
 }
 
+bool imencode( const String& ext, InputArray _image,
+               std::vector<uchar>& buf, const std::vector<int>& params )
+{
+    ImageEncoder encoder = findEncoder( ext );
+    if( !encoder )
+        CV_Error( CV_StsError, "could not find encoder for the specified extension" );
+
+    return imencode_( encoder, _image.getMat(), buf, params );
+}
+
+bool imencode( const String& ext, InputArray _image, uchar* buf, size_t bufsize,
+               size_t& size, const std::vector<int>& params )
+{
+    ImageEncoder encoder = findEncoder( ext );
+    if( !encoder )
+        CV_Error( CV_StsError, "could not find encoder for the specified extension" );
+
+    Mat image = getEncodableImage( encoder, _image.getMat() );
+    uchar dummy = 0;
+    if( !buf )
+    {
+        CV_Assert( bufsize == 0 );
+        buf = &dummy;
+    }
+
+    if( !encoder->setDestination( buf, bufsize ) )
+    {
+        // the encoder can only grow a vector, so the image is copied
+        std::vector<uchar> temp;
+        imencode_( encoder, image, temp, params );
+        size = temp.size();
+        if( size > bufsize )
+            return false;
+        if( size > 0 )
+            memcpy( buf, &temp[0], size );
+        return true;
+    }
+
+    bool code = encoder->write( image, params );
+    encoder->throwOnEror();
+    CV_Assert( code );
+    size = encoder->outputSize();
+    return size <= bufsize;
+}
+
+// every stripe of the batch gets its own codec instances, which are then reused
+// for all the images of the stripe; a few stripes per thread balance the load
+static int getBatchStripes( int count )
+{
+    return std::max( std::min( count, getNumThreads()*4 ), 1 );
+}
+
+class ImageDecodeBatchInvoker : public ParallelLoopBody
+{
+public:
+    ImageDecodeBatchInvoker( const std::vector<Mat>& _bufs, std::vector<Mat>& _imgs, int _flags ) :
+        bufs(&_bufs), imgs(&_imgs), flags(_flags)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        std::vector<ImageDecoder> decoders( codecs.decoders.size() );
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            const Mat& buf = (*bufs)[i];
+            Mat& img = (*imgs)[i];
+
+            int idx = findDecoderIndex( buf );
+            if( idx < 0 )
+                continue;
+            if( !decoders[idx] )
+                decoders[idx] = codecs.decoders[idx]->newDecoder();
+            ImageDecoder& decoder = decoders[idx];
+
+            try
+            {
+                int scale_denom = decoder->setScale( getScaleDenom(flags) );
+                if( !decoder->setSource(buf) )
+                {
+                    // the decoder can only read files, go the usual way through a temporary one
+                    imdecode_( buf, flags, LOAD_MAT, &img );
+                    continue;
+                }
+                if( !decoder->readHeader() )
+                    continue;
+                img.create( getReducedSize( decoder, scale_denom ), getImageType( flags, decoder->type() ) );
+                if( !readImageData( decoder, img, scale_denom, Rect( Point(), img.size() ) ) )
+                    img.release();
+            }
+            catch( const cv::Exception& )
+            {
+                img.release();
+                decoder.release();
+            }
+        }
+    }
+
+protected:
+    const std::vector<Mat>* bufs;
+    std::vector<Mat>* imgs;
+    int flags;
+};
+
+int imdecodeBatch( InputArrayOfArrays _bufs, std::vector<Mat>& imgs, int flags )
+{
+    int i, count = (int)_bufs.total();
+    std::vector<Mat> bufs( count );
+    for( i = 0; i < count; i++ )
+        bufs[i] = _bufs.getMat(i);
+
+    imgs.clear();
+    imgs.resize( count );
+    parallel_for_( Range(0, count), ImageDecodeBatchInvoker( bufs, imgs, flags ), getBatchStripes( count ) );
+
+    int decoded = 0;
+    for( i = 0; i < count; i++ )
+        decoded += !imgs[i].empty();
+    return decoded;
+}
+
+class ImageEncodeBatchInvoker : public ParallelLoopBody
+{
+public:
+    ImageEncodeBatchInvoker( const String& _ext, const std::vector<Mat>& _imgs,
+                             std::vector<std::vector<uchar> >& _bufs, const std::vector<int>& _params,
+                             std::vector<uchar>& _ok ) :
+        ext(_ext), imgs(&_imgs), bufs(&_bufs), params(&_params), ok(&_ok)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        ImageEncoder encoder = findEncoder( ext );
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            std::vector<uchar>& buf = (*bufs)[i];
+            try
+            {
+                (*ok)[i] = imencode_( encoder, (*imgs)[i], buf, *params );
+            }
+            catch( const cv::Exception& )
+            {
+                encoder = findEncoder( ext );
+            }
+            if( !(*ok)[i] )
+                buf.clear();
+        }
+    }
+
+protected:
+    String ext;
+    const std::vector<Mat>* imgs;
+    std::vector<std::vector<uchar> >* bufs;
+    const std::vector<int>* params;
+    std::vector<uchar>* ok;
+};
+
+bool imencodeBatch( const String& ext, InputArrayOfArrays _imgs,
+                    std::vector<std::vector<uchar> >& bufs, const std::vector<int>& params )
+{
+    if( !findEncoder( ext ) )
+        CV_Error( CV_StsError, "could not find encoder for the specified extension" );
+
+    int i, count = (int)_imgs.total();
+    std::vector<Mat> imgs( count );
+    for( i = 0; i < count; i++ )
+        imgs[i] = _imgs.getMat(i);
+
+    std::vector<uchar> ok( count, (uchar)0 );
+    bufs.resize( count );
+    parallel_for_( Range(0, count), ImageEncodeBatchInvoker( ext, imgs, bufs, params, ok ), getBatchStripes( count ) );
+
+    for( i = 0; i < count; i++ )
+        if( !ok[i] )
+            return false;
+    return true;
+}
+
 }
 
 /****************************************************************************************\
@@ -397,4 +397,35 @@ TEST(Highgui_Video_parallel_writers_and_readers, accuracy)
     }
 }
 
+TEST(Highgui_Video, ffmpeg_decoding_options)
+{
+    string filename = cvtest::TS::ptr()->get_data_path() + "../cv/shared/video_for_test.avi";
+    VideoCapture cap_bgr(filename), cap(filename);
+    ASSERT_TRUE(cap_bgr.isOpened() && cap.isOpened());
+
+    ASSERT_TRUE(cap.set(CAP_PROP_FFMPEG_THREAD_COUNT, 1));
+    EXPECT_EQ(1, cap.get(CAP_PROP_FFMPEG_THREAD_COUNT));
+    ASSERT_TRUE(cap.set(CAP_PROP_FFMPEG_SKIP_LOOP_FILTER, CAP_FFMPEG_DISCARD_NONREF));
+    EXPECT_EQ(CAP_FFMPEG_DISCARD_NONREF, cap.get(CAP_PROP_FFMPEG_SKIP_LOOP_FILTER));
+    EXPECT_FALSE(cap.set(CAP_PROP_FFMPEG_SKIP_FRAME, CAP_FFMPEG_DISCARD_ALL + 1));
+    EXPECT_FALSE(cap.set(CAP_PROP_FFMPEG_SKIP_LOOP_FILTER, CAP_FFMPEG_DISCARD_NONE - 1));
+    EXPECT_EQ(CAP_FFMPEG_DISCARD_NONREF, cap.get(CAP_PROP_FFMPEG_SKIP_LOOP_FILTER));
+    ASSERT_TRUE(cap.set(CAP_PROP_FORMAT, CV_8UC1));
+    EXPECT_EQ(CV_8UC1, cap.get(CAP_PROP_FORMAT));
+
+    for (int i = 0; i < 10; i++)
+    {
+        Mat frame_bgr, frame, gray;
+        cap_bgr >> frame_bgr;
+        cap >> frame;
+        ASSERT_FALSE(frame_bgr.empty() || frame.empty());
+        ASSERT_EQ(CV_8UC1, frame.type());
+        ASSERT_EQ(frame_bgr.size(), frame.size());
+
+        // the luma has the limited range and is not filtered for the non-reference frames
+        cvtColor(frame_bgr, gray, COLOR_BGR2GRAY);
+        EXPECT_LE(cvtest::norm(gray, frame, NORM_L1) / frame.total(), 32.);
+    }
+}
+
 #endif
@@ -259,6 +259,41 @@ public:
 
 TEST(Highgui_Image, encode_png) { CV_GrfmtPNGEncodeTest test; test.safe_run(); }
 
+TEST(Highgui_Image, encode_png_parallel)
+{
+    // a few pixels, several bands, and rows wider than the deflate window
+    const Size sizes[] = { Size(3, 2), Size(640, 1000), Size(20000, 7) };
+    const int types[] = { CV_8UC1, CV_8UC3, CV_8UC4, CV_16UC1, CV_16UC3, CV_16UC4 };
+    const int levels[] = { -1, 0, 6, 9 };
+
+    for( size_t i = 0; i < sizeof(sizes)/sizeof(sizes[0]); i++ )
+        for( size_t j = 0; j < sizeof(types)/sizeof(types[0]); j++ )
+        {
+            Mat img( sizes[i], types[j] );
+            randu( img, Scalar::all(0), Scalar::all(CV_MAT_DEPTH(types[j]) == CV_8U ? 256 : 65536) );
+            GaussianBlur( img, img, Size(5, 5), 2 );
+
+            for( size_t k = 0; k < sizeof(levels)/sizeof(levels[0]); k++ )
+            {
+                std::vector<int> params;
+                params.push_back( IMWRITE_PNG_PARALLEL );
+                params.push_back( 1 );
+                if( levels[k] >= 0 )
+                {
+                    params.push_back( IMWRITE_PNG_COMPRESSION );
+                    params.push_back( levels[k] );
+                }
+
+                std::vector<uchar> buf;
+                ASSERT_TRUE( imencode( ".png", img, buf, params ) );
+                Mat decoded = imdecode( buf, IMREAD_UNCHANGED );
+                ASSERT_EQ( img.size(), decoded.size() ) << i << " " << j << " " << k;
+                ASSERT_EQ( img.type(), decoded.type() );
+                EXPECT_EQ( 0, cvtest::norm( img, decoded, NORM_INF ) ) << i << " " << j << " " << k;
+            }
+        }
+}
+
 TEST(Highgui_ImreadVSCvtColor, regression)
 {
     cvtest::TS& ts = *cvtest::TS::ptr();
@@ -378,6 +413,218 @@ public:
 TEST(Highgui_Image, read_png_color_palette_with_alpha) { CV_GrfmtReadPNGColorPaletteWithAlphaTest test; test.safe_run(); }
 #endif
 
+TEST(Highgui_Image, read_reduced)
+{
+    const char* exts[] = { ".bmp",
+#ifdef HAVE_PNG
+        ".png",
+#endif
+#ifdef HAVE_JPEG
+        ".jpg",
+#endif
+    };
+    const int flags[] = { IMREAD_REDUCED_COLOR_2, IMREAD_REDUCED_GRAYSCALE_2,
+                          IMREAD_REDUCED_COLOR_4, IMREAD_REDUCED_GRAYSCALE_4,
+                          IMREAD_REDUCED_COLOR_8, IMREAD_REDUCED_GRAYSCALE_8 };
+
+    // a smooth image, so that the DCT-domain downscaling of JPEG is close to the area averaging
+    Mat img(203, 301, CV_8UC3);
+    for( int y = 0; y < img.rows; y++ )
+        for( int x = 0; x < img.cols; x++ )
+            img.at<Vec3b>(y, x) = Vec3b(saturate_cast<uchar>(x*255/img.cols),
+                                        saturate_cast<uchar>(y*255/img.rows),
+                                        saturate_cast<uchar>(128 + 100*std::sin(x*0.02 + y*0.03)));
+
+    for( size_t i = 0; i < sizeof(exts)/sizeof(exts[0]); i++ )
+    {
+        string filename = cv::tempfile(exts[i]);
+        ASSERT_TRUE(imwrite(filename, img));
+        Mat full = imread(filename, IMREAD_COLOR), full_gray = imread(filename, IMREAD_GRAYSCALE);
+        std::vector<uchar> buf;
+        ASSERT_TRUE(imencode(exts[i], img, buf));
+
+        for( size_t j = 0; j < sizeof(flags)/sizeof(flags[0]); j++ )
+        {
+            int scale = flags[j] & IMREAD_REDUCED_GRAYSCALE_8 ? 8 : flags[j] & IMREAD_REDUCED_GRAYSCALE_4 ? 4 : 2;
+            Size size((img.cols + scale - 1)/scale, (img.rows + scale - 1)/scale);
+            Mat reduced = imread(filename, flags[j]), decoded = imdecode(buf, flags[j]), ref;
+
+            resize((flags[j] & IMREAD_COLOR) ? full : full_gray, ref, size, 0, 0, INTER_AREA);
+            ASSERT_EQ(size, reduced.size()) << exts[i] << " " << flags[j];
+            ASSERT_EQ(ref.type(), reduced.type()) << exts[i] << " " << flags[j];
+            EXPECT_LE(cvtest::norm(ref, reduced, NORM_L1)/ref.total()/ref.channels(), 5.) << exts[i] << " " << flags[j];
+            EXPECT_EQ(0, cvtest::norm(reduced, decoded, NORM_INF)) << exts[i] << " " << flags[j];
+        }
+        remove(filename.c_str());
+    }
+}
+
+TEST(Highgui_Image, read_roi)
+{
+    const char* exts[] = { ".bmp",
+#ifdef HAVE_PNG
+        ".png",
+#endif
+#ifdef HAVE_JPEG
+        ".jpg",
+#endif
+#ifdef HAVE_TIFF
+        ".tiff",
+#endif
+    };
+    const int flags[] = { IMREAD_COLOR, IMREAD_GRAYSCALE, IMREAD_UNCHANGED, IMREAD_REDUCED_COLOR_2 };
+    const Rect rois[] = { Rect(0, 0, 301, 203), Rect(17, 33, 100, 50), Rect(250, 150, 100, 100),
+                          Rect(0, 202, 301, 1), Rect(400, 300, 10, 10) };
+
+    Mat img(203, 301, CV_8UC3);
+    randu(img, Scalar::all(0), Scalar::all(256));
+    GaussianBlur(img, img, Size(5, 5), 2);
+
+    for( size_t i = 0; i < sizeof(exts)/sizeof(exts[0]); i++ )
+    {
+        string filename = cv::tempfile(exts[i]);
+        ASSERT_TRUE(imwrite(filename, img));
+        std::vector<uchar> buf;
+        ASSERT_TRUE(imencode(exts[i], img, buf));
+
+        for( size_t j = 0; j < sizeof(flags)/sizeof(flags[0]); j++ )
+        {
+            Mat full = imread(filename, flags[j]);
+            ASSERT_FALSE(full.empty());
+            for( size_t k = 0; k < sizeof(rois)/sizeof(rois[0]); k++ )
+            {
+                Rect r = rois[k] & Rect(0, 0, full.cols, full.rows);
+                Mat region = imread(filename, rois[k], flags[j]), decoded = imdecode(buf, rois[k], flags[j]);
+                if( r.area() == 0 )
+                {
+                    EXPECT_TRUE(region.empty());
+                    EXPECT_TRUE(decoded.empty());
+                    continue;
+                }
+                ASSERT_EQ(r.size(), region.size()) << exts[i] << " " << flags[j] << " " << k;
+                ASSERT_EQ(full.type(), region.type());
+                // libjpeg-turbo upsamples the chroma at the left border of the cropped area differently
+                EXPECT_LE(cvtest::norm(full(r), region, NORM_L1)/region.total()/region.channels(), 1.)
+                    << exts[i] << " " << flags[j] << " " << k;
+                EXPECT_EQ(0, cvtest::norm(region, decoded, NORM_INF)) << exts[i] << " " << flags[j] << " " << k;
+            }
+        }
+        remove(filename.c_str());
+    }
+}
+
+TEST(Highgui_Image, decode_encode_batch)
+{
+    const char* exts[] = { ".bmp",
+#ifdef HAVE_PNG
+        ".png",
+#endif
+#ifdef HAVE_JPEG
+        ".jpg",
+#endif
+#ifdef HAVE_TIFF
+        ".tiff",
+#endif
+    };
+    const int count = 11;
+
+    std::vector<Mat> imgs( count );
+    for( int k = 0; k < count; k++ )
+    {
+        imgs[k].create( 50 + k*7, 80 - k*3, k % 3 ? CV_8UC3 : CV_8UC1 );
+        randu( imgs[k], Scalar::all(0), Scalar::all(256) );
+        GaussianBlur( imgs[k], imgs[k], Size(5, 5), 2 );
+    }
+
+    for( size_t i = 0; i < sizeof(exts)/sizeof(exts[0]); i++ )
+    {
+        std::vector<std::vector<uchar> > bufs;
+        ASSERT_TRUE( imencodeBatch( exts[i], imgs, bufs ) );
+        ASSERT_EQ( (size_t)count, bufs.size() );
+        for( int k = 0; k < count; k++ )
+        {
+            std::vector<uchar> single;
+            ASSERT_TRUE( imencode( exts[i], imgs[k], single ) );
+            EXPECT_TRUE( single == bufs[k] ) << exts[i] << " " << k;
+        }
+
+        // the garbage and the truncated buffer must not break the decoders reused for the others
+        std::vector<std::vector<uchar> > all( bufs );
+        all.insert( all.begin() + 3, std::vector<uchar>( 100, (uchar)7 ) );
+        all.insert( all.begin() + 6, std::vector<uchar>( bufs[4].begin(), bufs[4].begin() + bufs[4].size()/2 ) );
+        all.push_back( std::vector<uchar>() );
+
+        const int flags[] = { IMREAD_COLOR, IMREAD_UNCHANGED, IMREAD_REDUCED_GRAYSCALE_2 };
+        for( size_t j = 0; j < sizeof(flags)/sizeof(flags[0]); j++ )
+        {
+            std::vector<Mat> decoded;
+            int n = imdecodeBatch( all, decoded, flags[j] );
+            ASSERT_EQ( all.size(), decoded.size() );
+            EXPECT_LE( count, n );
+            EXPECT_TRUE( decoded[3].empty() );
+            EXPECT_TRUE( decoded.back().empty() );
+
+            for( size_t k = 0; k < all.size(); k++ )
+            {
+                if( k == 6 )
+                    continue; // may or may not decode, depending on the codec
+                Mat expected = all[k].empty() ? Mat() : imdecode( all[k], flags[j] );
+                ASSERT_EQ( expected.size(), decoded[k].size() ) << exts[i] << " " << flags[j] << " " << k;
+                ASSERT_EQ( expected.type(), decoded[k].type() );
+                if( !expected.empty() )
+                {
+                    EXPECT_EQ( 0, cvtest::norm( expected, decoded[k], NORM_INF ) ) << exts[i] << " " << flags[j] << " " << k;
+                }
+            }
+        }
+    }
+
+    std::vector<std::vector<uchar> > bufs;
+    EXPECT_THROW( imencodeBatch( ".unknown", imgs, bufs ), cv::Exception );
+}
+
+TEST(Highgui_Image, encode_to_memory)
+{
+    const char* exts[] = { ".bmp",
+#ifdef HAVE_PNG
+        ".png",
+#endif
+#ifdef HAVE_JPEG
+        ".jpg",
+#endif
+#ifdef HAVE_WEBP
+        ".webp",
+#endif
+    };
+
+    Mat img(203, 301, CV_8UC3);
+    randu(img, Scalar::all(0), Scalar::all(256));
+    GaussianBlur(img, img, Size(5, 5), 2);
+
+    for( size_t i = 0; i < sizeof(exts)/sizeof(exts[0]); i++ )
+    {
+        std::vector<uchar> expected;
+        ASSERT_TRUE(imencode(exts[i], img, expected));
+
+        // more than enough, just enough, too little and no memory at all
+        size_t capacities[] = { expected.size()*2, expected.size(), expected.size()/3, 5, 0 };
+        for( size_t j = 0; j < sizeof(capacities)/sizeof(capacities[0]); j++ )
+        {
+            size_t capacity = capacities[j], size = 0;
+            std::vector<uchar> buf( capacity + 1, (uchar)0xCD );
+            bool fits = imencode(exts[i], img, capacity ? &buf[0] : 0, capacity, size);
+
+            EXPECT_EQ(expected.size(), size) << exts[i] << " " << capacity;
+            EXPECT_EQ(expected.size() <= capacity, fits) << exts[i] << " " << capacity;
+            EXPECT_EQ(0xCD, buf[capacity]) << exts[i] << " " << capacity;
+            if( fits )
+            {
+                EXPECT_TRUE(std::equal(expected.begin(), expected.end(), buf.begin())) << exts[i] << " " << capacity;
+            }
+        }
+    }
+}
+
 #ifdef HAVE_JPEG
 TEST(Highgui_Jpeg, encode_empty)
 {
@@ -525,6 +772,90 @@ TEST(Highgui_Tiff, write_read_16bit_big_little_endian)
     }
 }
 
+// writes an uncompressed little endian multi-page TIFF with the 16-bit grayscale pages
+static void writeMultiPageTiff16( const string& filename, const std::vector<Mat>& pages )
+{
+    std::vector<uchar> buf;
+    const uchar header[] = { 0x49, 0x49, 0x2a, 0x00, 0, 0, 0, 0 };
+    buf.assign( header, header + sizeof(header) );
+    size_t next_ifd_pos = 4;
+
+    for( size_t i = 0; i < pages.size(); i++ )
+    {
+        const Mat& page = pages[i];
+        CV_Assert( page.type() == CV_16UC1 && page.isContinuous() );
+        uint data_pos = (uint)buf.size(), data_size = (uint)(page.total()*page.elemSize());
+        buf.insert( buf.end(), page.data, page.data + data_size );
+
+        uint ifd_pos = (uint)buf.size();
+        memcpy( &buf[next_ifd_pos], &ifd_pos, 4 );
+        const uint tags[][3] = { { 256, 4, (uint)page.cols }, { 257, 4, (uint)page.rows }, { 258, 3, 16 },
+                                 { 262, 3, 1 }, { 273, 4, data_pos }, { 279, 4, data_size } };
+        const int ntags = (int)(sizeof(tags)/sizeof(tags[0]));
+        ushort count = (ushort)ntags;
+        buf.insert( buf.end(), (uchar*)&count, (uchar*)&count + 2 );
+        for( int j = 0; j < ntags; j++ )
+        {
+            ushort entry[] = { (ushort)tags[j][0], (ushort)tags[j][1], 1, 0 };
+            buf.insert( buf.end(), (uchar*)entry, (uchar*)entry + sizeof(entry) );
+            buf.insert( buf.end(), (uchar*)&tags[j][2], (uchar*)&tags[j][2] + 4 );
+        }
+        next_ifd_pos = buf.size();
+        buf.insert( buf.end(), 4, (uchar)0 );
+    }
+
+    FILE* fp = fopen( filename.c_str(), "wb" );
+    ASSERT_TRUE( fp != NULL );
+    ASSERT_EQ( buf.size(), fwrite( &buf[0], 1, buf.size(), fp ) );
+    fclose( fp );
+}
+
+TEST(Highgui_Tiff, read_multipage)
+{
+    // the test file is written in the host byte order
+    const ushort one = 1;
+    if( *(const uchar*)&one != 1 )
+        return;
+
+    std::vector<Mat> pages;
+    pages.push_back(Mat(2, 3, CV_16UC1));
+    pages.push_back(Mat(40, 50, CV_16UC1));
+    pages.push_back(Mat(7, 1, CV_16UC1));
+    for( size_t i = 0; i < pages.size(); i++ )
+        randu(pages[i], Scalar::all(0), Scalar::all(65536));
+
+    string filename = cv::tempfile(".tiff");
+    writeMultiPageTiff16(filename, pages);
+
+    std::vector<Mat> mats(1);
+    ASSERT_TRUE(imreadmulti(filename, mats, IMREAD_UNCHANGED));
+    ASSERT_EQ(pages.size() + 1, mats.size());
+    for( size_t i = 0; i < pages.size(); i++ )
+    {
+        ASSERT_EQ(pages[i].size(), mats[i + 1].size());
+        ASSERT_EQ(CV_16UC1, mats[i + 1].type());
+        EXPECT_EQ(0, cvtest::norm(pages[i], mats[i + 1], NORM_INF)) << i;
+    }
+
+    // imread reads the first page, the flags are applied to all the pages
+    EXPECT_EQ(0, cvtest::norm(pages[0], imread(filename, IMREAD_UNCHANGED), NORM_INF));
+    mats.clear();
+    ASSERT_TRUE(imreadmulti(filename, mats, IMREAD_COLOR));
+    ASSERT_EQ(pages.size(), mats.size());
+    EXPECT_EQ(CV_8UC3, mats[1].type());
+
+    // the single page images are read as well
+    string png_filename = cv::tempfile(".png");
+    ASSERT_TRUE(imwrite(png_filename, pages[1]));
+    mats.clear();
+    ASSERT_TRUE(imreadmulti(png_filename, mats, IMREAD_UNCHANGED));
+    ASSERT_EQ(1u, mats.size());
+    EXPECT_EQ(0, cvtest::norm(pages[1], mats[0], NORM_INF));
+
+    remove(filename.c_str());
+    remove(png_filename.c_str());
+}
+
 class CV_GrfmtReadTifTiledWithNotFullTiles: public cvtest::BaseTest
 {
 public:
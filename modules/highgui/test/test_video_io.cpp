@@ -577,3 +577,72 @@ TEST(Highgui_Video, write_read) { CV_SpecificVideoTest test; test.safe_run(); }
 #endif
 
 TEST(Highgui_Image, write_read) { CV_SpecificImageTest test; test.safe_run(); }
+
+TEST(Highgui_Video, async_capture)
+{
+    const int count = 30;
+    string pattern = cv::tempfile() + "_%02d.png";
+    for( int i = 0; i < count; i++ )
+        ASSERT_TRUE(imwrite(format(pattern.c_str(), i), Mat(48, 64, CV_8UC3, Scalar::all(i*8))));
+
+    VideoCapture cap(pattern);
+    ASSERT_TRUE(cap.isOpened());
+    ASSERT_TRUE(cap.set(CAP_PROP_ASYNC_QUEUE_SIZE, 4));
+    EXPECT_EQ(4, cap.get(CAP_PROP_ASYNC_QUEUE_SIZE));
+    EXPECT_EQ(CAP_ASYNC_BLOCK, cap.get(CAP_PROP_ASYNC_POLICY));
+
+    // all the frames in order; the buffers handed over to the caller are not reused
+    Mat frame;
+    std::vector<Mat> kept;
+    for( int i = 0; i < count; i++ )
+    {
+        ASSERT_TRUE(cap.read(frame)) << i;
+        ASSERT_EQ(i*8, frame.at<Vec3b>(0, 0)[0]) << i;
+        if( i % 3 == 0 )
+        {
+            kept.push_back(frame);
+            frame = Mat();
+        }
+    }
+    EXPECT_FALSE(cap.read(frame));
+    EXPECT_TRUE(frame.empty());
+    for( size_t i = 0; i < kept.size(); i++ )
+        EXPECT_EQ((int)i*24, kept[i].at<Vec3b>(47, 63)[2]) << i;
+    EXPECT_LE(cap.get(CAP_PROP_ASYNC_MAX_DEPTH), 4);
+    EXPECT_GE(cap.get(CAP_PROP_ASYNC_MAX_DEPTH), 1);
+    EXPECT_EQ(0, cap.get(CAP_PROP_ASYNC_DROPPED));
+
+    // seeking drops the queued frames
+    ASSERT_TRUE(cap.set(CAP_PROP_POS_FRAMES, 10));
+    ASSERT_TRUE(cap.read(frame));
+    EXPECT_EQ(80, frame.at<Vec3b>(0, 0)[0]);
+    ASSERT_TRUE(cap.retrieve(frame));
+    EXPECT_EQ(80, frame.at<Vec3b>(0, 0)[0]);
+
+    // only the newest frames are left when the caller is slow
+    ASSERT_TRUE(cap.set(CAP_PROP_ASYNC_QUEUE_SIZE, 2));
+    ASSERT_TRUE(cap.set(CAP_PROP_ASYNC_POLICY, CAP_ASYNC_DROP_OLDEST));
+    int64 start = getTickCount();
+    while( cap.get(CAP_PROP_ASYNC_DROPPED) < count - 13 &&
+           (getTickCount() - start)/getTickFrequency() < 10 )
+        ;
+    EXPECT_EQ(count - 13, cap.get(CAP_PROP_ASYNC_DROPPED));
+    EXPECT_EQ(2, cap.get(CAP_PROP_ASYNC_QUEUE_DEPTH));
+    for( int i = count - 2; i < count; i++ )
+    {
+        ASSERT_TRUE(cap.read(frame));
+        EXPECT_EQ(i*8, frame.at<Vec3b>(0, 0)[0]);
+    }
+    EXPECT_FALSE(cap.read(frame));
+
+    // back to the synchronous capture
+    ASSERT_TRUE(cap.set(CAP_PROP_ASYNC_QUEUE_SIZE, 0));
+    ASSERT_TRUE(cap.set(CAP_PROP_POS_FRAMES, 5));
+    ASSERT_TRUE(cap.read(frame));
+    EXPECT_EQ(40, frame.at<Vec3b>(0, 0)[0]);
+    EXPECT_EQ(0, cap.get(CAP_PROP_ASYNC_QUEUE_SIZE));
+
+    cap.release();
+    for( int i = 0; i < count; i++ )
+        remove(format(pattern.c_str(), i).c_str());
+}
@@ -657,6 +657,7 @@ public:
     virtual int proceed(const uchar* src, int srcStep, int srcCount,
                         uchar* dst, int dstStep);
     //! applies filter to the specified ROI of the image. if srcRoi=(0,0,-1,-1), the whole image is filtered.
+    //! large images are split into horizontal stripes that are filtered in parallel by copies of the engine.
     virtual void apply( const Mat& src, Mat& dst,
                         const Rect& srcRoi = Rect(0,0,-1,-1),
                         Point dstOfs = Point(0,0),
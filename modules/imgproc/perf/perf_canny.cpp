@@ -35,3 +35,25 @@ PERF_TEST_P(Img_Aperture_L2_thresholds, canny,
 
     SANITY_CHECK(edges);
 }
+
+typedef std::tr1::tuple<Size, bool> Size_L2_t;
+typedef perf::TestBaseWithParam<Size_L2_t> Size_L2;
+
+PERF_TEST_P(Size_L2, canny_large,
+            testing::Combine(
+                testing::Values( sz1080p, sz2160p ),
+                testing::Bool()
+                )
+            )
+{
+    Size size = get<0>(GetParam());
+    bool useL2 = get<1>(GetParam());
+
+    Mat img(size, CV_8UC1), edges(size, CV_8UC1);
+    declare.in(img, WARMUP_RNG).out(edges);
+    GaussianBlur(img, img, Size(0, 0), 2);
+
+    TEST_CYCLE() Canny(img, edges, 20, 60, 3, useL2);
+
+    SANITY_CHECK_NOTHING();
+}
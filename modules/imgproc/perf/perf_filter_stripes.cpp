@@ -0,0 +1,47 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+// Large images, which FilterEngine::apply splits into the stripes processed in parallel
+
+enum { GAUSSIAN_BLUR, SEP_FILTER_2D, FILTER_2D, SOBEL, SCHARR, LAPLACIAN, BLUR };
+CV_ENUM(FilterKind, GAUSSIAN_BLUR, SEP_FILTER_2D, FILTER_2D, SOBEL, SCHARR, LAPLACIAN, BLUR)
+
+typedef std::tr1::tuple<Size, MatType, FilterKind> Size_MatType_FilterKind_t;
+typedef perf::TestBaseWithParam<Size_MatType_FilterKind_t> Size_MatType_FilterKind;
+
+PERF_TEST_P(Size_MatType_FilterKind, FilterEngine_stripes,
+            testing::Combine(
+                testing::Values(sz1080p, sz2160p),
+                testing::Values(CV_8UC1, CV_8UC4),
+                FilterKind::all()
+            )
+          )
+{
+    Size size = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    int kind = get<2>(GetParam());
+
+    Mat src(size, type), dst;
+    Mat kernel(5, 5, CV_32F, Scalar::all(1./25));
+    Mat kx = getGaussianKernel(9, 2., CV_32F), ky = getGaussianKernel(5, 1., CV_32F);
+
+    declare.in(src, WARMUP_RNG).time(60);
+
+    switch( kind )
+    {
+    case GAUSSIAN_BLUR: TEST_CYCLE() GaussianBlur(src, dst, Size(5, 5), 0); break;
+    case SEP_FILTER_2D: TEST_CYCLE() sepFilter2D(src, dst, CV_32F, kx, ky); break;
+    case FILTER_2D: TEST_CYCLE() filter2D(src, dst, -1, kernel); break;
+    case SOBEL: TEST_CYCLE() Sobel(src, dst, CV_16S, 1, 0); break;
+    case SCHARR: TEST_CYCLE() Scharr(src, dst, CV_16S, 0, 1); break;
+    case LAPLACIAN: TEST_CYCLE() Laplacian(src, dst, CV_16S, 3); break;
+    case BLUR: TEST_CYCLE() blur(src, dst, Size(7, 7)); break;
+    }
+
+    SANITY_CHECK_NOTHING();
+}
@@ -39,3 +39,77 @@ PERF_TEST_P(Image_RhoStep_ThetaStep_Threshold, HoughLines,
     transpose(lines, lines);
     SANITY_CHECK(lines);
 }
+
+// Dense edge maps: random edge pixels, so that the voting dominates the run time
+
+typedef std::tr1::tuple<Size, int> Size_EdgeDensity_t;
+typedef perf::TestBaseWithParam<Size_EdgeDensity_t> Size_EdgeDensity;
+
+static Mat denseEdges(Size sz, int percent)
+{
+    Mat edges(sz, CV_8UC1);
+    randu(edges, 0, 100);
+    return edges < percent;
+}
+
+PERF_TEST_P(Size_EdgeDensity, HoughLines_dense,
+            testing::Combine(
+                testing::Values( szVGA, sz1080p ),
+                testing::Values( 5, 20 )
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    Mat image = denseEdges(sz, get<1>(GetParam()));
+    std::vector<Vec2f> lines;
+    declare.time(60);
+
+    TEST_CYCLE() HoughLines(image, lines, 1, CV_PI/180, sz.height);
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(Size_EdgeDensity, HoughLinesP_dense,
+            testing::Combine(
+                testing::Values( szVGA, sz1080p ),
+                testing::Values( 5, 20 )
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    Mat image = denseEdges(sz, get<1>(GetParam()));
+    std::vector<Vec4i> lines;
+    declare.time(60);
+
+    TEST_CYCLE() HoughLinesP(image, lines, 1, CV_PI/180, sz.height, 50, 5);
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef std::tr1::tuple<Size, int> Size_CirclesCount_t;
+typedef perf::TestBaseWithParam<Size_CirclesCount_t> Size_CirclesCount;
+
+PERF_TEST_P(Size_CirclesCount, HoughCircles,
+            testing::Combine(
+                testing::Values( szVGA, sz1080p ),
+                testing::Values( 20, 200 )
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int count = get<1>(GetParam());
+    Mat image(sz, CV_8UC1, Scalar::all(0)), noise(sz, CV_8UC1);
+    RNG rng(0x1234);
+    for( int i = 0; i < count; i++ )
+        circle(image, Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height)),
+               rng.uniform(8, 40), Scalar::all(rng.uniform(100, 256)), -1);
+    randu(noise, 0, 30);
+    image += noise;
+    GaussianBlur(image, image, Size(5, 5), 1.5);
+    std::vector<Vec3f> circles;
+    declare.time(60);
+
+    TEST_CYCLE() HoughCircles(image, circles, HOUGH_GRADIENT, 1, 10, 100, 20, 5, 50);
+
+    SANITY_CHECK_NOTHING();
+}
@@ -82,3 +82,26 @@ PERF_TEST_P( Size_MatType_OutMatDepth, integral_sqsum_tilted,
     SANITY_CHECK(sqsum, 1e-6);
     SANITY_CHECK(tilted, 1e-6, tilted.depth() > CV_32S ? ERROR_RELATIVE : ERROR_ABSOLUTE);
 }
+
+PERF_TEST_P(Size_MatType_OutMatDepth, integral_sqsum_large,
+            testing::Combine(
+                testing::Values(::perf::sz1080p, ::perf::sz2160p),
+                testing::Values(CV_8UC1, CV_8UC4),
+                testing::Values(CV_32S, CV_32F, CV_64F)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int matType = get<1>(GetParam());
+    int sdepth = get<2>(GetParam());
+
+    Mat src(sz, matType);
+    Mat sum, sqsum;
+
+    declare.in(src, WARMUP_RNG);
+    declare.time(100);
+
+    TEST_CYCLE() integral(src, sum, sqsum, sdepth, CV_64F);
+
+    SANITY_CHECK_NOTHING();
+}
@@ -81,3 +81,32 @@ PERF_TEST_P(ImgSize_TmplSize_Method, matchTemplateBig,
 
     SANITY_CHECK(result, eps);
 }
+
+typedef std::tr1::tuple<Size, MatType, MethodType> TmplSize_MatType_Method_t;
+typedef perf::TestBaseWithParam<TmplSize_MatType_Method_t> TmplSize_MatType_Method;
+
+PERF_TEST_P(TmplSize_MatType_Method, matchTemplate1080p,
+            testing::Combine(
+                testing::Values(cv::Size(8, 8), cv::Size(16, 16), cv::Size(32, 32)),
+                testing::Values(CV_8UC1, CV_8UC3, CV_32FC1),
+                testing::Values((int)TM_CCORR, (int)TM_CCOEFF_NORMED)
+                )
+    )
+{
+    Size tmplSz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    int method = get<2>(GetParam());
+
+    Mat img(sz1080p, type);
+    Mat tmpl(tmplSz, type);
+    Mat result;
+
+    declare
+        .in(img, WARMUP_RNG)
+        .in(tmpl, WARMUP_RNG)
+        .time(60);
+
+    TEST_CYCLE() matchTemplate(img, tmpl, result, method);
+
+    SANITY_CHECK_NOTHING();
+}
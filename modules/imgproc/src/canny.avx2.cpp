@@ -0,0 +1,104 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2008-2013, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and / or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+/* ////////////////////////////////////////////////////////////////////
+//
+//  AVX2 version of the gradient magnitude of Canny.
+//  Built with the AVX2 compiler flags and called from canny.cpp when the CPU supports AVX2.
+//
+// */
+
+#include "opt_avx2.hpp"
+
+#if CV_AVX2
+
+namespace cv
+{
+namespace opt_AVX2
+{
+
+int cannyMagnitude(const short* dx, const short* dy, int* mag, int n, bool L2gradient)
+{
+    int j = 0;
+
+    if( !L2gradient )
+    {
+        for( ; j <= n - 16; j += 16 )
+        {
+            // abs(-32768) is 0x8000, which is right when zero-extended
+            __m256i v_dx = _mm256_abs_epi16(_mm256_loadu_si256((const __m256i*)(dx + j)));
+            __m256i v_dy = _mm256_abs_epi16(_mm256_loadu_si256((const __m256i*)(dy + j)));
+
+            __m256i v_lo = _mm256_add_epi32(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(v_dx)),
+                                            _mm256_cvtepu16_epi32(_mm256_castsi256_si128(v_dy)));
+            __m256i v_hi = _mm256_add_epi32(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(v_dx, 1)),
+                                            _mm256_cvtepu16_epi32(_mm256_extracti128_si256(v_dy, 1)));
+            _mm256_storeu_si256((__m256i*)(mag + j), v_lo);
+            _mm256_storeu_si256((__m256i*)(mag + j + 8), v_hi);
+        }
+    }
+    else
+    {
+        for( ; j <= n - 16; j += 16 )
+        {
+            __m256i v_dx = _mm256_loadu_si256((const __m256i*)(dx + j));
+            __m256i v_dy = _mm256_loadu_si256((const __m256i*)(dy + j));
+
+            // the unpacking works within the 128-bit lanes: 0-3,8-11 and 4-7,12-15
+            __m256i v_lo = _mm256_unpacklo_epi16(v_dx, v_dy);
+            __m256i v_hi = _mm256_unpackhi_epi16(v_dx, v_dy);
+            v_lo = _mm256_madd_epi16(v_lo, v_lo);
+            v_hi = _mm256_madd_epi16(v_hi, v_hi);
+
+            _mm256_storeu_si256((__m256i*)(mag + j), _mm256_permute2x128_si256(v_lo, v_hi, 0x20));
+            _mm256_storeu_si256((__m256i*)(mag + j + 8), _mm256_permute2x128_si256(v_lo, v_hi, 0x31));
+        }
+    }
+
+    return j;
+}
+
+}
+}
+
+#endif
@@ -41,6 +41,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels.hpp"
+#include "opt_avx2.hpp"
 
 
 #if defined (HAVE_IPP) && (IPP_VERSION_MAJOR >= 7)
@@ -254,167 +255,276 @@ static bool ocl_Canny(InputArray _src, OutputArray _dst, float low_thresh, float
 
 #endif
 
-}
 
-void cv::Canny( InputArray _src, OutputArray _dst,
-                double low_thresh, double high_thresh,
-                int aperture_size, bool L2gradient )
+#if CV_SSE2
+static int cannyMagnitudeSSE2(const short* dx, const short* dy, int* mag, int n, bool L2gradient)
 {
-    const int type = _src.type(), depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
-    const Size size = _src.size();
+    int j = 0;
 
-    CV_Assert( depth == CV_8U );
-    _dst.create(size, CV_8U);
-
-    if (!L2gradient && (aperture_size & CV_CANNY_L2_GRADIENT) == CV_CANNY_L2_GRADIENT)
+    if (!L2gradient)
     {
-        // backward compatibility
-        aperture_size &= ~CV_CANNY_L2_GRADIENT;
-        L2gradient = true;
+        for ( ; j <= n - 8; j += 8)
+        {
+            // |dx| + |dy| does not fit 16 bits, so the sums are computed in 32 bits
+            __m128i v_dx = _mm_loadu_si128((const __m128i*)(dx + j));
+            __m128i v_dy = _mm_loadu_si128((const __m128i*)(dy + j));
+            __m128i v_dx_lo = _mm_srai_epi32(_mm_unpacklo_epi16(v_dx, v_dx), 16);
+            __m128i v_dx_hi = _mm_srai_epi32(_mm_unpackhi_epi16(v_dx, v_dx), 16);
+            __m128i v_dy_lo = _mm_srai_epi32(_mm_unpacklo_epi16(v_dy, v_dy), 16);
+            __m128i v_dy_hi = _mm_srai_epi32(_mm_unpackhi_epi16(v_dy, v_dy), 16);
+
+            __m128i v_sign;
+            v_sign = _mm_srai_epi32(v_dx_lo, 31); v_dx_lo = _mm_sub_epi32(_mm_xor_si128(v_dx_lo, v_sign), v_sign);
+            v_sign = _mm_srai_epi32(v_dx_hi, 31); v_dx_hi = _mm_sub_epi32(_mm_xor_si128(v_dx_hi, v_sign), v_sign);
+            v_sign = _mm_srai_epi32(v_dy_lo, 31); v_dy_lo = _mm_sub_epi32(_mm_xor_si128(v_dy_lo, v_sign), v_sign);
+            v_sign = _mm_srai_epi32(v_dy_hi, 31); v_dy_hi = _mm_sub_epi32(_mm_xor_si128(v_dy_hi, v_sign), v_sign);
+
+            _mm_storeu_si128((__m128i*)(mag + j), _mm_add_epi32(v_dx_lo, v_dy_lo));
+            _mm_storeu_si128((__m128i*)(mag + j + 4), _mm_add_epi32(v_dx_hi, v_dy_hi));
+        }
     }
+    else
+    {
+        for ( ; j <= n - 8; j += 8)
+        {
+            __m128i v_dx = _mm_loadu_si128((const __m128i*)(dx + j));
+            __m128i v_dy = _mm_loadu_si128((const __m128i*)(dy + j));
+            __m128i v_lo = _mm_unpacklo_epi16(v_dx, v_dy);
+            __m128i v_hi = _mm_unpackhi_epi16(v_dx, v_dy);
 
-    if ((aperture_size & 1) == 0 || (aperture_size != -1 && (aperture_size < 3 || aperture_size > 7)))
-        CV_Error(CV_StsBadFlag, "Aperture size should be odd");
+            _mm_storeu_si128((__m128i*)(mag + j), _mm_madd_epi16(v_lo, v_lo));
+            _mm_storeu_si128((__m128i*)(mag + j + 4), _mm_madd_epi16(v_hi, v_hi));
+        }
+    }
 
-    if (low_thresh > high_thresh)
-        std::swap(low_thresh, high_thresh);
+    return j;
+}
+#endif
 
-    CV_OCL_RUN(_dst.isUMat() && (cn == 1 || cn == 3),
-               ocl_Canny(_src, _dst, (float)low_thresh, (float)high_thresh, aperture_size, L2gradient, cn, size))
+static void cannyMagnitude(const short* dx, const short* dy, int* mag, int n,
+                           bool L2gradient, bool haveSSE2, bool haveAVX2)
+{
+    int j = 0;
 
-    Mat src = _src.getMat(), dst = _dst.getMat();
+#ifdef HAVE_DISPATCH_AVX2
+    if (haveAVX2)
+        j = opt_AVX2::cannyMagnitude(dx, dy, mag, n, L2gradient);
+#else
+    (void)haveAVX2;
+#endif
 
-#ifdef HAVE_TEGRA_OPTIMIZATION
-    if (tegra::canny(src, dst, low_thresh, high_thresh, aperture_size, L2gradient))
-        return;
+#if CV_SSE2
+    if (haveSSE2)
+        j += cannyMagnitudeSSE2(dx + j, dy + j, mag + j, n - j, L2gradient);
+#else
+    (void)haveSSE2;
 #endif
 
-#ifdef USE_IPP_CANNY
-    if( aperture_size == 3 && !L2gradient && 1 == cn )
+    if (!L2gradient)
     {
-        if (ippCanny(src, dst, (float)low_thresh, (float)high_thresh))
-            return;
-        setIppErrorStatus();
+        for ( ; j < n; j++)
+            mag[j] = std::abs(int(dx[j])) + std::abs(int(dy[j]));
     }
-#endif
+    else
+    {
+        for ( ; j < n; j++)
+            mag[j] = int(dx[j])*dx[j] + int(dy[j])*dy[j];
+    }
+}
 
-    Mat dx(src.rows, src.cols, CV_16SC(cn));
-    Mat dy(src.rows, src.cols, CV_16SC(cn));
+#define CANNY_PUSH(d)    *(d) = uchar(2), stack.push_back(d)
+#define CANNY_POP(d)     (d) = stack.back(), stack.pop_back()
 
-    Sobel(src, dx, CV_16S, 1, 0, aperture_size, 1, 0, BORDER_REPLICATE);
-    Sobel(src, dy, CV_16S, 0, 1, aperture_size, 1, 0, BORDER_REPLICATE);
+// tracks the edges from the pixels in the stack over the whole map (hysteresis thresholding)
+static void cannyHysteresis(std::vector<uchar*>& stack, ptrdiff_t mapstep)
+{
+    while (!stack.empty())
+    {
+        uchar* m;
+        CANNY_POP(m);
 
-    if (L2gradient)
+        if (!m[-1])         CANNY_PUSH(m - 1);
+        if (!m[1])          CANNY_PUSH(m + 1);
+        if (!m[-mapstep-1]) CANNY_PUSH(m - mapstep - 1);
+        if (!m[-mapstep])   CANNY_PUSH(m - mapstep);
+        if (!m[-mapstep+1]) CANNY_PUSH(m - mapstep + 1);
+        if (!m[mapstep-1])  CANNY_PUSH(m + mapstep - 1);
+        if (!m[mapstep])    CANNY_PUSH(m + mapstep);
+        if (!m[mapstep+1])  CANNY_PUSH(m + mapstep + 1);
+    }
+}
+
+/*
+   Computes the gradient magnitude, performs the non-maxima suppression and the hysteresis
+   thresholding in horizontal stripes of the image. Each stripe writes only its own rows of
+   the map; the neighbours of its edge pixels from the other stripes are collected
+   in borderPeaks, and the edges are tracked across the stripes after all of them are done.
+   So the result is the same as of the single pass over the image.
+*/
+class CannyInvoker : public ParallelLoopBody
+{
+public:
+    CannyInvoker(const Mat& _dx, const Mat& _dy, uchar* _map, ptrdiff_t _mapstep,
+                 int _low, int _high, bool _L2gradient, int _nStripes,
+                 std::vector<std::vector<uchar*> >& _borderPeaks) :
+        dx(_dx), dy(_dy), map(_map), mapstep(_mapstep), low(_low), high(_high),
+        L2gradient(_L2gradient), nStripes(_nStripes), borderPeaks(&_borderPeaks)
     {
-        low_thresh = std::min(32767.0, low_thresh);
-        high_thresh = std::min(32767.0, high_thresh);
+        haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+        haveAVX2 = checkHardwareSupport(CV_CPU_AVX2);
+    }
 
-        if (low_thresh > 0) low_thresh *= low_thresh;
-        if (high_thresh > 0) high_thresh *= high_thresh;
+    void operator()(const Range& range) const
+    {
+        for (int i = range.start; i < range.end; i++)
+            processStripe(dx.rows*i/nStripes, dx.rows*(i+1)/nStripes, (*borderPeaks)[i]);
     }
-    int low = cvFloor(low_thresh);
-    int high = cvFloor(high_thresh);
 
-    ptrdiff_t mapstep = src.cols + 2;
-    AutoBuffer<uchar> buffer((src.cols+2)*(src.rows+2) + cn * mapstep * 3 * sizeof(int));
+private:
+    void processStripe(int row0, int row1, std::vector<uchar*>& peaks) const
+    {
+        int rows = dx.rows, cols = dx.cols, cn = dx.channels();
+        if (row0 >= row1)
+            return;
 
-    int* mag_buf[3];
-    mag_buf[0] = (int*)(uchar*)buffer;
-    mag_buf[1] = mag_buf[0] + mapstep*cn;
-    mag_buf[2] = mag_buf[1] + mapstep*cn;
-    memset(mag_buf[0], 0, /* cn* */mapstep*sizeof(int));
+        AutoBuffer<int> mbuffer(mapstep*cn*3);
+        AutoBuffer<short> xybuffer(cn > 1 ? cols*6 : 1);
+        int* mag_buf[3];
+        const short* x_buf[3];
+        const short* y_buf[3];
+        for (int k = 0; k < 3; k++)
+        {
+            mag_buf[k] = (int*)mbuffer + mapstep*cn*k;
+            x_buf[k] = y_buf[k] = 0;
+        }
 
-    uchar* map = (uchar*)(mag_buf[2] + mapstep*cn);
-    memset(map, 1, mapstep);
-    memset(map + mapstep*(src.rows + 1), 1, mapstep);
+        std::vector<uchar*> stack;
+        stack.reserve(std::max(1 << 10, (row1 - row0)*cols/10));
+
+        /* sector numbers
+           (Top-Left Origin)
+
+            1   2   3
+             *  *  *
+              * * *
+            0*******0
+              * * *
+             *  *  *
+            3   2   1
+        */
+
+        // calculate magnitude and angle of gradient, perform non-maxima suppression.
+        // fill the map with one of the following values:
+        //   0 - the pixel might belong to an edge
+        //   1 - the pixel can not belong to an edge
+        //   2 - the pixel does belong to an edge
+        // the magnitude of the rows row0-1 and row1 is needed as well
+        for (int i = row0 - 1; i <= row1; i++)
+        {
+            int* _norm = mag_buf[2] + 1;
+            if (0 <= i && i < rows)
+            {
+                const short* _dx = dx.ptr<short>(i);
+                const short* _dy = dy.ptr<short>(i);
 
-    int maxsize = std::max(1 << 10, src.cols * src.rows / 10);
-    std::vector<uchar*> stack(maxsize);
-    uchar **stack_top = &stack[0];
-    uchar **stack_bottom = &stack[0];
-
-    /* sector numbers
-       (Top-Left Origin)
-
-        1   2   3
-         *  *  *
-          * * *
-        0*******0
-          * * *
-         *  *  *
-        3   2   1
-    */
-
-    #define CANNY_PUSH(d)    *(d) = uchar(2), *stack_top++ = (d)
-    #define CANNY_POP(d)     (d) = *--stack_top
-
-    // calculate magnitude and angle of gradient, perform non-maxima suppression.
-    // fill the map with one of the following values:
-    //   0 - the pixel might belong to an edge
-    //   1 - the pixel can not belong to an edge
-    //   2 - the pixel does belong to an edge
-    for (int i = 0; i <= src.rows; i++)
-    {
-        int* _norm = mag_buf[(i > 0) + 1] + 1;
-        if (i < src.rows)
+                cannyMagnitude(_dx, _dy, _norm, cols*cn, L2gradient, haveSSE2, haveAVX2);
+
+                if (cn > 1)
+                {
+                    // the channel with the largest magnitude is taken
+                    short* _x = (short*)xybuffer + cols*(((i - row0 + 1) % 3)*2);
+                    short* _y = _x + cols;
+                    for(int j = 0, jn = 0; j < cols; ++j, jn += cn)
+                    {
+                        int maxIdx = jn;
+                        for(int k = 1; k < cn; ++k)
+                            if(_norm[jn + k] > _norm[maxIdx]) maxIdx = jn + k;
+                        _norm[j] = _norm[maxIdx];
+                        _x[j] = _dx[maxIdx];
+                        _y[j] = _dy[maxIdx];
+                    }
+                    _dx = _x;
+                    _dy = _y;
+                }
+                _norm[-1] = _norm[cols] = 0;
+                x_buf[2] = _dx;
+                y_buf[2] = _dy;
+            }
+            else
+                memset(_norm-1, 0, /* cn* */mapstep*sizeof(int));
+
+            if (i > row0)
+                suppressNonMaxima(i - 1, row0, mag_buf, x_buf[1], y_buf[1], stack);
+
+            // scroll the ring buffer
+            int* _mag = mag_buf[0];
+            mag_buf[0] = mag_buf[1];
+            mag_buf[1] = mag_buf[2];
+            mag_buf[2] = _mag;
+            x_buf[0] = x_buf[1]; x_buf[1] = x_buf[2];
+            y_buf[0] = y_buf[1]; y_buf[1] = y_buf[2];
+        }
+
+        // now track the edges within the stripe (hysteresis thresholding)
+        // the first and the last rows of the stripe have the neighbours in the other stripes
+        const uchar* first = map + mapstep*(row0 + 2);
+        const uchar* last = map + mapstep*row1;
+        bool hasPrev = row0 > 0, hasNext = row1 < rows;
+
+        while (!stack.empty())
         {
-            short* _dx = dx.ptr<short>(i);
-            short* _dy = dy.ptr<short>(i);
+            uchar* m;
+            CANNY_POP(m);
+
+            if (!m[-1])         CANNY_PUSH(m - 1);
+            if (!m[1])          CANNY_PUSH(m + 1);
 
-            if (!L2gradient)
+            if (hasPrev && m < first)
             {
-                for (int j = 0; j < src.cols*cn; j++)
-                    _norm[j] = std::abs(int(_dx[j])) + std::abs(int(_dy[j]));
+                // the row above belongs to the previous stripe
+                peaks.push_back(m - mapstep - 1);
+                peaks.push_back(m - mapstep);
+                peaks.push_back(m - mapstep + 1);
             }
             else
             {
-                for (int j = 0; j < src.cols*cn; j++)
-                    _norm[j] = int(_dx[j])*_dx[j] + int(_dy[j])*_dy[j];
+                if (!m[-mapstep-1]) CANNY_PUSH(m - mapstep - 1);
+                if (!m[-mapstep])   CANNY_PUSH(m - mapstep);
+                if (!m[-mapstep+1]) CANNY_PUSH(m - mapstep + 1);
             }
 
-            if (cn > 1)
+            if (hasNext && m >= last)
             {
-                for(int j = 0, jn = 0; j < src.cols; ++j, jn += cn)
-                {
-                    int maxIdx = jn;
-                    for(int k = 1; k < cn; ++k)
-                        if(_norm[jn + k] > _norm[maxIdx]) maxIdx = jn + k;
-                    _norm[j] = _norm[maxIdx];
-                    _dx[j] = _dx[maxIdx];
-                    _dy[j] = _dy[maxIdx];
-                }
+                // the row below belongs to the next stripe
+                peaks.push_back(m + mapstep - 1);
+                peaks.push_back(m + mapstep);
+                peaks.push_back(m + mapstep + 1);
+            }
+            else
+            {
+                if (!m[mapstep-1])  CANNY_PUSH(m + mapstep - 1);
+                if (!m[mapstep])    CANNY_PUSH(m + mapstep);
+                if (!m[mapstep+1])  CANNY_PUSH(m + mapstep + 1);
             }
-            _norm[-1] = _norm[src.cols] = 0;
         }
-        else
-            memset(_norm-1, 0, /* cn* */mapstep*sizeof(int));
-
-        // at the very beginning we do not have a complete ring
-        // buffer of 3 magnitude rows for non-maxima suppression
-        if (i == 0)
-            continue;
+    }
 
-        uchar* _map = map + mapstep*i + 1;
-        _map[-1] = _map[src.cols] = 1;
+    void suppressNonMaxima(int row, int row0, int** mag_buf, const short* _x, const short* _y,
+                           std::vector<uchar*>& stack) const
+    {
+        int cols = dx.cols;
+        uchar* _map = map + mapstep*(row + 1) + 1;
+        _map[-1] = _map[cols] = 1;
 
         int* _mag = mag_buf[1] + 1; // take the central row
         ptrdiff_t magstep1 = mag_buf[2] - mag_buf[1];
         ptrdiff_t magstep2 = mag_buf[0] - mag_buf[1];
 
-        const short* _x = dx.ptr<short>(i-1);
-        const short* _y = dy.ptr<short>(i-1);
-
-        if ((stack_top - stack_bottom) + src.cols > maxsize)
-        {
-            int sz = (int)(stack_top - stack_bottom);
-            maxsize = maxsize * 3/2;
-            stack.resize(maxsize);
-            stack_bottom = &stack[0];
-            stack_top = stack_bottom + sz;
-        }
+        // the first row of the stripe can not look at the row above, it is written by another stripe
+        const uchar* above = row > row0 ? _map - mapstep : 0;
 
         int prev_flag = 0;
-        for (int j = 0; j < src.cols; j++)
+        for (int j = 0; j < cols; j++)
         {
             #define CANNY_SHIFT 15
             const int TG22 = (int)(0.4142135623730950488016887242097*(1<<CANNY_SHIFT) + 0.5);
@@ -452,7 +562,7 @@ void cv::Canny( InputArray _src, OutputArray _dst,
             _map[j] = uchar(1);
             continue;
 __ocv_canny_push:
-            if (!prev_flag && m > high && _map[j-mapstep] != 2)
+            if (!prev_flag && m > high && (!above || above[j] != 2))
             {
                 CANNY_PUSH(_map + j);
                 prev_flag = 1;
@@ -460,47 +570,134 @@ __ocv_canny_push:
             else
                 _map[j] = 0;
         }
+    }
 
-        // scroll the ring buffer
-        _mag = mag_buf[0];
-        mag_buf[0] = mag_buf[1];
-        mag_buf[1] = mag_buf[2];
-        mag_buf[2] = _mag;
+    const Mat& dx;
+    const Mat& dy;
+    uchar* map;
+    ptrdiff_t mapstep;
+    int low, high;
+    bool L2gradient;
+    bool haveSSE2, haveAVX2;
+    int nStripes;
+    std::vector<std::vector<uchar*> >* borderPeaks;
+};
+
+class CannyFinalPass : public ParallelLoopBody
+{
+public:
+    CannyFinalPass(const uchar* _map, ptrdiff_t _mapstep, Mat& _dst) :
+        map(_map), mapstep(_mapstep), dst(_dst)
+    {
     }
 
-    // now track the edges (hysteresis thresholding)
-    while (stack_top > stack_bottom)
+    void operator()(const Range& range) const
     {
-        uchar* m;
-        if ((stack_top - stack_bottom) + 8 > maxsize)
+        for (int i = range.start; i < range.end; i++)
         {
-            int sz = (int)(stack_top - stack_bottom);
-            maxsize = maxsize * 3/2;
-            stack.resize(maxsize);
-            stack_bottom = &stack[0];
-            stack_top = stack_bottom + sz;
+            const uchar* pmap = map + mapstep*i;
+            uchar* pdst = dst.ptr(i);
+            for (int j = 0; j < dst.cols; j++)
+                pdst[j] = (uchar)-(pmap[j] >> 1);
         }
+    }
 
-        CANNY_POP(m);
+private:
+    const uchar* map;
+    ptrdiff_t mapstep;
+    Mat& dst;
+};
 
-        if (!m[-1])         CANNY_PUSH(m - 1);
-        if (!m[1])          CANNY_PUSH(m + 1);
-        if (!m[-mapstep-1]) CANNY_PUSH(m - mapstep - 1);
-        if (!m[-mapstep])   CANNY_PUSH(m - mapstep);
-        if (!m[-mapstep+1]) CANNY_PUSH(m - mapstep + 1);
-        if (!m[mapstep-1])  CANNY_PUSH(m + mapstep - 1);
-        if (!m[mapstep])    CANNY_PUSH(m + mapstep);
-        if (!m[mapstep+1])  CANNY_PUSH(m + mapstep + 1);
+}
+
+void cv::Canny( InputArray _src, OutputArray _dst,
+                double low_thresh, double high_thresh,
+                int aperture_size, bool L2gradient )
+{
+    const int type = _src.type(), depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
+    const Size size = _src.size();
+
+    CV_Assert( depth == CV_8U );
+    _dst.create(size, CV_8U);
+
+    if (!L2gradient && (aperture_size & CV_CANNY_L2_GRADIENT) == CV_CANNY_L2_GRADIENT)
+    {
+        // backward compatibility
+        aperture_size &= ~CV_CANNY_L2_GRADIENT;
+        L2gradient = true;
     }
 
-    // the final pass, form the final image
-    const uchar* pmap = map + mapstep + 1;
-    uchar* pdst = dst.ptr();
-    for (int i = 0; i < src.rows; i++, pmap += mapstep, pdst += dst.step)
+    if ((aperture_size & 1) == 0 || (aperture_size != -1 && (aperture_size < 3 || aperture_size > 7)))
+        CV_Error(CV_StsBadFlag, "Aperture size should be odd");
+
+    if (low_thresh > high_thresh)
+        std::swap(low_thresh, high_thresh);
+
+    CV_OCL_RUN(_dst.isUMat() && (cn == 1 || cn == 3),
+               ocl_Canny(_src, _dst, (float)low_thresh, (float)high_thresh, aperture_size, L2gradient, cn, size))
+
+    Mat src = _src.getMat(), dst = _dst.getMat();
+
+#ifdef HAVE_TEGRA_OPTIMIZATION
+    if (tegra::canny(src, dst, low_thresh, high_thresh, aperture_size, L2gradient))
+        return;
+#endif
+
+#ifdef USE_IPP_CANNY
+    if( aperture_size == 3 && !L2gradient && 1 == cn )
     {
-        for (int j = 0; j < src.cols; j++)
-            pdst[j] = (uchar)-(pmap[j] >> 1);
+        if (ippCanny(src, dst, (float)low_thresh, (float)high_thresh))
+            return;
+        setIppErrorStatus();
     }
+#endif
+
+    Mat dx(src.rows, src.cols, CV_16SC(cn));
+    Mat dy(src.rows, src.cols, CV_16SC(cn));
+
+    Sobel(src, dx, CV_16S, 1, 0, aperture_size, 1, 0, BORDER_REPLICATE);
+    Sobel(src, dy, CV_16S, 0, 1, aperture_size, 1, 0, BORDER_REPLICATE);
+
+    if (L2gradient)
+    {
+        low_thresh = std::min(32767.0, low_thresh);
+        high_thresh = std::min(32767.0, high_thresh);
+
+        if (low_thresh > 0) low_thresh *= low_thresh;
+        if (high_thresh > 0) high_thresh *= high_thresh;
+    }
+    int low = cvFloor(low_thresh);
+    int high = cvFloor(high_thresh);
+
+    ptrdiff_t mapstep = src.cols + 2;
+    AutoBuffer<uchar> buffer((src.cols+2)*(src.rows+2));
+
+    uchar* map = (uchar*)buffer;
+    memset(map, 1, mapstep);
+    memset(map + mapstep*(src.rows + 1), 1, mapstep);
+
+    // every stripe should have a few rows, since the rows around it are processed twice
+    int nStripes = std::max(std::min(getNumThreads(), src.rows/16), 1);
+    std::vector<std::vector<uchar*> > borderPeaks(nStripes);
+
+    parallel_for_(Range(0, nStripes),
+                  CannyInvoker(dx, dy, map, mapstep, low, high, L2gradient, nStripes, borderPeaks),
+                  nStripes);
+
+    // now finish tracking the edges, which cross the stripe boundaries
+    std::vector<uchar*> stack;
+    for (int i = 0; i < nStripes; i++)
+    {
+        const std::vector<uchar*>& peaks = borderPeaks[i];
+        for (size_t k = 0; k < peaks.size(); k++)
+            if (!*peaks[k])
+                CANNY_PUSH(peaks[k]);
+    }
+    cannyHysteresis(stack, mapstep);
+
+    // the final pass, form the final image
+    parallel_for_(Range(0, src.rows), CannyFinalPass(map + mapstep + 1, mapstep, dst),
+                  dst.total()/(double)(1<<16));
 }
 
 void cvCanny( const CvArr* image, CvArr* edges, double threshold1,
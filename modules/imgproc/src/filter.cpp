@@ -393,6 +393,68 @@ int FilterEngine::proceed( const uchar* src, int srcstep, int count,
 }
 
 
+// Each stripe is filtered by its own copy of the engine (with its own ring buffer and
+// its own copies of the filters) as a sub-ROI of the source image, so the rows above and
+// below the stripe are read from the image like in the serial pass and the result is the same.
+class FilterEngineInvoker : public ParallelLoopBody
+{
+public:
+    FilterEngineInvoker(const FilterEngine& _engine, const Mat& _src, Mat& _dst,
+                        const Rect& _srcRoi, Point _dstOfs, bool _isolated, int _nStripes) :
+        engine(&_engine), src(&_src), dst(&_dst), srcRoi(_srcRoi), dstOfs(_dstOfs),
+        isolated(_isolated), nStripes(_nStripes)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        FilterEngine f;
+        f.init(cloneFilter(engine->filter2D), cloneFilter(engine->rowFilter),
+               cloneFilter(engine->columnFilter),
+               engine->srcType, engine->dstType, engine->bufType,
+               engine->rowBorderType, engine->columnBorderType);
+        f.constBorderValue = engine->constBorderValue;
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            int y0 = srcRoi.height*i/nStripes, y1 = srcRoi.height*(i+1)/nStripes;
+            int y = f.start(*src, Rect(srcRoi.x, srcRoi.y + y0, srcRoi.width, y1 - y0), isolated);
+            f.proceed( src->data + y*src->step, (int)src->step, f.endY - f.startY,
+                       dst->data + (dstOfs.y + y0)*dst->step + dstOfs.x*dst->elemSize(), (int)dst->step );
+        }
+    }
+
+private:
+    const FilterEngine* engine;
+    const Mat* src;
+    Mat* dst;
+    Rect srcRoi;
+    Point dstOfs;
+    bool isolated;
+    int nStripes;
+};
+
+static int getFilterStripes(const FilterEngine& f, const Mat& src, const Mat& dst, const Rect& srcRoi)
+{
+    // every stripe reads ksize.height-1 extra rows, so they should not be too thin
+    const int minStripeRows = std::max(f.ksize.height*4, 32);
+    int nStripes = std::min(getNumThreads(), srcRoi.height/minStripeRows);
+    if( nStripes <= 1 || (double)srcRoi.width*srcRoi.height*src.elemSize() < (1 << 16) )
+        return 1;
+
+    // in-place filtering: the stripes would overwrite the rows their neighbours still need
+    if( src.datastart < dst.dataend && dst.datastart < src.dataend )
+        return 1;
+
+    // the filters may keep some state, so every stripe needs its own copies of them
+    if( (f.filter2D && !isClonableFilter(f.filter2D)) ||
+        (f.rowFilter && !isClonableFilter(f.rowFilter)) ||
+        (f.columnFilter && !isClonableFilter(f.columnFilter)) )
+        return 1;
+
+    return nStripes;
+}
+
 void FilterEngine::apply(const Mat& src, Mat& dst,
     const Rect& _srcRoi, Point dstOfs, bool isolated)
 {
@@ -405,10 +467,22 @@ void FilterEngine::apply(const Mat& src, Mat& dst,
     if( srcRoi.area() == 0 )
         return;
 
+    CV_Assert( srcRoi.x >= 0 && srcRoi.y >= 0 &&
+        srcRoi.x + srcRoi.width <= src.cols &&
+        srcRoi.y + srcRoi.height <= src.rows );
     CV_Assert( dstOfs.x >= 0 && dstOfs.y >= 0 &&
         dstOfs.x + srcRoi.width <= dst.cols &&
         dstOfs.y + srcRoi.height <= dst.rows );
 
+    int nStripes = getFilterStripes(*this, src, dst, srcRoi);
+    if( nStripes > 1 )
+    {
+        parallel_for_(Range(0, nStripes),
+                      FilterEngineInvoker(*this, src, dst, srcRoi, dstOfs, isolated, nStripes),
+                      nStripes);
+        return;
+    }
+
     int y = start(src, srcRoi, isolated);
     proceed( src.data + y*src.step, (int)src.step, endY - startY,
              dst.data + dstOfs.y*dst.step + dstOfs.x*dst.elemSize(), (int)dst.step );
@@ -2220,7 +2294,7 @@ typedef FilterNoVec FilterVec_32f;
 #endif
 
 
-template<typename ST, typename DT, class VecOp> struct RowFilter : public BaseRowFilter
+template<typename ST, typename DT, class VecOp> struct RowFilter : public BaseRowFilter, public ClonableFilter<BaseRowFilter>
 {
     RowFilter( const Mat& _kernel, int _anchor, const VecOp& _vecOp=VecOp() )
     {
@@ -2235,6 +2309,8 @@ template<typename ST, typename DT, class VecOp> struct RowFilter : public BaseRo
         vecOp = _vecOp;
     }
 
+    Ptr<BaseRowFilter> clone() const { return makePtr<RowFilter>(*this); }
+
     void operator()(const uchar* src, uchar* dst, int width, int cn)
     {
         int _ksize = ksize;
@@ -2293,6 +2369,8 @@ template<typename ST, typename DT, class VecOp> struct SymmRowSmallFilter :
         CV_Assert( (symmetryType & (KERNEL_SYMMETRICAL | KERNEL_ASYMMETRICAL)) != 0 && this->ksize <= 5 );
     }
 
+    Ptr<BaseRowFilter> clone() const { return makePtr<SymmRowSmallFilter>(*this); }
+
     void operator()(const uchar* src, uchar* dst, int width, int cn)
     {
         int ksize2 = this->ksize/2, ksize2n = ksize2*cn;
@@ -2410,7 +2488,7 @@ template<typename ST, typename DT, class VecOp> struct SymmRowSmallFilter :
 };
 
 
-template<class CastOp, class VecOp> struct ColumnFilter : public BaseColumnFilter
+template<class CastOp, class VecOp> struct ColumnFilter : public BaseColumnFilter, public ClonableFilter<BaseColumnFilter>
 {
     typedef typename CastOp::type1 ST;
     typedef typename CastOp::rtype DT;
@@ -2432,6 +2510,8 @@ template<class CastOp, class VecOp> struct ColumnFilter : public BaseColumnFilte
                    (kernel.rows == 1 || kernel.cols == 1));
     }
 
+    Ptr<BaseColumnFilter> clone() const { return makePtr<ColumnFilter>(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         const ST* ky = (const ST*)kernel.data;
@@ -2495,6 +2575,8 @@ template<class CastOp, class VecOp> struct SymmColumnFilter : public ColumnFilte
         CV_Assert( (symmetryType & (KERNEL_SYMMETRICAL | KERNEL_ASYMMETRICAL)) != 0 );
     }
 
+    Ptr<BaseColumnFilter> clone() const { return makePtr<SymmColumnFilter>(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int ksize2 = this->ksize/2;
@@ -2601,6 +2683,8 @@ struct SymmColumnSmallFilter : public SymmColumnFilter<CastOp, VecOp>
         CV_Assert( this->ksize == 3 );
     }
 
+    Ptr<BaseColumnFilter> clone() const { return makePtr<SymmColumnSmallFilter>(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int ksize2 = this->ksize/2;
@@ -3058,7 +3142,7 @@ void preprocess2DKernel( const Mat& kernel, std::vector<Point>& coords, std::vec
 }
 
 
-template<typename ST, class CastOp, class VecOp> struct Filter2D : public BaseFilter
+template<typename ST, class CastOp, class VecOp> struct Filter2D : public BaseFilter, public ClonableFilter<BaseFilter>
 {
     typedef typename CastOp::type1 KT;
     typedef typename CastOp::rtype DT;
@@ -3077,6 +3161,8 @@ template<typename ST, class CastOp, class VecOp> struct Filter2D : public BaseFi
         ptrs.resize( coords.size() );
     }
 
+    Ptr<BaseFilter> clone() const { return makePtr<Filter2D>(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width, int cn)
     {
         KT _delta = delta;
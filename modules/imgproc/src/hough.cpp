@@ -64,6 +64,156 @@ struct hough_cmp_gt
 };
 
 
+// cos(angle)/rho and sin(angle)/rho for all the accumulator angles.
+// The classical transform accumulates the angle in float (min_theta, min_theta+theta, ...),
+// the probabilistic one computes it as n*theta; both ways are kept to preserve the results.
+struct HoughTrigTable
+{
+    HoughTrigTable( int _numangle, double _minTheta, float _theta, float _irho, bool _stepAngle )
+        : numangle(_numangle), minTheta(_minTheta), theta(_theta), irho(_irho), stepAngle(_stepAngle)
+    {
+        tabCos.resize(numangle);
+        tabSin.resize(numangle);
+
+        if( stepAngle )
+        {
+            float ang = static_cast<float>(minTheta);
+            for( int n = 0; n < numangle; ang += theta, n++ )
+            {
+                tabSin[n] = (float)(sin((double)ang) * irho);
+                tabCos[n] = (float)(cos((double)ang) * irho);
+            }
+        }
+        else
+        {
+            for( int n = 0; n < numangle; n++ )
+            {
+                tabCos[n] = (float)(cos((double)n*theta) * irho);
+                tabSin[n] = (float)(sin((double)n*theta) * irho);
+            }
+        }
+    }
+
+    bool matches( int _numangle, double _minTheta, float _theta, float _irho, bool _stepAngle ) const
+    {
+        return numangle == _numangle && minTheta == _minTheta && theta == _theta &&
+               irho == _irho && stepAngle == _stepAngle;
+    }
+
+    int numangle;
+    double minTheta;
+    float theta, irho;
+    bool stepAngle;
+    std::vector<float> tabCos, tabSin;
+};
+
+enum { HOUGH_TABLES_CACHE_SIZE = 8 };
+
+static Mutex houghTablesMutex;
+static Ptr<HoughTrigTable> houghTablesCache[HOUGH_TABLES_CACHE_SIZE];
+
+// The tables are shared between the calls with the same parameters,
+// the recently used ones are kept at the head of the cache
+static Ptr<HoughTrigTable>
+getHoughTrigTable( int numangle, double minTheta, float theta, float irho, bool stepAngle )
+{
+    {
+        AutoLock lock(houghTablesMutex);
+        for( int i = 0; i < HOUGH_TABLES_CACHE_SIZE && houghTablesCache[i]; i++ )
+        {
+            if( houghTablesCache[i]->matches(numangle, minTheta, theta, irho, stepAngle) )
+            {
+                Ptr<HoughTrigTable> t = houghTablesCache[i];
+                for( ; i > 0; i-- )
+                    houghTablesCache[i] = houghTablesCache[i-1];
+                houghTablesCache[0] = t;
+                return t;
+            }
+        }
+    }
+
+    Ptr<HoughTrigTable> t = makePtr<HoughTrigTable>(numangle, minTheta, theta, irho, stepAngle);
+
+    AutoLock lock(houghTablesMutex);
+    for( int i = HOUGH_TABLES_CACHE_SIZE - 1; i > 0; i-- )
+        houghTablesCache[i] = houghTablesCache[i-1];
+    houghTablesCache[0] = t;
+    return t;
+}
+
+// Computes cvRound(x*tabCos[n] + y*tabSin[n]) + rofs for all n < numangle.
+// _mm_cvtps_epi32 rounds to the nearest even just like cvRound,
+// so the vector path gives the same indices as the scalar one.
+static void
+houghRhoIndices( int x, int y, const float* tabCos, const float* tabSin,
+                 int numangle, int rofs, int* ridx, bool haveSSE2 )
+{
+    int n = 0;
+#if CV_SSE2
+    if( haveSSE2 )
+    {
+        __m128 v_x = _mm_set1_ps((float)x), v_y = _mm_set1_ps((float)y);
+        __m128i v_rofs = _mm_set1_epi32(rofs);
+        for( ; n <= numangle - 8; n += 8 )
+        {
+            __m128 r0 = _mm_add_ps(_mm_mul_ps(v_x, _mm_loadu_ps(tabCos + n)),
+                                   _mm_mul_ps(v_y, _mm_loadu_ps(tabSin + n)));
+            __m128 r1 = _mm_add_ps(_mm_mul_ps(v_x, _mm_loadu_ps(tabCos + n + 4)),
+                                   _mm_mul_ps(v_y, _mm_loadu_ps(tabSin + n + 4)));
+            _mm_storeu_si128((__m128i*)(ridx + n), _mm_add_epi32(_mm_cvtps_epi32(r0), v_rofs));
+            _mm_storeu_si128((__m128i*)(ridx + n + 4), _mm_add_epi32(_mm_cvtps_epi32(r1), v_rofs));
+        }
+    }
+#else
+    (void)haveSSE2;
+#endif
+    for( ; n < numangle; n++ )
+        ridx[n] = cvRound( x * tabCos[n] + y * tabSin[n] ) + rofs;
+}
+
+// Every stripe votes for its part of the non-zero points into its own accumulator,
+// the caller sums the accumulators up
+class HoughLinesAccumInvoker : public ParallelLoopBody
+{
+public:
+    HoughLinesAccumInvoker( const std::vector<Point>& _nzloc, std::vector<Mat>& _accums,
+                            const float* _tabCos, const float* _tabSin, int _numangle, int _numrho )
+        : nzloc(_nzloc), accums(_accums), tabCos(_tabCos), tabSin(_tabSin),
+          numangle(_numangle), numrho(_numrho)
+    {
+        haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int nstripes = (int)accums.size(), count = (int)nzloc.size();
+        int astep = numrho + 2;
+        std::vector<int> ridx(numangle + 1);
+
+        for( int s = range.start; s < range.end; s++ )
+        {
+            int* adata = accums[s].ptr<int>() + astep + 1;
+            int i0 = (int)((int64)count*s/nstripes), i1 = (int)((int64)count*(s+1)/nstripes);
+
+            for( int i = i0; i < i1; i++ )
+            {
+                houghRhoIndices( nzloc[i].x, nzloc[i].y, tabCos, tabSin,
+                                 numangle, (numrho - 1) / 2, &ridx[0], haveSSE2 );
+                for( int n = 0; n < numangle; n++ )
+                    adata[n*astep + ridx[n]]++;
+            }
+        }
+    }
+
+private:
+    const std::vector<Point>& nzloc;
+    std::vector<Mat>& accums;
+    const float *tabCos, *tabSin;
+    int numangle, numrho;
+    bool haveSSE2;
+};
+
+
 /*
 Here image is an input raster;
 step is it's step; size characterizes it's ROI;
@@ -97,35 +247,46 @@ HoughLinesStandard( const Mat& img, float rho, float theta,
     int numangle = cvRound((max_theta - min_theta) / theta);
     int numrho = cvRound(((width + height) * 2 + 1) / rho);
 
-    AutoBuffer<int> _accum((numangle+2) * (numrho+2));
-    std::vector<int> _sort_buf;
-    AutoBuffer<float> _tabSin(numangle);
-    AutoBuffer<float> _tabCos(numangle);
-    int *accum = _accum;
-    float *tabSin = _tabSin, *tabCos = _tabCos;
-
-    memset( accum, 0, sizeof(accum[0]) * (numangle+2) * (numrho+2) );
+    if( numangle <= 0 )
+        return;
 
-    float ang = static_cast<float>(min_theta);
-    for(int n = 0; n < numangle; ang += theta, n++ )
-    {
-        tabSin[n] = (float)(sin((double)ang) * irho);
-        tabCos[n] = (float)(cos((double)ang) * irho);
-    }
+    Ptr<HoughTrigTable> trig = getHoughTrigTable(numangle, min_theta, theta, irho, true);
+    std::vector<int> _sort_buf;
+    std::vector<Point> nzloc;
 
-    // stage 1. fill accumulator
     for( i = 0; i < height; i++ )
         for( j = 0; j < width; j++ )
         {
             if( image[i * step + j] != 0 )
-                for(int n = 0; n < numangle; n++ )
-                {
-                    int r = cvRound( j * tabCos[n] + i * tabSin[n] );
-                    r += (numrho - 1) / 2;
-                    accum[(n+1) * (numrho+2) + r+1]++;
-                }
+                nzloc.push_back(Point(j, i));
         }
 
+    // stage 1. fill accumulator.
+    // The points are split between a few stripes voting into the private accumulators,
+    // which are then summed up. Every accumulator costs a pass to clear it and another one
+    // to add it up, so each stripe must cast at least 4 votes per accumulator cell
+    // (nz_count*numangle/nstripes >= 4*(numangle+2)*(numrho+2)), and all the accumulators
+    // together may take at most 64Mb.
+    int nz_count = (int)nzloc.size();
+    double accumSize = (double)(numangle + 2)*(numrho + 2);
+    double maxStripes = std::min((double)nz_count*numangle/(accumSize*4),
+                                 (double)(1 << 26)/(accumSize*sizeof(int)));
+    int nstripes = (int)std::min((double)std::min(getNumThreads(), 16), maxStripes);
+    nstripes = std::max(nstripes, 1);
+    std::vector<Mat> accums(nstripes);
+    for( int s = 0; s < nstripes; s++ )
+        accums[s] = Mat::zeros(numangle + 2, numrho + 2, CV_32SC1);
+
+    HoughLinesAccumInvoker invoker(nzloc, accums, &trig->tabCos[0], &trig->tabSin[0], numangle, numrho);
+    if( nstripes > 1 )
+        parallel_for_(Range(0, nstripes), invoker, nstripes);
+    else
+        invoker(Range(0, 1));
+    for( int s = 1; s < nstripes; s++ )
+        add(accums[0], accums[s], accums[0]);
+
+    const int* accum = accums[0].ptr<int>();
+
     // stage 2. find local maximums
     for(int r = 0; r < numrho; r++ )
         for(int n = 0; n < numangle; n++ )
@@ -406,14 +567,13 @@ HoughLinesProbabilistic( Mat& image,
 
     Mat accum = Mat::zeros( numangle, numrho, CV_32SC1 );
     Mat mask( height, width, CV_8UC1 );
-    std::vector<float> trigtab(numangle*2);
+    if( numangle <= 0 )
+        return;
 
-    for( int n = 0; n < numangle; n++ )
-    {
-        trigtab[n*2] = (float)(cos((double)n*theta) * irho);
-        trigtab[n*2+1] = (float)(sin((double)n*theta) * irho);
-    }
-    const float* ttab = &trigtab[0];
+    Ptr<HoughTrigTable> trig = getHoughTrigTable(numangle, 0., theta, irho, false);
+    const float *tabCos = &trig->tabCos[0], *tabSin = &trig->tabSin[0];
+    std::vector<int> ridx(numangle + 1);
+    bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
     uchar* mdata0 = mask.data;
     std::vector<Point> nzloc;
 
@@ -458,11 +618,10 @@ HoughLinesProbabilistic( Mat& image,
             continue;
 
         // update accumulator, find the most probable line
+        houghRhoIndices( j, i, tabCos, tabSin, numangle, (numrho - 1) / 2, &ridx[0], haveSSE2 );
         for( int n = 0; n < numangle; n++, adata += numrho )
         {
-            int r = cvRound( j * ttab[n*2] + i * ttab[n*2+1] );
-            r += (numrho - 1) / 2;
-            int val = ++adata[r];
+            int val = ++adata[ridx[n]];
             if( max_val < val )
             {
                 max_val = val;
@@ -476,8 +635,8 @@ HoughLinesProbabilistic( Mat& image,
 
         // from the current point walk in each direction
         // along the found line and extract the line segment
-        a = -ttab[max_n*2+1];
-        b = ttab[max_n*2];
+        a = -tabSin[max_n];
+        b = tabCos[max_n];
         x0 = j;
         y0 = i;
         if( fabs(a) > fabs(b) )
@@ -579,12 +738,10 @@ HoughLinesProbabilistic( Mat& image,
                     if( good_line )
                     {
                         adata = (int*)accum.data;
+                        houghRhoIndices( j1, i1, tabCos, tabSin, numangle,
+                                         (numrho - 1) / 2, &ridx[0], haveSSE2 );
                         for( int n = 0; n < numangle; n++, adata += numrho )
-                        {
-                            int r = cvRound( j1 * ttab[n*2] + i1 * ttab[n*2+1] );
-                            r += (numrho - 1) / 2;
-                            adata[r]--;
-                        }
+                            adata[ridx[n]]--;
                     }
                     *mdata = 0;
                 }
@@ -753,27 +910,249 @@ cvHoughLines2( CvArr* src_image, void* lineStorage, int method,
 *                                     Circle Detection                                   *
 \****************************************************************************************/
 
+namespace cv
+{
+
+// Accumulates the circle evidence for the edge pixels of the image rows of every stripe.
+// Every stripe has its own accumulator and list of the edge points,
+// the caller sums up the accumulators and joins the lists in the stripe order.
+class HoughCirclesAccumInvoker : public ParallelLoopBody
+{
+public:
+    HoughCirclesAccumInvoker( const Mat& _edges, const Mat& _dx, const Mat& _dy,
+                              std::vector<Mat>& _accums, std::vector<std::vector<Point> >& _nz,
+                              float _idp, int _minRadius, int _maxRadius )
+        : edges(_edges), dx(_dx), dy(_dy), accums(_accums), nz(_nz),
+          idp(_idp), minRadius(_minRadius), maxRadius(_maxRadius)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        const int SHIFT = 10, ONE = 1 << SHIFT;
+        int rows = edges.rows, cols = edges.cols, nstripes = (int)accums.size();
+
+        for( int s = range.start; s < range.end; s++ )
+        {
+            Mat& accum = accums[s];
+            std::vector<Point>& nzs = nz[s];
+            int arows = accum.rows - 2, acols = accum.cols - 2;
+            int astep = (int)(accum.step/sizeof(int));
+            int* adata = accum.ptr<int>();
+            int ystart = rows*s/nstripes, yend = rows*(s+1)/nstripes;
+
+            for( int y = ystart; y < yend; y++ )
+            {
+                const uchar* edges_row = edges.ptr<uchar>(y);
+                const short* dx_row = dx.ptr<short>(y);
+                const short* dy_row = dy.ptr<short>(y);
+
+                for( int x = 0; x < cols; x++ )
+                {
+                    float vx, vy;
+                    int sx, sy, x0, y0, x1, y1, r;
+
+                    vx = dx_row[x];
+                    vy = dy_row[x];
+
+                    if( !edges_row[x] || (vx == 0 && vy == 0) )
+                        continue;
+
+                    float mag = std::sqrt(vx*vx+vy*vy);
+                    assert( mag >= 1 );
+                    sx = cvRound((vx*idp)*ONE/mag);
+                    sy = cvRound((vy*idp)*ONE/mag);
+
+                    x0 = cvRound((x*idp)*ONE);
+                    y0 = cvRound((y*idp)*ONE);
+                    // Step from min_radius to max_radius in both directions of the gradient
+                    for(int k1 = 0; k1 < 2; k1++ )
+                    {
+                        x1 = x0 + minRadius * sx;
+                        y1 = y0 + minRadius * sy;
+
+                        for( r = minRadius; r <= maxRadius; x1 += sx, y1 += sy, r++ )
+                        {
+                            int x2 = x1 >> SHIFT, y2 = y1 >> SHIFT;
+                            if( (unsigned)x2 >= (unsigned)acols ||
+                                (unsigned)y2 >= (unsigned)arows )
+                                break;
+                            adata[y2*astep + x2]++;
+                        }
+
+                        sx = -sx; sy = -sy;
+                    }
+
+                    nzs.push_back(Point(x, y));
+                }
+            }
+        }
+    }
+
+private:
+    const Mat &edges, &dx, &dy;
+    std::vector<Mat>& accums;
+    std::vector<std::vector<Point> >& nz;
+    float idp;
+    int minRadius, maxRadius;
+};
+
+// Estimates the best radius and its support for each of the candidate centers.
+// The centers are independent, so they are processed in parallel;
+// counts[i] is -1 when there are no edge points in the radius range.
+class HoughCirclesRadiusInvoker : public ParallelLoopBody
+{
+public:
+    HoughCirclesRadiusInvoker( const std::vector<Point>& _nz, const Point2f* _centers,
+                               float _minRadius2, float _maxRadius2, int _maxRadius, float _dr,
+                               float* _radii, int* _counts )
+        : nz(_nz), centers(_centers), minRadius2(_minRadius2), maxRadius2(_maxRadius2),
+          maxRadius(_maxRadius), dr(_dr), radii(_radii), counts(_counts)
+    {
+        haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int nz_count = (int)nz.size();
+        std::vector<float> _ddata(nz_count);
+        std::vector<int> sort_buf(nz_count);
+        float* ddata = &_ddata[0];
+        const Point* pts = &nz[0];
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            float cx = centers[i].x, cy = centers[i].y;
+            float start_dist, dist_sum;
+            float r_best = 0;
+            int max_count = 0;
+            int j = 0, k = 0;
+
+#if CV_SSE2
+            if( haveSSE2 )
+            {
+                __m128 v_cx = _mm_set1_ps(cx), v_cy = _mm_set1_ps(cy);
+                __m128 v_minr2 = _mm_set1_ps(minRadius2), v_maxr2 = _mm_set1_ps(maxRadius2);
+                for( ; j <= nz_count - 4; j += 4 )
+                {
+                    __m128 p0 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(pts + j)));
+                    __m128 p1 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(pts + j + 2)));
+                    __m128 v_dx = _mm_sub_ps(v_cx, _mm_cvtepi32_ps(_mm_castps_si128(
+                                                _mm_shuffle_ps(p0, p1, _MM_SHUFFLE(2, 0, 2, 0)))));
+                    __m128 v_dy = _mm_sub_ps(v_cy, _mm_cvtepi32_ps(_mm_castps_si128(
+                                                _mm_shuffle_ps(p0, p1, _MM_SHUFFLE(3, 1, 3, 1)))));
+                    __m128 v_r2 = _mm_add_ps(_mm_mul_ps(v_dx, v_dx), _mm_mul_ps(v_dy, v_dy));
+                    int mask = _mm_movemask_ps(_mm_and_ps(_mm_cmple_ps(v_minr2, v_r2),
+                                                          _mm_cmple_ps(v_r2, v_maxr2)));
+                    if( mask )
+                    {
+                        float CV_DECL_ALIGNED(16) buf[4];
+                        _mm_store_ps(buf, v_r2);
+                        for( int t = 0; t < 4; t++ )
+                            if( mask & (1 << t) )
+                            {
+                                ddata[k] = buf[t];
+                                sort_buf[k] = k;
+                                k++;
+                            }
+                    }
+                }
+            }
+#endif
+            for( ; j < nz_count; j++ )
+            {
+                float _dx = cx - pts[j].x, _dy = cy - pts[j].y;
+                float _r2 = _dx*_dx + _dy*_dy;
+                if(minRadius2 <= _r2 && _r2 <= maxRadius2 )
+                {
+                    ddata[k] = _r2;
+                    sort_buf[k] = k;
+                    k++;
+                }
+            }
+
+            int nz_count1 = k, start_idx = nz_count1 - 1;
+            if( nz_count1 == 0 )
+            {
+                radii[i] = 0.f;
+                counts[i] = -1;
+                continue;
+            }
+            Mat dist(1, nz_count1, CV_32FC1, ddata);
+            cv::sqrt(dist, dist);
+            std::sort(sort_buf.begin(), sort_buf.begin() + nz_count1, hough_cmp_gt((int*)ddata));
+
+            dist_sum = start_dist = ddata[sort_buf[nz_count1-1]];
+            for( j = nz_count1 - 2; j >= 0; j-- )
+            {
+                float d = ddata[sort_buf[j]];
+
+                if( d > maxRadius )
+                    break;
+
+                if( d - start_dist > dr )
+                {
+                    float r_cur = ddata[sort_buf[(j + start_idx)/2]];
+                    if( (start_idx - j)*r_best >= max_count*r_cur ||
+                        (r_best < FLT_EPSILON && start_idx - j >= max_count) )
+                    {
+                        r_best = r_cur;
+                        max_count = start_idx - j;
+                    }
+                    start_dist = d;
+                    start_idx = j;
+                    dist_sum = 0;
+                }
+                dist_sum += d;
+            }
+
+            radii[i] = r_best;
+            counts[i] = max_count;
+        }
+    }
+
+private:
+    const std::vector<Point>& nz;
+    const Point2f* centers;
+    float minRadius2, maxRadius2;
+    int maxRadius;
+    float dr;
+    float* radii;
+    int* counts;
+    bool haveSSE2;
+};
+
+}
+
+// Checks the distance to the previously detected circles
+static bool
+icvHoughCircleIsNear( const CvSeq* circles, float cx, float cy, float min_dist )
+{
+    for( int j = 0; j < circles->total; j++ )
+    {
+        const float* c = (const float*)cvGetSeqElem( circles, j );
+        if( (c[0] - cx)*(c[0] - cx) + (c[1] - cy)*(c[1] - cy) < min_dist )
+            return true;
+    }
+    return false;
+}
+
 static void
 icvHoughCirclesGradient( CvMat* img, float dp, float min_dist,
                          int min_radius, int max_radius,
                          int canny_threshold, int acc_threshold,
                          CvSeq* circles, int circles_max )
 {
-    const int SHIFT = 10, ONE = 1 << SHIFT;
     cv::Ptr<CvMat> dx, dy;
-    cv::Ptr<CvMat> edges, accum, dist_buf;
+    cv::Ptr<CvMat> edges, accum;
     std::vector<int> sort_buf;
-    cv::Ptr<CvMemStorage> storage;
 
-    int x, y, i, j, k, center_count, nz_count;
+    int x, y, i, k, center_count, nz_count;
     float min_radius2 = (float)min_radius*min_radius;
     float max_radius2 = (float)max_radius*max_radius;
-    int rows, cols, arows, acols;
-    int astep, *adata;
-    float* ddata;
-    CvSeq *nz, *centers;
+    int rows, arows, acols;
+    int *adata;
     float idp, dr;
-    CvSeqReader reader;
 
     edges.reset(cvCreateMat( img->rows, img->cols, CV_8UC1 ));
     cvCanny( img, edges, MAX(canny_threshold/2,1), canny_threshold, 3 );
@@ -789,66 +1168,40 @@ icvHoughCirclesGradient( CvMat* img, float dp, float min_dist,
     accum.reset(cvCreateMat( cvCeil(img->rows*idp)+2, cvCeil(img->cols*idp)+2, CV_32SC1 ));
     cvZero(accum);
 
-    storage.reset(cvCreateMemStorage());
-    nz = cvCreateSeq( CV_32SC2, sizeof(CvSeq), sizeof(CvPoint), storage );
-    centers = cvCreateSeq( CV_32SC1, sizeof(CvSeq), sizeof(int), storage );
-
     rows = img->rows;
-    cols = img->cols;
     arows = accum->rows - 2;
     acols = accum->cols - 2;
     adata = accum->data.i;
-    astep = accum->step/sizeof(adata[0]);
-    // Accumulate circle evidence for each edge pixel
-    for( y = 0; y < rows; y++ )
-    {
-        const uchar* edges_row = edges->data.ptr + y*edges->step;
-        const short* dx_row = (const short*)(dx->data.ptr + y*dx->step);
-        const short* dy_row = (const short*)(dy->data.ptr + y*dy->step);
-
-        for( x = 0; x < cols; x++ )
-        {
-            float vx, vy;
-            int sx, sy, x0, y0, x1, y1, r;
-            CvPoint pt;
-
-            vx = dx_row[x];
-            vy = dy_row[x];
 
-            if( !edges_row[x] || (vx == 0 && vy == 0) )
-                continue;
-
-            float mag = std::sqrt(vx*vx+vy*vy);
-            assert( mag >= 1 );
-            sx = cvRound((vx*idp)*ONE/mag);
-            sy = cvRound((vy*idp)*ONE/mag);
-
-            x0 = cvRound((x*idp)*ONE);
-            y0 = cvRound((y*idp)*ONE);
-            // Step from min_radius to max_radius in both directions of the gradient
-            for(int k1 = 0; k1 < 2; k1++ )
-            {
-                x1 = x0 + min_radius * sx;
-                y1 = y0 + min_radius * sy;
-
-                for( r = min_radius; r <= max_radius; x1 += sx, y1 += sy, r++ )
-                {
-                    int x2 = x1 >> SHIFT, y2 = y1 >> SHIFT;
-                    if( (unsigned)x2 >= (unsigned)acols ||
-                        (unsigned)y2 >= (unsigned)arows )
-                        break;
-                    adata[y2*astep + x2]++;
-                }
-
-                sx = -sx; sy = -sy;
-            }
+    // Accumulate circle evidence for each edge pixel.
+    // The image rows are split between a few stripes, each voting into its own accumulator;
+    // the accumulators are summed up afterwards.
+    int nthreads = cv::getNumThreads();
+    int nstripes = std::max(std::min(std::min(nthreads, rows/64), 8), 1);
+    cv::Mat edgesMat = cv::cvarrToMat(edges), dxMat = cv::cvarrToMat(dx), dyMat = cv::cvarrToMat(dy);
+    cv::Mat accumMat = cv::cvarrToMat(accum);
+    std::vector<cv::Mat> accums(nstripes);
+    std::vector<std::vector<cv::Point> > nzs(nstripes);
+    accums[0] = accumMat;
+    for( k = 1; k < nstripes; k++ )
+        accums[k] = cv::Mat::zeros(accumMat.size(), CV_32SC1);
+
+    cv::HoughCirclesAccumInvoker accumInvoker(edgesMat, dxMat, dyMat, accums, nzs,
+                                              idp, min_radius, max_radius);
+    if( nstripes > 1 )
+        cv::parallel_for_(cv::Range(0, nstripes), accumInvoker, nstripes);
+    else
+        accumInvoker(cv::Range(0, 1));
 
-            pt.x = x; pt.y = y;
-            cvSeqPush( nz, &pt );
-        }
+    std::vector<cv::Point> nz;
+    nz.swap(nzs[0]);
+    for( k = 1; k < nstripes; k++ )
+    {
+        cv::add(accumMat, accums[k], accumMat);
+        nz.insert(nz.end(), nzs[k].begin(), nzs[k].end());
     }
 
-    nz_count = nz->total;
+    nz_count = (int)nz.size();
     if( !nz_count )
         return;
     //Find possible circle centers
@@ -860,106 +1213,70 @@ icvHoughCirclesGradient( CvMat* img, float dp, float min_dist,
             if( adata[base] > acc_threshold &&
                 adata[base] > adata[base-1] && adata[base] > adata[base+1] &&
                 adata[base] > adata[base-acols-2] && adata[base] > adata[base+acols+2] )
-                cvSeqPush(centers, &base);
+                sort_buf.push_back(base);
         }
     }
 
-    center_count = centers->total;
+    center_count = (int)sort_buf.size();
     if( !center_count )
         return;
 
-    sort_buf.resize( MAX(center_count,nz_count) );
-    cvCvtSeqToArray( centers, &sort_buf[0] );
-
     std::sort(sort_buf.begin(), sort_buf.begin() + center_count, cv::hough_cmp_gt(adata));
-    cvClearSeq( centers );
-    cvSeqPushMulti( centers, &sort_buf[0], center_count );
-
-    dist_buf.reset(cvCreateMat( 1, nz_count, CV_32FC1 ));
-    ddata = dist_buf->data.fl;
 
     dr = dp;
     min_dist = MAX( min_dist, dp );
     min_dist *= min_dist;
     // For each found possible center
-    // Estimate radius and check support
-    for( i = 0; i < centers->total; i++ )
+    // Estimate radius and check support.
+    // The radii are estimated for small batches of the centers in parallel,
+    // then the centers of the batch are accepted one by one in the sorted order,
+    // exactly like when they are processed sequentially.
+    int batch_size = nthreads > 1 ? nthreads*4 : 1;
+    std::vector<cv::Point2f> batch_centers(batch_size);
+    std::vector<float> batch_radii(batch_size);
+    std::vector<int> batch_counts(batch_size);
+
+    for( i = 0; i < center_count; i += batch_size )
     {
-        int ofs = *(int*)cvGetSeqElem( centers, i );
-        y = ofs/(acols+2);
-        x = ofs - (y)*(acols+2);
-        //Calculate circle's center in pixels
-        float cx = (float)((x + 0.5f)*dp), cy = (float)(( y + 0.5f )*dp);
-        float start_dist, dist_sum;
-        float r_best = 0;
-        int max_count = 0;
-        // Check distance with previously detected circles
-        for( j = 0; j < circles->total; j++ )
+        int ncenters = 0;
+        for( k = i; k < std::min(i + batch_size, center_count); k++ )
         {
-            float* c = (float*)cvGetSeqElem( circles, j );
-            if( (c[0] - cx)*(c[0] - cx) + (c[1] - cy)*(c[1] - cy) < min_dist )
-                break;
+            int ofs = sort_buf[k];
+            y = ofs/(acols+2);
+            x = ofs - (y)*(acols+2);
+            //Calculate circle's center in pixels
+            float cx = (float)((x + 0.5f)*dp), cy = (float)(( y + 0.5f )*dp);
+            // The centers close to the circles found in the previous batches are skipped right away
+            if( !icvHoughCircleIsNear( circles, cx, cy, min_dist ) )
+                batch_centers[ncenters++] = cv::Point2f(cx, cy);
         }
 
-        if( j < circles->total )
+        if( ncenters == 0 )
             continue;
-        // Estimate best radius
-        cvStartReadSeq( nz, &reader );
-        for( j = k = 0; j < nz_count; j++ )
-        {
-            CvPoint pt;
-            float _dx, _dy, _r2;
-            CV_READ_SEQ_ELEM( pt, reader );
-            _dx = cx - pt.x; _dy = cy - pt.y;
-            _r2 = _dx*_dx + _dy*_dy;
-            if(min_radius2 <= _r2 && _r2 <= max_radius2 )
-            {
-                ddata[k] = _r2;
-                sort_buf[k] = k;
-                k++;
-            }
-        }
 
-        int nz_count1 = k, start_idx = nz_count1 - 1;
-        if( nz_count1 == 0 )
-            continue;
-        dist_buf->cols = nz_count1;
-        cvPow( dist_buf, dist_buf, 0.5 );
-        std::sort(sort_buf.begin(), sort_buf.begin() + nz_count1, cv::hough_cmp_gt((int*)ddata));
+        cv::HoughCirclesRadiusInvoker radiusInvoker(nz, &batch_centers[0], min_radius2, max_radius2,
+                                                    max_radius, dr, &batch_radii[0], &batch_counts[0]);
+        if( ncenters > 1 )
+            cv::parallel_for_(cv::Range(0, ncenters), radiusInvoker, std::min(nthreads, ncenters));
+        else
+            radiusInvoker(cv::Range(0, 1));
 
-        dist_sum = start_dist = ddata[sort_buf[nz_count1-1]];
-        for( j = nz_count1 - 2; j >= 0; j-- )
+        for( k = 0; k < ncenters; k++ )
         {
-            float d = ddata[sort_buf[j]];
-
-            if( d > max_radius )
-                break;
-
-            if( d - start_dist > dr )
+            float cx = batch_centers[k].x, cy = batch_centers[k].y;
+            if( k > 0 && icvHoughCircleIsNear( circles, cx, cy, min_dist ) )
+                continue;
+            // Check if the circle has enough support
+            if( batch_counts[k] >= 0 && batch_counts[k] > acc_threshold )
             {
-                float r_cur = ddata[sort_buf[(j + start_idx)/2]];
-                if( (start_idx - j)*r_best >= max_count*r_cur ||
-                    (r_best < FLT_EPSILON && start_idx - j >= max_count) )
-                {
-                    r_best = r_cur;
-                    max_count = start_idx - j;
-                }
-                start_dist = d;
-                start_idx = j;
-                dist_sum = 0;
+                float c[3];
+                c[0] = cx;
+                c[1] = cy;
+                c[2] = batch_radii[k];
+                cvSeqPush( circles, c );
+                if( circles->total > circles_max )
+                    return;
             }
-            dist_sum += d;
-        }
-        // Check if the circle has enough support
-        if( max_count > acc_threshold )
-        {
-            float c[3];
-            c[0] = cx;
-            c[1] = cy;
-            c[2] = (float)r_best;
-            cvSeqPush( circles, c );
-            if( circles->total > circles_max )
-                return;
         }
     }
 }
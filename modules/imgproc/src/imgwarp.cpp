@@ -3397,7 +3397,10 @@ public:
         bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
     #endif
 
-        Mat _bufxy(brows0, bcols0, CV_16SC2), _bufa;
+        // the tile buffers are taken from the thread scratch arena when the caller is inside a ScratchScope
+        Mat _bufxy, _bufa;
+        _bufxy.allocator = _bufa.allocator = getScratchAllocator();
+        _bufxy.create(brows0, bcols0, CV_16SC2);
         if( !nnfunc )
             _bufa.create(brows0, bcols0, CV_16UC1);
 
@@ -631,7 +631,7 @@ typedef MorphNoVec ErodeVec64f;
 typedef MorphNoVec DilateVec64f;
 
 
-template<class Op, class VecOp> struct MorphRowFilter : public BaseRowFilter
+template<class Op, class VecOp> struct MorphRowFilter : public BaseRowFilter, public ClonableFilter<BaseRowFilter>
 {
     typedef typename Op::rtype T;
 
@@ -641,6 +641,8 @@ template<class Op, class VecOp> struct MorphRowFilter : public BaseRowFilter
         anchor = _anchor;
     }
 
+    Ptr<BaseRowFilter> clone() const { return makePtr<MorphRowFilter>(*this); }
+
     void operator()(const uchar* src, uchar* dst, int width, int cn)
     {
         int i, j, k, _ksize = ksize*cn;
@@ -685,7 +687,7 @@ template<class Op, class VecOp> struct MorphRowFilter : public BaseRowFilter
 };
 
 
-template<class Op, class VecOp> struct MorphColumnFilter : public BaseColumnFilter
+template<class Op, class VecOp> struct MorphColumnFilter : public BaseColumnFilter, public ClonableFilter<BaseColumnFilter>
 {
     typedef typename Op::rtype T;
 
@@ -695,6 +697,8 @@ template<class Op, class VecOp> struct MorphColumnFilter : public BaseColumnFilt
         anchor = _anchor;
     }
 
+    Ptr<BaseColumnFilter> clone() const { return makePtr<MorphColumnFilter>(*this); }
+
     void operator()(const uchar** _src, uchar* dst, int dststep, int count, int width)
     {
         int i, k, _ksize = ksize;
@@ -780,7 +784,7 @@ template<class Op, class VecOp> struct MorphColumnFilter : public BaseColumnFilt
 };
 
 
-template<class Op, class VecOp> struct MorphFilter : BaseFilter
+template<class Op, class VecOp> struct MorphFilter : BaseFilter, ClonableFilter<BaseFilter>
 {
     typedef typename Op::rtype T;
 
@@ -796,6 +800,8 @@ template<class Op, class VecOp> struct MorphFilter : BaseFilter
         ptrs.resize( coords.size() );
     }
 
+    Ptr<BaseFilter> clone() const { return makePtr<MorphFilter>(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width, int cn)
     {
         const Point* pt = &coords[0];
@@ -1143,6 +1149,7 @@ static bool IPPMorphReplicate(int op, const Mat &src, Mat &dst, const Mat &kerne
     int type = src.type();
     const Mat* _src = &src;
     Mat temp;
+    temp.allocator = getScratchAllocator();
     if (src.data == dst.data)
     {
         src.copyTo(temp);
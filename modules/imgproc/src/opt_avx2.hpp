@@ -0,0 +1,66 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2008-2013, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and / or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+#ifndef __OPENCV_IMGPROC_OPT_AVX2_HPP__
+#define __OPENCV_IMGPROC_OPT_AVX2_HPP__
+
+// Kernels compiled with the AVX2 flags (see *.avx2.cpp). The callers may only use them
+// when the build has HAVE_DISPATCH_AVX2 and checkHardwareSupport(CV_CPU_AVX2) is true.
+// This header is included by the sources built with and without AVX2, so it must not
+// define any inline code.
+
+#include "opencv2/core/cvdef.h"
+
+namespace cv
+{
+namespace opt_AVX2
+{
+
+// the gradient magnitude of Canny, |dx| + |dy| or dx*dx + dy*dy;
+// returns the number of the processed elements
+int cannyMagnitude(const short* dx, const short* dy, int* mag, int n, bool L2gradient);
+
+}
+}
+
+#endif
@@ -538,15 +538,17 @@ cv::Point2d cv::phaseCorrelate(InputArray _src1, InputArray _src2, InputArray _w
 
     // execute phase correlation equation
     // Reference: http://en.wikipedia.org/wiki/Phase_correlation
-    dft(padded1, FFT1, DFT_REAL_OUTPUT);
-    dft(padded2, FFT2, DFT_REAL_OUTPUT);
+    // the three transforms are of the same size, so they share the tables
+    DFTPlan plan(padded1.size(), padded1.type());
+    plan.execute(padded1, FFT1, DFT_REAL_OUTPUT);
+    plan.execute(padded2, FFT2, DFT_REAL_OUTPUT);
 
     mulSpectrums(FFT1, FFT2, P, 0, true);
 
     magSpectrums(P, Pm);
     divSpectrums(P, Pm, C, 0, false); // FF* / |FF*| (phase correlation equation completed here...)
 
-    idft(C, C); // gives us the nice peak shift location...
+    plan.execute(C, C, DFT_INVERSE); // gives us the nice peak shift location...
 
     fftShift(C); // shift the energy to the center of the frame.
 
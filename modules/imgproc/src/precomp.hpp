@@ -97,6 +97,29 @@ void crossCorr( const Mat& src, const Mat& templ, Mat& dst,
                 Point anchor=Point(0,0), double delta=0,
                 int borderType=BORDER_REFLECT_101 );
 
+// internal interface of the filters that cv::FilterEngine can copy
+// to process horizontal stripes of the image in parallel
+template<class BaseFilterT> class ClonableFilter
+{
+public:
+    virtual ~ClonableFilter() {}
+    // false when the stripes would not be bit-exact with the serial result
+    virtual bool isClonable() const { return true; }
+    virtual Ptr<BaseFilterT> clone() const = 0;
+};
+
+template<class BaseFilterT> static inline bool isClonableFilter( const Ptr<BaseFilterT>& f )
+{
+    const ClonableFilter<BaseFilterT>* cf = dynamic_cast<const ClonableFilter<BaseFilterT>*>(f.get());
+    return cf && cf->isClonable();
+}
+
+template<class BaseFilterT> static inline Ptr<BaseFilterT> cloneFilter( const Ptr<BaseFilterT>& f )
+{
+    const ClonableFilter<BaseFilterT>* cf = dynamic_cast<const ClonableFilter<BaseFilterT>*>(f.get());
+    return cf ? cf->clone() : Ptr<BaseFilterT>();
+}
+
 }
 
 typedef struct CvPyramid
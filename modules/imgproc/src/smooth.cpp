@@ -69,7 +69,8 @@ namespace cv
 
 template<typename T, typename ST>
 struct RowSum :
-        public BaseRowFilter
+        public BaseRowFilter,
+        public ClonableFilter<BaseRowFilter>
 {
     RowSum( int _ksize, int _anchor ) :
         BaseRowFilter()
@@ -78,6 +79,8 @@ struct RowSum :
         anchor = _anchor;
     }
 
+    virtual Ptr<BaseRowFilter> clone() const { return makePtr<RowSum>(*this); }
+
     virtual void operator()(const uchar* src, uchar* dst, int width, int cn)
     {
         const T* S = (const T*)src;
@@ -103,7 +106,8 @@ struct RowSum :
 
 template<typename ST, typename T>
 struct ColumnSum :
-        public BaseColumnFilter
+        public BaseColumnFilter,
+        public ClonableFilter<BaseColumnFilter>
 {
     ColumnSum( int _ksize, int _anchor, double _scale ) :
         BaseColumnFilter()
@@ -116,6 +120,11 @@ struct ColumnSum :
 
     virtual void reset() { sumCount = 0; }
 
+    // the running floating-point sum would be rounded differently in every stripe
+    virtual bool isClonable() const { return DataType<ST>::depth < CV_32F; }
+
+    virtual Ptr<BaseColumnFilter> clone() const { return makePtr<ColumnSum>(*this); }
+
     virtual void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
@@ -206,7 +215,8 @@ struct ColumnSum :
 
 template<>
 struct ColumnSum<int, uchar> :
-        public BaseColumnFilter
+        public BaseColumnFilter,
+        public ClonableFilter<BaseColumnFilter>
 {
     ColumnSum( int _ksize, int _anchor, double _scale ) :
         BaseColumnFilter()
@@ -219,6 +229,8 @@ struct ColumnSum<int, uchar> :
 
     virtual void reset() { sumCount = 0; }
 
+    virtual Ptr<BaseColumnFilter> clone() const { return makePtr<ColumnSum>(*this); }
+
     virtual void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
@@ -350,7 +362,8 @@ struct ColumnSum<int, uchar> :
 
 template<>
 struct ColumnSum<int, short> :
-        public BaseColumnFilter
+        public BaseColumnFilter,
+        public ClonableFilter<BaseColumnFilter>
 {
     ColumnSum( int _ksize, int _anchor, double _scale ) :
         BaseColumnFilter()
@@ -363,6 +376,8 @@ struct ColumnSum<int, short> :
 
     virtual void reset() { sumCount = 0; }
 
+    virtual Ptr<BaseColumnFilter> clone() const { return makePtr<ColumnSum>(*this); }
+
     virtual void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
@@ -491,7 +506,8 @@ struct ColumnSum<int, short> :
 
 template<>
 struct ColumnSum<int, ushort> :
-        public BaseColumnFilter
+        public BaseColumnFilter,
+        public ClonableFilter<BaseColumnFilter>
 {
     ColumnSum( int _ksize, int _anchor, double _scale ) :
         BaseColumnFilter()
@@ -504,6 +520,8 @@ struct ColumnSum<int, ushort> :
 
     virtual void reset() { sumCount = 0; }
 
+    virtual Ptr<BaseColumnFilter> clone() const { return makePtr<ColumnSum>(*this); }
+
     virtual void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
@@ -944,7 +962,8 @@ namespace cv
 
 template<typename T, typename ST>
 struct SqrRowSum :
-        public BaseRowFilter
+        public BaseRowFilter,
+        public ClonableFilter<BaseRowFilter>
 {
     SqrRowSum( int _ksize, int _anchor ) :
         BaseRowFilter()
@@ -953,6 +972,8 @@ struct SqrRowSum :
         anchor = _anchor;
     }
 
+    virtual Ptr<BaseRowFilter> clone() const { return makePtr<SqrRowSum>(*this); }
+
     virtual void operator()(const uchar* src, uchar* dst, int width, int cn)
     {
         const T* S = (const T*)src;
@@ -1304,10 +1325,10 @@ medianBlur_8u_O1( const Mat& _src, Mat& _dst, int ksize )
 
     int STRIPE_SIZE = std::min( _dst.cols, 512/cn );
 
-    std::vector<HT> _h_coarse(1 * 16 * (STRIPE_SIZE + 2*r) * cn + 16);
-    std::vector<HT> _h_fine(16 * 16 * (STRIPE_SIZE + 2*r) * cn + 16);
-    HT* h_coarse = alignPtr(&_h_coarse[0], 16);
-    HT* h_fine = alignPtr(&_h_fine[0], 16);
+    AutoBuffer<HT> _h_coarse(1 * 16 * (STRIPE_SIZE + 2*r) * cn + 16);
+    AutoBuffer<HT> _h_fine(16 * 16 * (STRIPE_SIZE + 2*r) * cn + 16);
+    HT* h_coarse = alignPtr((HT*)_h_coarse, 16);
+    HT* h_fine = alignPtr((HT*)_h_fine, 16);
 #if MEDIAN_HAVE_SIMD
     volatile bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
 #endif
@@ -2071,6 +2092,7 @@ void cv::medianBlur( InputArray _src0, OutputArray _dst, int ksize )
         );
 
     Mat src;
+    src.allocator = getScratchAllocator();
     if( useSortNet )
     {
         if( dst.data != src0.data )
@@ -2433,6 +2455,7 @@ bilateralFilter_8u( const Mat& src, Mat& dst, int d,
     d = radius*2 + 1;
 
     Mat temp;
+    temp.allocator = getScratchAllocator();
     copyMakeBorder( src, temp, radius, radius, radius, radius, borderType );
 
 #if defined HAVE_IPP && (IPP_VERSION_MAJOR >= 7) && 0
@@ -2447,12 +2470,12 @@ bilateralFilter_8u( const Mat& src, Mat& dst, int d,
     }
 #endif
 
-    std::vector<float> _color_weight(cn*256);
-    std::vector<float> _space_weight(d*d);
-    std::vector<int> _space_ofs(d*d);
-    float* color_weight = &_color_weight[0];
-    float* space_weight = &_space_weight[0];
-    int* space_ofs = &_space_ofs[0];
+    AutoBuffer<float> _color_weight(cn*256);
+    AutoBuffer<float> _space_weight(d*d);
+    AutoBuffer<int> _space_ofs(d*d);
+    float* color_weight = _color_weight;
+    float* space_weight = _space_weight;
+    int* space_ofs = _space_ofs;
 
     // initialize color-related bilateral filter coefficients
 
@@ -2702,21 +2725,22 @@ bilateralFilter_32f( const Mat& src, Mat& dst, int d,
 
     // temporary copy of the image with borders for easy processing
     Mat temp;
+    temp.allocator = getScratchAllocator();
     copyMakeBorder( src, temp, radius, radius, radius, radius, borderType );
     const double insteadNaNValue = -5. * sigma_color;
     patchNaNs( temp, insteadNaNValue ); // this replacement of NaNs makes the assumption that depth values are nonnegative
                                         // TODO: make insteadNaNValue avalible in the outside function interface to control the cases breaking the assumption
     // allocate lookup tables
-    std::vector<float> _space_weight(d*d);
-    std::vector<int> _space_ofs(d*d);
-    float* space_weight = &_space_weight[0];
-    int* space_ofs = &_space_ofs[0];
+    AutoBuffer<float> _space_weight(d*d);
+    AutoBuffer<int> _space_ofs(d*d);
+    float* space_weight = _space_weight;
+    int* space_ofs = _space_ofs;
 
     // assign a length which is slightly more than needed
     len = (float)(maxValSrc - minValSrc) * cn;
     kExpNumBins = kExpNumBinsPerChannel * cn;
-    std::vector<float> _expLUT(kExpNumBins+2);
-    float* expLUT = &_expLUT[0];
+    AutoBuffer<float> _expLUT(kExpNumBins+2);
+    float* expLUT = _expLUT;
 
     scale_index = kExpNumBins/len;
 
@@ -50,166 +50,385 @@ static IppStatus sts = ippInit();
 namespace cv
 {
 
-template<typename T, typename ST, typename QT>
-void integral_( const T* src, size_t _srcstep, ST* sum, size_t _sumstep,
-                QT* sqsum, size_t _sqsumstep, ST* tilted, size_t _tiltedstep,
-                Size size, int cn )
+// dst = a + b, for the rows of the integral images; b may be the same as dst
+template<typename ST> static inline void
+addIntegralRow( const ST* a, const ST* b, ST* dst, int n )
 {
-    int x, y, k;
+    for( int x = 0; x < n; x++ )
+        dst[x] = a[x] + b[x];
+}
 
-    int srcstep = (int)(_srcstep/sizeof(T));
-    int sumstep = (int)(_sumstep/sizeof(ST));
-    int tiltedstep = (int)(_tiltedstep/sizeof(ST));
-    int sqsumstep = (int)(_sqsumstep/sizeof(QT));
+#if CV_SSE2
 
-    size.width *= cn;
+static inline void addIntegralRow( const int* a, const int* b, int* dst, int n )
+{
+    int x = 0;
+    for( ; x <= n - 4; x += 4 )
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_add_epi32(_mm_loadu_si128((const __m128i*)(a + x)),
+                                                             _mm_loadu_si128((const __m128i*)(b + x))));
+    for( ; x < n; x++ )
+        dst[x] = a[x] + b[x];
+}
 
-    memset( sum, 0, (size.width+cn)*sizeof(sum[0]));
-    sum += sumstep + cn;
+static inline void addIntegralRow( const float* a, const float* b, float* dst, int n )
+{
+    int x = 0;
+    for( ; x <= n - 4; x += 4 )
+        _mm_storeu_ps(dst + x, _mm_add_ps(_mm_loadu_ps(a + x), _mm_loadu_ps(b + x)));
+    for( ; x < n; x++ )
+        dst[x] = a[x] + b[x];
+}
 
-    if( sqsum )
-    {
-        memset( sqsum, 0, (size.width+cn)*sizeof(sqsum[0]));
-        sqsum += sqsumstep + cn;
-    }
+static inline void addIntegralRow( const double* a, const double* b, double* dst, int n )
+{
+    int x = 0;
+    for( ; x <= n - 2; x += 2 )
+        _mm_storeu_pd(dst + x, _mm_add_pd(_mm_loadu_pd(a + x), _mm_loadu_pd(b + x)));
+    for( ; x < n; x++ )
+        dst[x] = a[x] + b[x];
+}
 
-    if( tilted )
-    {
-        memset( tilted, 0, (size.width+cn)*sizeof(tilted[0]));
-        tilted += tiltedstep + cn;
-    }
+// dst = above + v for the four 32-bit prefix sums in v
+static inline void storeIntegral( int* dst, const int* above, __m128i v )
+{
+    _mm_storeu_si128((__m128i*)dst, _mm_add_epi32(_mm_loadu_si128((const __m128i*)above), v));
+}
+
+static inline void storeIntegral( float* dst, const float* above, __m128i v )
+{
+    _mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(above), _mm_cvtepi32_ps(v)));
+}
+
+static inline void storeIntegral( double* dst, const double* above, __m128i v )
+{
+    _mm_storeu_pd(dst, _mm_add_pd(_mm_loadu_pd(above), _mm_cvtepi32_pd(v)));
+    _mm_storeu_pd(dst + 2, _mm_add_pd(_mm_loadu_pd(above + 2), _mm_cvtepi32_pd(_mm_srli_si128(v, 8))));
+}
+
+// inclusive prefix sum of the four 32-bit lanes plus the carry broadcasted in v_carry
+static inline __m128i prefixSum4( __m128i v, __m128i v_carry )
+{
+    v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+    v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+    return _mm_add_epi32(v, v_carry);
+}
+
+#endif
+
+// whether the row sums accumulated in the type ST up to maxval are the same
+// when they are computed in 32-bit integers and converted to ST
+template<typename ST> static inline bool exactFrom32s( double ) { return true; }
+template<> inline bool exactFrom32s<float>( double maxval ) { return maxval < (double)(1 << 24); }
+template<> inline bool exactFrom32s<double>( double maxval ) { return maxval <= INT_MAX; }
 
-    if( sqsum == 0 && tilted == 0 )
+// Computes one row of the sum (and sqsum) integral images: the prefix sums
+// of the source row added to the integral row above. The additions are done in
+// the same order as in the plain row-by-row scan, so the result does not depend
+// on how the image is split between the threads.
+template<typename T, typename ST, typename QT>
+struct IntegralRow
+{
+    IntegralRow( int _width, int _cn, bool ) : width(_width), cn(_cn) {}
+
+    void operator()( const T* src, ST* sum, const ST* sumAbove,
+                     QT* sqsum, const QT* sqsumAbove ) const
     {
-        for( y = 0; y < size.height; y++, src += srcstep - cn, sum += sumstep - cn )
+        for( int k = 0; k < cn; k++ )
         {
-            for( k = 0; k < cn; k++, src++, sum++ )
+            ST s = sum[k - cn] = 0;
+            QT sq = 0;
+
+            if( !sqsum )
             {
-                ST s = sum[-cn] = 0;
-                for( x = 0; x < size.width; x += cn )
+                for( int x = k; x < width; x += cn )
                 {
                     s += src[x];
-                    sum[x] = sum[x - sumstep] + s;
+                    sum[x] = sumAbove[x] + s;
                 }
+                continue;
+            }
+
+            sqsum[k - cn] = 0;
+            for( int x = k; x < width; x += cn )
+            {
+                T it = src[x];
+                s += it;
+                sq += (QT)it*it;
+                sum[x] = sumAbove[x] + s;
+                sqsum[x] = sqsumAbove[x] + sq;
             }
         }
     }
-    else if( tilted == 0 )
+
+    int width, cn;
+};
+
+// single-channel 8u rows are summed with SIMD in 32-bit integers, when that gives the same result
+template<typename ST, typename QT>
+struct IntegralRow<uchar, ST, QT>
+{
+    IntegralRow( int _width, int _cn, bool withSqsum ) : width(_width), cn(_cn)
     {
-        for( y = 0; y < size.height; y++, src += srcstep - cn,
-                        sum += sumstep - cn, sqsum += sqsumstep - cn )
+        useSIMD = false;
+#if CV_SSE2
+        useSIMD = cn == 1 && checkHardwareSupport(CV_CPU_SSE2) && exactFrom32s<ST>(255.*width) &&
+            (!withSqsum || exactFrom32s<QT>(255.*255.*width));
+#endif
+    }
+
+    void operator()( const uchar* src, ST* sum, const ST* sumAbove,
+                     QT* sqsum, const QT* sqsumAbove ) const
+    {
+        int x = 0;
+
+        if( !useSIMD )
         {
-            for( k = 0; k < cn; k++, src++, sum++, sqsum++ )
+            for( int k = 0; k < cn; k++ )
             {
-                ST s = sum[-cn] = 0;
-                QT sq = sqsum[-cn] = 0;
-                for( x = 0; x < size.width; x += cn )
+                ST s = sum[k - cn] = 0;
+                QT sq = 0;
+
+                if( sqsum )
+                    sqsum[k - cn] = 0;
+                for( x = k; x < width; x += cn )
                 {
-                    T it = src[x];
+                    int it = src[x];
                     s += it;
-                    sq += (QT)it*it;
-                    ST t = sum[x - sumstep] + s;
-                    QT tq = sqsum[x - sqsumstep] + sq;
-                    sum[x] = t;
-                    sqsum[x] = tq;
+                    sum[x] = sumAbove[x] + s;
+                    if( sqsum )
+                    {
+                        sq += (QT)it*it;
+                        sqsum[x] = sqsumAbove[x] + sq;
+                    }
                 }
             }
+            return;
         }
-    }
-    else
-    {
-        AutoBuffer<ST> _buf(size.width+cn);
-        ST* buf = _buf;
-        ST s;
-        QT sq;
-        for( k = 0; k < cn; k++, src++, sum++, tilted++, buf++ )
+
+        int s = 0, sq = 0;
+        sum[-1] = 0;
+        if( sqsum )
+            sqsum[-1] = 0;
+
+#if CV_SSE2
+        __m128i z = _mm_setzero_si128(), v_s = z, v_sq = z;
+        for( ; x <= width - 8; x += 8 )
         {
-            sum[-cn] = tilted[-cn] = 0;
+            __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src + x)), z);
+            __m128i lo = prefixSum4(_mm_unpacklo_epi16(v, z), v_s);
+            __m128i hi = prefixSum4(_mm_unpackhi_epi16(v, z), _mm_shuffle_epi32(lo, 0xff));
+            storeIntegral(sum + x, sumAbove + x, lo);
+            storeIntegral(sum + x + 4, sumAbove + x + 4, hi);
+            v_s = _mm_shuffle_epi32(hi, 0xff);
 
-            for( x = 0, s = 0, sq = 0; x < size.width; x += cn )
+            if( sqsum )
             {
-                T it = src[x];
-                buf[x] = tilted[x] = it;
-                s += it;
-                sq += (QT)it*it;
-                sum[x] = s;
-                if( sqsum )
-                    sqsum[x] = sq;
+                // 255*255 does not fit into a signed short, but the low 16 bits are right
+                v = _mm_mullo_epi16(v, v);
+                lo = prefixSum4(_mm_unpacklo_epi16(v, z), v_sq);
+                hi = prefixSum4(_mm_unpackhi_epi16(v, z), _mm_shuffle_epi32(lo, 0xff));
+                storeIntegral(sqsum + x, sqsumAbove + x, lo);
+                storeIntegral(sqsum + x + 4, sqsumAbove + x + 4, hi);
+                v_sq = _mm_shuffle_epi32(hi, 0xff);
             }
+        }
+        s = _mm_cvtsi128_si32(v_s);
+        sq = _mm_cvtsi128_si32(v_sq);
+#endif
 
-            if( size.width == cn )
-                buf[cn] = 0;
-
+        for( ; x < width; x++ )
+        {
+            int it = src[x];
+            s += it;
+            sum[x] = sumAbove[x] + (ST)s;
             if( sqsum )
             {
-                sqsum[-cn] = 0;
-                sqsum++;
+                sq += it*it;
+                sqsum[x] = sqsumAbove[x] + (QT)sq;
             }
         }
+    }
+
+    int width, cn;
+    bool useSIMD;
+};
+
+// the first pass of the parallel integral: the prefix sums of the rows in each stripe
+template<typename T, typename ST, typename QT>
+class IntegralRowsInvoker : public ParallelLoopBody
+{
+public:
+    IntegralRowsInvoker( const IntegralRow<T, ST, QT>& _rowFunc, const T* _src, int _srcstep,
+                         ST* _sum, int _sumstep, QT* _sqsum, int _sqsumstep ) :
+        rowFunc(_rowFunc), src(_src), srcstep(_srcstep), sum(_sum), sumstep(_sumstep),
+        sqsum(_sqsum), sqsumstep(_sqsumstep)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        // the first row of the integral images is zero
+        for( int y = range.start; y < range.end; y++ )
+            rowFunc(src + y*srcstep, sum + (y + 1)*sumstep, sum,
+                    sqsum ? sqsum + (y + 1)*sqsumstep : 0, sqsum);
+    }
 
-        for( y = 1; y < size.height; y++ )
+private:
+    IntegralRow<T, ST, QT> rowFunc;
+    const T* src;
+    int srcstep;
+    ST* sum;
+    int sumstep;
+    QT* sqsum;
+    int sqsumstep;
+};
+
+// the second pass: the row sums are accumulated down the image in vertical tiles
+template<typename ST>
+class IntegralColsInvoker : public ParallelLoopBody
+{
+public:
+    enum { TILE_WIDTH = 64 };
+
+    IntegralColsInvoker( ST* _sum, int _sumstep, Size _size ) :
+        sum(_sum), sumstep(_sumstep), size(_size)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int x0 = range.start*TILE_WIDTH, x1 = std::min(range.end*TILE_WIDTH, size.width);
+        ST* row = sum + sumstep + x0;
+        for( int y = 1; y < size.height; y++ )
         {
-            src += srcstep - cn;
-            sum += sumstep - cn;
-            tilted += tiltedstep - cn;
-            buf += -cn;
+            row += sumstep;
+            addIntegralRow(row - sumstep, row, row, x1 - x0);
+        }
+    }
+
+private:
+    ST* sum;
+    int sumstep;
+    Size size;
+};
 
+// Computes the sum and the sqsum integral images. Large images are processed
+// in two parallel passes: the rows are summed in horizontal stripes and then
+// the row sums are accumulated in vertical tiles.
+template<typename T, typename ST, typename QT>
+void integralSum_( const T* src, int srcstep, ST* sum, int sumstep,
+                   QT* sqsum, int sqsumstep, Size size, int cn )
+{
+    int width = size.width*cn;
+    IntegralRow<T, ST, QT> rowFunc(width, cn, sqsum != 0);
+
+    memset( sum, 0, (width+cn)*sizeof(sum[0]));
+    sum += cn;
+
+    if( sqsum )
+    {
+        memset( sqsum, 0, (width+cn)*sizeof(sqsum[0]));
+        sqsum += cn;
+    }
+
+    int nthreads = getNumThreads();
+    if( nthreads <= 1 || (double)width*size.height < (double)(1 << 18) || size.height < nthreads*8 )
+    {
+        for( int y = 0; y < size.height; y++, src += srcstep )
+        {
+            rowFunc(src, sum + sumstep, sum, sqsum ? sqsum + sqsumstep : 0, sqsum);
+            sum += sumstep;
             if( sqsum )
-                sqsum += sqsumstep - cn;
+                sqsum += sqsumstep;
+        }
+        return;
+    }
 
-            for( k = 0; k < cn; k++, src++, sum++, tilted++, buf++ )
-            {
-                T it = src[0];
-                ST t0 = s = it;
-                QT tq0 = sq = (QT)it*it;
+    parallel_for_(Range(0, size.height),
+                  IntegralRowsInvoker<T, ST, QT>(rowFunc, src, srcstep, sum, sumstep, sqsum, sqsumstep),
+                  nthreads);
 
-                sum[-cn] = 0;
-                if( sqsum )
-                    sqsum[-cn] = 0;
-                tilted[-cn] = tilted[-tiltedstep];
+    Size tsize(width, size.height);
+    int ntiles = (width + IntegralColsInvoker<ST>::TILE_WIDTH - 1)/IntegralColsInvoker<ST>::TILE_WIDTH;
+    parallel_for_(Range(0, ntiles), IntegralColsInvoker<ST>(sum, sumstep, tsize), nthreads);
+    if( sqsum )
+        parallel_for_(Range(0, ntiles), IntegralColsInvoker<QT>(sqsum, sqsumstep, tsize), nthreads);
+}
 
-                sum[0] = sum[-sumstep] + t0;
-                if( sqsum )
-                    sqsum[0] = sqsum[-sqsumstep] + tq0;
-                tilted[0] = tilted[-tiltedstep] + t0 + buf[cn];
+// Computes the tilted integral image. Every element depends on the left neighbour
+// and on the row above, so the recurrence is computed serially.
+template<typename T, typename ST>
+void integralTilted_( const T* src, int srcstep, ST* tilted, int tiltedstep, Size size, int cn )
+{
+    int x, y, k;
 
-                for( x = cn; x < size.width - cn; x += cn )
-                {
-                    ST t1 = buf[x];
-                    buf[x - cn] = t1 + t0;
-                    t0 = it = src[x];
-                    tq0 = (QT)it*it;
-                    s += t0;
-                    sq += tq0;
-                    sum[x] = sum[x - sumstep] + s;
-                    if( sqsum )
-                        sqsum[x] = sqsum[x - sqsumstep] + sq;
-                    t1 += buf[x + cn] + t0 + tilted[x - tiltedstep - cn];
-                    tilted[x] = t1;
-                }
+    size.width *= cn;
 
-                if( size.width > cn )
-                {
-                    ST t1 = buf[x];
-                    buf[x - cn] = t1 + t0;
-                    t0 = it = src[x];
-                    tq0 = (QT)it*it;
-                    s += t0;
-                    sq += tq0;
-                    sum[x] = sum[x - sumstep] + s;
-                    if( sqsum )
-                        sqsum[x] = sqsum[x - sqsumstep] + sq;
-                    tilted[x] = t0 + t1 + tilted[x - tiltedstep - cn];
-                    buf[x] = t0;
-                }
+    memset( tilted, 0, (size.width+cn)*sizeof(tilted[0]));
+    tilted += tiltedstep + cn;
 
-                if( sqsum )
-                    sqsum++;
+    AutoBuffer<ST> _buf(size.width+cn);
+    ST* buf = _buf;
+    for( k = 0; k < cn; k++, src++, tilted++, buf++ )
+    {
+        tilted[-cn] = 0;
+
+        for( x = 0; x < size.width; x += cn )
+            buf[x] = tilted[x] = src[x];
+
+        if( size.width == cn )
+            buf[cn] = 0;
+    }
+
+    for( y = 1; y < size.height; y++ )
+    {
+        src += srcstep - cn;
+        tilted += tiltedstep - cn;
+        buf += -cn;
+
+        for( k = 0; k < cn; k++, src++, tilted++, buf++ )
+        {
+            ST t0 = src[0];
+
+            tilted[-cn] = tilted[-tiltedstep];
+            tilted[0] = tilted[-tiltedstep] + t0 + buf[cn];
+
+            for( x = cn; x < size.width - cn; x += cn )
+            {
+                ST t1 = buf[x];
+                buf[x - cn] = t1 + t0;
+                t0 = src[x];
+                t1 += buf[x + cn] + t0 + tilted[x - tiltedstep - cn];
+                tilted[x] = t1;
+            }
+
+            if( size.width > cn )
+            {
+                ST t1 = buf[x];
+                buf[x - cn] = t1 + t0;
+                t0 = src[x];
+                tilted[x] = t0 + t1 + tilted[x - tiltedstep - cn];
+                buf[x] = t0;
             }
         }
     }
 }
 
+template<typename T, typename ST, typename QT>
+void integral_( const T* src, size_t _srcstep, ST* sum, size_t _sumstep,
+                QT* sqsum, size_t _sqsumstep, ST* tilted, size_t _tiltedstep,
+                Size size, int cn )
+{
+    int srcstep = (int)(_srcstep/sizeof(T));
+    int sumstep = (int)(_sumstep/sizeof(ST));
+    int tiltedstep = (int)(_tiltedstep/sizeof(ST));
+    int sqsumstep = (int)(_sqsumstep/sizeof(QT));
+
+    integralSum_(src, srcstep, sum, sumstep, sqsum, sqsumstep, size, cn);
+    if( tilted )
+        integralTilted_(src, srcstep, tilted, tiltedstep, size, cn);
+}
+
 
 #define DEF_INTEGRAL_FUNC(suffix, T, ST, QT) \
 static void integral_##suffix( T* src, size_t srcstep, ST* sum, size_t sumstep, QT* sqsum, size_t sqsumstep, \
@@ -413,6 +413,119 @@ static bool ipp_sqrDistance(const Mat& src, const Mat& tpl, Mat& dst)
 
 #endif
 
+// computes the correlation of the image blocks with the template in the frequency domain;
+// the blocks are independent, so they are processed in parallel
+class CrossCorrInvoker : public ParallelLoopBody
+{
+public:
+    CrossCorrInvoker( const Mat& _img0, const Mat& _dftTempl, Mat& _corr, const DFTPlan& _plan,
+                      Size _blocksize, Size _templSize, Point _ofs, int _tcn,
+                      double _delta, int _borderType, int _bufSize ) :
+        img0(_img0), dftTempl(_dftTempl), corr(_corr), plan(_plan), blocksize(_blocksize),
+        templSize(_templSize), ofs(_ofs), tcn(_tcn), delta(_delta), borderType(_borderType),
+        bufSize(_bufSize)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int depth = img0.depth(), cn = img0.channels();
+        int cdepth = corr.depth(), ccn = corr.channels();
+        int maxDepth = plan.depth();
+        Size dftsize = plan.size();
+        int tileCountX = (corr.cols + blocksize.width - 1)/blocksize.width;
+
+        Mat dftImg( dftsize, maxDepth );
+        std::vector<uchar> buf(std::max(bufSize, 1));
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            int x = (i%tileCountX)*blocksize.width;
+            int y = (i/tileCountX)*blocksize.height;
+
+            Size bsz(std::min(blocksize.width, corr.cols - x),
+                     std::min(blocksize.height, corr.rows - y));
+            Size dsz(bsz.width + templSize.width - 1, bsz.height + templSize.height - 1);
+            int x0 = x - ofs.x, y0 = y - ofs.y;
+            int x1 = std::max(0, x0), y1 = std::max(0, y0);
+            int x2 = std::min(img0.cols, x0 + dsz.width);
+            int y2 = std::min(img0.rows, y0 + dsz.height);
+            Mat src0(img0, Range(y1, y2), Range(x1, x2));
+            Mat dst(dftImg, Rect(0, 0, dsz.width, dsz.height));
+            Mat dst1(dftImg, Rect(x1-x0, y1-y0, x2-x1, y2-y1));
+            Mat cdst(corr, Rect(x, y, bsz.width, bsz.height));
+
+            for( int k = 0; k < cn; k++ )
+            {
+                Mat src = src0;
+                dftImg = Scalar::all(0);
+
+                if( cn > 1 )
+                {
+                    src = depth == maxDepth ? dst1 : Mat(y2-y1, x2-x1, depth, &buf[0]);
+                    int pairs[] = {k, 0};
+                    mixChannels(&src0, 1, &src, 1, pairs, 1);
+                }
+
+                if( dst1.data != src.data )
+                    src.convertTo(dst1, dst1.depth());
+
+                if( x2 - x1 < dsz.width || y2 - y1 < dsz.height )
+                    copyMakeBorder(dst1, dst, y1-y0, dst.rows-dst1.rows-(y1-y0),
+                                   x1-x0, dst.cols-dst1.cols-(x1-x0), borderType);
+
+                plan.execute( dftImg, dftImg, 0, dsz.height );
+                Mat dftTempl1(dftTempl, Rect(0, tcn > 1 ? k*dftsize.height : 0,
+                                             dftsize.width, dftsize.height));
+                mulSpectrums(dftImg, dftTempl1, dftImg, 0, true);
+                plan.execute( dftImg, dftImg, DFT_INVERSE + DFT_SCALE, bsz.height );
+
+                src = dftImg(Rect(0, 0, bsz.width, bsz.height));
+
+                if( ccn > 1 )
+                {
+                    if( cdepth != maxDepth )
+                    {
+                        Mat plane(bsz, cdepth, &buf[0]);
+                        src.convertTo(plane, cdepth, 1, delta);
+                        src = plane;
+                    }
+                    int pairs[] = {0, k};
+                    mixChannels(&src, 1, &cdst, 1, pairs, 1);
+                }
+                else
+                {
+                    if( k == 0 )
+                        src.convertTo(cdst, cdepth, 1, delta);
+                    else
+                    {
+                        if( maxDepth != cdepth )
+                        {
+                            Mat plane(bsz, cdepth, &buf[0]);
+                            src.convertTo(plane, cdepth);
+                            src = plane;
+                        }
+                        add(src, cdst, cdst);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    Mat img0;
+    Mat dftTempl;
+    Mat corr;
+    const DFTPlan& plan;
+    Size blocksize;
+    Size templSize;
+    Point ofs;
+    int tcn;
+    double delta;
+    int borderType;
+    int bufSize;
+};
+
 void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
                 Size corrsize, int ctype,
                 Point anchor, double delta, int borderType )
@@ -464,9 +577,10 @@ void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
     blocksize.height = MIN( blocksize.height, corr.rows );
 
     Mat dftTempl( dftsize.height*tcn, dftsize.width, maxDepth );
-    Mat dftImg( dftsize, maxDepth );
+    // all the template planes and the image blocks are transformed with the same tables
+    DFTPlan plan( dftsize, maxDepth );
 
-    int i, k, bufSize = 0;
+    int k, bufSize = 0;
     if( tcn > 1 && tdepth != maxDepth )
         bufSize = templ.cols*templ.rows*CV_ELEM_SIZE(tdepth);
 
@@ -502,7 +616,7 @@ void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
             Mat part(dst, Range(0, templ.rows), Range(templ.cols, dst.cols));
             part = Scalar::all(0);
         }
-        dft(dst, dst, 0, templ.rows);
+        plan.execute(dst, dst, 0, templ.rows);
     }
 
     int tileCountX = (corr.cols + blocksize.width - 1)/blocksize.width;
@@ -522,79 +636,359 @@ void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
     borderType |= BORDER_ISOLATED;
 
     // calculate correlation by blocks
-    for( i = 0; i < tileCount; i++ )
+    CrossCorrInvoker invoker(img0, dftTempl, corr, plan, blocksize, templ.size(),
+                             Point(anchor.x - roiofs.x, anchor.y - roiofs.y), tcn,
+                             delta, borderType, bufSize);
+    parallel_for_(Range(0, tileCount), invoker);
+}
+
+// Small templates are correlated with the image directly, without DFT;
+// the output rows are independent, so they are computed in parallel.
+// In the 8u case every pixel is paired with its right neighbour, so that
+// _mm_madd_epi16 multiplies two pixels by two template values at once.
+class CrossCorrDirect8uInvoker : public ParallelLoopBody
+{
+public:
+    CrossCorrDirect8uInvoker( const Mat& _img, const Mat& templ, Mat& _corr ) :
+        img(_img), corr(_corr), tsize(templ.size()), cn(templ.channels())
+    {
+        npairs = (tsize.width + 1)/2;
+        coeffs.resize(cn*tsize.height*npairs*4);
+        for( int k = 0; k < cn; k++ )
+            for( int y = 0; y < tsize.height; y++ )
+            {
+                const uchar* t = templ.ptr(y);
+                for( int j = 0; j < npairs; j++ )
+                {
+                    int c0 = t[j*2*cn + k], c1 = j*2 + 1 < tsize.width ? t[(j*2 + 1)*cn + k] : 0;
+                    int* c = &coeffs[((k*tsize.height + y)*npairs + j)*4];
+                    c[0] = c[1] = c[2] = c[3] = c0 | (c1 << 16);
+                }
+            }
+        haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+    }
+
+    void operator()( const Range& range ) const
     {
-        int x = (i%tileCountX)*blocksize.width;
-        int y = (i/tileCountX)*blocksize.height;
-
-        Size bsz(std::min(blocksize.width, corr.cols - x),
-                 std::min(blocksize.height, corr.rows - y));
-        Size dsz(bsz.width + templ.cols - 1, bsz.height + templ.rows - 1);
-        int x0 = x - anchor.x + roiofs.x, y0 = y - anchor.y + roiofs.y;
-        int x1 = std::max(0, x0), y1 = std::max(0, y0);
-        int x2 = std::min(img0.cols, x0 + dsz.width);
-        int y2 = std::min(img0.rows, y0 + dsz.height);
-        Mat src0(img0, Range(y1, y2), Range(x1, x2));
-        Mat dst(dftImg, Rect(0, 0, dsz.width, dsz.height));
-        Mat dst1(dftImg, Rect(x1-x0, y1-y0, x2-x1, y2-y1));
-        Mat cdst(corr, Rect(x, y, bsz.width, bsz.height));
-
-        for( k = 0; k < cn; k++ )
+        // the pairs are made for the blocks of the output rows, to keep them in cache
+        const int blockSize = 64;
+        Mat pairs((std::min(blockSize, range.end - range.start) + tsize.height - 1)*cn,
+                  img.cols*2, CV_16S);
+
+        for( int y0 = range.start; y0 < range.end; y0 += blockSize )
         {
-            Mat src = src0;
-            dftImg = Scalar::all(0);
+            int y1 = std::min(y0 + blockSize, range.end);
+            int rows = y1 - y0 + tsize.height - 1;
+
+            for( int k = 0; k < cn; k++ )
+                for( int r = 0; r < rows; r++ )
+                    makePairs(img.ptr(y0 + r) + k, pairs.ptr<short>(k*rows + r));
+
+            processRows(pairs, rows, y0, y1);
+        }
+    }
 
-            if( cn > 1 )
+private:
+    void processRows( const Mat& pairs, int rows, int y0, int y1 ) const
+    {
+        int width = corr.cols, height = tsize.height, npairs0 = npairs, cn0 = cn;
+        const int* c0 = &coeffs[0];
+
+        for( int y = y0; y < y1; y++ )
+        {
+            float* dst = (float*)(corr.data + y*corr.step);
+            int yofs = y - y0, x = 0;
+
+#if CV_SSE2
+            for( ; haveSSE2 && x <= width - 16; x += 16 )
             {
-                src = depth == maxDepth ? dst1 : Mat(y2-y1, x2-x1, depth, &buf[0]);
-                int pairs[] = {k, 0};
-                mixChannels(&src0, 1, &src, 1, pairs, 1);
+                __m128i s0 = _mm_setzero_si128(), s1 = s0, s2 = s0, s3 = s0;
+                const int* c = c0;
+                for( int k = 0; k < cn0; k++ )
+                    for( int ty = 0; ty < height; ty++ )
+                    {
+                        const int* p = (const int*)pairs.ptr<short>(k*rows + yofs + ty) + x;
+                        for( int j = 0; j < npairs0; j++, p += 2, c += 4 )
+                        {
+                            __m128i v_c = _mm_loadu_si128((const __m128i*)c);
+                            s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)p), v_c));
+                            s1 = _mm_add_epi32(s1, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(p + 4)), v_c));
+                            s2 = _mm_add_epi32(s2, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(p + 8)), v_c));
+                            s3 = _mm_add_epi32(s3, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(p + 12)), v_c));
+                        }
+                    }
+                _mm_storeu_ps(dst + x, _mm_cvtepi32_ps(s0));
+                _mm_storeu_ps(dst + x + 4, _mm_cvtepi32_ps(s1));
+                _mm_storeu_ps(dst + x + 8, _mm_cvtepi32_ps(s2));
+                _mm_storeu_ps(dst + x + 12, _mm_cvtepi32_ps(s3));
             }
+#endif
 
-            if( dst1.data != src.data )
-                src.convertTo(dst1, dst1.depth());
+            for( ; x < width; x++ )
+            {
+                int s = 0;
+                const int* c = c0;
+                for( int k = 0; k < cn0; k++ )
+                    for( int ty = 0; ty < height; ty++ )
+                    {
+                        const short* p = pairs.ptr<short>(k*rows + yofs + ty) + x*2;
+                        for( int j = 0; j < npairs0; j++, p += 4, c += 4 )
+                            s += p[0]*(c[0] & 0xffff) + p[1]*(c[0] >> 16);
+                    }
+                dst[x] = (float)s;
+            }
+        }
+    }
 
-            if( x2 - x1 < dsz.width || y2 - y1 < dsz.height )
-                copyMakeBorder(dst1, dst, y1-y0, dst.rows-dst1.rows-(y1-y0),
-                               x1-x0, dst.cols-dst1.cols-(x1-x0), borderType);
+    // the pixels of the channel that starts at src, each with its right neighbour;
+    // the last pixel of the row is paired with 0
+    void makePairs( const uchar* src, short* dst ) const
+    {
+        int x = 0, width = img.cols;
 
-            dft( dftImg, dftImg, 0, dsz.height );
-            Mat dftTempl1(dftTempl, Rect(0, tcn > 1 ? k*dftsize.height : 0,
-                                         dftsize.width, dftsize.height));
-            mulSpectrums(dftImg, dftTempl1, dftImg, 0, true);
-            dft( dftImg, dftImg, DFT_INVERSE + DFT_SCALE, bsz.height );
+#if CV_SSE2
+        if( haveSSE2 && cn == 1 )
+        {
+            __m128i z = _mm_setzero_si128();
+            for( ; x <= width - 17; x += 16 )
+            {
+                __m128i a = _mm_loadu_si128((const __m128i*)(src + x));
+                __m128i b = _mm_loadu_si128((const __m128i*)(src + x + 1));
+                __m128i a0 = _mm_unpacklo_epi8(a, z), a1 = _mm_unpackhi_epi8(a, z);
+                __m128i b0 = _mm_unpacklo_epi8(b, z), b1 = _mm_unpackhi_epi8(b, z);
+                _mm_storeu_si128((__m128i*)(dst + x*2), _mm_unpacklo_epi16(a0, b0));
+                _mm_storeu_si128((__m128i*)(dst + x*2 + 8), _mm_unpackhi_epi16(a0, b0));
+                _mm_storeu_si128((__m128i*)(dst + x*2 + 16), _mm_unpacklo_epi16(a1, b1));
+                _mm_storeu_si128((__m128i*)(dst + x*2 + 24), _mm_unpackhi_epi16(a1, b1));
+            }
+        }
+#endif
 
-            src = dftImg(Rect(0, 0, bsz.width, bsz.height));
+        for( ; x < width - 1; x++ )
+        {
+            dst[x*2] = src[x*cn];
+            dst[x*2 + 1] = src[(x + 1)*cn];
+        }
+        dst[x*2] = src[x*cn];
+        dst[x*2 + 1] = 0;
+    }
 
-            if( ccn > 1 )
-            {
-                if( cdepth != maxDepth )
+    Mat img;
+    Mat corr;
+    Size tsize;
+    int cn;
+    int npairs;
+    std::vector<int> coeffs;
+    bool haveSSE2;
+};
+
+class CrossCorrDirect32fInvoker : public ParallelLoopBody
+{
+public:
+    CrossCorrDirect32fInvoker( const std::vector<Mat>& _planes, const Mat& templ, Mat& _corr ) :
+        planes(_planes), corr(_corr), tsize(templ.size())
+    {
+        int cn = templ.channels();
+        coeffs.resize(cn*tsize.area()*4);
+        for( int k = 0; k < cn; k++ )
+            for( int y = 0; y < tsize.height; y++ )
+                for( int x = 0; x < tsize.width; x++ )
                 {
-                    Mat plane(bsz, cdepth, &buf[0]);
-                    src.convertTo(plane, cdepth, 1, delta);
-                    src = plane;
+                    float* c = &coeffs[((k*tsize.height + y)*tsize.width + x)*4];
+                    c[0] = c[1] = c[2] = c[3] = templ.ptr<float>(y)[x*cn + k];
                 }
-                int pairs[] = {0, k};
-                mixChannels(&src, 1, &cdst, 1, pairs, 1);
+        haveSSE = checkHardwareSupport(CV_CPU_SSE);
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int cn = (int)planes.size();
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            float* dst = (float*)(corr.data + y*corr.step);
+            int x = 0;
+
+#if CV_SSE
+            for( ; haveSSE && x <= corr.cols - 16; x += 16 )
+            {
+                __m128 s0 = _mm_setzero_ps(), s1 = s0, s2 = s0, s3 = s0;
+                const float* c = &coeffs[0];
+                for( int k = 0; k < cn; k++ )
+                    for( int ty = 0; ty < tsize.height; ty++ )
+                    {
+                        const float* src = planes[k].ptr<float>(y + ty) + x;
+                        for( int tx = 0; tx < tsize.width; tx++, c += 4 )
+                        {
+                            __m128 v_c = _mm_loadu_ps(c);
+                            s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(src + tx), v_c));
+                            s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(src + tx + 4), v_c));
+                            s2 = _mm_add_ps(s2, _mm_mul_ps(_mm_loadu_ps(src + tx + 8), v_c));
+                            s3 = _mm_add_ps(s3, _mm_mul_ps(_mm_loadu_ps(src + tx + 12), v_c));
+                        }
+                    }
+                _mm_storeu_ps(dst + x, s0);
+                _mm_storeu_ps(dst + x + 4, s1);
+                _mm_storeu_ps(dst + x + 8, s2);
+                _mm_storeu_ps(dst + x + 12, s3);
             }
-            else
+#endif
+
+            // the same order of the additions as in the SIMD loop
+            for( ; x < corr.cols; x++ )
             {
-                if( k == 0 )
-                    src.convertTo(cdst, cdepth, 1, delta);
-                else
+                float s = 0;
+                const float* c = &coeffs[0];
+                for( int k = 0; k < cn; k++ )
+                    for( int ty = 0; ty < tsize.height; ty++ )
+                    {
+                        const float* src = planes[k].ptr<float>(y + ty) + x;
+                        for( int tx = 0; tx < tsize.width; tx++, c += 4 )
+                            s += src[tx]*c[0];
+                    }
+                dst[x] = s;
+            }
+        }
+    }
+
+private:
+    std::vector<Mat> planes;
+    Mat corr;
+    Size tsize;
+    std::vector<float> coeffs;
+    bool haveSSE;
+};
+
+// the direct correlation is faster than DFT for the small templates
+static bool useDirectCrossCorr( Size templSize )
+{
+    return templSize.area() <= 256;
+}
+
+static void crossCorrDirect( const Mat& img, const Mat& templ, Mat& corr )
+{
+    if( img.depth() == CV_8U )
+    {
+        parallel_for_(Range(0, corr.rows), CrossCorrDirect8uInvoker(img, templ, corr), getNumThreads());
+        return;
+    }
+
+    std::vector<Mat> planes;
+    if( img.channels() > 1 )
+        split(img, planes);
+    else
+        planes.push_back(img);
+
+    parallel_for_(Range(0, corr.rows), CrossCorrDirect32fInvoker(planes, templ, corr), getNumThreads());
+}
+
+// converts the correlation into the result of the given method, using the integral
+// images of the image (and of its squares) to get the window sums; the rows are independent
+class MatchTemplateNormInvoker : public ParallelLoopBody
+{
+public:
+    MatchTemplateNormInvoker( Mat& _result, const Mat& _sum, const Mat& _sqsum, Size _templSize,
+                              int _cn, int _method, const Scalar& _templMean,
+                              double _templNorm, double _templSum2 ) :
+        result(_result), sum(_sum), sqsum(_sqsum), templSize(_templSize), cn(_cn),
+        method(_method), templMean(_templMean), templNorm(_templNorm), templSum2(_templSum2)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int numType = method == CV_TM_CCORR || method == CV_TM_CCORR_NORMED ? 0 :
+                      method == CV_TM_CCOEFF || method == CV_TM_CCOEFF_NORMED ? 1 : 2;
+        bool isNormed = method == CV_TM_CCORR_NORMED ||
+                        method == CV_TM_SQDIFF_NORMED ||
+                        method == CV_TM_CCOEFF_NORMED;
+        double invArea = 1./((double)templSize.area());
+        const double *q0 = 0, *q1 = 0, *q2 = 0, *q3 = 0;
+
+        if( sqsum.data )
+        {
+            q0 = (const double*)sqsum.data;
+            q1 = q0 + templSize.width*cn;
+            q2 = (const double*)(sqsum.data + templSize.height*sqsum.step);
+            q3 = q2 + templSize.width*cn;
+        }
+
+        const double* p0 = (const double*)sum.data;
+        const double* p1 = p0 + templSize.width*cn;
+        const double* p2 = (const double*)(sum.data + templSize.height*sum.step);
+        const double* p3 = p2 + templSize.width*cn;
+
+        int sumstep = sum.data ? (int)(sum.step / sizeof(double)) : 0;
+        int sqstep = sqsum.data ? (int)(sqsum.step / sizeof(double)) : 0;
+
+        int i, j, k;
+
+        for( i = range.start; i < range.end; i++ )
+        {
+            float* rrow = (float*)(result.data + i*result.step);
+            int idx = i * sumstep;
+            int idx2 = i * sqstep;
+
+            for( j = 0; j < result.cols; j++, idx += cn, idx2 += cn )
+            {
+                double num = rrow[j], t;
+                double wndMean2 = 0, wndSum2 = 0;
+
+                if( numType == 1 )
                 {
-                    if( maxDepth != cdepth )
+                    for( k = 0; k < cn; k++ )
                     {
-                        Mat plane(bsz, cdepth, &buf[0]);
-                        src.convertTo(plane, cdepth);
-                        src = plane;
+                        t = p0[idx+k] - p1[idx+k] - p2[idx+k] + p3[idx+k];
+                        wndMean2 += t*t;
+                        num -= t*templMean[k];
+                    }
+
+                    wndMean2 *= invArea;
+                }
+
+                if( isNormed || numType == 2 )
+                {
+                    for( k = 0; k < cn; k++ )
+                    {
+                        t = q0[idx2+k] - q1[idx2+k] - q2[idx2+k] + q3[idx2+k];
+                        wndSum2 += t;
+                    }
+
+                    if( numType == 2 )
+                    {
+                        num = wndSum2 - 2*num + templSum2;
+                        num = MAX(num, 0.);
                     }
-                    add(src, cdst, cdst);
                 }
+
+                if( isNormed )
+                {
+                    t = std::sqrt(MAX(wndSum2 - wndMean2,0))*templNorm;
+                    if( fabs(num) < t )
+                        num /= t;
+                    else if( fabs(num) < t*1.125 )
+                        num = num > 0 ? 1 : -1;
+                    else
+                        num = method != CV_TM_SQDIFF_NORMED ? 0 : 1;
+                }
+
+                rrow[j] = (float)num;
             }
         }
     }
-}
+
+private:
+    Mat result;
+    Mat sum;
+    Mat sqsum;
+    Size templSize;
+    int cn;
+    int method;
+    Scalar templMean;
+    double templNorm;
+    double templSum2;
+};
+
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -616,9 +1010,6 @@ void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result,
 
     int numType = method == CV_TM_CCORR || method == CV_TM_CCORR_NORMED ? 0 :
                   method == CV_TM_CCOEFF || method == CV_TM_CCOEFF_NORMED ? 1 : 2;
-    bool isNormed = method == CV_TM_CCORR_NORMED ||
-                    method == CV_TM_SQDIFF_NORMED ||
-                    method == CV_TM_CCOEFF_NORMED;
 
     Mat img = _img.getMat(), templ = _templ.getMat();
     if (needswap)
@@ -633,8 +1024,10 @@ void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result,
         return;
 #endif
 
+    bool useDirect = useDirectCrossCorr(templ.size());
+
 #if defined HAVE_IPP && IPP_VERSION_MAJOR >= 7 && !defined HAVE_IPP_ICV_ONLY
-    if (method == CV_TM_SQDIFF && cn == 1)
+    if (method == CV_TM_SQDIFF && cn == 1 && !useDirect)
     {
         if (ipp_sqrDistance(img, templ, result))
             return;
@@ -642,6 +1035,9 @@ void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result,
     }
 #endif
 
+    if( useDirect )
+        crossCorrDirect( img, templ, result );
+    else
 #if defined HAVE_IPP && IPP_VERSION_MAJOR >= 7 && !defined HAVE_IPP_ICV_ONLY
     if (cn == 1)
     {
@@ -662,7 +1058,6 @@ void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result,
 
     Mat sum, sqsum;
     Scalar templMean, templSdv;
-    double *q0 = 0, *q1 = 0, *q2 = 0, *q3 = 0;
     double templNorm = 0, templSum2 = 0;
 
     if( method == CV_TM_CCOEFF )
@@ -694,78 +1089,13 @@ void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result,
         templSum2 /= invArea;
         templNorm = std::sqrt(templNorm);
         templNorm /= std::sqrt(invArea); // care of accuracy here
-
-        q0 = (double*)sqsum.data;
-        q1 = q0 + templ.cols*cn;
-        q2 = (double*)(sqsum.data + templ.rows*sqsum.step);
-        q3 = q2 + templ.cols*cn;
     }
 
-    double* p0 = (double*)sum.data;
-    double* p1 = p0 + templ.cols*cn;
-    double* p2 = (double*)(sum.data + templ.rows*sum.step);
-    double* p3 = p2 + templ.cols*cn;
-
-    int sumstep = sum.data ? (int)(sum.step / sizeof(double)) : 0;
-    int sqstep = sqsum.data ? (int)(sqsum.step / sizeof(double)) : 0;
-
-    int i, j, k;
-
-    for( i = 0; i < result.rows; i++ )
-    {
-        float* rrow = (float*)(result.data + i*result.step);
-        int idx = i * sumstep;
-        int idx2 = i * sqstep;
-
-        for( j = 0; j < result.cols; j++, idx += cn, idx2 += cn )
-        {
-            double num = rrow[j], t;
-            double wndMean2 = 0, wndSum2 = 0;
-
-            if( numType == 1 )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    t = p0[idx+k] - p1[idx+k] - p2[idx+k] + p3[idx+k];
-                    wndMean2 += t*t;
-                    num -= t*templMean[k];
-                }
-
-                wndMean2 *= invArea;
-            }
-
-            if( isNormed || numType == 2 )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    t = q0[idx2+k] - q1[idx2+k] - q2[idx2+k] + q3[idx2+k];
-                    wndSum2 += t;
-                }
-
-                if( numType == 2 )
-                {
-                    num = wndSum2 - 2*num + templSum2;
-                    num = MAX(num, 0.);
-                }
-            }
-
-            if( isNormed )
-            {
-                t = std::sqrt(MAX(wndSum2 - wndMean2,0))*templNorm;
-                if( fabs(num) < t )
-                    num /= t;
-                else if( fabs(num) < t*1.125 )
-                    num = num > 0 ? 1 : -1;
-                else
-                    num = method != CV_TM_SQDIFF_NORMED ? 0 : 1;
-            }
-
-            rrow[j] = (float)num;
-        }
-    }
+    parallel_for_(Range(0, result.rows),
+                  MatchTemplateNormInvoker(result, sum, sqsum, templ.size(), cn, method,
+                                           templMean, templNorm, templSum2), getNumThreads());
 }
 
-
 CV_IMPL void
 cvMatchTemplate( const CvArr* _img, const CvArr* _templ, CvArr* _result, int method )
 {
@@ -284,4 +284,43 @@ int CV_CannyTest::validate_test_results( int test_case_idx )
 
 TEST(Imgproc_Canny, accuracy) { CV_CannyTest test; test.safe_run(); }
 
+TEST(Imgproc_Canny, parallel_stripes)
+{
+    int nthreads = getNumThreads();
+    RNG& rng = theRNG();
+
+    for (int iter = 0; iter < 8; iter++)
+    {
+        int cn = iter % 2 == 0 ? 1 : 3;
+        bool L2gradient = (iter / 2) % 2 != 0;
+        int aperture_size = iter < 4 ? 3 : 5;
+
+        // the long edges of the circles and lines cross the stripe boundaries
+        Mat src(rng.uniform(300, 600), rng.uniform(300, 600), CV_8UC(cn));
+        randu(src, 0, 64);
+        for (int k = 0; k < 20; k++)
+        {
+            Point p1(rng.uniform(0, src.cols), rng.uniform(0, src.rows));
+            Point p2(rng.uniform(0, src.cols), rng.uniform(0, src.rows));
+            Scalar color(rng.uniform(64, 256), rng.uniform(64, 256), rng.uniform(64, 256));
+            line(src, p1, p2, color, rng.uniform(1, 4));
+            circle(src, p1, rng.uniform(10, 200), color, rng.uniform(1, 4));
+        }
+        GaussianBlur(src, src, Size(5, 5), 1.5);
+
+        double low = aperture_size == 3 ? 20 : 200, high = low*3;
+        Mat serial, parallel;
+        setNumThreads(1);
+        Canny(src, serial, low, high, aperture_size, L2gradient);
+        setNumThreads(4);
+        Canny(src, parallel, low, high, aperture_size, L2gradient);
+
+        ASSERT_GT(countNonZero(serial), 0);
+        EXPECT_EQ(0, cvtest::norm(serial, parallel, NORM_INF))
+            << "cn=" << cn << ", L2gradient=" << L2gradient << ", aperture_size=" << aperture_size;
+    }
+
+    setNumThreads(nthreads);
+}
+
 /* End of file. */
@@ -1918,3 +1918,154 @@ TEST(Imgproc_Blur, borderTypes)
     EXPECT_EQ(expected_dst.size(), dst.size());
     EXPECT_DOUBLE_EQ(0.0, cvtest::norm(expected_dst, dst, NORM_INF));
 }
+
+static void applyFilters(const Mat& src, int borderType, std::vector<Mat>& dst)
+{
+    Mat kernel(5, 5, CV_32F);
+    RNG rng(42);
+    rng.fill(kernel, RNG::UNIFORM, -1, 1);
+    Mat kx = getGaussianKernel(9, 2.5, CV_32F), ky = getGaussianKernel(7, 1.5, CV_32F);
+    Mat src32f, src64f, src16u;
+    src.convertTo(src32f, CV_32F, 1./255);
+    src.convertTo(src64f, CV_64F, 1./255);
+    src.convertTo(src16u, CV_16U, 256);
+    // unnormalized and floating-point boxFilter and the morphology do not accept BORDER_ISOLATED
+    int noIsolated = borderType & ~BORDER_ISOLATED;
+
+    dst.assign(12, Mat());
+    GaussianBlur(src, dst[0], Size(7, 7), 1.2, 1.2, borderType);
+    sepFilter2D(src32f, dst[1], -1, kx, ky, Point(-1, -1), 0, borderType);
+    filter2D(src, dst[2], CV_16S, kernel, Point(-1, -1), 0, borderType);
+    Sobel(src, dst[3], CV_16S, 1, 0, 3, 1, 0, borderType);
+    Scharr(src32f, dst[4], -1, 0, 1, 1, 0, borderType);
+    Laplacian(src, dst[5], CV_16S, 5, 1, 0, borderType);
+    boxFilter(src16u, dst[6], -1, Size(15, 3), Point(-1, -1), false, noIsolated);
+    blur(src, dst[7], Size(5, 5), Point(-1, -1), borderType);
+    erode(src, dst[8], getStructuringElement(MORPH_ELLIPSE, Size(7, 7)), Point(-1, -1), 1, noIsolated);
+    dilate(src32f, dst[9], Mat(), Point(-1, -1), 1, noIsolated);
+    // the floating-point box sums must stay bit-exact as well
+    boxFilter(src32f, dst[10], -1, Size(5, 9), Point(-1, -1), true, noIsolated);
+    blur(src64f, dst[11], Size(7, 7), Point(-1, -1), noIsolated);
+}
+
+TEST(Imgproc_Filtering, parallel_stripes)
+{
+    int nthreads = getNumThreads();
+    const int borderTypes[] = { BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT_101,
+                                BORDER_REFLECT_101 | BORDER_ISOLATED };
+
+    Mat whole(613, 511, CV_8UC3);
+    randu(whole, 0, 256);
+    Mat src = whole(Rect(3, 5, 500, 600));
+
+    for( size_t i = 0; i < sizeof(borderTypes)/sizeof(borderTypes[0]); i++ )
+    {
+        std::vector<Mat> serial, parallel;
+        setNumThreads(1);
+        applyFilters(src, borderTypes[i], serial);
+        setNumThreads(4);
+        applyFilters(src, borderTypes[i], parallel);
+
+        for( size_t j = 0; j < serial.size(); j++ )
+        {
+            ASSERT_EQ(serial[j].type(), parallel[j].type());
+            ASSERT_EQ(serial[j].size(), parallel[j].size());
+            EXPECT_EQ(0, cvtest::norm(serial[j], parallel[j], NORM_INF))
+                << "filter #" << j << ", border " << borderTypes[i];
+        }
+    }
+
+    setNumThreads(nthreads);
+}
+
+TEST(Imgproc_Filtering, scratch_arena)
+{
+    // the arena statistics are per thread, so keep all the work on the calling thread
+    int nthreads = getNumThreads();
+    setNumThreads(1);
+
+    Mat src(480, 640, CV_8UC3);
+    randu(src, 0, 256);
+    Mat src32f;
+    src.convertTo(src32f, CV_32F);
+
+    Mat ref[3], dst[3];
+    medianBlur(src, ref[0], 17);
+    bilateralFilter(src, ref[1], 9, 50, 5);
+    bilateralFilter(src32f, ref[2], 9, 50, 5);
+    for( int i = 0; i < 3; i++ )
+        dst[i].create(src.size(), ref[i].type());
+
+    for( int iter = 0; iter < 5; iter++ )
+    {
+        // the first iterations grow the arena
+        if( iter == 2 )
+            resetScratchArenaStats();
+
+        ScratchScope scope;
+        medianBlur(src, dst[0], 17);
+        bilateralFilter(src, dst[1], 9, 50, 5);
+        bilateralFilter(src32f, dst[2], 9, 50, 5);
+    }
+
+    ScratchArenaStats stats = getScratchArenaStats();
+    EXPECT_GT(stats.allocations, 0u);
+    EXPECT_EQ(0u, stats.heapAllocations);
+    EXPECT_EQ(0u, stats.usedBytes);
+
+    for( int i = 0; i < 3; i++ )
+        EXPECT_EQ(0, cvtest::norm(ref[i], dst[i], NORM_INF)) << "filter #" << i;
+
+    setNumThreads(nthreads);
+}
+
+TEST(Imgproc_Integral, parallel)
+{
+    int nthreads = getNumThreads();
+    const int types[][3] =
+    {
+        {CV_8UC1, CV_32S, CV_64F}, {CV_8UC1, CV_32F, CV_32F}, {CV_8UC1, CV_64F, CV_64F},
+        {CV_8UC3, CV_32S, CV_64F}, {CV_16UC1, CV_64F, CV_64F}, {CV_32FC1, CV_32F, CV_32F},
+        {CV_32FC2, CV_64F, CV_64F}
+    };
+    RNG& rng = theRNG();
+
+    for( size_t i = 0; i < sizeof(types)/sizeof(types[0]); i++ )
+    {
+        Mat whole(723, 1031, types[i][0]), sum[2], sqsum[2];
+        rng.fill(whole, RNG::UNIFORM, -100, 300);
+        Mat src = whole(Rect(7, 3, 1021, 717));
+
+        for( int j = 0; j < 2; j++ )
+        {
+            setNumThreads(j == 0 ? 1 : 4);
+            integral(src, sum[j], sqsum[j], types[i][1], types[i][2]);
+            if( types[i][0] == CV_8UC1 )
+            {
+                Mat tsum, tsqsum, tilted, srcf, refsum, reftilted;
+                integral(src, tsum, tsqsum, tilted, types[i][1], types[i][2]);
+                EXPECT_EQ(0, cvtest::norm(sum[j], tsum, NORM_INF)) << "type #" << i;
+                EXPECT_EQ(0, cvtest::norm(sqsum[j], tsqsum, NORM_INF)) << "type #" << i;
+
+                src.convertTo(srcf, CV_32F);
+                test_integral(srcf, &refsum, 0, &reftilted);
+                tilted.convertTo(tilted, CV_64F);
+                double eps = types[i][1] == CV_32F ? 1e-5 : 0;
+                EXPECT_LE(cvtest::norm(reftilted, tilted, NORM_INF), eps*cvtest::norm(reftilted, NORM_INF)) << "type #" << i;
+            }
+        }
+
+        EXPECT_EQ(0, cvtest::norm(sum[0], sum[1], NORM_INF)) << "type #" << i;
+        EXPECT_EQ(0, cvtest::norm(sqsum[0], sqsum[1], NORM_INF)) << "type #" << i;
+
+        // the last row and column of the sum are the totals
+        Mat total;
+        reduce(src.clone().reshape(1, src.rows*src.cols), total, 0, REDUCE_SUM, CV_64F);
+        Mat lastSum = sum[1].row(sum[1].rows - 1).reshape(1, sum[1].cols).row(sum[1].cols - 1);
+        Mat totalSum;
+        lastSum.convertTo(totalSum, CV_64F);
+        EXPECT_LE(cvtest::norm(total, totalSum, NORM_INF), 1e-5*cvtest::norm(total, NORM_INF)) << "type #" << i;
+    }
+
+    setNumThreads(nthreads);
+}
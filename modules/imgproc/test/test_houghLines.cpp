@@ -149,3 +149,65 @@ void CV_HoughLinesTest::run_test(int type)
 TEST(Imgproc_HoughLines, regression) { CV_StandartHoughLinesTest test; test.safe_run(); }
 
 TEST(Imgproc_HoughLinesP, regression) { CV_ProbabilisticHoughLinesTest test; test.safe_run(); }
+
+TEST(Imgproc_Hough, parallel)
+{
+    int nthreads = getNumThreads();
+    bool useOptimized = cv::useOptimized();
+    RNG& rng = theRNG();
+
+    for( int iter = 0; iter < 4; iter++ )
+    {
+        // dense edge map: random segments over a noise
+        Size sz(rng.uniform(200, 700), rng.uniform(200, 500));
+        Mat edges(sz, CV_8UC1), img(sz, CV_8UC1, Scalar::all(0));
+        rng.fill(edges, RNG::UNIFORM, 0, 256);
+        edges = edges > 240;
+        for( int i = 0; i < 30; i++ )
+            line(edges, Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height)),
+                 Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height)), Scalar::all(255));
+        for( int i = 0; i < 10; i++ )
+            circle(img, Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height)),
+                   rng.uniform(10, 50), Scalar::all(rng.uniform(100, 256)), -1);
+        GaussianBlur(img, img, Size(5, 5), 1.5);
+
+        std::vector<Vec2f> lines[3];
+        std::vector<Vec4i> linesP[3];
+        std::vector<Vec3f> circles[3];
+
+        // serial scalar, serial vectorized and parallel vectorized runs
+        for( int k = 0; k < 3; k++ )
+        {
+            setUseOptimized(k > 0);
+            setNumThreads(k < 2 ? 1 : 4);
+            HoughLines(edges, lines[k], 1, CV_PI/180, 100);
+            HoughLinesP(edges, linesP[k], 1, CV_PI/180, 80, 30, 3);
+            HoughCircles(img, circles[k], HOUGH_GRADIENT, 1, 10, 100, 15, 5, 60);
+        }
+
+        for( int k = 1; k < 3; k++ )
+        {
+            EXPECT_EQ(0, cvtest::norm(Mat(lines[0]).reshape(1), Mat(lines[k]).reshape(1), NORM_INF)) << "k " << k;
+            EXPECT_EQ(0, cvtest::norm(Mat(linesP[0]).reshape(1), Mat(linesP[k]).reshape(1), NORM_INF)) << "k " << k;
+            EXPECT_EQ(0, cvtest::norm(Mat(circles[0]).reshape(1), Mat(circles[k]).reshape(1), NORM_INF)) << "k " << k;
+        }
+    }
+
+    setUseOptimized(useOptimized);
+    setNumThreads(nthreads);
+}
+
+TEST(Imgproc_HoughCircles, ring)
+{
+    Mat img(480, 640, CV_8UC1, Scalar::all(0));
+    circle(img, Point(320, 240), 70, Scalar::all(255), -1);
+    GaussianBlur(img, img, Size(5, 5), 1.5);
+
+    std::vector<Vec3f> circles;
+    HoughCircles(img, circles, HOUGH_GRADIENT, 1, 100, 100, 30, 40, 100);
+
+    ASSERT_FALSE(circles.empty());
+    EXPECT_LE(fabs(circles[0][0] - 320), 2);
+    EXPECT_LE(fabs(circles[0][1] - 240), 2);
+    EXPECT_LE(fabs(circles[0][2] - 70), 2);
+}
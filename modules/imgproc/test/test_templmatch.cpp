@@ -334,3 +334,44 @@ void CV_TemplMatchTest::prepare_to_validation( int /*test_case_idx*/ )
 }
 
 TEST(Imgproc_MatchTemplate, accuracy) { CV_TemplMatchTest test; test.safe_run(); }
+
+TEST(Imgproc_MatchTemplate, parallel)
+{
+    int nthreads = getNumThreads();
+    const int types[] = { CV_8UC1, CV_8UC3, CV_32FC1, CV_32FC3 };
+    // the small templates are correlated directly, the larger ones with DFT
+    const Size templSizes[] = { Size(5, 5), Size(16, 16), Size(27, 9), Size(40, 33) };
+    RNG& rng = theRNG();
+
+    for( size_t i = 0; i < sizeof(types)/sizeof(types[0]); i++ )
+        for( size_t j = 0; j < sizeof(templSizes)/sizeof(templSizes[0]); j++ )
+        {
+            Mat img(517, 643, types[i]), templ(templSizes[j], types[i]);
+            rng.fill(img, RNG::UNIFORM, 0, 256);
+            rng.fill(templ, RNG::UNIFORM, 0, 256);
+
+            for( int method = CV_TM_SQDIFF; method <= CV_TM_CCOEFF_NORMED; method++ )
+            {
+                Mat serial, parallel;
+                setNumThreads(1);
+                matchTemplate(img, templ, serial, method);
+                setNumThreads(4);
+                matchTemplate(img, templ, parallel, method);
+
+                EXPECT_EQ(0, cvtest::norm(serial, parallel, NORM_INF))
+                    << "type " << types[i] << ", template " << templ.size() << ", method " << method;
+            }
+
+            // compare the correlation in one point with the plain sum
+            Mat corr;
+            matchTemplate(img, templ, corr, CV_TM_CCORR);
+            Point pt(rng.uniform(0, corr.cols), rng.uniform(0, corr.rows));
+            Mat prod;
+            multiply(img(Rect(pt, templ.size())), templ, prod, 1, CV_64F);
+            Scalar s4 = sum(prod);
+            double s = s4[0] + s4[1] + s4[2] + s4[3];
+            EXPECT_LE(fabs(corr.at<float>(pt) - s), 1e-5*s) << "type " << types[i] << ", template " << templ.size();
+        }
+
+    setNumThreads(nthreads);
+}
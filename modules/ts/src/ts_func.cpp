@@ -3019,6 +3019,8 @@ void printVersionInfo(bool useStdOut)
 #if CV_AVX
     if (checkHardwareSupport(CV_CPU_AVX)) cpu_features += " avx";
 #endif
+    // AVX2 kernels are selected at runtime, so they don't depend on the baseline instruction set
+    if (checkHardwareSupport(CV_CPU_AVX2)) cpu_features += " avx2";
 #if CV_NEON
     cpu_features += " neon"; // NEON is currently not checked at runtime
 #endif